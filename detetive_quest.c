@@ -9,15 +9,52 @@
 //
 // AUTOR: Diego Bloise
 // DATA: Novembro de 2025
-// LINGUAGEM: C (ANSI C - padrão C99)
-// COMPILAÇÃO: gcc detective_quest.c -o detective_quest
-// EXECUÇÃO:   ./detective_quest
+// LINGUAGEM: C11 (atômicos, _Thread_local, aligned_alloc) + POSIX.1-2008 e pthreads
+// COMPILAÇÃO: gcc -std=c11 detetive_quest.c -o detetive_quest -pthread -lm
+// EXECUÇÃO:   ./detetive_quest
 // ============================================================================
 
+/* POSIX.1-2008 (sigaction/SA_RESTART, pthread_rwlock_t, open_memstream, S_ISSOCK)
+ * também sob -std=c11, que sozinho esconde tudo que não é ISO C */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <locale.h>
+#include <time.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Caminhante AVX2 da simulação: compilado com target("avx2") e escolhido em tempo de execução */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMULACAO_AVX2
+#endif
 
 // ============================================================================
 //                            CONFIGURAÇÕES E CONSTANTES
@@ -30,6 +67,181 @@
 #define MAX_NOME 64
 #define MAX_PISTA 128
 
+/** Tamanho máximo de uma palavra indexada (após normalização). */
+#define MAX_PALAVRA 32
+
+/** Quantidade de buckets do índice invertido de palavras. */
+#define TAM_INDICE_PALAVRAS 257
+
+/** Profundidade máxima da pilha do iterador (altura AVL < 1.45 log2 n). */
+#define MAX_ALTURA_PISTAS 64
+
+/** Quantidade de pistas exibidas por página na listagem durante a exploração. */
+#define PISTAS_POR_PAGINA 5
+
+/** Maior ala com rotas pré-calculadas entre todos os pares (Floyd-Warshall, k^2 de memória). */
+#define MAX_SALAS_TABELA_ALA 256
+
+/** Pistas coletadas contra o acusado para confirmar a acusação. */
+#define PISTAS_PARA_CONDENAR 2
+
+/** Mais salas com pista de um suspeito para o plano exato (DP em 2^k x k); acima disso, plano guloso. */
+#define MAX_TERMINAIS_PLANO 12
+
+/** Meta de --bench suspeitos: p99 da consulta aproximada abaixo de 1 ms. */
+#define META_BUSCA_SUSPEITO_NS 1000000LL
+
+/** Casos pequenos conferidos por força bruta ao fim de --bench dicas. */
+#define CASOS_CONFERENCIA_DICAS 65536
+
+/** Simulação (--simular): limite de portas por partida e chance 1/N de desistir a cada porta (jogador aleatório). */
+#define SIMULACAO_MAX_PASSOS 64
+#define SIMULACAO_DESISTENCIA 8
+#define SIMULACAO_SEMENTE 0x5EED2024ULL
+
+/** Políticas de jogador da simulação. */
+#define POLITICA_ALEATORIA   0   /**< Porta sorteada; desiste ao acaso */
+#define POLITICA_EXPLORADORA 1   /**< Prefere salas novas; para ao reunir evidência */
+#define POLITICA_PALPITE     2   /**< Anda como o aleatório; acusa um suspeito sorteado, sem olhar as pistas */
+
+/** Robô detetive (MCTS): orçamento por jogada, portas por partida, nós por árvore e constante do UCB1. */
+#define MCTS_TEMPO_PADRAO_MS 100
+#define MCTS_HORIZONTE_PADRAO 32
+#define MCTS_NOS_POR_THREAD (1 << 18)
+#define MCTS_EXPLORACAO 0.7
+
+/** Ações especiais do robô (as demais são índices de porta, base 0). */
+#define MCTS_ACUSAR  -1
+#define MCTS_RAIZ    -2
+
+/** Arquivo de caso (texto, um registro por linha): cabeçalho e versão do formato. */
+#define CASO_MAGICO "DQCASO"
+#define CASO_VERSAO 1
+
+/** Resolvedor exaustivo: mais estados (salas x 2^pistas do suspeito) que isso não é tentado. */
+#define RESOLVEDOR_MAX_ESTADOS (1 << 22)
+
+/** Faixas de dificuldade: portas do menor caminho do Hall até condenar o culpado. */
+#define FAIXA_FACIL   0   /**< Até GERADOR_FACIL_MAX_PORTAS */
+#define FAIXA_MEDIA   1   /**< Até GERADOR_MEDIA_MAX_PORTAS */
+#define FAIXA_DIFICIL 2   /**< Acima disso */
+#define GERADOR_FACIL_MAX_PORTAS 3
+#define GERADOR_MEDIA_MAX_PORTAS 6
+
+/** Gerador de casos (--gerar): candidatos por rodada, casos gravados e semente. */
+#define GERADOR_CANDIDATOS 10000
+#define GERADOR_MELHORES 5
+#define GERADOR_SEMENTE 0xCA5E2025ULL
+
+/** Tamanho dos candidatos: salas, suspeitos e pistas por suspeito (cada pista em 1 ou 2 salas). */
+#define GERADOR_MIN_SALAS 8
+#define GERADOR_MAX_SALAS 40
+#define GERADOR_MAX_SUSPEITOS 5
+#define GERADOR_MAX_PISTAS_SUSPEITO 3
+
+/** Escalonador (work stealing): deque inicial, rodadas de roubo antes de dormir e menor subárvore bifurcada. */
+#define ESCALONADOR_CAPACIDADE_DEQUE 256
+#define ESCALONADOR_RODADAS_OCIOSAS 64
+#define ESCALONADOR_CORTE_ARVORE 1024
+
+/** Conjunto concorrente de pistas (skiplist): níveis máximos e detetives padrão do modo --cooperativo. */
+#define CONJUNTO_MAX_NIVEIS 24
+#define COOPERATIVO_DETETIVES 4
+
+/** RCU: fatias de contadores de leitores (uma linha de cache cada), carga máxima por balde e menor tabela. */
+#define RCU_FATIAS 64
+#define RCU_CARGA_MAXIMA 2
+#define RCU_CAPACIDADE_MINIMA 16
+
+/** Imagem do caso em memória compartilhada (--processos): assinatura, versão e sessões por processo. */
+#define IMAGEM_MAGICO "DQIMG"
+#define IMAGEM_VERSAO 1
+#define PROCESSOS_SESSOES 100000L
+
+/** Cotas de memória: blocos da reserva do processo, quantos uma sessão pode tomar e o modo --estresse. */
+#define COTA_ILIMITADA 0
+#define RESERVA_BLOCO 256
+#define RESERVA_BLOCOS 256
+#define RESERVA_POR_SESSAO 16
+#define ESTRESSE_SESSOES 4
+#define ESTRESSE_SALAS 20000
+#define ESTRESSE_MARGEM_MB 2
+#define ESTRESSE_COMANDOS 200
+#define ESTRESSE_ROTAS 8
+
+/** Histogramas de latência: 2^7 subfaixas por potência de 2 (erro < 1/64) até 2^41 ns. */
+#define HISTOGRAMA_SUB_BITS 7
+#define HISTOGRAMA_SUB (1 << HISTOGRAMA_SUB_BITS)
+#define HISTOGRAMA_MAX_BITS 41
+#define HISTOGRAMA_FAIXAS (HISTOGRAMA_SUB + (HISTOGRAMA_MAX_BITS - HISTOGRAMA_SUB_BITS) * (HISTOGRAMA_SUB / 2))
+#define LATENCIA_MAX_THREADS 256
+#define LATENCIA_COMANDOS_POR_SESSAO 64
+#define LATENCIA_SALAS 100000
+#define LATENCIA_PISTAS 2000
+
+/** Arquivo padrão para salvar/retomar a investigação. */
+#define ARQUIVO_SESSAO "detetive_quest.sav"
+
+/** Formato binário da sessão salva: assinatura mágica e versão. */
+#define SESSAO_MAGICO "DQSS"
+#define SESSAO_VERSAO 3
+
+/** Códigos de retorno de salvar/carregar sessão. */
+#define SESSAO_OK             0
+#define SESSAO_ERRO_ARQUIVO  -1  /**< Falha de E/S (abrir, gravar, renomear) */
+#define SESSAO_ERRO_FORMATO  -2  /**< Dados truncados ou assinatura mágica inválida */
+#define SESSAO_ERRO_VERSAO   -3  /**< Versão do formato não suportada */
+#define SESSAO_ERRO_CASO     -4  /**< Sessão pertence a outro caso (mapa/pistas diferentes) */
+#define SESSAO_ERRO_MEMORIA  -5  /**< Cota da sessão (ou memória do processo e reserva) esgotada */
+
+/** Diário de comandos (gravação e reprodução): assinatura mágica do arquivo. */
+#define DIARIO_MAGICO "DQJ1"
+
+/**
+ * Códigos de registro do diário. Os códigos 0-6 cabem nos 3 bits baixos do
+ * byte de registro; os demais são gravados como 7 (extensão) + 1 byte extra.
+ */
+#define DIARIO_ESQUERDA   0
+#define DIARIO_DIREITA    1
+#define DIARIO_SAIR       2
+#define DIARIO_LISTAR     3
+#define DIARIO_PREFIXO    4   /**< + texto */
+#define DIARIO_PALAVRAS   5   /**< + texto */
+#define DIARIO_GRAVAR     6
+#define DIARIO_EXTENSAO   7
+#define DIARIO_INICIO     8   /**< + estado inicial (sessão serializada) */
+#define DIARIO_ACUSAR     9   /**< + texto */
+#define DIARIO_INVALIDO  10   /**< + texto (tecla digitada) */
+#define DIARIO_VOLTAR    11
+#define DIARIO_ULTIMO_RAMO 12
+#define DIARIO_IR_PARA   13   /**< + texto (nome da sala) */
+#define DIARIO_ROTA      14   /**< + texto (nome da sala) */
+#define DIARIO_ALA       15
+#define DIARIO_PORTA_TEXTO 16 /**< + texto (índice da porta, base 0); só lido, de diários antigos */
+#define DIARIO_DICA      17   /**< + texto (suspeito; "" = todos) */
+#define DIARIO_ORACULO   18
+#define DIARIO_PORTA     19   /**< + varint (índice da porta + 1; 0 = inválida) */
+
+/** Comandos com histograma de latência (registrarComando). */
+#define COMANDO_MOVER     0   /**< Portas, e/d/v, último ramo, ir até uma sala */
+#define COMANDO_LISTAR    1   /**< Página de pistas coletadas */
+#define COMANDO_BUSCAR    2   /**< Prefixo e palavras */
+#define COMANDO_PLANEJAR  3   /**< Rota, dica, oráculo e resumo da ala */
+#define COMANDO_GRAVAR    4   /**< Gravar a investigação */
+#define COMANDO_ACUSAR    5   /**< Avaliação da acusação final */
+#define TOTAL_COMANDOS    6
+
+/** Rótulos reservados das portas derivadas da árvore de salas. */
+#define ROTULO_ESQUERDA  0
+#define ROTULO_DIREITA   1
+#define ROTULO_VOLTAR    2
+
+/** Estado da acusação registrada na sessão. */
+#define ACUSACAO_PENDENTE        0
+#define ACUSACAO_CONFIRMADA      1
+#define ACUSACAO_FRAGIL          2
+#define ACUSACAO_SEM_FUNDAMENTO  3
+
 // ============================================================================
 //                            ESTRUTURAS DE DADOS
 // ============================================================================
@@ -42,22 +254,36 @@
  *  - nome: identificador do cômodo
  *  - pista: string com a pista associada (pode ser vazia)
  *  - esquerda / direita: ponteiros para os cômodos adjacentes
+ *  - pai: cômodo de onde se chega a este (preenchido por indexarSalas)
+ *  - profundidade / rota: caminho a partir do Hall, um bit por passo
+ *  - tamanhoAla: salas da subárvore; como os IDs são pré-ordem, a ala
+ *    ocupa os IDs [id, id + tamanhoAla)
  */
 typedef struct Sala {
     char nome[MAX_NOME];           /**< Nome do cômodo (ex: "Cozinha") */
     char pista[MAX_PISTA];         /**< Pista associada (opcional) */
+    int id;                        /**< Índice da sala no caso (pré-ordem a partir do Hall) */
     struct Sala* esquerda;         /**< Sala à esquerda (NULL se não existir) */
     struct Sala* direita;          /**< Sala à direita (NULL se não existir) */
+    struct Sala* pai;              /**< Sala anterior no mapa (NULL no Hall) */
+    int profundidade;              /**< Passos desde o Hall (Hall = 0) */
+    uint64_t rota;                 /**< Bit i = passo i a partir do Hall (0 = esquerda, 1 = direita); válido até 64 passos */
+    int tamanhoAla;                /**< Quantidade de salas na subárvore (inclui a própria) */
 } Sala;
 
 /**
  * @struct PistaNode
  * @brief Nó da BST (árvore de busca binária) que armazena pistas coletadas.
  *
- * A BST organiza as pistas em ordem alfabética (strcmp).
+ * A BST organiza as pistas em ordem alfabética (strcmp). É mantida
+ * balanceada (AVL) e cada nó guarda o tamanho da própria subárvore, o que
+ * permite consultas de estatística de ordem (posição, k-ésima pista,
+ * contagem em intervalo e paginação) em O(log n).
  */
 typedef struct PistaNode {
     char pista[MAX_PISTA];         /**< Texto da pista */
+    int altura;                    /**< Altura da subárvore (folha = 1) */
+    int tamanho;                   /**< Quantidade de nós na subárvore */
     struct PistaNode* esquerda;    /**< Ponteiro para subárvore esquerda (menores) */
     struct PistaNode* direita;     /**< Ponteiro para subárvore direita (maiores) */
 } PistaNode;
@@ -72,504 +298,11490 @@ typedef struct PistaNode {
 typedef struct SuspeitoNode {
     char pista[MAX_PISTA];         /**< Texto da pista (chave) */
     char suspeito[MAX_NOME];       /**< Nome do suspeito (valor) */
+    int id;                        /**< Identificador da pista no caso (-1 se não cadastrada) */
+    int idSuspeito;                /**< Identificador do suspeito no caso (-1 se não cadastrada) */
     struct SuspeitoNode* prox;     /**< Próximo nó na lista (colisão) */
 } SuspeitoNode;
 
-// ============================================================================
-//                            PROTÓTIPOS (Doxygen)
-// ============================================================================
-
-/* ----------------- Criação e exploração da mansão ----------------- */
+/**
+ * @struct IteradorPistas
+ * @brief Cursor in-order sobre a BST de pistas, criado a partir de um limite inferior.
+ *
+ * Guarda apenas o caminho da raiz até a próxima pista (memória O(altura)).
+ * A última pista entregue fica registrada em `ultima` e o limite inferior em
+ * `inicio`, de modo que o cursor pode ser suspenso (ex.: entre duas
+ * requisições) e retomado com retomarIteradorPistas() mesmo que a árvore
+ * tenha recebido novas pistas.
+ */
+typedef struct IteradorPistas {
+    PistaNode* pilha[MAX_ALTURA_PISTAS]; /**< Ancestrais ainda não visitados */
+    int topo;                            /**< Quantidade de nós na pilha */
+    char ultima[MAX_PISTA];              /**< Última pista entregue ("" se nenhuma) */
+    char inicio[MAX_PISTA + 1];          /**< Limite inferior inclusivo ("" se nenhum) */
+} IteradorPistas;
 
 /**
- * @brief Cria dinamicamente uma sala com nome e pista associada.
+ * @struct NoRadix
+ * @brief Nó de uma árvore radix (trie compactada) usada para busca por prefixo.
  *
- * Aloca memória, copia o nome e a pista, e inicializa ponteiros.
+ * Cada aresta carrega um fragmento de texto (`rotulo`) em vez de um único
+ * caractere; cadeias sem ramificação ficam em um só nó. Os filhos formam uma
+ * lista encadeada ordenada pelo primeiro byte do rótulo, o que mantém a
+ * enumeração em ordem alfabética (mesma ordem do strcmp).
+ */
+typedef struct NoRadix {
+    char* rotulo;                  /**< Fragmento da aresta que chega ao nó */
+    int tamRotulo;                 /**< Comprimento de `rotulo` */
+    char* chave;                   /**< Texto completo se o nó termina uma pista, senão NULL */
+    struct NoRadix* filho;         /**< Primeiro filho (menor primeiro byte) */
+    struct NoRadix* irmao;         /**< Próximo irmão na lista ordenada */
+} NoRadix;
+
+/**
+ * @struct Postagem
+ * @brief Entrada do índice invertido: uma palavra e a lista de pistas que a contêm.
  *
- * @param nome Nome do cômodo (string).
- * @param pista Texto da pista associada ao cômodo (pode ser "").
- * @return Ponteiro para a Sala criada (não-NULL). Em falha, finaliza o programa.
+ * A lista de IDs é mantida em ordem crescente (as pistas recebem IDs
+ * crescentes ao serem cadastradas), o que permite interseção por intercalação.
  */
-Sala* criarSala(const char* nome, const char* pista);
+typedef struct Postagem {
+    char palavra[MAX_PALAVRA];     /**< Palavra normalizada (minúscula, sem acento) */
+    int* ids;                      /**< IDs das pistas, ordenados e sem repetição */
+    int total;                     /**< Quantidade de IDs */
+    int capacidade;                /**< Capacidade alocada de `ids` */
+    struct Postagem* prox;         /**< Próxima palavra no mesmo bucket */
+} Postagem;
 
 /**
- * @brief Explora a mansão interativamente a partir de uma sala inicial.
+ * @struct NoBK
+ * @brief Nó de uma BK-tree sobre os nomes dos suspeitos (distância de edição).
  *
- * A cada sala visitada, se houver pista não-vazia, ela é automaticamente
- * inserida na BST de pistas e relacionada na tabela hash (pista→suspeito).
+ * Cada filho fica pendurado pela distância de Levenshtein até o pai; pela
+ * desigualdade triangular, uma busca com tolerância t só precisa descer nos
+ * filhos com distância em [d - t, d + t]. As comparações usam o nome
+ * normalizado (minúsculas, sem acentos, espaços simples).
+ */
+typedef struct NoBK {
+    char nome[MAX_NOME];           /**< Nome do suspeito como cadastrado */
+    char chave[MAX_NOME];          /**< Nome normalizado usado nas distâncias */
+    int id;                        /**< Identificador do suspeito no caso */
+    int distancia;                 /**< Distância até o nó pai */
+    struct NoBK* filho;            /**< Primeiro filho */
+    struct NoBK* irmao;            /**< Próximo irmão (mesmo pai) */
+} NoBK;
+
+/**
+ * @struct TotaisAlas
+ * @brief Árvores de Fenwick com as salas que guardam pistas, iguais para toda sessão.
  *
- * Comandos de navegação:
- *  - 'e' / 'E' : esquerda
- *  - 'd' / 'D' : direita
- *  - 's' / 'S' : encerrar exploração
+ * Montadas uma vez por caso, na primeira sessão; cada sessão guarda só o que
+ * já encontrou, e "pendentes" é a diferença entre as duas árvores.
+ */
+typedef struct TotaisAlas {
+    int** porSuspeito;             /**< [suspeito]: salas com pista do suspeito */
+    int* total;                    /**< Salas com qualquer pista cadastrada */
+    int totalSuspeitos;            /**< Quantidade de suspeitos indexados */
+    int totalSalas;                /**< Quantidade de posições de cada árvore */
+} TotaisAlas;
+
+/**
+ * @struct Caso
+ * @brief Dados fixos de um caso: mapa da mansão, suspeitos e índices de pistas.
  *
- * @param atual Ponteiro para a sala inicial (raiz da exploração).
- * @param raizPistas Endereço do ponteiro para a raiz da BST de pistas coletadas.
- * @param tabela Tabela hash (vetor de ponteiros para SuspeitoNode) já inicializada.
+ * Agrupa tudo que é montado uma vez em main() e só é lido durante a partida.
  */
-void explorarMansao(Sala* atual, PistaNode** raizPistas, SuspeitoNode* tabela[]);
+typedef struct Caso {
+    Sala* mansao;                  /**< Raiz da árvore de salas (Hall de Entrada) */
+    SuspeitoNode* tabela[TAM_HASH]; /**< Tabela hash pista -> suspeito */
+    NoRadix* prefixos;             /**< Índice de prefixos de todas as pistas conhecidas */
+    Postagem* palavras[TAM_INDICE_PALAVRAS]; /**< Índice invertido palavra -> IDs de pistas */
+    SuspeitoNode** pistasPorId;    /**< Catálogo: ID -> nó da tabela hash */
+    int totalPistas;               /**< Quantidade de pistas cadastradas */
+    int capacidadePistas;          /**< Capacidade alocada do catálogo */
+    NoBK* suspeitos;               /**< BK-tree com os nomes dos suspeitos */
+    NoBK** suspeitosPorId;         /**< Registro: ID -> nó da BK-tree */
+    int totalSuspeitos;            /**< Quantidade de suspeitos cadastrados */
+    int capacidadeSuspeitos;       /**< Capacidade alocada do registro */
+    Sala** salasPorId;             /**< Índice: ID -> sala (pré-ordem) */
+    int totalSalas;                /**< Quantidade de salas da mansão */
+    int* salasPorNome;             /**< Hash aberto nome normalizado -> ID da sala (-1 = vazio) */
+    uint32_t* hashNomes;           /**< Hash de cada posição de `salasPorNome` */
+    int capacidadeNomes;           /**< Tamanho do hash de nomes (potência de 2) */
+    int* inicioPortas;             /**< CSR: portas da sala i em [inicioPortas[i], inicioPortas[i + 1]) */
+    int* destinoPortas;            /**< CSR: ID da sala de destino de cada porta */
+    uint16_t* rotuloPortas;        /**< CSR: índice do rótulo de cada porta */
+    uint16_t* custoPortas;         /**< CSR: custo do corredor (portas da árvore = 1) */
+    int totalPortas;               /**< Quantidade de portas no CSR */
+    int* avulsasOrigem;            /**< Portas extras ainda fora do CSR: origem */
+    int* avulsasDestino;           /**< Portas extras ainda fora do CSR: destino */
+    uint16_t* avulsasRotulo;       /**< Portas extras ainda fora do CSR: rótulo */
+    uint16_t* avulsasCusto;        /**< Portas extras ainda fora do CSR: custo */
+    int totalAvulsas;              /**< Quantidade de portas extras pendentes */
+    int capacidadeAvulsas;         /**< Capacidade dos vetores de portas pendentes */
+    char** rotulos;                /**< Tabela de rótulos de porta ("esquerda", "passagem secreta"...) */
+    int totalRotulos;              /**< Quantidade de rótulos */
+    uint32_t assinatura;           /**< Impressão digital do caso (salas e pistas, FNV-1a) */
+    _Atomic(TotaisAlas*) totaisAlas; /**< Pistas por ala (montadas na primeira sessão; NULL = ainda não) */
+} Caso;
 
-/* ----------------- BST de pistas ----------------- */
+/**
+ * @struct ReservaMemoria
+ * @brief Blocos pré-alocados que socorrem as sessões quando o malloc falha.
+ *
+ * Só atende pedidos de até RESERVA_BLOCO bytes (nós da BST de pistas), e
+ * cada sessão toma no máximo RESERVA_POR_SESSAO blocos: uma sessão
+ * desgovernada não esvazia a reserva das outras.
+ */
+typedef struct ReservaMemoria {
+    unsigned char* blocos;         /**< RESERVA_BLOCO * total bytes contíguos */
+    int* livres;                   /**< Pilha de índices dos blocos livres */
+    int totalLivres;               /**< Altura da pilha */
+    int total;                     /**< Quantidade de blocos */
+    long emprestimos;              /**< Blocos já emprestados (acumulado) */
+    pthread_mutex_t trava;         /**< Sessões de threads diferentes dividem a reserva */
+} ReservaMemoria;
 
 /**
- * @brief Insere uma pista na BST (mantendo ordem alfabética).
+ * @struct CotaMemoria
+ * @brief Orçamento de memória de uma sessão.
  *
- * Não insere duplicatas idênticas (comparação por strcmp).
+ * Toda alocação da sessão passa por alocarNaCota(); cada bloco guarda num
+ * cabeçalho a cota dona, então liberarDaCota() não precisa recebê-la.
+ * Os campos são da thread dona da sessão (só a reserva é compartilhada).
+ */
+typedef struct CotaMemoria {
+    size_t limite;                 /**< Bytes permitidos (COTA_ILIMITADA = sem limite) */
+    size_t usados;                 /**< Bytes alocados agora (com cabeçalhos) */
+    size_t pico;                   /**< Maior valor de `usados` */
+    long recusas;                  /**< Pedidos negados (cota, memória do processo ou reserva) */
+    long socorros;                 /**< Pedidos atendidos pela reserva */
+    int emprestados;               /**< Blocos da reserva em uso agora */
+    ReservaMemoria* reserva;       /**< Reserva do processo (NULL = nenhuma) */
+} CotaMemoria;
+
+/**
+ * @struct ContagemAlas
+ * @brief Árvores de Fenwick (BIT) sobre os IDs de sala para resumos por ala.
  *
- * @param raiz Ponteiro para a raiz atual da BST.
- * @param pista Texto da pista a inserir.
- * @return Ponteiro atualizado para a raiz da BST.
+ * Como a ala de uma sala é um intervalo contíguo de IDs, "quantas pistas do
+ * suspeito X há sob a Biblioteca" vira uma soma de intervalo em O(log n), e
+ * cada primeira visita é uma atualização pontual em O(log n).
+ * Os vetores são 1-based (posição id + 1). Só as salas encontradas são da
+ * sessão; os totais do caso são compartilhados (Caso::totaisAlas).
  */
-PistaNode* inserirPista(PistaNode* raiz, const char* pista);
+typedef struct ContagemAlas {
+    int** encontradas;             /**< [suspeito]: salas visitadas com pista do suspeito */
+    int* encontradasTotal;         /**< Salas visitadas com qualquer pista (para listar) */
+    const TotaisAlas* totais;      /**< Totais do caso (pendentes = totais - encontradas) */
+    int totalSuspeitos;            /**< Quantidade de suspeitos indexados */
+    int totalSalas;                /**< Quantidade de posições de cada árvore */
+    int marcadas;                  /**< Visitas somadas desde a última limpeza (0 = árvores zeradas) */
+    CotaMemoria* cota;             /**< Cota de onde saem os vetores (a da sessão dona) */
+} ContagemAlas;
 
 /**
- * @brief Exibe todas as pistas armazenadas na BST, em ordem alfabética.
+ * @struct Sessao
+ * @brief Estado de uma partida: posição, pistas coletadas e acusação.
  *
- * Percurso in-order recursivo.
+ * As pistas coletadas ficam na BST (ordem alfabética) e também em um bitset
+ * indexado pelo ID da pista, que é o que vai para o arquivo salvo.
+ * As salas visitadas ficam em outro bitset (ID da sala), e a pilha `ramos`
+ * guarda as salas na ordem da primeira visita para o comando "último ramo".
+ * Toda a memória da sessão sai da sua cota, que os blocos apontam: depois
+ * de iniciada, a sessão não pode ser copiada para outro endereço.
+ */
+typedef struct Sessao {
+    Sala* atual;                   /**< Sala onde o jogador está */
+    PistaNode* pistas;             /**< BST de pistas coletadas */
+    unsigned char* coletadas;      /**< Bitset: bit i = pista de ID i coletada */
+    int totalBits;                 /**< Quantidade de bits válidos em `coletadas` */
+    unsigned char* visitadas;      /**< Bitset: bit i = sala de ID i já visitada */
+    int* ramos;                    /**< Pilha de IDs de salas que ainda podem ter saídas inexploradas */
+    int totalRamos;                /**< Altura da pilha `ramos` */
+    ContagemAlas alas;             /**< Contagens por ala (comando 'a') */
+    int estadoAcusacao;            /**< ACUSACAO_* */
+    char acusado[MAX_NOME];        /**< Nome do acusado ("" se pendente) */
+    IteradorPistas listagem;       /**< Cursor da listagem paginada (comando 'p') */
+    CotaMemoria cota;              /**< Orçamento de memória da sessão */
+} Sessao;
+
+/**
+ * @struct Diario
+ * @brief Diário binário de comandos de uma ou mais sessões (modo --diario).
  *
- * @param raiz Ponteiro para a raiz da BST de pistas.
+ * Cada registro começa com um byte: 3 bits de código e 5 bits com o
+ * intervalo desde o comando anterior, em ms (0-30; 31 = intervalo maior,
+ * gravado em seguida como varint). Textos vão como varint de tamanho + bytes.
  */
-void exibirPistas(PistaNode* raiz);
+typedef struct Diario {
+    FILE* arquivo;                 /**< Arquivo aberto para anexar (NULL = desligado) */
+    long long ultimoMs;            /**< Instante do último registro */
+} Diario;
 
 /**
- * @brief Libera recursivamente toda a memória alocada pela BST de pistas.
+ * @struct IndiceLCA
+ * @brief Sparse table para ancestral comum (LCA) em O(1) sobre a mansão.
  *
- * @param raiz Ponteiro para a raiz da BST.
+ * Usa a variante do Euler tour com n posições: como os IDs das salas já são
+ * a pré-ordem, o LCA de u != v é o pai da sala de menor profundidade no
+ * intervalo de IDs (min(u,v), max(u,v)]. Cada entrada guarda
+ * (profundidade << 32 | ID do pai), de modo que o mínimo já traz a resposta.
  */
-void liberarPistas(PistaNode* raiz);
+typedef struct IndiceLCA {
+    uint64_t** niveis;             /**< niveis[k][i] = mínimo do intervalo [i, i + 2^k) */
+    int totalNiveis;               /**< Quantidade de níveis (floor(log2 n) + 1) */
+    int* profundidades;            /**< Profundidade por ID de sala (vetor compacto) */
+    int totalSalas;                /**< Quantidade de salas indexadas */
+} IndiceLCA;
 
-/* ----------------- Tabela hash e suspeitos ----------------- */
+/**
+ * @struct ConsultaLCA
+ * @brief Par de salas de uma consulta em lote e as respostas.
+ */
+typedef struct ConsultaLCA {
+    int a, b;                      /**< IDs das salas consultadas */
+    int ancestral;                 /**< Saída: ID da sala mais profunda em comum */
+    int distancia;                 /**< Saída: passos entre as duas salas */
+} ConsultaLCA;
 
 /**
- * @brief Inicializa a tabela hash, setando todos os buckets para NULL.
+ * @struct HeapRadix
+ * @brief Fila de prioridade monotônica para Dijkstra com custos inteiros.
  *
- * @param tabela Vetor (size TAM_HASH) de ponteiros para SuspeitoNode.
+ * O balde i guarda as chaves cujo bit mais alto diferente da última chave
+ * retirada é o bit i - 1 (balde 0 = iguais). Cada entrada desce de balde no
+ * máximo 32 vezes, então inserir é O(1) e retirar é O(log C) amortizado.
  */
-void inicializarHash(SuspeitoNode* tabela[]);
+typedef struct HeapRadix {
+    uint32_t ultima;               /**< Última chave retirada (mínimo corrente) */
+    int total;                     /**< Entradas na fila */
+    uint32_t* chaves[33];          /**< Chave de cada entrada, por balde */
+    int* salas[33];                /**< Sala de cada entrada, por balde */
+    int tamanho[33];               /**< Entradas em cada balde */
+    int capacidade[33];            /**< Capacidade de cada balde */
+    int semMemoria;                /**< Um balde não pôde crescer: a busca corrente é descartada */
+} HeapRadix;
 
 /**
- * @brief Função hash simples — transforma a string (pista) em índice.
- *
- * Implementação: soma dos bytes (unsigned char) mod TAM_HASH.
+ * @struct PlanejadorRotas
+ * @brief Área de trabalho reutilizável para consultas de rota no grafo.
  *
- * @param pista Texto da pista.
- * @return Índice no intervalo [0, TAM_HASH-1].
+ * Guarda o CSR reverso (portas de chegada) para as buscas bidirecionais e
+ * vetores indexados por sala com carimbo de geração, de modo que cada
+ * consulta custa só o que visita (não há limpeza O(n) entre consultas).
+ * O índice [0] é a busca a partir da origem; [1], a busca a partir do destino.
+ * Deve ser refeito se o CSR do caso for reconstruído.
  */
-int hash(const char* pista);
+typedef struct PlanejadorRotas {
+    const Caso* caso;              /**< Caso cujo CSR é consultado */
+    int* inicioReverso;            /**< CSR reverso: portas que chegam à sala i */
+    int* origemReversa;            /**< CSR reverso: sala de origem de cada porta */
+    uint16_t* custoReverso;        /**< CSR reverso: custo de cada porta */
+    uint32_t* distancia[2];        /**< Distância (portas ou custo) por sala */
+    uint32_t* marca[2];            /**< Geração em que `distancia` foi escrita */
+    int* anterior[2];              /**< Sala anterior no caminho de cada busca */
+    int* fila[2];                  /**< Filas da BFS */
+    int* caminho;                  /**< Rota da última consulta de planejarAte (reutilizada) */
+    uint32_t geracao;              /**< Geração da consulta corrente */
+    HeapRadix heaps[2];            /**< Filas de prioridade do Dijkstra */
+} PlanejadorRotas;
 
 /**
- * @brief Insere uma associação (pista -> suspeito) na tabela hash.
- *
- * Trata colisões por inserção no início da lista encadeada do bucket.
+ * @struct TabelaAla
+ * @brief Rotas pré-calculadas entre todas as salas de uma ala pequena.
  *
- * @param tabela Tabela hash previamente inicializada.
- * @param pista Texto da pista (chave).
- * @param suspeito Nome do suspeito (valor).
+ * Floyd-Warshall sobre as portas internas à ala (IDs [base, base + tamanho)),
+ * com matriz de próximo salto para reconstruir a rota em O(comprimento).
  */
-void inserirNaHash(SuspeitoNode* tabela[], const char* pista, const char* suspeito);
+typedef struct TabelaAla {
+    int base;                      /**< ID da raiz da ala */
+    int tamanho;                   /**< Salas na ala (k) */
+    uint32_t* custo;               /**< k x k: custo mínimo (UINT32_MAX = sem rota interna) */
+    int* proximo;                  /**< k x k: próxima sala (índice local) na rota */
+} TabelaAla;
 
 /**
- * @brief Consulta a tabela hash buscando o suspeito ligado a uma pista.
- *
- * Se a pista não estiver presente, retorna a string literal "Desconhecido".
+ * @struct PlanoSuspeito
+ * @brief Tabelas para reunir evidências contra um suspeito pelo menor caminho.
  *
- * @param tabela Tabela hash.
- * @param pista Texto da pista buscada.
- * @return Ponteiro para o nome do suspeito (string estática ou do nó).
+ * Os terminais são as salas com pista do suspeito. `ate` guarda a distância
+ * (em portas) de qualquer sala até cada terminal (BFS no grafo reverso) e
+ * `cadeia` o menor passeio que sai de um terminal e passa por um conjunto de
+ * terminais (DP sobre subconjuntos). Nada disso depende da posição do
+ * jogador: a cada dica basta combinar as tabelas com a sala atual.
  */
-const char* encontrarSuspeito(SuspeitoNode* tabela[], const char* pista);
+typedef struct PlanoSuspeito {
+    int pronto;                    /**< Tabelas já montadas (montagem na primeira dica) */
+    int total;                     /**< Quantidade de terminais */
+    int* salas;                    /**< ID da sala de cada terminal */
+    int* pistas;                   /**< ID da pista de cada terminal */
+    int* mesmaPista;               /**< Máscara dos outros terminais com a mesma pista */
+    uint32_t* ate;                 /**< total x salas: portas até o terminal i (NULL = plano guloso) */
+    uint32_t* cadeia;              /**< 2^total x total: menor passeio a partir do terminal i cobrindo a máscara */
+} PlanoSuspeito;
 
 /**
- * @brief Libera toda a memória alocada na tabela hash (listas encadeadas).
+ * @struct PlanejadorEvidencias
+ * @brief Planos de todos os suspeitos de um caso (comando 'c').
+ */
+typedef struct PlanejadorEvidencias {
+    const Caso* caso;              /**< Caso planejado */
+    const PlanejadorRotas* rotas;  /**< Fornece o CSR reverso */
+    PlanoSuspeito* suspeitos;      /**< Plano por ID de suspeito */
+    int totalSuspeitos;            /**< Quantidade de planos */
+    int* pistaDaSala;              /**< ID da pista de cada sala (-1 = sem pista) */
+    int* distancia;                /**< Área da BFS do plano guloso (-1 = não alcançada) */
+    int* fila;                     /**< Fila da BFS do plano guloso */
+} PlanejadorEvidencias;
+
+/**
+ * @struct GeradorXoshiro
+ * @brief Estado do gerador pseudoaleatório xoshiro256** (simulação).
  *
- * @param tabela Tabela hash.
+ * Cada thread recebe uma cópia avançada com saltarXoshiro(), o que garante
+ * sequências sem sobreposição sem nenhum estado compartilhado.
  */
-void liberarHash(SuspeitoNode* tabela[]);
+typedef struct GeradorXoshiro {
+    uint64_t s[4];                 /**< Estado (não pode ser todo zero) */
+} GeradorXoshiro;
 
-/* ----------------- Verificação final / utilitários ----------------- */
+/**
+ * @struct MapaPistas
+ * @brief Pistas do caso em vetores planos, para os laços quentes (simulação e robô).
+ */
+typedef struct MapaPistas {
+    int* pistaDaSala;              /**< ID da pista de cada sala (-1 = sem pista) */
+    int* suspeitoDaPista;          /**< ID do suspeito de cada pista */
+    uint64_t* mascaraSuspeito;     /**< [suspeito]: bits das pistas dele (válido se cabeEm64) */
+    int cabeEm64;                  /**< O caso tem no máximo 64 pistas */
+} MapaPistas;
 
 /**
- * @brief Conta, entre as pistas coletadas (BST), quantas apontam para um suspeito.
- *
- * Percorre a BST e, para cada pista, consulta a tabela hash para recuperar
- * o suspeito associado — se coincidir com o nome passado, incrementa contador.
- *
- * @param tabela Tabela hash (pista→suspeito).
- * @param raizPistas Raiz da BST com as pistas coletadas.
- * @param suspeito Nome do suspeito a ser verificado.
- * @return Quantidade de pistas coletadas que apontam para o suspeito.
+ * @struct OpcoesMCTS
+ * @brief Parâmetros de uma busca do robô detetive.
  */
-int contarPistasPorSuspeitoNaBST(SuspeitoNode* tabela[], PistaNode* raizPistas, const char* suspeito);
+typedef struct OpcoesMCTS {
+    int tempoMs;                   /**< Orçamento de tempo por jogada */
+    int threads;                   /**< Árvores em paralelo (<= 0 ou acima do escalonador = uma por trabalhador) */
+    int horizonte;                 /**< Portas que ainda podem ser atravessadas */
+    int nosPorThread;              /**< Capacidade do pool de nós de cada árvore */
+} OpcoesMCTS;
 
 /**
- * @brief Fase de julgamento: solicita acusação e verifica evidências.
- *
- * Regras: acusação é considerada consistente se houver pelo menos 2 pistas
- * coletadas que apontem para o suspeito acusado.
- *
- * @param tabela Tabela hash de associações.
- * @param raizPistas Raiz da BST com as pistas coletadas.
+ * @struct ResultadoMCTS
+ * @brief Jogada escolhida pelo robô e números da busca.
  */
-void verificarSuspeitoFinal(SuspeitoNode* tabela[], PistaNode* raizPistas);
+typedef struct ResultadoMCTS {
+    int acao;                      /**< Porta (base 0) ou MCTS_ACUSAR */
+    int suspeito;                  /**< Quem acusar, pelas pistas já em mãos */
+    double valor;                  /**< Recompensa média estimada da jogada */
+    long long playouts;            /**< Simulações (todas as threads) */
+    long long nos;                 /**< Nós criados (todas as threads) */
+    int arvoresCheias;             /**< Árvores que esgotaram o pool antes do prazo */
+} ResultadoMCTS;
+
+struct ArvoreMCTS;
 
 /**
- * @brief Limpa o buffer de entrada (stdin) para evitar lixo em leituras.
+ * @struct RoboDetetive
+ * @brief Estado do robô que dura a partida inteira: mapa de pistas e pools de nós.
  */
-void limparBufferEntrada(void);
+typedef struct RoboDetetive {
+    MapaPistas mapa;               /**< Pistas do caso em bits (montado uma vez) */
+    OpcoesMCTS opcoes;             /**< Opções da partida; o horizonte só pode baixar entre jogadas */
+    struct ArvoreMCTS* arvores;    /**< Uma árvore (pool + pilha da descida) por thread; NULL = não iniciado */
+    int threads;                   /**< Árvores alocadas */
+    int maxAcoes;                  /**< Maior número de portas de uma sala + 1 (acusar) */
+    uint32_t* visitas;             /**< [ação da raiz]: visitas somadas das árvores */
+    double* somas;                 /**< [ação da raiz]: recompensas somadas das árvores */
+} RoboDetetive;
 
 /**
- * @brief Limpa o terminal (compatível Windows / Unix).
+ * @struct AvaliacaoCaso
+ * @brief Veredito do resolvedor exaustivo sobre um caso (gerador e --caso).
  */
-void limparTela(void);
+typedef struct AvaliacaoCaso {
+    int condenaveis;               /**< Suspeitos que alguma rota a partir do Hall condena */
+    int culpado;                   /**< ID do único condenável (-1 se não houver exatamente um) */
+    int portas;                    /**< Menor rota do Hall até condenar o culpado (-1 sem culpado) */
+    int faixa;                     /**< FAIXA_* do caso (-1 sem culpado) */
+    int armadilhas;                /**< Salas com pista de inocente a no máximo `portas` do Hall */
+} AvaliacaoCaso;
 
 /**
- * @brief Libera toda a memória da árvore de salas (mansão).
- *
- * Percorre recursivamente e libera cada nó (Sala).
+ * @struct Tarefa
+ * @brief Unidade de trabalho do escalonador (fica na pilha de quem bifurca até o join).
+ */
+typedef struct Tarefa {
+    void (*executar)(void* arg);   /**< Corpo da tarefa */
+    void* arg;                     /**< Argumento do corpo */
+    struct GrupoTarefas* grupo;    /**< Join que espera por ela */
+} Tarefa;
+
+/**
+ * @struct GrupoTarefas
+ * @brief Ponto de junção: tarefas bifurcadas que ainda não terminaram.
+ */
+typedef struct GrupoTarefas {
+    atomic_int pendentes;          /**< Bifurcadas e não concluídas */
+} GrupoTarefas;
+
+/**
+ * @struct VetorDeque
+ * @brief Buffer circular de um deque; ao crescer, o antigo fica encadeado até o fim do escalonador.
+ */
+typedef struct VetorDeque {
+    long capacidade;               /**< Potência de 2 */
+    struct VetorDeque* anterior;   /**< Buffer substituído (ladrões podem ainda estar lendo) */
+    _Atomic(Tarefa*) itens[];      /**< Tarefas, indexadas por posição & (capacidade - 1) */
+} VetorDeque;
+
+/**
+ * @struct DequeTarefas
+ * @brief Deque de Chase-Lev: o dono empilha e desempilha na base; ladrões tiram do topo.
+ */
+typedef struct DequeTarefas {
+    _Alignas(64) atomic_long topo; /**< Próxima posição a ser roubada */
+    _Alignas(64) atomic_long base; /**< Próxima posição livre (só o dono escreve) */
+    _Atomic(VetorDeque*) vetor;    /**< Buffer atual */
+} DequeTarefas;
+
+/**
+ * @struct Trabalhador
+ * @brief Um núcleo do escalonador: deque próprio, thread e estatísticas.
  *
- * @param raiz Ponteiro para a raiz da árvore de salas.
+ * O trabalhador 0 não tem thread: é ocupado pela thread que entra no
+ * escalonador (executarNoEscalonador) enquanto ela espera pelo resultado.
  */
-void liberarMansao(Sala* raiz);
+typedef struct Trabalhador {
+    DequeTarefas deque;            /**< Tarefas bifurcadas por este trabalhador */
+    struct Escalonador* escalonador; /**< Dono */
+    int indice;                    /**< Posição no escalonador */
+    uint64_t sorteio;              /**< Estado do xorshift que escolhe a vítima do roubo */
+    pthread_t thread;              /**< Thread (trabalhadores 1..total-1) */
+    int criada;                    /**< A thread subiu */
+    atomic_llong tarefas;          /**< Tarefas executadas */
+    atomic_llong roubos;           /**< Tarefas roubadas de outros deques */
+    atomic_llong roubosFalhos;     /**< Tentativas de roubo sem sucesso */
+    atomic_llong ociosoNs;         /**< Tempo procurando trabalho ou dormindo */
+} Trabalhador;
 
-// ============================================================================
-//                                MAIN
-// ============================================================================
+/**
+ * @struct Escalonador
+ * @brief Pool de trabalhadores com roubo de tarefas, compartilhado pelos motores paralelos.
+ */
+typedef struct Escalonador {
+    int total;                     /**< Trabalhadores (inclui o 0, da thread chamadora) */
+    Trabalhador* trabalhadores;    /**< Vetor alinhado a 64 bytes */
+    atomic_int encerrar;           /**< Pede a saída das threads */
+    atomic_int dormindo;           /**< Trabalhadores esperando em `acordar` */
+    pthread_mutex_t trava;         /**< Protege o sono (com `acordar`) */
+    pthread_cond_t acordar;        /**< Sinalizado quando surge tarefa */
+    pthread_mutex_t entrada;       /**< Uma thread externa por vez ocupa o trabalhador 0 */
+} Escalonador;
 
 /**
- * @brief Ponto de entrada do programa.
+ * @struct NoConjunto
+ * @brief Nó da skiplist do conjunto concorrente de pistas.
  *
- * Constrói o mapa fixo da mansão, inicializa a tabela hash com associações
- * pista→suspeito, conduz a exploração interativa, exibe pistas e realiza
- * a fase final de acusação.
+ * O texto fica no mesmo bloco, logo depois dos ponteiros. Depois de ligado
+ * no nível 0 o nó nunca sai da lista; só os ponteiros `proximo` mudam.
  */
-int main(void) {
-    setlocale(LC_ALL, "Portuguese");
+typedef struct NoConjunto {
+    const char* pista;             /**< Texto da pista (NULL na cabeça) */
+    int niveis;                    /**< Níveis em que o nó aparece (1..CONJUNTO_MAX_NIVEIS) */
+    _Atomic(struct NoConjunto*) proximo[]; /**< Sucessor em cada nível */
+} NoConjunto;
 
-    limparTela();
-    printf("========================================================\n");
-    printf("  DETECTIVE QUEST - NÍVEL MESTRE (Investigaçã o Final)\n");
-    printf("========================================================\n\n");
+/**
+ * @struct ConjuntoPistas
+ * @brief Conjunto ordenado de pistas com inserção concorrente sem travas (skiplist).
+ *
+ * Várias threads inserem ao mesmo tempo (inserir-se-ausente por CAS no
+ * nível 0). Não há remoção, então nenhum nó é liberado antes de
+ * liberarConjuntoPistas() e leitores nunca tocam memória devolvida.
+ */
+typedef struct ConjuntoPistas {
+    NoConjunto* cabeca;            /**< Sentinela com CONJUNTO_MAX_NIVEIS níveis */
+} ConjuntoPistas;
 
-    /* -----------------------------
-     * Montagem fixa da mansão (árvore)
-     * -----------------------------
-     *
-     *                 [Hall de Entrada]
-     *                   /           \
-     *            [Biblioteca]       [Cozinha]
-     *             /      \             \
-     *       [Sala de Estudo] [Jardim]  [Sótão]
-     *
-     * Cada cômodo tem uma pista estática definida abaixo.
-     */
+/**
+ * @struct FatiaRCU
+ * @brief Contadores de leitores de uma fatia de threads, um por paridade de época.
+ */
+typedef struct FatiaRCU {
+    _Alignas(64) atomic_long leitores[2]; /**< Seções de leitura abertas em cada paridade */
+} FatiaRCU;
 
-    Sala* hall       = criarSala("Hall de Entrada", "Pegadas de lama recentes");
-    Sala* biblioteca = criarSala("Biblioteca", "Página arrancada de um diário");
-    Sala* cozinha    = criarSala("Cozinha", "Copo quebrado com marca de batom");
-    Sala* estudo     = criarSala("Sala de Estudo", "Envelope selado com cera vermelha");
-    Sala* jardim     = criarSala("Jardim", "Chave antiga caída entre as flores");
-    Sala* sotao      = criarSala("Sótão", "Retrato rasgado de uma mulher desconhecida");
+/**
+ * @struct DominioRCU
+ * @brief Período de graça ao estilo RCU: leitores só incrementam um contador.
+ *
+ * O leitor soma 1 no contador da paridade atual (na fatia da sua thread) e
+ * subtrai ao sair; quem escreve inverte a paridade duas vezes e, a cada vez,
+ * espera zerar os contadores da paridade antiga. Depois disso nenhum leitor
+ * pode ainda enxergar o que foi despublicado antes da espera.
+ */
+typedef struct DominioRCU {
+    atomic_int paridade;           /**< Paridade em que novos leitores entram */
+    atomic_long periodos;          /**< Períodos de graça concluídos */
+    FatiaRCU fatias[RCU_FATIAS];   /**< Contadores por fatia de threads */
+} DominioRCU;
 
-    hall->esquerda       = biblioteca;
-    hall->direita        = cozinha;
-    biblioteca->esquerda = estudo;
-    biblioteca->direita  = jardim;
-    cozinha->direita     = sotao;
+/**
+ * @struct VersaoTabelaRCU
+ * @brief Uma versão publicada da tabela pista -> suspeito.
+ *
+ * Os nós de uma cadeia publicada nunca mudam: atualizar um balde é publicar
+ * uma cópia da cadeia; redimensionar é publicar uma versão nova inteira.
+ */
+typedef struct VersaoTabelaRCU {
+    int capacidade;                /**< Baldes (potência de 2) */
+    int total;                     /**< Pistas na versão (só quem escreve lê) */
+    _Atomic(SuspeitoNode*) baldes[]; /**< Cabeça da cadeia de cada balde */
+} VersaoTabelaRCU;
 
-    /* -----------------------------
-     * Inicialização da BST de pistas e tabela hash
-     * ----------------------------- */
-    PistaNode* raizPistas = NULL;
-    SuspeitoNode* tabela[TAM_HASH];
-    inicializarHash(tabela);
+/**
+ * @struct TabelaSuspeitosRCU
+ * @brief Tabela pista -> suspeito para muitos leitores e raras atualizações.
+ *
+ * Consultas não travam nem esperam (entram no domínio RCU, seguem ponteiros
+ * imutáveis e saem); atualizações são serializadas por `escrita` e liberam a
+ * memória antiga só depois de um período de graça.
+ */
+typedef struct TabelaSuspeitosRCU {
+    _Atomic(VersaoTabelaRCU*) atual; /**< Versão que os leitores enxergam */
+    pthread_mutex_t escrita;       /**< Um escritor por vez */
+    DominioRCU rcu;                /**< Protege versões e cadeias despublicadas */
+    long redimensionamentos;       /**< Versões inteiras publicadas por crescimento */
+} TabelaSuspeitosRCU;
 
-    /* -----------------------------
-     * Associação pista -> suspeito (pré-definida)
-     * -----------------------------
-     *
-     * Observação: não há inserção dinâmica de suspeitos neste nível.
-     */
-    inserirNaHash(tabela, "Pegadas de lama recentes", "Jardineiro");
-    inserirNaHash(tabela, "Página arrancada de um diário", "Governanta");
-    inserirNaHash(tabela, "Copo quebrado com marca de batom", "Madame Sinclair");
-    inserirNaHash(tabela, "Envelope selado com cera vermelha", "Governanta");
-    inserirNaHash(tabela, "Chave antiga caída entre as flores", "Jardineiro");
-    inserirNaHash(tabela, "Retrato rasgado de uma mulher desconhecida", "Madame Sinclair");
+/**
+ * @struct VersaoCaso
+ * @brief Um caso publicado no catálogo, com a contagem de quem o fixou.
+ */
+typedef struct VersaoCaso {
+    Caso caso;                     /**< Mansão, pistas e suspeitos desta versão */
+    atomic_int referencias;        /**< Sessões fixadas (+1 enquanto for a versão atual) */
+    int numero;                    /**< 1, 2, ... na ordem de publicação */
+    struct CatalogoCasos* catalogo; /**< Dono (contagem de versões liberadas) */
+} VersaoCaso;
 
-    /* -----------------------------
-     * Exploração interativa (coleta automática de pistas)
-     * ----------------------------- */
-    explorarMansao(hall, &raizPistas, tabela);
+/**
+ * @struct CatalogoCasos
+ * @brief Versão atual do caso, trocada a quente sem parar as sessões em andamento.
+ *
+ * Cada sessão fixa a versão atual ao começar e a solta ao terminar; uma
+ * recarga publica a versão nova com um único store atômico e a antiga só é
+ * liberada quando a última sessão fixada nela terminar.
+ */
+typedef struct CatalogoCasos {
+    _Atomic(VersaoCaso*) atual;    /**< Versão que as novas sessões recebem */
+    DominioRCU rcu;                /**< Cobre o intervalo entre ler `atual` e contar a referência */
+    pthread_mutex_t publicacao;    /**< Uma publicação por vez */
+    const char* arquivo;           /**< Arquivo relido pela recarga (NULL = caso fixo) */
+    atomic_int publicadas;         /**< Versões publicadas */
+    atomic_int liberadas;          /**< Versões já liberadas */
+    atomic_int falhas;             /**< Recargas recusadas (arquivo ausente ou inválido) */
+    int avisos[2];                 /**< Pipe do SIGHUP para a thread de recarga (-1 = inativo) */
+    pthread_t carregador;          /**< Thread que relê o arquivo em segundo plano */
+} CatalogoCasos;
 
-    /* -----------------------------
-     * Exibe pistas coletadas (ordenadas)
-     * ----------------------------- */
-    limparTela();
-    printf("========================================================\n");
-    printf("               PISTAS COLETADAS (ORDENADAS)\n");
-    printf("========================================================\n\n");
-    exibirPistas(raizPistas);
+/**
+ * @struct CabecalhoImagem
+ * @brief Início de uma imagem do caso: bloco único, só com inteiros e deslocamentos.
+ *
+ * Todo "ponteiro" da imagem é um deslocamento em bytes a partir do
+ * cabeçalho, então ela vale em qualquer endereço (memória compartilhada
+ * mapeada em lugares diferentes por processo). Depois das tabelas vem o
+ * pool de textos (nomes, pistas, suspeitos e rótulos, terminados em '\0').
+ */
+typedef struct CabecalhoImagem {
+    char magico[8];                /**< IMAGEM_MAGICO */
+    uint32_t versao;               /**< IMAGEM_VERSAO */
+    uint32_t tamanho;              /**< Bytes da imagem inteira */
+    uint32_t assinatura;           /**< Assinatura do caso de origem */
+    int32_t totalSalas;            /**< Salas (IDs em pré-ordem; Hall = 0) */
+    int32_t totalPortas;           /**< Portas do CSR */
+    int32_t totalRotulos;          /**< Rótulos de porta */
+    int32_t totalPistas;           /**< Pistas cadastradas */
+    int32_t totalSuspeitos;        /**< Suspeitos cadastrados */
+    int32_t capacidadeIndice;      /**< Posições do índice pista -> ID (potência de 2) */
+    uint32_t salas;                /**< SalaImagem[totalSalas] */
+    uint32_t inicioPortas;         /**< int32_t[totalSalas + 1] (CSR) */
+    uint32_t destinoPortas;        /**< int32_t[totalPortas] */
+    uint32_t custoPortas;          /**< uint16_t[totalPortas] */
+    uint32_t rotuloPortas;         /**< uint16_t[totalPortas] */
+    uint32_t rotulos;              /**< Deslocamento do texto de cada rótulo */
+    uint32_t pistas;               /**< PistaImagem[totalPistas] */
+    uint32_t suspeitos;            /**< Deslocamento do nome de cada suspeito */
+    uint32_t indice;               /**< int32_t[capacidadeIndice]: ID da pista ou -1 (sondagem linear) */
+} CabecalhoImagem;
 
-    /* -----------------------------
-     * Fase final: acusação e veredito
-     * ----------------------------- */
-    verificarSuspeitoFinal(tabela, raizPistas);
+/**
+ * @struct SalaImagem
+ * @brief Sala dentro da imagem (textos e vizinhas por deslocamento e ID).
+ */
+typedef struct SalaImagem {
+    uint32_t nome;                 /**< Deslocamento do nome */
+    uint32_t pista;                /**< Deslocamento do texto da pista ("" se não há) */
+    int32_t esquerda, direita, pai; /**< IDs (-1 = não existe) */
+    int32_t idPista;               /**< ID da pista da sala (-1 = sem pista) */
+} SalaImagem;
 
-    /* -----------------------------
-     * Limpeza de memória
-     * ----------------------------- */
-    liberarPistas(raizPistas);
-    liberarHash(tabela);
-    liberarMansao(hall);
+/**
+ * @struct PistaImagem
+ * @brief Pista dentro da imagem: texto, suspeito e hash (para o índice).
+ */
+typedef struct PistaImagem {
+    uint32_t texto;                /**< Deslocamento do texto */
+    int32_t suspeito;              /**< ID do suspeito */
+    uint32_t hash;                 /**< FNV-1a do texto */
+} PistaImagem;
 
-    printf("\nInvestigação finalizada. Obrigado por jogar Detective Quest!\n");
-    return 0;
-}
+/**
+ * @struct HistogramaLatencia
+ * @brief Histograma HDR (log-linear) de latências em nanossegundos.
+ *
+ * Abaixo de HISTOGRAMA_SUB ns cada valor tem a sua faixa; acima, cada
+ * potência de 2 é dividida em HISTOGRAMA_SUB / 2 faixas iguais, então o
+ * erro relativo de qualquer percentil fica abaixo de 1/64. Só a thread dona
+ * escreve (stores relaxados, sem instrução travada); qualquer thread pode
+ * ler para somar.
+ */
+typedef struct HistogramaLatencia {
+    atomic_llong contagens[HISTOGRAMA_FAIXAS]; /**< Amostras por faixa */
+    atomic_llong maximo;           /**< Maior latência exata vista (ns) */
+} HistogramaLatencia;
+
+/**
+ * @struct ServidorEstatisticas
+ * @brief Socket Unix local que responde cada conexão com o resumo de latências.
+ */
+typedef struct ServidorEstatisticas {
+    int descritor;                 /**< Socket de escuta (-1 = fechado) */
+    char caminho[108];             /**< Caminho do socket (tamanho de sun_path) */
+    pthread_t atendente;           /**< Thread que aceita as conexões */
+} ServidorEstatisticas;
 
 // ============================================================================
-//                       IMPLEMENTAÇÃO DAS FUNÇÕES
+//                            PROTÓTIPOS (Doxygen)
 // ============================================================================
 
-Sala* criarSala(const char* nome, const char* pista) {
-    /* Alocação e verificação */
-    Sala* s = (Sala*) malloc(sizeof(Sala));
-    if (!s) {
-        fprintf(stderr, "Erro: falha na alocação de memória para Sala '%s'\n", nome);
+/* ----------------- Criação e exploração da mansão ----------------- */
+
+/**
+ * @brief Cria dinamicamente uma sala com nome e pista associada.
+ *
+ * Aloca memória, copia o nome e a pista, e inicializa ponteiros.
+ *
+ * @param nome Nome do cômodo (string).
+ * @param pista Texto da pista associada ao cômodo (pode ser "").
+ * @return Ponteiro para a Sala criada (não-NULL). Em falha, finaliza o programa.
+ */
+Sala* criarSala(const char* nome, const char* pista);
+
+/**
+ * @brief Explora a mansão interativamente a partir da sala atual da sessão.
+ *
+ * Na primeira visita a cada sala, se houver pista não-vazia, ela é
+ * automaticamente inserida na BST de pistas (revisitas não tocam a BST).
+ *
+ * Comandos de navegação:
+ *  - '1'..'n'  : atravessar a porta de número correspondente
+ *  - 'e' / 'd' / 'v' : atalhos para esquerda, direita e voltar (árvore da planta)
+ *  - 'u' / 'U' : ir ao último ramo ainda inexplorado
+ *  - 'r' / 'R' : mostrar a rota mais rápida até uma sala (pelo nome)
+ *  - 'i' / 'I' : ir até uma sala (pelo nome), percorrendo a rota mais rápida
+ *  - 'a' / 'A' : resumo da ala (subárvore) da sala atual
+ *  - 'p' / 'P' : listar pistas coletadas (paginado)
+ *  - 'b' / 'B' : buscar pistas por prefixo (autocompletar)
+ *  - 'f' / 'F' : procurar pistas por palavras (acentos e maiúsculas ignorados)
+ *  - 'g' / 'G' : gravar a investigação (ARQUIVO_SESSAO)
+ *  - 's' / 'S' : encerrar exploração
+ *
+ * @param caso Caso em andamento (tabela hash e índices).
+ * @param sessao Sessão do jogador (posição e pistas coletadas).
+ * @param diario Diário onde cada comando é anexado (NULL = sem gravação).
+ */
+void explorarMansao(Caso* caso, Sessao* sessao, Diario* diario);
+
+/**
+ * @brief Atravessa uma porta da sala atual (CSR).
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador.
+ * @param porta Índice da porta na sala atual (base 0).
+ * @return 1 se houve movimento, 0 se a porta não existe, SESSAO_ERRO_MEMORIA
+ *         se a pista da sala não coube na cota (a sessão fica onde estava).
+ */
+int atravessarPorta(Caso* caso, Sessao* sessao, int porta);
+
+/**
+ * @brief Move a sessão para a sala à esquerda ('e') ou à direita ('d').
+ *
+ * Ao chegar, a pista da nova sala é coletada.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador.
+ * @param direcao 'e' ou 'd'.
+ * @return 1 se houve movimento, 0 se não existe caminho nessa direção,
+ *         SESSAO_ERRO_MEMORIA como em atravessarPorta().
+ */
+int moverSessao(Caso* caso, Sessao* sessao, char direcao);
+
+/**
+ * @brief Coloca a sessão em uma sala, registrando a primeira visita.
+ *
+ * O teste de "já visitada" é um bit em O(1): só na primeira visita a sala
+ * entra na pilha de ramos e a sua pista é coletada. A pista é anotada
+ * antes de qualquer outra mudança: se ela não couber na cota, nada muda.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador.
+ * @param sala Sala de destino.
+ * @return 1 se foi a primeira visita, 0 se a sala já havia sido visitada,
+ *         SESSAO_ERRO_MEMORIA se a pista não coube (a sessão não se move).
+ */
+int entrarNaSala(Caso* caso, Sessao* sessao, Sala* sala);
+
+/**
+ * @brief Volta para a sala anterior (ponteiro `pai`).
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador.
+ * @return 1 se houve movimento, 0 se a sessão já está no Hall, SESSAO_ERRO_MEMORIA
+ *         como em atravessarPorta().
+ */
+int voltarSessao(Caso* caso, Sessao* sessao);
+
+/**
+ * @brief Salta para a saída inexplorada da sala visitada mais recentemente.
+ *
+ * Desempilha de `ramos` as salas cujas saídas já foram todas visitadas (elas
+ * nunca voltam a ter saídas novas), então o custo amortizado é O(1).
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador.
+ * @return 1 se houve movimento, 0 se a mansão inteira já foi explorada,
+ *         SESSAO_ERRO_MEMORIA como em atravessarPorta().
+ */
+int irUltimoRamo(Caso* caso, Sessao* sessao);
+
+/**
+ * @brief Calcula a rota entre duas salas ('v' = voltar, 'e', 'd').
+ *
+ * Com as rotas pré-calculadas a partir do Hall, o ancestral comum sai de
+ * um XOR dos bits; o custo é proporcional apenas ao tamanho da rota.
+ * Salas a mais de 64 passos do Hall caem para a subida pelos pais.
+ *
+ * @param origem Sala de partida.
+ * @param destino Sala de chegada.
+ * @param passos Saída: sequência de passos (sem terminador).
+ * @param capacidade Tamanho de `passos`.
+ * @return Quantidade de passos, ou -1 se `passos` for pequeno demais.
+ */
+int rotaEntreSalas(const Sala* origem, const Sala* destino, char* passos, int capacidade);
+
+/**
+ * @brief Leva a sessão até uma sala pelo nome pela rota mais rápida.
+ *
+ * A rota vem do planejador (Dijkstra bidirecional sobre os custos dos
+ * corredores). Cada sala do caminho é visitada normalmente
+ * (atravessarPorta), então as pistas do trajeto também são coletadas.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador.
+ * @param planejador Planejador do caso.
+ * @param nome Nome da sala (acentos e maiúsculas ignorados).
+ * @return Quantidade de portas atravessadas, -1 se a sala não existe ou é inalcançável,
+ *         ou SESSAO_ERRO_MEMORIA se faltou memória para a rota (a sessão não sai do lugar)
+ *         ou se a cota acabou no caminho (a sessão para ali).
+ */
+int irParaSala(Caso* caso, Sessao* sessao, PlanejadorRotas* planejador, const char* nome);
+
+/**
+ * @brief Exibe a rota mais rápida da sala atual até uma sala, porta a porta.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão do jogador (não é movida).
+ * @param planejador Planejador do caso.
+ * @param nome Nome da sala de destino.
+ * @return Quantidade de portas, -1 se a sala não existe ou é inalcançável, ou
+ *         SESSAO_ERRO_MEMORIA se faltou memória para a rota.
+ */
+int exibirRota(Caso* caso, const Sessao* sessao, PlanejadorRotas* planejador, const char* nome);
+
+/* ----------------- Planejador de rotas (grafo de portas) ----------------- */
+
+/**
+ * @brief Prepara o planejador: CSR reverso e vetores por sala.
+ *
+ * @param planejador Planejador a iniciar.
+ * @param caso Caso com o CSR já montado (construirPortas).
+ */
+void iniciarPlanejador(PlanejadorRotas* planejador, const Caso* caso);
+
+/**
+ * @brief Libera o planejador.
+ *
+ * @param planejador Planejador a liberar.
+ */
+void liberarPlanejador(PlanejadorRotas* planejador);
+
+/**
+ * @brief Rota com o menor número de portas (BFS bidirecional).
+ *
+ * Expande sempre a fronteira menor, nível a nível, e para no primeiro nível
+ * em que as buscas se encontram.
+ *
+ * @param planejador Planejador do caso.
+ * @param origem ID da sala de partida.
+ * @param destino ID da sala de chegada.
+ * @param caminho Saída: IDs das salas da rota, da origem ao destino (pode ser NULL).
+ * @param capacidade Tamanho de `caminho`.
+ * @return Número de portas, ou -1 se não há rota (ou `caminho` é pequeno demais).
+ */
+int rotaMenosPortas(PlanejadorRotas* planejador, int origem, int destino, int* caminho, int capacidade);
+
+/**
+ * @brief Rota de menor custo total (Dijkstra bidirecional com heaps radix).
+ *
+ * Para quando a soma dos topos das duas filas alcança o melhor custo
+ * encontrado, o que explora muito menos salas que o Dijkstra de um lado só.
+ *
+ * @param planejador Planejador do caso.
+ * @param origem ID da sala de partida.
+ * @param destino ID da sala de chegada.
+ * @param caminho Saída: IDs das salas da rota (pode ser NULL).
+ * @param capacidade Tamanho de `caminho`.
+ * @param tamanho Saída: quantidade de portas da rota (pode ser NULL).
+ * @return Custo total, -1 se não há rota (ou `caminho` é pequeno demais), ou
+ *         SESSAO_ERRO_MEMORIA se as filas não puderam crescer.
+ */
+long rotaMaisRapida(PlanejadorRotas* planejador, int origem, int destino, int* caminho, int capacidade, int* tamanho);
+
+/**
+ * @brief Pré-calcula as rotas entre todos os pares de salas de uma ala.
+ *
+ * @param tabela Tabela a preencher.
+ * @param caso Caso com o CSR montado.
+ * @param ala Raiz da ala (no máximo MAX_SALAS_TABELA_ALA salas).
+ * @return 1 em sucesso, 0 se a ala é grande demais.
+ */
+int construirTabelaAla(TabelaAla* tabela, const Caso* caso, const Sala* ala);
+
+/**
+ * @brief Monta as tabelas de todas as alas maximais com até `limite` salas.
+ *
+ * @param caso Caso com o CSR montado.
+ * @param limite Tamanho máximo de ala (<= MAX_SALAS_TABELA_ALA).
+ * @param total Saída: quantidade de tabelas.
+ * @return Vetor de tabelas (liberar com liberarTabelasAlas).
+ */
+TabelaAla* construirTabelasAlas(const Caso* caso, int limite, int* total);
+
+/**
+ * @brief Reconstrói uma rota interna a partir da tabela da ala.
+ *
+ * @param tabela Tabela da ala.
+ * @param origem ID (global) da sala de partida.
+ * @param destino ID (global) da sala de chegada.
+ * @param caminho Saída: IDs globais das salas da rota.
+ * @param capacidade Tamanho de `caminho`.
+ * @return Número de portas, ou -1 se não há rota interna.
+ */
+int rotaNaTabelaAla(const TabelaAla* tabela, int origem, int destino, int* caminho, int capacidade);
+
+/**
+ * @brief Libera um vetor de tabelas de alas.
+ *
+ * @param tabelas Vetor de tabelas.
+ * @param total Quantidade de tabelas.
+ */
+void liberarTabelasAlas(TabelaAla* tabelas, int total);
+
+/* ----------------- Planejador de evidências ----------------- */
+
+/**
+ * @brief Prepara os planos de evidência de todos os suspeitos.
+ *
+ * Só cataloga as salas com pista; as tabelas de cada suspeito são montadas
+ * na primeira consulta sobre ele.
+ *
+ * @param planejador Planejador a iniciar.
+ * @param caso Caso com pistas cadastradas e CSR montado.
+ * @param rotas Planejador de rotas do mesmo caso (CSR reverso).
+ */
+void iniciarPlanejadorEvidencias(PlanejadorEvidencias* planejador, const Caso* caso, const PlanejadorRotas* rotas);
+
+/**
+ * @brief Libera o planejador de evidências.
+ *
+ * @param planejador Planejador a liberar.
+ */
+void liberarPlanejadorEvidencias(PlanejadorEvidencias* planejador);
+
+/**
+ * @brief Conta as pistas distintas já coletadas contra um suspeito.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão com o bitset de pistas.
+ * @param suspeito ID do suspeito.
+ * @return Quantidade de pistas coletadas do suspeito.
+ */
+int pistasColetadasContra(const Caso* caso, const Sessao* sessao, int suspeito);
+
+/**
+ * @brief Menor número de portas para reunir `limiar` pistas contra um suspeito.
+ *
+ * Exato enquanto o suspeito tiver até MAX_TERMINAIS_PLANO salas com pista:
+ * testa cada conjunto com as pistas que faltam, somando a distância até o
+ * primeiro terminal e o passeio pré-calculado. Acima disso usa a sala com
+ * pista nova mais próxima, repetidamente (estimativa).
+ *
+ * @param planejador Planejador de evidências.
+ * @param sessao Sessão (sala atual e pistas coletadas).
+ * @param suspeito ID do suspeito.
+ * @param limiar Pistas exigidas (ex.: PISTAS_PARA_CONDENAR).
+ * @param ordem Saída: IDs das salas a visitar, na ordem (pode ser NULL).
+ * @param capacidade Tamanho de `ordem`.
+ * @param faltam Saída: pistas que ainda faltam (pode ser NULL).
+ * @return Portas a atravessar (0 = já há evidência), -1 se não há pistas suficientes alcançáveis,
+ *         ou SESSAO_ERRO_MEMORIA se faltou memória até para a estimativa. Sem memória para a
+ *         tabela exata, o suspeito fica com a estimativa até a próxima consulta.
+ */
+long planejarEvidencias(PlanejadorEvidencias* planejador, const Sessao* sessao, int suspeito, int limiar,
+                        int* ordem, int capacidade, int* faltam);
+
+/**
+ * @brief Mostra a dica de evidências para um suspeito ou para todos.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão atual.
+ * @param planejador Planejador de evidências.
+ * @param nome Nome do suspeito (aproximado) ou "" para todos.
+ * @return 1 se o suspeito foi reconhecido (ou todos), 0 caso contrário, ou
+ *         SESSAO_ERRO_MEMORIA se alguma dica não pôde ser calculada.
+ */
+int exibirDica(Caso* caso, const Sessao* sessao, PlanejadorEvidencias* planejador, const char* nome);
+
+/* ----------------- Simulação Monte Carlo ----------------- */
+
+/**
+ * @brief Achata as pistas do caso (sala -> pista -> suspeito e máscaras por suspeito).
+ *
+ * @param mapa Mapa a preencher.
+ * @param caso Caso com pistas cadastradas.
+ * @return 1 em sucesso, 0 sem memória (o mapa fica zerado).
+ */
+int montarMapaPistas(MapaPistas* mapa, const Caso* caso);
+
+/**
+ * @brief Libera o mapa de pistas.
+ *
+ * @param mapa Mapa a liberar.
+ */
+void liberarMapaPistas(MapaPistas* mapa);
+
+/**
+ * @brief Inicia o gerador a partir de uma semente de 64 bits (via splitmix64).
+ *
+ * @param gerador Gerador a iniciar.
+ * @param semente Semente qualquer.
+ */
+void semearXoshiro(GeradorXoshiro* gerador, uint64_t semente);
+
+/**
+ * @brief Próximo número de 64 bits do xoshiro256**.
+ *
+ * @param gerador Gerador.
+ * @return Número pseudoaleatório.
+ */
+uint64_t proximoXoshiro(GeradorXoshiro* gerador);
+
+/**
+ * @brief Avança o gerador 2^128 passos (uma sequência independente por chamada).
+ *
+ * @param gerador Gerador.
+ */
+void saltarXoshiro(GeradorXoshiro* gerador);
+
+/**
+ * @brief Desfecho de uma acusação com `evidencias` pistas contra o acusado.
+ *
+ * Mesmas três faixas da fase final (verificarSuspeitoFinal).
+ *
+ * @param evidencias Pistas coletadas que apontam para o acusado.
+ * @return ACUSACAO_CONFIRMADA, ACUSACAO_FRAGIL ou ACUSACAO_SEM_FUNDAMENTO.
+ */
+int classificarAcusacao(int evidencias);
+
+/**
+ * @brief Simula partidas completas (exploração + acusação) sem interface.
+ *
+ * Cada partida começa no Hall, anda pelas portas segundo a política e, ao
+ * parar, acusa o suspeito com mais pistas coletadas (na política de
+ * palpite, um suspeito sorteado, que pode ficar sem fundamento). As partidas são
+ * divididas em faixas, executadas pelo escalonador global; nenhuma
+ * alocação é feita dentro do laço.
+ *
+ * @param caso Caso simulado (CSR montado).
+ * @param politica POLITICA_ALEATORIA, POLITICA_EXPLORADORA ou POLITICA_PALPITE.
+ * @param partidas Quantidade de partidas.
+ * @param semente Semente do gerador.
+ * @param threads Faixas, cada uma com a sua sequência aleatória (<= 0 = uma por trabalhador).
+ * @param contagens Saída: contagens[suspeito * 4 + ACUSACAO_*] (totalSuspeitos * 4 posições).
+ */
+void simularPartidas(const Caso* caso, int politica, long long partidas, uint64_t semente, int threads,
+                     long long* contagens);
+
+/**
+ * @brief Modo --simular: roda as três políticas e imprime as taxas por suspeito.
+ *
+ * Com mais de um trabalhador, repete cada política com um só para mostrar
+ * a aceleração medida.
+ *
+ * @param caso Caso simulado.
+ * @param partidas Partidas por política.
+ */
+void executarSimulacao(const Caso* caso, long long partidas);
+
+/**
+ * @brief Modo --cooperativo: vários detetives exploram a mansão ao mesmo tempo.
+ *
+ * Cada detetive é uma tarefa do escalonador global e anda como o jogador
+ * explorador da simulação, mas as pistas vão para um único conjunto
+ * concorrente (ConjuntoPistas). Todos param quando o grupo reúne evidência
+ * contra alguém; o grupo acusa o suspeito com mais pistas no conjunto.
+ *
+ * @param caso Caso investigado (CSR montado).
+ * @param detetives Quantidade de detetives (>= 1).
+ * @return ID do suspeito acusado, ou -1 se o caso não tem suspeitos.
+ */
+int executarCooperativo(const Caso* caso, int detetives);
+
+/* ----------------- Robô detetive (MCTS) ----------------- */
+
+/**
+ * @brief Preenche as opções padrão do robô (MCTS_*).
+ *
+ * @param opcoes Opções a preencher.
+ */
+void opcoesMCTSPadrao(OpcoesMCTS* opcoes);
+
+/**
+ * @brief Escolhe a próxima jogada por busca em árvore Monte Carlo (UCT).
+ *
+ * Estado = (sala, pistas coletadas, portas gastas); ações = portas da sala
+ * ou acusar quem tem mais pistas. A recompensa é 1 para acusação confirmada,
+ * descontada pelas portas gastas, e 0 caso contrário. Os nós vêm dos pools
+ * do robô, reaproveitados a cada jogada; cada tarefa do escalonador monta a sua árvore (paralelismo de
+ * raiz) e as visitas da raiz são somadas no fim do orçamento de tempo. Uma
+ * árvore cujo pool enche para de iterar antes do prazo (não há como expandir
+ * sem viciar a busca) e é contada em `arvoresCheias`.
+ *
+ * @param robo Robô iniciado para o caso (opções, mapa e pools).
+ * @param caso Caso em andamento.
+ * @param sessao Sessão (sala atual e pistas coletadas).
+ * @param resultado Saída: jogada e estatísticas.
+ * @return 1 em sucesso, 0 se o caso tem mais de 64 pistas.
+ */
+int jogadaMCTS(RoboDetetive* robo, const Caso* caso, const Sessao* sessao, ResultadoMCTS* resultado);
+
+/**
+ * @brief Aloca o estado do robô para uma partida: mapa de pistas, um pool de
+ * nós por árvore e as pilhas da descida.
+ *
+ * @param robo Robô a iniciar.
+ * @param caso Caso a jogar (CSR montado).
+ * @param opcoes Threads, horizonte máximo e tamanho do pool.
+ * @return 1 em sucesso, 0 sem memória (nada fica alocado).
+ */
+int iniciarRoboDetetive(RoboDetetive* robo, const Caso* caso, const OpcoesMCTS* opcoes);
+
+/**
+ * @brief Libera o robô (aceita um robô zerado, nunca iniciado).
+ *
+ * @param robo Robô a liberar.
+ */
+void liberarRoboDetetive(RoboDetetive* robo);
+
+/**
+ * @brief Comando 'o': mostra a jogada sugerida pelo robô.
+ *
+ * O robô é iniciado na primeira consulta e reaproveitado nas seguintes.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão atual.
+ * @param robo Robô da partida (zerado até a primeira consulta).
+ * @return 1 se houve sugestão, 0 caso contrário.
+ */
+int exibirOraculo(Caso* caso, const Sessao* sessao, RoboDetetive* robo);
+
+/**
+ * @brief Joga uma partida inteira com o robô, a partir do Hall.
+ *
+ * @param caso Caso a jogar.
+ * @param opcoes Opções de cada jogada (o horizonte vale para a partida toda).
+ * @param verboso Imprime cada jogada.
+ * @param simulacoes Saída: simulações somadas de todas as jogadas (pode ser NULL).
+ * @return Portas atravessadas até a acusação confirmada, ou -1 se não confirmou.
+ */
+int jogarComRobo(Caso* caso, const OpcoesMCTS* opcoes, int verboso, long long* simulacoes);
+
+/* ----------------- Arquivo de caso e gerador ----------------- */
+
+/**
+ * @brief Monta o caso padrão (as seis salas, pistas e portas extras do jogo).
+ *
+ * @param caso Caso a preencher.
+ */
+void montarCasoPadrao(Caso* caso);
+
+/**
+ * @brief Grava o caso no formato texto (CASO_MAGICO).
+ *
+ * Uma linha por registro, campos separados por '|':
+ *  - `sala|nome|pista|sala de cima|e ou d` em pré-ordem (a primeira é o Hall)
+ *  - `pista|texto|suspeito` na ordem de cadastro
+ *  - `porta|origem|destino|rótulo|custo` para as portas além das da árvore
+ * Linhas vazias e iniciadas por '#' são ignoradas. O formato não tem escape:
+ * um nome, pista, suspeito ou rótulo com '|' ou quebra de linha é recusado
+ * (avisado em stderr) antes de o arquivo ser aberto.
+ *
+ * @param caso Caso a gravar.
+ * @param arquivo Caminho do arquivo.
+ * @return 1 em sucesso, 0 em falha de E/S ou texto que o formato não representa.
+ */
+int gravarCaso(const Caso* caso, const char* arquivo);
+
+/**
+ * @brief Carrega um caso gravado por gravarCaso (ou escrito à mão).
+ *
+ * O mesmo arquivo sempre produz a mesma assinatura, então as sessões salvas
+ * de um caso carregado continuam valendo. Erros são descritos em stderr com
+ * o número da linha.
+ *
+ * @param caso Caso a preencher (só é válido se o retorno for 1).
+ * @param arquivo Caminho do arquivo.
+ * @return 1 em sucesso, 0 se o arquivo não abriu ou é inválido.
+ */
+int carregarCaso(Caso* caso, const char* arquivo);
+
+/**
+ * @brief Menor rota (em portas) do Hall até reunir `limiar` pistas distintas contra o suspeito.
+ *
+ * Busca em largura exaustiva sobre (sala, pistas do suspeito já coletadas):
+ * não depende de heurística, então serve de gabarito para o gerador.
+ *
+ * @param caso Caso com o CSR montado.
+ * @param mapa Mapa de pistas do caso.
+ * @param suspeito ID do suspeito.
+ * @param limiar Pistas distintas necessárias.
+ * @return Portas, -1 se nenhuma rota condena, -2 se o suspeito tem mais de 16 pistas
+ *         ou o caso passa de RESOLVEDOR_MAX_ESTADOS estados, -3 sem memória.
+ */
+int resolverCasoExaustivo(const Caso* caso, const MapaPistas* mapa, int suspeito, int limiar);
+
+/**
+ * @brief Avalia o caso: quem pode ser condenado, em quantas portas e com quantas armadilhas.
+ *
+ * Não encerra o processo sem memória (a recarga por SIGHUP chama isto numa
+ * thread de fundo): devolve -1 e a avaliação fica indefinida.
+ *
+ * @param caso Caso com o CSR montado.
+ * @param avaliacao Saída.
+ * @return 1 se exatamente um suspeito pode ser condenado, 0 caso contrário, -1 sem memória.
+ */
+int avaliarCaso(const Caso* caso, AvaliacaoCaso* avaliacao);
+
+/**
+ * @brief Monta um caso candidato aleatório (planta, suspeitos, pistas e atalhos).
+ *
+ * A mesma semente sempre gera o mesmo caso.
+ *
+ * @param caso Caso a preencher.
+ * @param semente Semente do candidato.
+ */
+void gerarCasoCandidato(Caso* caso, uint64_t semente);
+
+/**
+ * @brief Modo --gerar: gera e valida candidatos em paralelo e grava os melhores da faixa.
+ *
+ * Os candidatos são divididos em lotes pelo escalonador global; cada
+ * trabalhador guarda os seus GERADOR_MELHORES (mais armadilhas primeiro) e
+ * os vencedores são remontados pela semente e gravados em
+ * `caso-<faixa>-<n>.txt`.
+ *
+ * @param faixa FAIXA_FACIL, FAIXA_MEDIA ou FAIXA_DIFICIL.
+ * @param candidatos Candidatos a avaliar.
+ * @param semente Semente da rodada.
+ * @return Quantidade de casos gravados.
+ */
+int gerarCasos(int faixa, long candidatos, uint64_t semente);
+
+/* ----------------- Catálogo de casos (recarga a quente) ----------------- */
+
+/**
+ * @brief Inicia o catálogo publicando `caso` como versão 1.
+ *
+ * O conteúdo de `caso` passa a pertencer ao catálogo (não chamar liberarCaso).
+ *
+ * @param catalogo Catálogo a iniciar.
+ * @param caso Caso montado ou carregado.
+ * @param arquivo Arquivo que recarregarCaso() relê (NULL = sem recarga).
+ * @return 1 se a versão 1 foi publicada, 0 sem memória (o caso continua com quem chamou
+ *         e o catálogo não deve ser usado).
+ */
+int iniciarCatalogoCasos(CatalogoCasos* catalogo, Caso* caso, const char* arquivo);
+
+/**
+ * @brief Para a recarga em segundo plano e solta a versão atual.
+ *
+ * Todas as sessões já devem ter soltado suas versões.
+ *
+ * @param catalogo Catálogo a encerrar.
+ */
+void encerrarCatalogoCasos(CatalogoCasos* catalogo);
+
+/**
+ * @brief Fixa a versão atual para uma sessão (sem trava: uma seção RCU e um incremento).
+ *
+ * @param catalogo Catálogo.
+ * @return Versão fixada; válida até soltarCaso().
+ */
+VersaoCaso* fixarCaso(CatalogoCasos* catalogo);
+
+/**
+ * @brief Solta uma versão fixada; a última referência libera o caso.
+ *
+ * @param versao Versão devolvida por fixarCaso().
+ */
+void soltarCaso(VersaoCaso* versao);
+
+/**
+ * @brief Publica um caso novo como versão atual.
+ *
+ * As sessões em andamento continuam na versão que fixaram; só as próximas
+ * recebem a nova. A versão anterior perde a referência do catálogo depois
+ * de um período de graça (sincronizarRCU).
+ *
+ * @param catalogo Catálogo.
+ * @param caso Caso montado (o conteúdo passa a pertencer ao catálogo se publicado).
+ * @return Número da versão publicada, ou 0 sem memória (nada muda e o caso
+ *         continua com quem chamou).
+ */
+int publicarCaso(CatalogoCasos* catalogo, Caso* caso);
+
+/**
+ * @brief Relê o arquivo do catálogo e publica o resultado.
+ *
+ * Um arquivo inválido, ou que não coube na memória para ser avaliado ou
+ * publicado, é recusado (os erros vão para stderr) e a versão atual
+ * continua valendo.
+ *
+ * @param catalogo Catálogo com arquivo.
+ * @return Número da versão publicada, ou 0 se a recarga foi recusada.
+ */
+int recarregarCaso(CatalogoCasos* catalogo);
+
+/**
+ * @brief Liga a recarga por SIGHUP: o sinal acorda uma thread que chama recarregarCaso().
+ *
+ * O tratador só escreve um byte num pipe, então o sinal não interrompe nem
+ * atrasa a thread do jogo (as leituras do terminal são reiniciadas).
+ *
+ * @param catalogo Catálogo com arquivo.
+ * @return 1 se a recarga ficou ativa, 0 caso contrário (sem arquivo ou sem suporte).
+ */
+int ativarRecargaPorSinal(CatalogoCasos* catalogo);
+
+/* ----------------- Imagem compartilhada do caso (processos pré-criados) ----------------- */
+
+/**
+ * @brief Achata o caso numa imagem independente de posição (CabecalhoImagem).
+ *
+ * Com `destino` = NULL só mede: chamar uma vez para saber o tamanho e outra
+ * para escrever.
+ *
+ * @param caso Caso com o CSR montado.
+ * @param destino Buffer da imagem (alinhado a 8) ou NULL.
+ * @param capacidade Bytes disponíveis em `destino`.
+ * @return Tamanho da imagem em bytes, ou 0 se não coube em `capacidade`.
+ */
+size_t montarImagemCaso(const Caso* caso, void* destino, size_t capacidade);
+
+/**
+ * @brief Confere assinatura, versão e limites de uma imagem recebida.
+ *
+ * Além das tabelas, confere cada deslocamento de texto (dentro da imagem,
+ * que termina em '\0') e cada ID guardado (salas, pistas, suspeitos,
+ * rótulos, CSR e índice), para que as leituras depois não precisem de teste.
+ *
+ * @param base Início da imagem.
+ * @param tamanho Bytes mapeados.
+ * @return Cabeçalho, ou NULL se a imagem é inválida.
+ */
+const CabecalhoImagem* validarImagemCaso(const void* base, size_t tamanho);
+
+/**
+ * @brief Texto da imagem a partir do deslocamento.
+ *
+ * @param imagem Imagem validada.
+ * @param deslocamento Deslocamento guardado numa tabela da imagem.
+ * @return Texto terminado em '\0'.
+ */
+const char* textoDaImagem(const CabecalhoImagem* imagem, uint32_t deslocamento);
+
+/**
+ * @brief Busca o ID de uma pista no índice da imagem.
+ *
+ * @param imagem Imagem validada.
+ * @param pista Texto da pista.
+ * @return ID da pista, ou -1 se não cadastrada.
+ */
+int pistaNaImagem(const CabecalhoImagem* imagem, const char* pista);
+
+/**
+ * @brief Suspeito de uma pista, como encontrarSuspeito(), lendo só a imagem.
+ *
+ * @param imagem Imagem validada.
+ * @param pista Texto da pista.
+ * @return Nome do suspeito (dentro da imagem) ou "Desconhecido".
+ */
+const char* suspeitoNaImagem(const CabecalhoImagem* imagem, const char* pista);
+
+/**
+ * @brief Cria o segmento POSIX `nome` (shm_open) e grava nele a imagem do caso.
+ *
+ * @param caso Caso com o CSR montado.
+ * @param nome Nome do segmento ("/..."); falha se já existir.
+ * @param tamanho Saída: bytes da imagem.
+ * @return 1 em sucesso, 0 em falha (mensagem em stderr).
+ */
+int criarImagemCompartilhada(const Caso* caso, const char* nome, size_t* tamanho);
+
+/**
+ * @brief Mapeia o segmento `nome` só para leitura e valida a imagem.
+ *
+ * @param nome Nome do segmento.
+ * @param tamanho Saída: bytes mapeados (para desanexarImagem).
+ * @return Cabeçalho da imagem, ou NULL em falha.
+ */
+const CabecalhoImagem* anexarImagemCompartilhada(const char* nome, size_t* tamanho);
+
+/**
+ * @brief Desfaz o mapeamento de anexarImagemCompartilhada().
+ *
+ * @param imagem Imagem anexada.
+ * @param tamanho Bytes mapeados.
+ */
+void desanexarImagem(const CabecalhoImagem* imagem, size_t tamanho);
+
+/**
+ * @brief Modo --processos: um carregador publica a imagem e N processos filhos a usam.
+ *
+ * O processo atual grava a imagem num segmento compartilhado e cria os
+ * filhos com fork(); cada um anexa o segmento só para leitura, confere o
+ * índice e joga PROCESSOS_SESSOES passeios com consultas pista -> suspeito.
+ * Imprime, por processo, o tempo para anexar, a vazão e a memória privada.
+ *
+ * @param caso Caso com o CSR montado.
+ * @param processos Quantidade de processos filhos (>= 1).
+ * @return 1 se todos os filhos terminaram bem, 0 caso contrário.
+ */
+int executarProcessos(const Caso* caso, int processos);
+
+/* ----------------- Histogramas de latência por comando ----------------- */
+
+/**
+ * @brief Marca o início de um comando da sessão.
+ *
+ * @return Instante atual (ns, relógio monotônico), para registrarComando().
+ */
+long long inicioComando(void);
+
+/**
+ * @brief Soma a duração de um comando no histograma da thread atual.
+ *
+ * Na primeira chamada a thread ganha o seu conjunto de histogramas; depois
+ * disso o registro não trava nem compartilha linhas de cache. Quando a
+ * thread termina, as contagens vão para um acumulado de aposentadas e a vaga
+ * volta ao registro. Se não houver vaga (mais de LATENCIA_MAX_THREADS threads
+ * vivas) ou memória, a amostra é descartada e contada.
+ *
+ * @param comando COMANDO_*.
+ * @param inicio Valor devolvido por inicioComando().
+ */
+void registrarComando(int comando, long long inicio);
+
+/**
+ * @brief Junta os histogramas de todas as threads para um comando.
+ *
+ * Pode rodar enquanto as threads registram: cada contador é lido uma vez,
+ * então o resultado é uma foto consistente o bastante para percentis.
+ *
+ * @param comando COMANDO_*.
+ * @param destino Histograma de saída (sobrescrito).
+ * @return Quantidade de amostras somadas.
+ */
+long long somarLatencias(int comando, HistogramaLatencia* destino);
+
+/**
+ * @brief Percentil de um histograma somado.
+ *
+ * @param histograma Histograma (de somarLatencias()).
+ * @param fracao Fração entre 0 e 1 (0.5 = p50, 0.999 = p999).
+ * @return Limite superior da faixa do percentil (ns, nunca acima do máximo), 0 se vazio.
+ */
+long long percentilLatencia(const HistogramaLatencia* histograma, double fracao);
+
+/**
+ * @brief Escreve a tabela amostras/p50/p99/p999/máximo de cada comando.
+ *
+ * @param saida Arquivo de destino (stdout, socket...).
+ */
+void escreverEstatisticas(FILE* saida);
+
+/**
+ * @brief Abre o socket de estatísticas e a thread que o atende.
+ *
+ * Cada conexão recebe o resumo atual (escreverEstatisticas) e é fechada,
+ * então `nc -U caminho` basta para consultar. Um socket velho no mesmo
+ * caminho é substituído.
+ *
+ * @param servidor Servidor a iniciar.
+ * @param caminho Caminho do socket no sistema de arquivos.
+ * @return 1 se o socket está atendendo, 0 caso contrário.
+ */
+int abrirSocketEstatisticas(ServidorEstatisticas* servidor, const char* caminho);
+
+/**
+ * @brief Para a thread do socket e remove o arquivo.
+ *
+ * @param servidor Servidor aberto por abrirSocketEstatisticas() (ou com descritor -1).
+ */
+void fecharSocketEstatisticas(ServidorEstatisticas* servidor);
+
+/* ----------------- Resumo por ala (Fenwick sobre a pré-ordem) ----------------- */
+
+/**
+ * @brief Monta as árvores de Fenwick da sessão a partir das salas visitadas.
+ *
+ * Chamada ao iniciar e ao restaurar uma sessão: custa O(v log n) para as v
+ * salas visitadas com pista. Se as contagens já existem para o mesmo tamanho
+ * de caso, os vetores são reaproveitados. Os vetores novos saem de
+ * `alas->cota`; os totais do caso são montados na primeira chamada.
+ *
+ * @param alas Contagens a (re)construir (zeradas ou já construídas).
+ * @param caso Caso da partida (salas, pistas e suspeitos).
+ * @param visitadas Bitset de salas visitadas.
+ * @return SESSAO_OK, ou SESSAO_ERRO_MEMORIA (as contagens ficam liberadas).
+ */
+int construirAlas(ContagemAlas* alas, const Caso* caso, const unsigned char* visitadas);
+
+/**
+ * @brief Libera as árvores de Fenwick.
+ *
+ * @param alas Contagens a liberar.
+ */
+void liberarAlas(ContagemAlas* alas);
+
+/**
+ * @brief Registra a primeira visita a uma sala com pista (O(log n)).
+ *
+ * @param alas Contagens da sessão.
+ * @param idSala ID da sala visitada.
+ * @param idSuspeito Suspeito apontado pela pista da sala.
+ */
+void marcarVisitaNasAlas(ContagemAlas* alas, int idSala, int idSuspeito);
+
+/**
+ * @brief Soma de uma árvore de Fenwick sobre a ala de uma sala.
+ *
+ * @param arvore Vetor de Fenwick (1-based).
+ * @param ala Sala cuja subárvore é consultada.
+ * @return Soma no intervalo [ala->id, ala->id + ala->tamanhoAla).
+ */
+int somarNaAla(const int* arvore, const Sala* ala);
+
+/**
+ * @brief Lista as salas da ala que ainda guardam pistas não visitadas.
+ *
+ * Cada sala é localizada por descida na árvore de Fenwick: O(k log n).
+ *
+ * @param caso Caso da partida.
+ * @param alas Contagens da sessão.
+ * @param ala Raiz da ala consultada.
+ * @param saida Vetor de saída.
+ * @param maximo Capacidade de `saida`.
+ * @return Quantidade de salas escritas.
+ */
+int listarPendentesNaAla(const Caso* caso, const ContagemAlas* alas, const Sala* ala, Sala** saida, int maximo);
+
+/**
+ * @brief Exibe, por suspeito, as pistas encontradas e pendentes na ala atual.
+ *
+ * @param caso Caso da partida.
+ * @param sessao Sessão do jogador.
+ */
+void exibirResumoAla(const Caso* caso, const Sessao* sessao);
+
+/* ----------------- BST de pistas ----------------- */
+
+/**
+ * @brief Insere uma pista na BST (mantendo ordem alfabética).
+ *
+ * Não insere duplicatas idênticas (comparação por strcmp). Após a inserção,
+ * altura e tamanho são atualizados no caminho de volta e a árvore é
+ * rebalanceada por rotações AVL.
+ *
+ * @param raiz Ponteiro para a raiz atual da BST.
+ * @param pista Texto da pista a inserir.
+ * @return Ponteiro atualizado para a raiz da BST.
+ */
+PistaNode* inserirPista(PistaNode* raiz, const char* pista);
+
+/**
+ * @brief Como inserirPista(), mas o nó sai de uma cota e a falta de memória não encerra o processo.
+ *
+ * @param raiz Ponteiro para a raiz atual da BST.
+ * @param pista Texto da pista a inserir.
+ * @param cota Cota da sessão dona da árvore (NULL = sem limite).
+ * @param erro Recebe SESSAO_ERRO_MEMORIA se o nó não pôde ser alocado (a árvore fica intacta).
+ * @return Ponteiro atualizado para a raiz da BST.
+ */
+PistaNode* inserirPistaNaCota(PistaNode* raiz, const char* pista, CotaMemoria* cota, int* erro);
+
+/**
+ * @brief Exibe todas as pistas armazenadas na BST, em ordem alfabética.
+ *
+ * Percurso in-order recursivo.
+ *
+ * @param raiz Ponteiro para a raiz da BST de pistas.
+ */
+void exibirPistas(PistaNode* raiz);
+
+/**
+ * @brief Quantidade de pistas armazenadas na (sub)árvore, em O(1).
+ *
+ * @param raiz Ponteiro para a raiz da BST (pode ser NULL).
+ * @return Número de nós da subárvore.
+ */
+int tamanhoPistas(PistaNode* raiz);
+
+/**
+ * @brief Recalcula altura e tamanho de um nó a partir dos filhos.
+ *
+ * @param no Nó a atualizar (não-NULL).
+ */
+void atualizarPistaNode(PistaNode* no);
+
+/**
+ * @brief Rotação simples à direita (filho esquerdo sobe).
+ *
+ * @param no Raiz da subárvore desbalanceada.
+ * @return Nova raiz da subárvore.
+ */
+PistaNode* rotacionarDireita(PistaNode* no);
+
+/**
+ * @brief Rotação simples à esquerda (filho direito sobe).
+ *
+ * @param no Raiz da subárvore desbalanceada.
+ * @return Nova raiz da subárvore.
+ */
+PistaNode* rotacionarEsquerda(PistaNode* no);
+
+/**
+ * @brief Restaura a propriedade AVL de um nó após uma inserção.
+ *
+ * @param no Raiz da subárvore (filhos já balanceados).
+ * @return Nova raiz da subárvore.
+ */
+PistaNode* balancearPista(PistaNode* no);
+
+/**
+ * @brief Posição (rank) de uma pista: quantas pistas são estritamente menores.
+ *
+ * A pista não precisa estar na árvore. Custo O(log n).
+ *
+ * @param raiz Raiz da BST de pistas.
+ * @param pista Texto de referência.
+ * @return Número de pistas armazenadas com strcmp(p, pista) < 0.
+ */
+int posicaoPista(PistaNode* raiz, const char* pista);
+
+/**
+ * @brief Seleciona a k-ésima pista em ordem alfabética (select), em O(log n).
+ *
+ * @param raiz Raiz da BST de pistas.
+ * @param k Posição desejada, começando em 1.
+ * @return Texto da pista, ou NULL se k estiver fora do intervalo [1, n].
+ */
+const char* selecionarPista(PistaNode* raiz, int k);
+
+/**
+ * @brief Conta as pistas no intervalo alfabético [inicio, fim), em O(log n).
+ *
+ * Ex.: inicio = "A", fim = "N" conta as pistas que começam de A a M.
+ *
+ * @param raiz Raiz da BST de pistas.
+ * @param inicio Limite inferior inclusivo (NULL = sem limite).
+ * @param fim Limite superior exclusivo (NULL = sem limite).
+ * @return Quantidade de pistas no intervalo.
+ */
+int contarPistasNoIntervalo(PistaNode* raiz, const char* inicio, const char* fim);
+
+/**
+ * @brief Exibe as pistas nas posições [inicio, inicio + quantidade).
+ *
+ * Subárvores inteiramente fora da faixa são descartadas pelo tamanho,
+ * então o custo é O(log n + quantidade).
+ *
+ * @param raiz Raiz da BST de pistas.
+ * @param inicio Posição inicial (começando em 0).
+ * @param quantidade Número máximo de pistas a exibir.
+ * @return Quantidade de pistas efetivamente exibidas.
+ */
+int exibirFaixaPistas(PistaNode* raiz, int inicio, int quantidade);
+
+/**
+ * @brief Exibe uma página da lista ordenada de pistas.
+ *
+ * @param raiz Raiz da BST de pistas.
+ * @param pagina Número da página, começando em 1.
+ * @param porPagina Quantidade de pistas por página (> 0).
+ * @return Quantidade de pistas exibidas (0 se a página não existir).
+ */
+int exibirPaginaPistas(PistaNode* raiz, int pagina, int porPagina);
+
+/**
+ * @brief Posiciona o iterador na primeira pista >= inicio, em O(log n).
+ *
+ * @param it Iterador a inicializar.
+ * @param raiz Raiz da BST de pistas.
+ * @param inicio Limite inferior inclusivo (NULL ou "" = primeira pista).
+ */
+void iniciarIteradorPistas(IteradorPistas* it, PistaNode* raiz, const char* inicio);
+
+/**
+ * @brief Retoma um iterador suspenso logo após a última pista entregue.
+ *
+ * Necessário sempre que a BST tiver sido modificada desde o último avanço
+ * (rotações invalidam a pilha). Se nenhuma pista foi entregue ainda, volta à
+ * primeira pista >= o limite inferior dado a iniciarIteradorPistas(). Custo O(log n).
+ *
+ * @param it Iterador previamente usado.
+ * @param raiz Raiz atual da BST de pistas.
+ */
+void retomarIteradorPistas(IteradorPistas* it, PistaNode* raiz);
+
+/**
+ * @brief Avança o iterador, em O(1) amortizado.
+ *
+ * @param it Iterador.
+ * @return Texto da próxima pista em ordem alfabética, ou NULL ao final.
+ */
+const char* proximaPista(IteradorPistas* it);
+
+/**
+ * @brief Exibe as próximas pistas do iterador (uma página).
+ *
+ * @param it Iterador posicionado.
+ * @param porPagina Quantidade máxima de pistas a exibir.
+ * @return Quantidade de pistas exibidas.
+ */
+int exibirProximasPistas(IteradorPistas* it, int porPagina);
+
+/**
+ * @brief Libera recursivamente toda a memória alocada pela BST de pistas.
+ *
+ * @param raiz Ponteiro para a raiz da BST.
+ */
+void liberarPistas(PistaNode* raiz);
+
+/* ----------------- Tabela hash e suspeitos ----------------- */
+
+/**
+ * @brief Inicializa a tabela hash, setando todos os buckets para NULL.
+ *
+ * @param tabela Vetor (size TAM_HASH) de ponteiros para SuspeitoNode.
+ */
+void inicializarHash(SuspeitoNode* tabela[]);
+
+/**
+ * @brief Função hash simples — transforma a string (pista) em índice.
+ *
+ * Implementação: soma dos bytes (unsigned char) mod TAM_HASH.
+ *
+ * @param pista Texto da pista.
+ * @return Índice no intervalo [0, TAM_HASH-1].
+ */
+int hash(const char* pista);
+
+/**
+ * @brief Insere uma associação (pista -> suspeito) na tabela hash.
+ *
+ * Trata colisões por inserção no início da lista encadeada do bucket.
+ *
+ * @param tabela Tabela hash previamente inicializada.
+ * @param pista Texto da pista (chave).
+ * @param suspeito Nome do suspeito (valor).
+ * @return Nó criado (com id = -1), ou NULL se algum argumento for NULL.
+ */
+SuspeitoNode* inserirNaHash(SuspeitoNode* tabela[], const char* pista, const char* suspeito);
+
+/**
+ * @brief Busca o nó da tabela hash correspondente a uma pista.
+ *
+ * @param tabela Tabela hash.
+ * @param pista Texto da pista buscada.
+ * @return Nó encontrado, ou NULL se a pista não estiver cadastrada.
+ */
+SuspeitoNode* buscarNaHash(SuspeitoNode* tabela[], const char* pista);
+
+/**
+ * @brief Consulta a tabela hash buscando o suspeito ligado a uma pista.
+ *
+ * Se a pista não estiver presente, retorna a string literal "Desconhecido".
+ *
+ * @param tabela Tabela hash.
+ * @param pista Texto da pista buscada.
+ * @return Ponteiro para o nome do suspeito (string estática ou do nó).
+ */
+const char* encontrarSuspeito(SuspeitoNode* tabela[], const char* pista);
+
+/**
+ * @brief Libera toda a memória alocada na tabela hash (listas encadeadas).
+ *
+ * @param tabela Tabela hash.
+ */
+void liberarHash(SuspeitoNode* tabela[]);
+
+/* ----------------- Índice de prefixos (árvore radix) ----------------- */
+
+/**
+ * @brief Cria um nó radix com uma cópia do rótulo informado.
+ *
+ * @param rotulo Fragmento de texto da aresta.
+ * @param tam Quantidade de bytes de `rotulo` a copiar.
+ * @return Nó alocado (não-NULL). Em falha, finaliza o programa.
+ */
+NoRadix* criarNoRadix(const char* rotulo, int tam);
+
+/**
+ * @brief Insere um texto na árvore radix, dividindo arestas quando necessário.
+ *
+ * Duplicatas são ignoradas. Custo O(comprimento do texto).
+ *
+ * @param raiz Raiz atual (pode ser NULL).
+ * @param texto Texto a indexar.
+ * @return Ponteiro atualizado para a raiz.
+ */
+NoRadix* inserirNoRadix(NoRadix* raiz, const char* texto);
+
+/**
+ * @brief Localiza a subárvore que contém todos os textos com o prefixo dado.
+ *
+ * @param raiz Raiz da árvore radix.
+ * @param prefixo Prefixo procurado.
+ * @param consumidos Saída: quantos bytes do rótulo do nó retornado já
+ *                   foram casados com o fim do prefixo (pode ser NULL).
+ * @return Nó cuja subárvore contém as ocorrências, ou NULL se não houver.
+ */
+NoRadix* buscarPrefixoRadix(NoRadix* raiz, const char* prefixo, int* consumidos);
+
+/**
+ * @brief Lista, em ordem alfabética, os textos que começam com o prefixo.
+ *
+ * Custo O(|prefixo| + resultados).
+ *
+ * @param raiz Raiz da árvore radix.
+ * @param prefixo Prefixo procurado ("" lista tudo).
+ * @param saida Vetor que recebe ponteiros para os textos encontrados.
+ * @param max Capacidade de `saida`.
+ * @return Quantidade de textos gravados em `saida`.
+ */
+int listarPorPrefixo(NoRadix* raiz, const char* prefixo, const char* saida[], int max);
+
+/**
+ * @brief Autocompleta o prefixo até o próximo ponto de ambiguidade.
+ *
+ * Estende o prefixo enquanto houver um único caminho possível na árvore
+ * (como o TAB de um terminal).
+ *
+ * @param raiz Raiz da árvore radix.
+ * @param prefixo Prefixo digitado.
+ * @param saida Buffer que recebe o prefixo estendido.
+ * @param tam Tamanho de `saida`.
+ * @return 1 se há ao menos um texto com o prefixo, 0 caso contrário.
+ */
+int completarPrefixo(NoRadix* raiz, const char* prefixo, char* saida, size_t tam);
+
+/**
+ * @brief Libera toda a memória da árvore radix.
+ *
+ * @param raiz Raiz da árvore radix.
+ */
+void liberarRadix(NoRadix* raiz);
+
+/**
+ * @brief Exibe as pistas coletadas que começam com o prefixo, em O(log n + k).
+ *
+ * Usa o iterador da BST a partir do limite inferior `prefixo`.
+ *
+ * @param raiz Raiz da BST de pistas coletadas.
+ * @param prefixo Prefixo procurado.
+ * @return Quantidade de pistas exibidas.
+ */
+int exibirPistasComPrefixo(PistaNode* raiz, const char* prefixo);
+
+/**
+ * @brief Verifica se uma pista já foi coletada (busca na BST), em O(log n).
+ *
+ * @param raiz Raiz da BST de pistas.
+ * @param pista Texto procurado.
+ * @return 1 se presente, 0 caso contrário.
+ */
+int pistaColetada(PistaNode* raiz, const char* pista);
+
+/* ----------------- Busca textual (índice invertido) ----------------- */
+
+/**
+ * @brief Normaliza um caractere UTF-8: minúsculas e sem acentos.
+ *
+ * Reconhece letras latinas acentuadas (À-ÿ, codificadas como 0xC3 0x80-0xBF).
+ * Qualquer outro caractere não alfanumérico vira separador.
+ *
+ * @param cursor Endereço do ponteiro de leitura; avança 1 ou mais bytes.
+ * @return Caractere ASCII [a-z0-9], ou 0 se for separador.
+ */
+char normalizarCaractere(const char** cursor);
+
+/**
+ * @brief Extrai a próxima palavra normalizada de um texto.
+ *
+ * @param cursor Endereço do ponteiro de leitura (avança após a palavra).
+ * @param palavra Buffer de saída (MAX_PALAVRA bytes).
+ * @return 1 se uma palavra foi extraída, 0 ao fim do texto.
+ */
+int proximaPalavra(const char** cursor, char* palavra);
+
+/**
+ * @brief Função hash de palavras (djb2) para o índice invertido.
+ *
+ * @param palavra Palavra normalizada.
+ * @return Índice no intervalo [0, TAM_INDICE_PALAVRAS-1].
+ */
+int hashPalavra(const char* palavra);
+
+/**
+ * @brief Busca a lista de postagens de uma palavra normalizada.
+ *
+ * @param indice Vetor de buckets do índice invertido.
+ * @param palavra Palavra normalizada.
+ * @return Postagem encontrada, ou NULL.
+ */
+Postagem* buscarPostagem(Postagem* indice[], const char* palavra);
+
+/**
+ * @brief Indexa todas as palavras de uma pista sob o ID informado.
+ *
+ * IDs devem ser cadastrados em ordem crescente (mantém as listas ordenadas).
+ *
+ * @param indice Vetor de buckets do índice invertido.
+ * @param id ID da pista.
+ * @param texto Texto livre da pista.
+ */
+void indexarPalavras(Postagem* indice[], int id, const char* texto);
+
+/**
+ * @brief Interseção de duas listas de IDs ordenadas e sem repetição.
+ *
+ * Usa SSE2 (comparação de blocos de 4 IDs contra as 4 rotações do outro
+ * bloco) quando disponível, com intercalação escalar para o restante.
+ *
+ * @param a Primeira lista.
+ * @param na Tamanho de `a`.
+ * @param b Segunda lista.
+ * @param nb Tamanho de `b`.
+ * @param saida Destino (capacidade mínima: min(na, nb)); pode coincidir com `a`.
+ * @return Quantidade de IDs na interseção.
+ */
+int intersectarIds(const int* a, int na, const int* b, int nb, int* saida);
+
+/**
+ * @brief Busca pistas que contêm TODAS as palavras da consulta (AND).
+ *
+ * As listas são intersectadas da menor para a maior. Não há limite de
+ * palavras: todas entram na interseção.
+ *
+ * @param indice Vetor de buckets do índice invertido.
+ * @param consulta Texto livre (ex.: "chave flores").
+ * @param saida Recebe os IDs encontrados, em ordem crescente.
+ * @param max Capacidade de `saida`.
+ * @return Quantidade de IDs encontrados (limitada a `max`), ou SESSAO_ERRO_MEMORIA.
+ */
+int buscarPorPalavras(Postagem* indice[], const char* consulta, int* saida, int max);
+
+/**
+ * @brief Libera o índice invertido.
+ *
+ * @param indice Vetor de buckets do índice invertido.
+ */
+void liberarIndicePalavras(Postagem* indice[]);
+
+/* ----------------- Suspeitos (BK-tree) ----------------- */
+
+/**
+ * @brief Normaliza um nome: palavras sem acento, minúsculas, separadas por um espaço.
+ *
+ * Ex.: "  Madame   SINCLÁIR " -> "madame sinclair".
+ *
+ * @param nome Texto original.
+ * @param saida Buffer de saída.
+ * @param tam Tamanho de `saida`.
+ */
+void normalizarNome(const char* nome, char* saida, size_t tam);
+
+/**
+ * @brief Distância de Levenshtein com corte.
+ *
+ * Bit-paralela (uma palavra de 64 bits por coluna); interrompe assim que
+ * nem as letras restantes de `b` trariam a distância de volta a `limite`.
+ *
+ * @param a Primeira string.
+ * @param b Segunda string.
+ * @param limite Maior distância de interesse.
+ * @return Distância exata se <= limite; caso contrário, limite + 1.
+ */
+int distanciaEdicao(const char* a, const char* b, int limite);
+
+/**
+ * @brief Procura na BK-tree o nome mais próximo da consulta.
+ *
+ * @param raiz Raiz da BK-tree.
+ * @param nome Nome digitado (normalizado internamente).
+ * @param tolerancia Distância máxima aceita.
+ * @param distancia Saída: distância do melhor nome (pode ser NULL).
+ * @return Nó do suspeito mais próximo, ou NULL se nenhum estiver dentro da tolerância
+ *         (ou se faltou memória para a busca).
+ */
+NoBK* buscarSuspeitoAproximado(NoBK* raiz, const char* nome, int tolerancia, int* distancia);
+
+/**
+ * @brief Registra um suspeito no caso (BK-tree + registro por ID).
+ *
+ * Nomes que normalizam para a mesma chave são considerados o mesmo suspeito.
+ *
+ * @param caso Caso em montagem.
+ * @param nome Nome do suspeito.
+ * @return ID do suspeito (existente ou novo).
+ */
+int registrarSuspeito(Caso* caso, const char* nome);
+
+/**
+ * @brief Resolve um nome digitado para um suspeito cadastrado, tolerando erros.
+ *
+ * A tolerância cresce com o comprimento do nome (1 erro a cada 4 letras,
+ * no mínimo 1).
+ *
+ * @param caso Caso em andamento.
+ * @param nome Nome digitado pelo jogador.
+ * @param distancia Saída: distância de edição até o nome escolhido (pode ser NULL).
+ * @return Nó do suspeito correspondente, ou NULL se não houver candidato próximo.
+ */
+NoBK* resolverSuspeito(Caso* caso, const char* nome, int* distancia);
+
+/**
+ * @brief Libera a BK-tree de suspeitos.
+ *
+ * @param raiz Raiz da BK-tree.
+ */
+void liberarBK(NoBK* raiz);
+
+/* ----------------- Caso ----------------- */
+
+/**
+ * @brief Prepara um caso vazio para a mansão informada.
+ *
+ * @param caso Caso a inicializar.
+ * @param mansao Raiz da árvore de salas.
+ */
+void inicializarCaso(Caso* caso, Sala* mansao);
+
+/**
+ * @brief Cadastra uma pista conhecida: associa ao suspeito e indexa o texto.
+ *
+ * A pista recebe o próximo ID do catálogo e é registrada na tabela hash,
+ * no índice de prefixos e no índice invertido de palavras. Pistas já
+ * cadastradas são ignoradas.
+ *
+ * @param caso Caso em montagem.
+ * @param pista Texto da pista.
+ * @param suspeito Nome do suspeito associado.
+ * @return ID da pista (existente ou novo).
+ */
+int cadastrarPista(Caso* caso, const char* pista, const char* suspeito);
+
+/**
+ * @brief Numera as salas em pré-ordem e monta o índice ID -> sala.
+ *
+ * Preenche `pai`, `profundidade` e `rota` de cada sala, monta o índice por
+ * nome (indexarNomesSalas) e também incorpora os nomes e pistas das salas à assinatura do caso.
+ *
+ * @param caso Caso cuja mansão já está montada.
+ */
+void indexarSalas(Caso* caso);
+
+/**
+ * @brief Monta o hash aberto nome normalizado -> sala.
+ *
+ * Em nomes repetidos, vale a primeira sala em pré-ordem.
+ *
+ * @param caso Caso com as salas já numeradas.
+ */
+void indexarNomesSalas(Caso* caso);
+
+/**
+ * @brief Registra (ou reencontra) um rótulo de porta.
+ *
+ * @param caso Caso em montagem.
+ * @param rotulo Texto do rótulo (ex.: "passagem secreta").
+ * @return Índice do rótulo (no máximo 65535 rótulos distintos).
+ */
+int registrarRotulo(Caso* caso, const char* rotulo);
+
+/**
+ * @brief Acrescenta uma porta de mão única entre duas salas.
+ *
+ * A porta fica pendente até a próxima chamada a construirPortas(). Portas
+ * extras podem formar ciclos; as da árvore (esquerda, direita, voltar) são
+ * geradas automaticamente.
+ *
+ * @param caso Caso em montagem.
+ * @param origem ID da sala de origem.
+ * @param destino ID da sala de destino.
+ * @param rotulo Índice do rótulo (registrarRotulo).
+ * @param custo Custo de atravessar o corredor (1-65535; a árvore usa 1).
+ */
+void adicionarPorta(Caso* caso, int origem, int destino, int rotulo, int custo);
+
+/**
+ * @brief Monta a adjacência CSR com as portas da árvore e as extras.
+ *
+ * Ordenação por contagem em O(n + m): por sala, primeiro as portas da
+ * árvore (esquerda, direita, voltar), depois as extras em ordem de
+ * inserção. Pode ser chamada de novo após mais adicionarPorta().
+ *
+ * @param caso Caso com as salas numeradas.
+ */
+void construirPortas(Caso* caso);
+
+/**
+ * @brief Quantidade de portas de uma sala.
+ *
+ * @param caso Caso da partida.
+ * @param sala Sala consultada.
+ * @return Número de portas.
+ */
+int portasDaSala(const Caso* caso, const Sala* sala);
+
+/**
+ * @brief Sala de destino de uma porta.
+ *
+ * @param caso Caso da partida.
+ * @param sala Sala de origem.
+ * @param porta Índice da porta (base 0).
+ * @return Sala de destino.
+ */
+Sala* destinoDaPorta(const Caso* caso, const Sala* sala, int porta);
+
+/**
+ * @brief Rótulo de uma porta.
+ *
+ * @param caso Caso da partida.
+ * @param sala Sala de origem.
+ * @param porta Índice da porta (base 0).
+ * @return Texto do rótulo.
+ */
+const char* rotuloDaPorta(const Caso* caso, const Sala* sala, int porta);
+
+/**
+ * @brief Procura uma sala pelo nome em O(1) esperado.
+ *
+ * @param caso Caso da partida.
+ * @param nome Nome da sala (acentos, maiúsculas e espaços extras ignorados).
+ * @return Sala encontrada, ou NULL.
+ */
+Sala* buscarSala(const Caso* caso, const char* nome);
+
+/**
+ * @brief Acumula um texto no hash FNV-1a de 32 bits.
+ *
+ * @param h Valor atual do hash.
+ * @param texto Texto a incorporar (inclui o terminador, separando campos).
+ * @return Novo valor do hash.
+ */
+uint32_t acumularAssinatura(uint32_t h, const char* texto);
+
+/**
+ * @brief Libera a mansão, a tabela hash e os índices do caso.
+ *
+ * @param caso Caso a liberar.
+ */
+void liberarCaso(Caso* caso);
+
+/* ----------------- Cotas de memória por sessão ----------------- */
+
+/**
+ * @brief Pré-aloca a reserva do processo (encerra o programa se nem isso couber).
+ *
+ * @param reserva Reserva a inicializar.
+ * @param blocos Quantidade de blocos de RESERVA_BLOCO bytes.
+ */
+void iniciarReservaMemoria(ReservaMemoria* reserva, int blocos);
+
+/**
+ * @brief Libera a reserva (todos os blocos já devem ter sido devolvidos).
+ *
+ * @param reserva Reserva a liberar.
+ */
+void liberarReservaMemoria(ReservaMemoria* reserva);
+
+/**
+ * @brief Zera uma cota com o limite e a reserva dados.
+ *
+ * @param cota Cota a inicializar.
+ * @param limite Bytes permitidos (COTA_ILIMITADA = sem limite).
+ * @param reserva Reserva do processo (NULL = nenhuma).
+ */
+void iniciarCotaMemoria(CotaMemoria* cota, size_t limite, ReservaMemoria* reserva);
+
+/**
+ * @brief Aloca `quantidade` * `tamanho` bytes zerados, descontados da cota.
+ *
+ * Se o malloc falhar e o pedido couber num bloco, a reserva socorre
+ * (até RESERVA_POR_SESSAO blocos por cota). Nunca encerra o processo.
+ *
+ * @param cota Cota a descontar (NULL = sem limite e sem reserva).
+ * @param quantidade Quantidade de elementos.
+ * @param tamanho Tamanho de cada elemento.
+ * @return Bloco alocado, ou NULL se a cota, a memória e a reserva não bastarem.
+ */
+void* alocarNaCota(CotaMemoria* cota, size_t quantidade, size_t tamanho);
+
+/**
+ * @brief Devolve um bloco de alocarNaCota() à cota dona (e à reserva, se veio dela).
+ *
+ * @param bloco Bloco a liberar (NULL é ignorado).
+ */
+void liberarDaCota(void* bloco);
+
+/**
+ * @brief Modo --estresse: sessões com cota e o processo sem memória, sem derrubar ninguém.
+ *
+ * Numa mansão sintética de ESTRESSE_SALAS salas (todas com pista), a
+ * sessão 0 recebe só um quarto da cota e as demais exploram tudo; depois o
+ * espaço de endereçamento é limitado (setrlimit) e a sessão 0, sem cota,
+ * esgota a memória do processo enquanto as outras tentam comandos, incluindo
+ * rotas ('i') com o planejador ainda sem filas alocadas. Ao encerrar a
+ * sessão 0, as outras voltam a andar.
+ *
+ * @param sessoes Quantidade de sessões (mínimo 2).
+ * @return 1 se todas as recusas vieram como SESSAO_ERRO_MEMORIA e as outras sessões terminaram.
+ */
+int executarEstresseMemoria(int sessoes);
+
+/* ----------------- Sessão: estado, salvar e retomar ----------------- */
+
+/**
+ * @brief Inicia uma sessão nova no Hall de Entrada, sem pistas.
+ *
+ * Nenhuma sala é marcada como visitada: a primeira visita (e a coleta da
+ * pista do Hall) acontece em entrarNaSala().
+ *
+ * @param sessao Sessão a inicializar.
+ * @param caso Caso da partida (define o tamanho dos bitsets).
+ * @return SESSAO_OK ou SESSAO_ERRO_MEMORIA (a sessão fica liberada).
+ */
+int iniciarSessao(Sessao* sessao, const Caso* caso);
+
+/**
+ * @brief Como iniciarSessao(), com um orçamento de memória para a sessão inteira.
+ *
+ * Bitsets, pilha de ramos, contagens por ala e nós da BST saem da cota;
+ * estourá-la recusa só o comando desta sessão, com SESSAO_ERRO_MEMORIA.
+ *
+ * @param sessao Sessão a inicializar (não pode mudar de endereço depois).
+ * @param caso Caso da partida.
+ * @param limite Bytes permitidos (COTA_ILIMITADA = sem limite).
+ * @param reserva Reserva do processo para quando o malloc falhar (NULL = nenhuma).
+ * @return SESSAO_OK ou SESSAO_ERRO_MEMORIA (a sessão fica liberada).
+ */
+int iniciarSessaoComCota(Sessao* sessao, const Caso* caso, size_t limite, ReservaMemoria* reserva);
+
+/**
+ * @brief Libera a BST, os bitsets e a pilha de ramos da sessão.
+ *
+ * @param sessao Sessão a liberar.
+ */
+void liberarSessao(Sessao* sessao);
+
+/**
+ * @brief Registra a pista de uma sala como coletada (bitset + BST).
+ *
+ * A verificação de duplicata é um teste de bit em O(1); a BST só é tocada
+ * quando a pista é realmente nova.
+ *
+ * @param caso Caso da partida.
+ * @param sessao Sessão do jogador.
+ * @param pista Texto da pista encontrada.
+ * @return 1 se a pista era nova, 0 se já estava coletada ou é desconhecida,
+ *         SESSAO_ERRO_MEMORIA se a cota não comporta o nó (nada é marcado).
+ */
+int coletarPista(Caso* caso, Sessao* sessao, const char* pista);
+
+/**
+ * @brief Serializa a sessão no formato binário compacto (sem E/S).
+ *
+ * Layout (little-endian): "DQSS", versão (u16), reservado (u16),
+ * assinatura do caso (u32), ID da sala atual (u32), nº de bits (u32),
+ * estado da acusação (u8), tamanho do nome (u8), nome, bitset de pistas,
+ * bitset de salas visitadas (desde a versão 2) e, desde a versão 3, a pilha
+ * de ramos na ordem das visitas: quantidade (u32) e IDs das salas (u32),
+ * já sem as salas esgotadas.
+ *
+ * @param caso Caso da partida.
+ * @param sessao Sessão a gravar.
+ * @param buffer Destino.
+ * @param capacidade Tamanho de `buffer`.
+ * @return Bytes escritos, ou 0 se `buffer` for pequeno demais.
+ */
+size_t serializarSessao(const Caso* caso, const Sessao* sessao, unsigned char* buffer, size_t capacidade);
+
+/**
+ * @brief Tamanho máximo de uma sessão serializada neste caso.
+ *
+ * @param caso Caso da partida.
+ * @return Capacidade suficiente para qualquer chamada a serializarSessao().
+ */
+size_t tamanhoMaximoSessao(const Caso* caso);
+
+/**
+ * @brief Reconstrói uma sessão a partir do formato binário.
+ *
+ * A sessão deve estar iniciada (iniciarSessao); em caso de erro ela não é alterada.
+ * Arquivos da versão 1 (sem salas visitadas) são aceitos: considera-se
+ * visitado o caminho do Hall até a sala atual. Nas versões 1 e 2 (sem a
+ * ordem das visitas) a pilha de ramos é a pré-ordem das salas visitadas.
+ *
+ * @param caso Caso da partida.
+ * @param sessao Sessão de destino.
+ * @param buffer Dados serializados.
+ * @param tamanho Tamanho de `buffer`.
+ * @return SESSAO_OK ou um código SESSAO_ERRO_*.
+ */
+int desserializarSessao(Caso* caso, Sessao* sessao, const unsigned char* buffer, size_t tamanho);
+
+/**
+ * @brief Salva a sessão em arquivo de forma atômica (grava .tmp e renomeia).
+ *
+ * @param caso Caso da partida.
+ * @param sessao Sessão a salvar.
+ * @param arquivo Caminho do arquivo final.
+ * @return SESSAO_OK ou SESSAO_ERRO_ARQUIVO.
+ */
+int salvarSessao(const Caso* caso, const Sessao* sessao, const char* arquivo);
+
+/**
+ * @brief Carrega uma sessão salva por salvarSessao().
+ *
+ * @param caso Caso da partida.
+ * @param sessao Sessão iniciada que receberá o estado.
+ * @param arquivo Caminho do arquivo.
+ * @return SESSAO_OK ou um código SESSAO_ERRO_*.
+ */
+int carregarSessao(Caso* caso, Sessao* sessao, const char* arquivo);
+
+/* ----------------- Diário de comandos (gravação e reprodução) ----------------- */
+
+/**
+ * @brief Abre (ou cria) um diário para anexar comandos e marca o início da sessão.
+ *
+ * O registro de início carrega a sessão serializada (serializarSessao), de
+ * modo que partidas retomadas de um arquivo salvo também são reproduzíveis.
+ *
+ * @param diario Diário a abrir.
+ * @param arquivo Caminho do arquivo.
+ * @param caso Caso da sessão.
+ * @param sessao Estado da sessão no momento em que a gravação começa.
+ * @return 1 em sucesso, 0 se o arquivo não pôde ser aberto.
+ */
+int abrirDiario(Diario* diario, const char* arquivo, const Caso* caso, const Sessao* sessao);
+
+/**
+ * @brief Anexa um comando ao diário (não faz nada se o diário estiver desligado).
+ *
+ * @param diario Diário aberto ou NULL.
+ * @param codigo DIARIO_*.
+ * @param texto Parâmetro textual do comando (ou NULL).
+ */
+void registrarNoDiario(Diario* diario, int codigo, const char* texto);
+
+/**
+ * @brief Anexa ao diário a travessia de uma porta (índice em varint).
+ *
+ * @param diario Diário aberto ou NULL.
+ * @param porta Índice da porta digitada (base 0; negativo = entrada inválida).
+ */
+void registrarPortaNoDiario(Diario* diario, int porta);
+
+/**
+ * @brief Fecha o diário.
+ *
+ * @param diario Diário aberto.
+ */
+void fecharDiario(Diario* diario);
+
+/**
+ * @brief Reexecuta um diário sem renderização, na velocidade máxima.
+ *
+ * Cada sessão do arquivo é reproduzida sobre uma sessão nova e, ao final,
+ * é impresso um resumo determinístico (sala, pistas, acusação) que serve
+ * de oráculo para regressões. Comandos de gravação não tocam o disco.
+ *
+ * @param caso Caso usado na gravação (assinatura conferida).
+ * @param arquivo Caminho do diário.
+ * @return Quantidade de sessões reproduzidas, ou -1 em erro de leitura/formato.
+ */
+int reproduzirDiario(Caso* caso, const char* arquivo);
+
+/* ----------------- Escalonador de tarefas (work stealing) ----------------- */
+
+/**
+ * @brief Sobe um escalonador com `trabalhadores` núcleos (trabalhadores - 1 threads novas).
+ *
+ * @param escalonador Escalonador a iniciar.
+ * @param trabalhadores Quantidade de trabalhadores (<= 0 = um por núcleo).
+ */
+void iniciarEscalonador(Escalonador* escalonador, int trabalhadores);
+
+/**
+ * @brief Para as threads e libera os deques. Não pode haver tarefa em andamento.
+ *
+ * @param escalonador Escalonador a encerrar.
+ */
+void encerrarEscalonador(Escalonador* escalonador);
+
+/**
+ * @brief Escalonador do processo (um trabalhador por núcleo), criado no primeiro uso.
+ *
+ * @return Escalonador compartilhado por simulação, robô, gerador, LCA e alas.
+ */
+Escalonador* escalonadorGlobal(void);
+
+/**
+ * @brief Executa `raiz(arg)` dentro do escalonador e espera todas as tarefas bifurcadas.
+ *
+ * Fora do escalonador, a thread ocupa o trabalhador 0 durante a chamada
+ * (outras threads externas esperam a vez); dentro, apenas chama `raiz`.
+ *
+ * @param escalonador Escalonador.
+ * @param raiz Função inicial (pode bifurcar e juntar tarefas).
+ * @param arg Argumento de `raiz`.
+ */
+void executarNoEscalonador(Escalonador* escalonador, void (*raiz)(void* arg), void* arg);
+
+/**
+ * @brief Zera o contador de uma junção (antes da primeira bifurcação).
+ *
+ * @param grupo Junção a iniciar.
+ */
+void iniciarGrupoTarefas(GrupoTarefas* grupo);
+
+/**
+ * @brief Fork: empilha a tarefa no deque do trabalhador atual (outros podem roubá-la).
+ *
+ * @pre Chamada de dentro do escalonador; `tarefa` vive até juntarTarefas(grupo).
+ *
+ * @param grupo Junção que vai esperar a tarefa.
+ * @param tarefa Tarefa com `executar` e `arg` preenchidos.
+ */
+void bifurcarTarefa(GrupoTarefas* grupo, Tarefa* tarefa);
+
+/**
+ * @brief Join: executa tarefas (próprias ou roubadas) até o grupo terminar.
+ *
+ * @param grupo Junção a esperar.
+ */
+void juntarTarefas(GrupoTarefas* grupo);
+
+/**
+ * @brief Laço paralelo: divide [inicio, fim) ao meio até `grao` e executa as partes.
+ *
+ * @param escalonador Escalonador.
+ * @param inicio Primeiro índice.
+ * @param fim Depois do último índice.
+ * @param grao Menor faixa que não é mais dividida (>= 1).
+ * @param corpo Executa uma faixa [de, ate).
+ * @param arg Argumento de `corpo`.
+ */
+void paraCadaParalelo(Escalonador* escalonador, long inicio, long fim, long grao,
+                      void (*corpo)(void* arg, long de, long ate), void* arg);
+
+/**
+ * @brief Recursão fork/join sobre a mansão: visita a sala e, se pedir, desce nos filhos.
+ *
+ * A subárvore da esquerda é bifurcada quando tem ao menos `corte` salas
+ * (tamanhoAla, válido após indexarSalas); abaixo disso a descida é sequencial.
+ *
+ * @param escalonador Escalonador.
+ * @param raiz Sala inicial.
+ * @param visitar Retorna 1 para descer nos filhos da sala, 0 para podar.
+ * @param arg Argumento de `visitar`.
+ * @param corte Menor subárvore bifurcada (<= 0 = ESCALONADOR_CORTE_ARVORE).
+ */
+void visitarSalasParalelo(Escalonador* escalonador, Sala* raiz, int (*visitar)(Sala* sala, void* arg), void* arg,
+                          int corte);
+
+/**
+ * @brief Recursão fork/join sobre a BST de pistas (mesmas regras de visitarSalasParalelo, com `tamanho`).
+ *
+ * @param escalonador Escalonador.
+ * @param raiz Raiz da BST.
+ * @param visitar Retorna 1 para descer nos filhos, 0 para podar.
+ * @param arg Argumento de `visitar`.
+ * @param corte Menor subárvore bifurcada (<= 0 = ESCALONADOR_CORTE_ARVORE).
+ */
+void visitarPistasParalelo(Escalonador* escalonador, PistaNode* raiz, int (*visitar)(PistaNode* no, void* arg),
+                           void* arg, int corte);
+
+/**
+ * @brief Índice do trabalhador que executa a thread atual (para dados por trabalhador).
+ *
+ * @return 0..total-1 dentro do escalonador, -1 fora.
+ */
+int trabalhadorAtual(void);
+
+/**
+ * @brief Zera tarefas, roubos e ociosidade de todos os trabalhadores.
+ *
+ * @param escalonador Escalonador.
+ */
+void zerarEstatisticasEscalonador(Escalonador* escalonador);
+
+/**
+ * @brief Imprime, por trabalhador, tarefas executadas, roubos (e falhas) e tempo ocioso.
+ *
+ * @param escalonador Escalonador.
+ */
+void exibirEstatisticasEscalonador(Escalonador* escalonador);
+
+/* ----------------- Conjunto concorrente de pistas (skiplist) ----------------- */
+
+/**
+ * @brief Inicia um conjunto vazio.
+ *
+ * @param conjunto Conjunto a iniciar.
+ */
+void iniciarConjuntoPistas(ConjuntoPistas* conjunto);
+
+/**
+ * @brief Libera todos os nós. Nenhuma thread pode estar usando o conjunto.
+ *
+ * @param conjunto Conjunto a liberar.
+ */
+void liberarConjuntoPistas(ConjuntoPistas* conjunto);
+
+/**
+ * @brief Insere a pista se ela ainda não estiver no conjunto (seguro entre threads).
+ *
+ * Sem travas: a pista passa a pertencer ao conjunto no CAS que a liga no
+ * nível 0; os níveis de cima são ligados depois, só como atalhos. Entre
+ * várias threads inserindo a mesma pista, exatamente uma recebe 1.
+ *
+ * @param conjunto Conjunto compartilhado.
+ * @param pista Texto da pista (copiado).
+ * @return 1 se inseriu, 0 se a pista já estava lá.
+ */
+int inserirNoConjuntoPistas(ConjuntoPistas* conjunto, const char* pista);
+
+/**
+ * @brief Verifica se a pista está no conjunto (seguro durante inserções).
+ *
+ * @param conjunto Conjunto compartilhado.
+ * @param pista Texto procurado.
+ * @return 1 se encontrada, 0 caso contrário.
+ */
+int conjuntoContemPista(const ConjuntoPistas* conjunto, const char* pista);
+
+/**
+ * @brief Fotografa o conjunto em ordem alfabética (seguro durante inserções).
+ *
+ * A lista sai ordenada e sem repetições e traz toda pista inserida antes da
+ * chamada; as inseridas durante a chamada podem ou não aparecer. Os textos
+ * valem até liberarConjuntoPistas().
+ *
+ * @param conjunto Conjunto compartilhado.
+ * @param total Saída: quantidade de pistas na foto.
+ * @return Vetor alocado com os textos (liberar com free).
+ */
+const char** fotografarConjuntoPistas(const ConjuntoPistas* conjunto, long* total);
+
+/**
+ * @brief Exibe as pistas do conjunto em ordem alfabética, como exibirPistas().
+ *
+ * @param conjunto Conjunto compartilhado.
+ */
+void exibirConjuntoPistas(const ConjuntoPistas* conjunto);
+
+/* ----------------- RCU e tabela de suspeitos concorrente ----------------- */
+
+/**
+ * @brief Inicia um domínio RCU sem leitores.
+ *
+ * @param dominio Domínio a iniciar.
+ */
+void iniciarDominioRCU(DominioRCU* dominio);
+
+/**
+ * @brief Abre uma seção de leitura (sem trava e sem espera: um incremento atômico).
+ *
+ * Tudo que for lido do domínio dentro da seção continua válido até
+ * sairLeituraRCU(). Seções podem ser aninhadas.
+ *
+ * @param dominio Domínio.
+ * @return Marca a devolver em sairLeituraRCU().
+ */
+int entrarLeituraRCU(DominioRCU* dominio);
+
+/**
+ * @brief Fecha a seção de leitura aberta por entrarLeituraRCU().
+ *
+ * @param dominio Domínio.
+ * @param marca Valor devolvido por entrarLeituraRCU().
+ */
+void sairLeituraRCU(DominioRCU* dominio, int marca);
+
+/**
+ * @brief Espera um período de graça: toda seção de leitura aberta antes da chamada termina.
+ *
+ * Só para quem escreve (uma chamada por vez); não pode ser chamada dentro de
+ * uma seção de leitura do mesmo domínio.
+ *
+ * @param dominio Domínio.
+ */
+void sincronizarRCU(DominioRCU* dominio);
+
+/**
+ * @brief Monta a tabela concorrente com as pistas do caso (ou vazia, se caso = NULL).
+ *
+ * @param tabela Tabela a iniciar.
+ * @param caso Caso com pistas cadastradas (pode ser NULL).
+ */
+void iniciarTabelaSuspeitosRCU(TabelaSuspeitosRCU* tabela, const Caso* caso);
+
+/**
+ * @brief Libera todas as versões. Nenhuma thread pode estar usando a tabela.
+ *
+ * @param tabela Tabela a liberar.
+ */
+void liberarTabelaSuspeitosRCU(TabelaSuspeitosRCU* tabela);
+
+/**
+ * @brief Liga (ou religa) uma pista a um suspeito, como inserirNaHash() numa tabela viva.
+ *
+ * Publica uma cópia do balde com a mudança (ou, se a carga passar de
+ * RCU_CARGA_MAXIMA, uma versão com o dobro de baldes) e libera o que saiu
+ * de circulação depois de sincronizarRCU(). Leitores nunca esperam por ela.
+ *
+ * @param tabela Tabela compartilhada.
+ * @param pista Texto da pista (chave).
+ * @param suspeito Nome do suspeito (valor).
+ * @return 1 se a pista é nova, 0 se só trocou o suspeito.
+ */
+int publicarSuspeitoRCU(TabelaSuspeitosRCU* tabela, const char* pista, const char* suspeito);
+
+/**
+ * @brief Retira uma pista da tabela viva (mesmo protocolo de publicarSuspeitoRCU()).
+ *
+ * @param tabela Tabela compartilhada.
+ * @param pista Texto da pista.
+ * @return 1 se a pista existia, 0 caso contrário.
+ */
+int removerPistaRCU(TabelaSuspeitosRCU* tabela, const char* pista);
+
+/**
+ * @brief Consulta o suspeito de uma pista, como encontrarSuspeito(), sem travar.
+ *
+ * O nome é copiado dentro da seção de leitura, então continua válido mesmo
+ * que a pista seja atualizada logo depois.
+ *
+ * @param tabela Tabela compartilhada.
+ * @param pista Texto da pista buscada.
+ * @param saida Buffer de MAX_NOME bytes para o nome.
+ * @return `saida`, com o nome do suspeito ou "Desconhecido".
+ */
+const char* encontrarSuspeitoRCU(TabelaSuspeitosRCU* tabela, const char* pista, char* saida);
+
+/* ----------------- Ancestral comum e distâncias (LCA) ----------------- */
+
+/**
+ * @brief Constrói a sparse table de LCA em O(n log n).
+ *
+ * @param indice Índice a preencher.
+ * @param caso Caso com as salas já numeradas (indexarSalas).
+ */
+void construirIndiceLCA(IndiceLCA* indice, const Caso* caso);
+
+/**
+ * @brief Libera a sparse table.
+ *
+ * @param indice Índice a liberar.
+ */
+void liberarIndiceLCA(IndiceLCA* indice);
+
+/**
+ * @brief Sala mais profunda em comum entre duas salas, em O(1).
+ *
+ * @param indice Índice construído.
+ * @param a ID da primeira sala.
+ * @param b ID da segunda sala.
+ * @return ID do ancestral comum mais profundo.
+ */
+int ancestralComum(const IndiceLCA* indice, int a, int b);
+
+/**
+ * @brief Distância (em passos) entre duas salas, em O(1).
+ *
+ * @param indice Índice construído.
+ * @param a ID da primeira sala.
+ * @param b ID da segunda sala.
+ * @return profundidade(a) + profundidade(b) - 2 * profundidade(LCA).
+ */
+int distanciaEntreSalas(const IndiceLCA* indice, int a, int b);
+
+/**
+ * @brief Responde um lote de consultas dividindo-o entre os trabalhadores do escalonador.
+ *
+ * O índice é somente leitura, então as tarefas não se coordenam: cada uma
+ * responde uma faixa contígua de `consultas`.
+ *
+ * @param indice Índice construído.
+ * @param consultas Vetor de consultas (ancestral/distancia são preenchidos).
+ * @param total Quantidade de consultas.
+ * @param threads 1 = tudo na thread chamadora; outro valor = escalonador global.
+ */
+void responderConsultasLCA(const IndiceLCA* indice, ConsultaLCA* consultas, long total, int threads);
+
+/**
+ * @brief Quantidade de núcleos disponíveis (1 se não for possível saber).
+ *
+ * @return Número de núcleos.
+ */
+int numeroDeNucleos(void);
+
+/* ----------------- Verificação final / utilitários ----------------- */
+
+/**
+ * @brief Conta, entre as pistas coletadas (BST), quantas apontam para um suspeito.
+ *
+ * Percorre a BST e, para cada pista, consulta a tabela hash para recuperar
+ * o suspeito associado — se coincidir com o nome passado, incrementa contador.
+ *
+ * @param tabela Tabela hash (pista→suspeito).
+ * @param raizPistas Raiz da BST com as pistas coletadas.
+ * @param suspeito Nome do suspeito a ser verificado.
+ * @return Quantidade de pistas coletadas que apontam para o suspeito.
+ */
+int contarPistasPorSuspeitoNaBST(SuspeitoNode* tabela[], PistaNode* raizPistas, const char* suspeito);
+
+/**
+ * @brief Avalia uma acusação contra as pistas coletadas, sem interação.
+ *
+ * Resolve o nome de forma aproximada, conta as evidências e registra o
+ * resultado em sessao->estadoAcusacao / sessao->acusado.
+ *
+ * @param caso Caso em andamento.
+ * @param sessao Sessão com as pistas coletadas.
+ * @param nome Nome digitado pelo jogador.
+ * @return Quantidade de pistas coletadas que apontam para o acusado.
+ */
+int avaliarAcusacao(Caso* caso, Sessao* sessao, const char* nome);
+
+/**
+ * @brief Fase de julgamento: solicita acusação e verifica evidências.
+ *
+ * Regras: acusação é considerada consistente se houver pelo menos
+ * PISTAS_PARA_CONDENAR pistas coletadas que apontem para o suspeito acusado. O nome digitado é casado
+ * de forma aproximada com os suspeitos cadastrados (resolverSuspeito).
+ * O resultado fica registrado na sessão (estadoAcusacao / acusado).
+ *
+ * @param caso Caso em andamento (tabela hash e suspeitos).
+ * @param sessao Sessão com as pistas coletadas.
+ * @param diario Diário onde a acusação é anexada (NULL = sem gravação).
+ */
+void verificarSuspeitoFinal(Caso* caso, Sessao* sessao, Diario* diario);
+
+/**
+ * @brief Limpa o buffer de entrada (stdin) para evitar lixo em leituras.
+ */
+void limparBufferEntrada(void);
+
+/**
+ * @brief Limpa o terminal (compatível Windows / Unix).
+ */
+void limparTela(void);
+
+/**
+ * @brief Relógio monotônico em milissegundos (origem arbitrária).
+ *
+ * @return Instante atual em ms.
+ */
+long long agoraMs(void);
+
+/**
+ * @brief Libera toda a memória da árvore de salas (mansão).
+ *
+ * Percorre recursivamente e libera cada nó (Sala).
+ *
+ * @param raiz Ponteiro para a raiz da árvore de salas.
+ */
+void liberarMansao(Sala* raiz);
+
+/* ----------------- Benchmarks (modo --bench) ----------------- */
+
+/**
+ * @brief Compara busca por prefixo na árvore radix contra varredura da BST.
+ *
+ * Gera `quantidade` pistas sintéticas, indexa nas duas estruturas e mede o
+ * tempo de uma bateria de prefixos: varredura completa estilo exibirPistas()
+ * com strncmp, iterador da BST a partir do limite inferior e árvore radix.
+ *
+ * @param quantidade Número de pistas sintéticas (ex.: 1000000).
+ */
+void benchPrefixos(long quantidade);
+
+/**
+ * @brief Mede a resolução de nomes digitados com erro na BK-tree de suspeitos.
+ *
+ * Registra `quantidade` suspeitos com nomes sintéticos, consulta nomes com um
+ * erro de digitação e confere a distância encontrada, numa amostra, contra a
+ * varredura de todos os suspeitos.
+ *
+ * @param quantidade Número de suspeitos (ex.: 50000).
+ * @return 1 se as distâncias conferem e o p99 ficou abaixo de META_BUSCA_SUSPEITO_NS, 0 caso contrário.
+ */
+int benchSuspeitos(long quantidade);
+
+/**
+ * @brief Mede o checkpoint em massa de sessões (serializar e desserializar).
+ *
+ * Cria `quantidade` sessões com posições e pistas aleatórias no caso
+ * informado e mede o custo médio por sessão de serializarSessao() e
+ * desserializarSessao().
+ *
+ * @param caso Caso usado nas sessões.
+ * @param quantidade Número de sessões (ex.: 100000).
+ */
+void benchSessoes(Caso* caso, long quantidade);
+
+/**
+ * @brief Mede o índice de LCA numa mansão aleatória enorme.
+ *
+ * Gera `quantidade` salas, mede a construção da sparse table e um lote de
+ * consultas com 1 trabalhador e com os do escalonador global (só se houver
+ * mais de um), conferindo as respostas entre si e, numa amostra, contra
+ * rotaEntreSalas().
+ *
+ * @param quantidade Número de salas (ex.: 1000000).
+ */
+void benchLCA(long quantidade);
+
+/**
+ * @brief Mede a montagem do CSR e uma busca em largura sobre ele.
+ *
+ * Gera uma mansão aleatória com `quantidade` salas e ~8 portas extras por
+ * sala e compara a BFS sobre o CSR com a mesma BFS sobre uma lista
+ * encadeada de portas alocadas uma a uma (representação por ponteiros).
+ *
+ * @param quantidade Número de salas (ex.: 1000000).
+ */
+void benchGrafo(long quantidade);
+
+/**
+ * @brief Mede o planejador de rotas numa mansão aleatória com corredores pesados.
+ *
+ * Compara BFS e Dijkstra de um lado só com as versões bidirecionais (e confere
+ * as respostas) e mede a montagem das tabelas de todas as alas pequenas.
+ *
+ * @param quantidade Número de salas (ex.: 1000000).
+ */
+void benchRotas(long quantidade);
+
+/**
+ * @brief Mede as dicas de evidência durante um passeio aleatório.
+ *
+ * Gera uma mansão com `quantidade` salas, portas extras e 6 suspeitos com
+ * 10 salas de pista cada; mede a montagem das tabelas (primeira dica) e o
+ * custo de cada dica depois disso, com a sala atual mudando a cada passo.
+ * Em seguida confere, em CASOS_CONFERENCIA_DICAS casos pequenos, o plano
+ * exato e o guloso contra uma BFS sobre (sala, pistas reunidas).
+ *
+ * @param quantidade Número de salas (ex.: 100000).
+ */
+void benchDicas(long quantidade);
+
+/**
+ * @brief Compara o caminhante escalar da simulação com o vetorial (AVX2).
+ *
+ * Gera um caso com 1000 salas, 5 suspeitos e 40 pistas e simula
+ * `quantidade` partidas do jogador aleatório numa thread, com e sem SIMD,
+ * mostrando a vazão e a maior diferença entre as taxas das duas versões.
+ *
+ * @param quantidade Número de partidas (ex.: 10000000).
+ */
+void benchSimd(long quantidade);
+
+/**
+ * @brief Mede o robô detetive contra o planejador exato em casos pequenos.
+ *
+ * Gera `quantidade` casos aleatórios (20-40 salas, 12 pistas, 3 suspeitos,
+ * portas extras), joga cada um com o robô (10 ms por jogada) e compara as
+ * portas gastas até a acusação confirmada com o ótimo de planejarEvidencias().
+ *
+ * @param quantidade Número de casos (ex.: 50).
+ */
+void benchMCTS(long quantidade);
+
+/**
+ * @brief Mede o escalonador (work stealing) com 1, N e mais trabalhadores que núcleos.
+ *
+ * Percorre com fork/join uma mansão aleatória de `quantidade` salas e uma
+ * BST de pistas, roda um laço paralelo de grão 1 (custo por tarefa), confere
+ * os resultados contra 1 trabalhador e imprime roubos e ociosidade.
+ *
+ * @param quantidade Número de salas (ex.: 1000000).
+ */
+void benchTarefas(long quantidade);
+
+/**
+ * @brief Mede o conjunto concorrente de pistas com 1 a 64 threads.
+ *
+ * Insere `quantidade` pistas (metade distintas, cada uma duas vezes, em
+ * ordem embaralhada) na skiplist sem travas e, para comparar, na BST AVL
+ * protegida por uma trava; depois busca todas na skiplist. Confere que cada
+ * pista foi inserida uma vez e que a foto do conjunto sai ordenada.
+ *
+ * @param quantidade Número de inserções (ex.: 200000).
+ */
+void benchConjunto(long quantidade);
+
+/**
+ * @brief Mede a tabela de suspeitos RCU com e sem um escritor concorrente.
+ *
+ * Com 1, N e mais trabalhadores que núcleos, faz `quantidade` consultas
+ * sobre 4096 pistas: sem escrita, com uma tarefa trocando suspeitos e
+ * incluindo/removendo pistas ao mesmo tempo e, para comparar, com as mesmas
+ * operações atrás de uma trava de leitura/escrita. Confere que toda
+ * resposta é válida e que o estado final reflete a última atualização.
+ *
+ * @param quantidade Número de consultas (ex.: 4000000).
+ */
+void benchRCU(long quantidade);
+
+/**
+ * @brief Mede sessões concorrentes com e sem recargas do caso no meio delas.
+ *
+ * Cada sessão fixa a versão atual, anda até SIMULACAO_MAX_PASSOS portas
+ * (cada passo cronometrado) e solta a versão; no segundo cenário uma tarefa
+ * publica 200 versões montadas em memória enquanto isso. No terceiro, a
+ * tarefa manda SIGHUP ao processo e a thread do catálogo relê, avalia e
+ * publica o arquivo (recarregarCaso) com as sessões ainda fixadas nas
+ * versões antigas. Mostra o passo médio e o p99, o custo de fixar e soltar
+ * e confere que nenhuma sessão viu a versão mudar, que toda releitura foi
+ * publicada e que toda versão publicada foi liberada.
+ *
+ * @param arquivo Caso relido no terceiro cenário (NULL = um caso gerado
+ *        válido, gravado num arquivo temporário).
+ * @param quantidade Número de sessões (ex.: 200000).
+ */
+void benchRecarga(const char* arquivo, long quantidade);
+
+/**
+ * @brief Mede a latência de cada comando com muitas sessões em paralelo.
+ *
+ * `quantidade` sessões rodam no escalonador do processo; cada uma faz
+ * LATENCIA_COMANDOS_POR_SESSAO comandos sorteados (mover, listar, buscar,
+ * rota e dica pelos planejadores do trabalhador) e termina gravando e
+ * acusando um suspeito. Tudo é cronometrado por registrarComando() e o
+ * resumo mostra p50/p99/p999/máximo, não médias.
+ *
+ * Sem caso, usa uma mansão sintética de LATENCIA_SALAS salas com
+ * LATENCIA_PISTAS pistas e portas extras, onde rota e dica custam o que
+ * custariam num caso grande (a mansão padrão tem 6 salas).
+ *
+ * @param caso Caso usado nas sessões (NULL = mansão sintética).
+ * @param quantidade Número de sessões (ex.: 20000).
+ */
+void benchLatencia(Caso* caso, long quantidade);
+
+/**
+ * @brief Gera uma mansão aleatória ("Sala 0", "Sala 1", ...) sem pistas.
+ *
+ * Cada sala nova é pendurada numa saída livre de uma sala anterior sorteada.
+ *
+ * @param quantidade Número de salas (>= 1).
+ * @param semente Estado do gerador pseudoaleatório (atualizado).
+ * @return Raiz (Sala 0).
+ */
+Sala* gerarMansaoAleatoria(long quantidade, unsigned long* semente);
+
+// ============================================================================
+//                                MAIN
+// ============================================================================
+
+/**
+ * @brief Ponto de entrada do programa.
+ *
+ * Constrói o mapa fixo da mansão (ou carrega um arquivo de caso), inicializa
+ * a tabela hash com associações pista→suspeito, conduz a exploração
+ * interativa, exibe pistas e realiza a fase final de acusação.
+ *
+ * Opções de linha de comando:
+ *  - `--diario <arquivo>`  anexa todos os comandos da partida ao diário
+ *  - `--replay <arquivo>`  reexecuta um diário sem interface e imprime o resumo
+ *  - `--simular [partidas]` estima as taxas de acusação por suspeito (Monte Carlo)
+ *  - `--robo [ms]`         o robô detetive (MCTS) joga o caso, com `ms` por jogada
+ *  - `--caso <arquivo>`    joga (ou simula, reproduz...) o caso do arquivo no lugar da mansão fixa
+ *  - `--avaliar`           com --caso, confere antes (avaliarCaso) que só um suspeito pode ser condenado
+ *  - `--gerar <facil|media|dificil> [candidatos]` gera casos com culpado único e grava os melhores
+ *  - `--processos [n]`     grava o caso em memória compartilhada e cria n processos que o usam
+ *  - `--cooperativo [detetives]` vários detetives investigam juntos, com um conjunto de pistas compartilhado
+ *  - `--estresse [sessoes]` sessões com cota de memória e o processo sem memória, sem derrubar as demais
+ *  - `--estatisticas <socket>` serve as latências por comando num socket Unix e as imprime no fim
+ *  - `--bench <prefixos|suspeitos|sessoes|lca|grafo|rotas|dicas|simd|mcts|tarefas|conjunto|rcu|recarga|latencia> [quantidade]`
+ */
+int main(int argc, char* argv[]) {
+    setlocale(LC_ALL, "Portuguese");
+
+    const char* bench = NULL;
+    const char* arquivoDiario = NULL;
+    const char* arquivoReplay = NULL;
+    long long simular = 0;
+    const char* arquivoCaso = NULL;
+    const char* gerar = NULL;
+    int robo = 0;
+    int cooperativo = 0;
+    int processos = 0;
+    int estresse = 0;
+    int avaliar = 0;
+    const char* socketEstatisticas = NULL;
+    long quantidade = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            bench = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') quantidade = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--diario") == 0 && i + 1 < argc) {
+            arquivoDiario = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            arquivoReplay = argv[++i];
+        } else if (strcmp(argv[i], "--caso") == 0 && i + 1 < argc) {
+            arquivoCaso = argv[++i];
+        } else if (strcmp(argv[i], "--avaliar") == 0) {
+            avaliar = 1;
+        } else if (strcmp(argv[i], "--gerar") == 0 && i + 1 < argc) {
+            gerar = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') quantidade = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--robo") == 0) {
+            robo = MCTS_TEMPO_PADRAO_MS;
+            if (i + 1 < argc && argv[i + 1][0] != '-') robo = atoi(argv[++i]);
+            if (robo <= 0) robo = MCTS_TEMPO_PADRAO_MS;
+        } else if (strcmp(argv[i], "--processos") == 0) {
+            processos = numeroDeNucleos();
+            if (i + 1 < argc && argv[i + 1][0] != '-') processos = atoi(argv[++i]);
+            if (processos <= 0) processos = numeroDeNucleos();
+        } else if (strcmp(argv[i], "--estresse") == 0) {
+            estresse = ESTRESSE_SESSOES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') estresse = atoi(argv[++i]);
+            if (estresse <= 0) estresse = ESTRESSE_SESSOES;
+        } else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc) {
+            socketEstatisticas = argv[++i];
+        } else if (strcmp(argv[i], "--cooperativo") == 0) {
+            cooperativo = COOPERATIVO_DETETIVES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') cooperativo = atoi(argv[++i]);
+            if (cooperativo <= 0) cooperativo = COOPERATIVO_DETETIVES;
+        } else if (strcmp(argv[i], "--simular") == 0) {
+            simular = 1000000LL;
+            if (i + 1 < argc && argv[i + 1][0] != '-') simular = atoll(argv[++i]);
+            if (simular <= 0) simular = 1000000LL;
+        } else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (gerar) {
+        int faixa = strcmp(gerar, "facil") == 0 ? FAIXA_FACIL
+                    : strcmp(gerar, "media") == 0 ? FAIXA_MEDIA
+                    : strcmp(gerar, "dificil") == 0 ? FAIXA_DIFICIL : -1;
+        if (faixa < 0) {
+            fprintf(stderr, "Faixa desconhecida: %s (use facil, media ou dificil)\n", gerar);
+            return EXIT_FAILURE;
+        }
+        return gerarCasos(faixa, quantidade > 0 ? quantidade : GERADOR_CANDIDATOS, GERADOR_SEMENTE) > 0
+               ? 0 : EXIT_FAILURE;
+    }
+    if (estresse) return executarEstresseMemoria(estresse) ? 0 : EXIT_FAILURE;
+    if (bench && strcmp(bench, "prefixos") == 0) {
+        benchPrefixos(quantidade > 0 ? quantidade : 1000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "suspeitos") == 0) {
+        return benchSuspeitos(quantidade > 0 ? quantidade : 50000L) ? 0 : EXIT_FAILURE;
+    }
+    if (bench && strcmp(bench, "lca") == 0) {
+        benchLCA(quantidade > 0 ? quantidade : 1000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "grafo") == 0) {
+        benchGrafo(quantidade > 0 ? quantidade : 1000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "rotas") == 0) {
+        benchRotas(quantidade > 0 ? quantidade : 1000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "dicas") == 0) {
+        benchDicas(quantidade > 0 ? quantidade : 100000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "simd") == 0) {
+        benchSimd(quantidade > 0 ? quantidade : 10000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "mcts") == 0) {
+        benchMCTS(quantidade > 0 ? quantidade : 50L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "tarefas") == 0) {
+        benchTarefas(quantidade > 0 ? quantidade : 1000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "conjunto") == 0) {
+        benchConjunto(quantidade > 0 ? quantidade : 200000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "rcu") == 0) {
+        benchRCU(quantidade > 0 ? quantidade : 4000000L);
+        return 0;
+    }
+    if (bench && strcmp(bench, "recarga") == 0) {
+        benchRecarga(arquivoCaso, quantidade > 0 ? quantidade : 200000L);
+        return 0;
+    }
+
+    /* -----------------------------
+     * Montagem do caso: mansão fixa ou arquivo de caso (--caso)
+     * ----------------------------- */
+    Caso caso;
+    AvaliacaoCaso avaliacao;
+    if (!arquivoCaso) montarCasoPadrao(&caso);
+    else if (!carregarCaso(&caso, arquivoCaso)) return EXIT_FAILURE;
+
+    int interativo = !bench && !arquivoReplay && !simular && !robo && !cooperativo && !processos;
+    if (interativo) {
+        limparTela();
+        printf("========================================================\n");
+        printf("  DETECTIVE QUEST - NÍVEL MESTRE (Investigaçã o Final)\n");
+        printf("========================================================\n\n");
+    }
+
+    /* Opcional: o resolvedor exaustivo custa salas x 2^pistas por suspeito (limitado a RESOLVEDOR_MAX_ESTADOS) */
+    int avaliado = arquivoCaso && avaliar ? avaliarCaso(&caso, &avaliacao) : 1;
+    if (avaliado < 0)
+        printf("Aviso: memória insuficiente para avaliar o caso '%s'.\n\n", arquivoCaso);
+    else if (!avaliado)
+        printf("Aviso: no caso '%s', %d suspeito(s) podem ser condenados (o esperado é 1).\n\n",
+               arquivoCaso, avaliacao.condenaveis);
+
+    /* Latências por comando consultáveis durante a execução (ex.: nc -U <socket>) */
+    ServidorEstatisticas estatisticas;
+    estatisticas.descritor = -1;
+    if (socketEstatisticas && abrirSocketEstatisticas(&estatisticas, socketEstatisticas) && interativo)
+        printf("(Latências por comando disponíveis em '%s'.)\n\n", socketEstatisticas);
+
+    if (!interativo) {
+        int ok = 1;
+        if (arquivoReplay) ok = reproduzirDiario(&caso, arquivoReplay) >= 0;
+        else if (simular) executarSimulacao(&caso, simular);
+        else if (cooperativo) ok = executarCooperativo(&caso, cooperativo) >= 0;
+        else if (processos) ok = executarProcessos(&caso, processos);
+        else if (robo) {
+            OpcoesMCTS opcoes;
+            opcoesMCTSPadrao(&opcoes);
+            opcoes.tempoMs = robo;
+            jogarComRobo(&caso, &opcoes, 1, NULL);
+        }
+        else if (strcmp(bench, "sessoes") == 0) benchSessoes(&caso, quantidade > 0 ? quantidade : 100000L);
+        else if (strcmp(bench, "latencia") == 0)
+            benchLatencia(arquivoCaso ? &caso : NULL, quantidade > 0 ? quantidade : 20000L);
+        else {
+            fprintf(stderr, "Benchmark desconhecido: %s\n", bench);
+            ok = 0;
+        }
+        if (socketEstatisticas && !(bench && strcmp(bench, "latencia") == 0)) {
+            printf("\nLatências por comando:\n");
+            escreverEstatisticas(stdout);
+        }
+        fecharSocketEstatisticas(&estatisticas);
+        liberarCaso(&caso);
+        return ok ? 0 : EXIT_FAILURE;
+    }
+
+    /* -----------------------------
+     * Catálogo: a partida fixa a versão atual do caso. A recarga por SIGHUP
+     * (ativarRecargaPorSinal, exercitada em --bench recarga) não é ligada
+     * aqui: o processo joga uma única partida, que nunca veria a versão nova,
+     * e o SIGHUP deve continuar encerrando o jogo quando o terminal é fechado
+     * ----------------------------- */
+    CatalogoCasos catalogo;
+    if (!iniciarCatalogoCasos(&catalogo, &caso, arquivoCaso)) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a versão do caso\n");
+        fecharSocketEstatisticas(&estatisticas);
+        liberarCaso(&caso);
+        return EXIT_FAILURE;
+    }
+    VersaoCaso* versao = fixarCaso(&catalogo);
+    Caso* ativo = &versao->caso;
+
+    /* -----------------------------
+     * Sessão do jogador (nova ou retomada do arquivo salvo); a reserva
+     * socorre a sessão se o processo ficar sem memória no meio de um comando
+     * ----------------------------- */
+    ReservaMemoria reserva;
+    iniciarReservaMemoria(&reserva, RESERVA_BLOCOS);
+    Sessao sessao;
+    if (iniciarSessaoComCota(&sessao, ativo, COTA_ILIMITADA, &reserva) != SESSAO_OK) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Sessao salva;
+    int status = iniciarSessao(&salva, ativo);
+    if (status == SESSAO_OK) status = carregarSessao(ativo, &salva, ARQUIVO_SESSAO);
+    if (status == SESSAO_OK && salva.estadoAcusacao == ACUSACAO_PENDENTE) {
+        char resposta;
+        printf("Há uma investigação salva em '%s' (%d pista(s)). Retomar? (s/n) ",
+               salva.atual->nome, tamanhoPistas(salva.pistas));
+        /* A sessão não pode trocar de endereço (os blocos apontam a cota): relê o arquivo nela */
+        if (scanf(" %c", &resposta) == 1 && (resposta == 's' || resposta == 'S')
+            && (status = carregarSessao(ativo, &sessao, ARQUIVO_SESSAO)) != SESSAO_OK)
+            printf("Aviso: não foi possível retomar a investigação (código %d).\n", status);
+        limparBufferEntrada();
+    } else if (status != SESSAO_OK && status != SESSAO_ERRO_ARQUIVO) {
+        printf("Aviso: arquivo salvo ignorado (código %d).\n", status);
+    }
+    liberarSessao(&salva);
+
+    /* -----------------------------
+     * Exploração interativa (coleta automática de pistas)
+     * ----------------------------- */
+    Diario diario;
+    Diario* pDiario = NULL;
+    if (arquivoDiario) {
+        if (abrirDiario(&diario, arquivoDiario, ativo, &sessao)) pDiario = &diario;
+        else fprintf(stderr, "Aviso: não foi possível abrir o diário '%s'.\n", arquivoDiario);
+    }
+    explorarMansao(ativo, &sessao, pDiario);
+
+    /* -----------------------------
+     * Exibe pistas coletadas (ordenadas)
+     * ----------------------------- */
+    limparTela();
+    printf("========================================================\n");
+    printf("               PISTAS COLETADAS (ORDENADAS)\n");
+    printf("========================================================\n\n");
+    exibirPistas(sessao.pistas);
+    printf("\nTotal: %d pista(s) coletada(s).\n", tamanhoPistas(sessao.pistas));
+
+    /* -----------------------------
+     * Fase final: acusação e veredito
+     * ----------------------------- */
+    verificarSuspeitoFinal(ativo, &sessao, pDiario);
+    if (pDiario) fecharDiario(pDiario);
+
+    /* Investigação concluída: o arquivo salvo passa a registrar o veredito */
+    if (sessao.estadoAcusacao != ACUSACAO_PENDENTE) salvarSessao(ativo, &sessao, ARQUIVO_SESSAO);
+
+    /* -----------------------------
+     * Limpeza de memória
+     * ----------------------------- */
+    liberarSessao(&sessao);
+    liberarReservaMemoria(&reserva);
+    soltarCaso(versao);
+    encerrarCatalogoCasos(&catalogo);
+    if (socketEstatisticas) {
+        printf("\nLatências por comando:\n");
+        escreverEstatisticas(stdout);
+    }
+    fecharSocketEstatisticas(&estatisticas);
+
+    printf("\nInvestigação finalizada. Obrigado por jogar Detective Quest!\n");
+    return 0;
+}
+
+// ============================================================================
+//                       IMPLEMENTAÇÃO DAS FUNÇÕES
+// ============================================================================
+
+Sala* criarSala(const char* nome, const char* pista) {
+    /* Alocação e verificação */
+    Sala* s = (Sala*) malloc(sizeof(Sala));
+    if (!s) {
+        fprintf(stderr, "Erro: falha na alocação de memória para Sala '%s'\n", nome);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Copia segura dos textos (assegurando terminação) */
+    strncpy(s->nome, nome, MAX_NOME - 1);
+    s->nome[MAX_NOME - 1] = '\0';
+
+    if (pista && pista[0] != '\0') {
+        strncpy(s->pista, pista, MAX_PISTA - 1);
+        s->pista[MAX_PISTA - 1] = '\0';
+    } else {
+        s->pista[0] = '\0';
+    }
+
+    s->id = -1;
+    s->esquerda = s->direita = s->pai = NULL;
+    s->profundidade = 0;
+    s->rota = 0;
+    s->tamanhoAla = 1;
+    return s;
+}
+
+/* Movimento recusado porque a pista não coube na cota: avisa e espera ENTER */
+static int avisarSemMemoria(int resultado) {
+    if (resultado != SESSAO_ERRO_MEMORIA) return 0;
+    printf("Memória da investigação esgotada: a pista da próxima sala não pôde ser anotada e você parou antes dela.\n");
+    printf("Pressione ENTER para continuar...");
+    limparBufferEntrada();
+    return 1;
+}
+
+void explorarMansao(Caso* caso, Sessao* sessao, Diario* diario) {
+    Sala* atual = sessao->atual;
+    PistaNode** raizPistas = &sessao->pistas;
+    char opcao;
+    char prefixo[MAX_PISTA];
+    PlanejadorRotas planejador;
+    PlanejadorEvidencias evidencias;
+    RoboDetetive robo;
+
+    memset(&robo, 0, sizeof(robo));   /* o oráculo aloca o robô na primeira consulta */
+    /* Coleta automática da sala inicial (as demais são coletadas ao mover) */
+    if (atual) entrarNaSala(caso, sessao, atual);
+    iniciarPlanejador(&planejador, caso);
+    iniciarPlanejadorEvidencias(&evidencias, caso, &planejador);
+
+    while (atual != NULL) {
+        limparTela();
+        printf("--------------------------------------------------------\n");
+        printf("Local: %s\n", atual->nome);
+        printf("--------------------------------------------------------\n");
+
+        if (atual->pista[0] != '\0') {
+            printf("Pista encontrada: \"%s\"\n", atual->pista);
+        } else {
+            printf("Nenhuma pista encontrada aqui.\n");
+        }
+
+        /* Portas da sala (CSR) apresentadas ao jogador */
+        printf("\nPortas:\n");
+        for (int p = 0; p < portasDaSala(caso, atual); ++p)
+            printf(" (%d) %s -> %s\n", p + 1, rotuloDaPorta(caso, atual, p), destinoDaPorta(caso, atual, p)->nome);
+        printf("\nOutras ações:\n");
+        printf(" (u) Ir ao último ramo inexplorado\n");
+        printf(" (r) Mostrar rota até uma sala\n");
+        printf(" (i) Ir até uma sala\n");
+        printf(" (a) Resumo desta ala\n");
+        printf(" (c) Dica: menor caminho até condenar um suspeito\n");
+        printf(" (o) Oráculo: jogada sugerida pelo robô detetive\n");
+        printf(" (p) Listar pistas coletadas (próxima página)\n");
+        printf(" (b) Buscar pistas por prefixo\n");
+        printf(" (f) Procurar pistas por palavras\n");
+        printf(" (g) Gravar investigação\n");
+        printf(" (s) Encerrar investigação\n");
+        printf("\n> ");
+        if (scanf(" %c", &opcao) != 1) opcao = 's';   /* fim da entrada encerra */
+        int porta = -1;
+        if (opcao >= '0' && opcao <= '9') {           /* número de porta (um ou mais dígitos) */
+            ungetc(opcao, stdin);
+            if (scanf("%d", &porta) == 1) porta--;
+        }
+        limparBufferEntrada();
+        long long inicio = inicioComando();   /* só o trabalho do comando, sem a digitação */
+
+        if (opcao >= '0' && opcao <= '9') {
+            registrarPortaNoDiario(diario, porta);
+            int r = atravessarPorta(caso, sessao, porta);
+            registrarComando(COMANDO_MOVER, inicio);
+            if (r > 0) atual = sessao->atual;
+            else if (!avisarSemMemoria(r)) {
+                printf("Porta inexistente! Pressione ENTER para continuar...");
+                limparBufferEntrada();
+            }
+        } else if (opcao == 'e' || opcao == 'E') {
+            registrarNoDiario(diario, DIARIO_ESQUERDA, NULL);
+            int r = moverSessao(caso, sessao, 'e');
+            registrarComando(COMANDO_MOVER, inicio);
+            if (r > 0) atual = sessao->atual;
+            else if (!avisarSemMemoria(r)) {
+                printf("Caminho inexistente à esquerda! Pressione ENTER para continuar...");
+                limparBufferEntrada();
+            }
+        } else if (opcao == 'd' || opcao == 'D') {
+            registrarNoDiario(diario, DIARIO_DIREITA, NULL);
+            int r = moverSessao(caso, sessao, 'd');
+            registrarComando(COMANDO_MOVER, inicio);
+            if (r > 0) atual = sessao->atual;
+            else if (!avisarSemMemoria(r)) {
+                printf("Caminho inexistente à direita! Pressione ENTER para continuar...");
+                limparBufferEntrada();
+            }
+        } else if (opcao == 'v' || opcao == 'V') {
+            registrarNoDiario(diario, DIARIO_VOLTAR, NULL);
+            int r = voltarSessao(caso, sessao);
+            registrarComando(COMANDO_MOVER, inicio);
+            if (r > 0) atual = sessao->atual;
+            else if (!avisarSemMemoria(r)) {
+                printf("Você já está no %s! Pressione ENTER para continuar...", atual->nome);
+                limparBufferEntrada();
+            }
+        } else if (opcao == 'u' || opcao == 'U') {
+            registrarNoDiario(diario, DIARIO_ULTIMO_RAMO, NULL);
+            int r = irUltimoRamo(caso, sessao);
+            registrarComando(COMANDO_MOVER, inicio);
+            if (r > 0) atual = sessao->atual;
+            else if (!avisarSemMemoria(r)) {
+                printf("Todos os cômodos já foram explorados! Pressione ENTER para continuar...");
+                limparBufferEntrada();
+            }
+        } else if (opcao == 'r' || opcao == 'R' || opcao == 'i' || opcao == 'I') {
+            int ir = opcao == 'i' || opcao == 'I';
+
+            printf("Sala: ");
+            if (fgets(prefixo, sizeof(prefixo), stdin) == NULL) break;
+            prefixo[strcspn(prefixo, "\n")] = '\0';
+            inicio = inicioComando();
+            registrarNoDiario(diario, ir ? DIARIO_IR_PARA : DIARIO_ROTA, prefixo);
+
+            int passos = ir ? irParaSala(caso, sessao, &planejador, prefixo)
+                            : exibirRota(caso, sessao, &planejador, prefixo);
+            registrarComando(ir ? COMANDO_MOVER : COMANDO_PLANEJAR, inicio);
+            if (passos == SESSAO_ERRO_MEMORIA) {
+                atual = sessao->atual;   /* parou no meio do caminho */
+                avisarSemMemoria(passos);
+            } else if (passos < 0) {
+                printf("Nenhuma rota até \"%s\". Pressione ENTER para continuar...", prefixo);
+                limparBufferEntrada();
+            } else if (ir) {
+                atual = sessao->atual;
+            } else {
+                printf("%d porta(s). Pressione ENTER para continuar...", passos);
+                limparBufferEntrada();
+            }
+        } else if (opcao == 'c' || opcao == 'C') {
+            printf("Suspeito (ENTER = todos): ");
+            if (fgets(prefixo, sizeof(prefixo), stdin) == NULL) break;
+            prefixo[strcspn(prefixo, "\n")] = '\0';
+            inicio = inicioComando();
+            registrarNoDiario(diario, DIARIO_DICA, prefixo);
+
+            exibirDica(caso, sessao, &evidencias, prefixo);
+            registrarComando(COMANDO_PLANEJAR, inicio);
+            printf("Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 'o' || opcao == 'O') {
+            registrarNoDiario(diario, DIARIO_ORACULO, NULL);
+            exibirOraculo(caso, sessao, &robo);
+            registrarComando(COMANDO_PLANEJAR, inicio);
+            printf("Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 'a' || opcao == 'A') {
+            registrarNoDiario(diario, DIARIO_ALA, NULL);
+            exibirResumoAla(caso, sessao);
+            registrarComando(COMANDO_PLANEJAR, inicio);
+            printf("Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 'p' || opcao == 'P') {
+            registrarNoDiario(diario, DIARIO_LISTAR, NULL);
+            /* Continua de onde a última página parou (pistas novas entram na ordem) */
+            retomarIteradorPistas(&sessao->listagem, *raizPistas);
+            printf("\nPistas coletadas:\n");
+            if (exibirProximasPistas(&sessao->listagem, PISTAS_POR_PAGINA) < PISTAS_POR_PAGINA) {
+                printf("(fim da lista)\n");
+                iniciarIteradorPistas(&sessao->listagem, NULL, NULL);
+            }
+            registrarComando(COMANDO_LISTAR, inicio);
+            printf("Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 'b' || opcao == 'B') {
+            const char* achadas[PISTAS_POR_PAGINA];
+            char completo[MAX_PISTA];
+
+            printf("Prefixo: ");
+            if (fgets(prefixo, sizeof(prefixo), stdin) == NULL) break;
+            prefixo[strcspn(prefixo, "\n")] = '\0';
+            inicio = inicioComando();
+            registrarNoDiario(diario, DIARIO_PREFIXO, prefixo);
+
+            if (completarPrefixo(caso->prefixos, prefixo, completo, sizeof(completo))) {
+                printf("\nAutocompletar: \"%s\"\n", completo);
+                int n = listarPorPrefixo(caso->prefixos, prefixo, achadas, PISTAS_POR_PAGINA);
+                for (int i = 0; i < n; ++i)
+                    printf(" %s %s\n", pistaColetada(*raizPistas, achadas[i]) ? "[x]" : "[ ]", achadas[i]);
+                printf("\nColetadas com esse prefixo:\n");
+                if (exibirPistasComPrefixo(*raizPistas, prefixo) == 0) printf("(nenhuma)\n");
+            } else {
+                printf("\nNenhuma pista conhecida começa com \"%s\".\n", prefixo);
+            }
+            registrarComando(COMANDO_BUSCAR, inicio);
+            printf("Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 'f' || opcao == 'F') {
+            int ids[PISTAS_POR_PAGINA];
+
+            printf("Palavras: ");
+            if (fgets(prefixo, sizeof(prefixo), stdin) == NULL) break;
+            prefixo[strcspn(prefixo, "\n")] = '\0';
+            inicio = inicioComando();
+            registrarNoDiario(diario, DIARIO_PALAVRAS, prefixo);
+
+            int n = buscarPorPalavras(caso->palavras, prefixo, ids, PISTAS_POR_PAGINA);
+            printf("\n");
+            for (int i = 0; i < n; ++i) {
+                const char* texto = caso->pistasPorId[ids[i]]->pista;
+                printf(" %s %s\n", pistaColetada(*raizPistas, texto) ? "[x]" : "[ ]", texto);
+            }
+            if (n == SESSAO_ERRO_MEMORIA) printf("Sem memória para esta busca agora.\n");
+            else if (n == 0) printf("Nenhuma pista contém todas essas palavras.\n");
+            registrarComando(COMANDO_BUSCAR, inicio);
+            printf("Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 'g' || opcao == 'G') {
+            registrarNoDiario(diario, DIARIO_GRAVAR, NULL);
+            int gravou = salvarSessao(caso, sessao, ARQUIVO_SESSAO) == SESSAO_OK;
+            registrarComando(COMANDO_GRAVAR, inicio);
+            if (gravou)
+                printf("Investigação gravada em %s.", ARQUIVO_SESSAO);
+            else
+                printf("Não foi possível gravar a investigação.");
+            printf(" Pressione ENTER para continuar...");
+            limparBufferEntrada();
+        } else if (opcao == 's' || opcao == 'S') {
+            registrarNoDiario(diario, DIARIO_SAIR, NULL);
+            printf("\nEncerrando exploração...\n");
+            break;
+        } else {
+            char tecla[2] = { opcao, '\0' };
+            registrarNoDiario(diario, DIARIO_INVALIDO, tecla);
+            printf("Opção inválida! Pressione ENTER para tentar novamente...");
+            limparBufferEntrada();
+        }
+    }
+    liberarRoboDetetive(&robo);
+    liberarPlanejadorEvidencias(&evidencias);
+    liberarPlanejador(&planejador);
+}
+
+int atravessarPorta(Caso* caso, Sessao* sessao, int porta) {
+    if (porta < 0 || porta >= portasDaSala(caso, sessao->atual)) return 0;
+
+    int r = entrarNaSala(caso, sessao, destinoDaPorta(caso, sessao->atual, porta));
+    return r < 0 ? r : 1;
+}
+
+int moverSessao(Caso* caso, Sessao* sessao, char direcao) {
+    Sala* destino = direcao == 'e' ? sessao->atual->esquerda : sessao->atual->direita;
+    if (!destino) return 0;
+
+    int r = entrarNaSala(caso, sessao, destino);
+    return r < 0 ? r : 1;
+}
+
+int entrarNaSala(Caso* caso, Sessao* sessao, Sala* sala) {
+    unsigned char bit = (unsigned char)(1u << (sala->id & 7));
+
+    if (sessao->visitadas[sala->id >> 3] & bit) {
+        sessao->atual = sala;
+        return 0;
+    }
+
+    /* A coleta é o único passo que aloca: vem primeiro, para falhar sem efeito */
+    if (sala->pista[0] != '\0') {
+        int coletada = coletarPista(caso, sessao, sala->pista);
+        if (coletada < 0) return coletada;
+        SuspeitoNode* no = buscarNaHash(caso->tabela, sala->pista);
+        if (no) marcarVisitaNasAlas(&sessao->alas, sala->id, no->idSuspeito);
+    }
+    sessao->atual = sala;
+    sessao->visitadas[sala->id >> 3] |= bit;
+    sessao->ramos[sessao->totalRamos++] = sala->id;
+    return 1;
+}
+
+int voltarSessao(Caso* caso, Sessao* sessao) {
+    if (!sessao->atual->pai) return 0;
+
+    int r = entrarNaSala(caso, sessao, sessao->atual->pai);
+    return r < 0 ? r : 1;
+}
+
+/* Primeira porta da sala que leva a uma sala ainda não visitada, ou NULL */
+static Sala* saidaInexplorada(const Caso* caso, const Sessao* sessao, const Sala* sala) {
+    for (int p = caso->inicioPortas[sala->id]; p < caso->inicioPortas[sala->id + 1]; ++p) {
+        int destino = caso->destinoPortas[p];
+        if (!(sessao->visitadas[destino >> 3] & (1u << (destino & 7)))) return caso->salasPorId[destino];
+    }
+    return NULL;
+}
+
+int irUltimoRamo(Caso* caso, Sessao* sessao) {
+    while (sessao->totalRamos > 0) {
+        Sala* destino = saidaInexplorada(caso, sessao, caso->salasPorId[sessao->ramos[sessao->totalRamos - 1]]);
+        if (destino) {
+            int r = entrarNaSala(caso, sessao, destino);
+            return r < 0 ? r : 1;
+        }
+        sessao->totalRamos--;   /* sala esgotada: nunca mais terá saídas novas */
+    }
+    return 0;
+}
+
+int rotaEntreSalas(const Sala* origem, const Sala* destino, char* passos, int capacidade) {
+    int total = 0;
+
+    if (origem->profundidade <= 64 && destino->profundidade <= 64) {
+        /* Ancestral comum = maior prefixo de bits em comum das duas rotas */
+        int menor = origem->profundidade < destino->profundidade ? origem->profundidade : destino->profundidade;
+        uint64_t diferenca = origem->rota ^ destino->rota;
+        int comum = menor;
+        if (diferenca != 0) {
+#if defined(__GNUC__)
+            int primeiro = __builtin_ctzll(diferenca);
+#else
+            int primeiro = 0;
+            while (!((diferenca >> primeiro) & 1)) primeiro++;
+#endif
+            if (primeiro < comum) comum = primeiro;
+        }
+        if (origem->profundidade - comum + destino->profundidade - comum > capacidade) return -1;
+        for (int i = comum; i < origem->profundidade; ++i) passos[total++] = 'v';
+        for (int i = comum; i < destino->profundidade; ++i)
+            passos[total++] = ((destino->rota >> i) & 1) ? 'd' : 'e';
+        return total;
+    }
+
+    /* Mansões muito profundas: sobe pelos pais até as duas salas se encontrarem */
+    const Sala* a = origem;
+    const Sala* b = destino;
+    int descida = 0;
+    while (a != b) {
+        if (total + descida >= capacidade) return -1;
+        if (a->profundidade >= b->profundidade) {
+            passos[total++] = 'v';
+            a = a->pai;
+        } else {
+            passos[capacidade - 1 - descida++] = b->pai->esquerda == b ? 'e' : 'd';
+            b = b->pai;
+        }
+    }
+    /* A descida foi escrita de trás para frente no fim do buffer */
+    for (int i = 0; i < descida; ++i) passos[total + i] = passos[capacidade - descida + i];
+    return total + descida;
+}
+
+/* Porta mais barata da sala `origem` que leva a `destino` (índice local), ou -1 */
+static int portaMaisBarata(const Caso* caso, int origem, int destino) {
+    int melhor = -1;
+    for (int p = caso->inicioPortas[origem]; p < caso->inicioPortas[origem + 1]; ++p)
+        if (caso->destinoPortas[p] == destino
+            && (melhor < 0 || caso->custoPortas[p] < caso->custoPortas[caso->inicioPortas[origem] + melhor]))
+            melhor = p - caso->inicioPortas[origem];
+    return melhor;
+}
+
+/* Rota mais rápida da sala atual até `nome` (em *caminho, o vetor do planejador) */
+static int planejarAte(Caso* caso, const Sessao* sessao, PlanejadorRotas* planejador,
+                       const char* nome, int** caminho, long* custo) {
+    Sala* destino = buscarSala(caso, nome);
+    int portas = -1;
+
+    *caminho = planejador->caminho;
+    if (!destino) return -1;
+    *custo = rotaMaisRapida(planejador, sessao->atual->id, destino->id, *caminho, caso->totalSalas + 1, &portas);
+    if (*custo == SESSAO_ERRO_MEMORIA) return SESSAO_ERRO_MEMORIA;
+    return *custo < 0 ? -1 : portas;
+}
+
+int irParaSala(Caso* caso, Sessao* sessao, PlanejadorRotas* planejador, const char* nome) {
+    int* caminho;
+    long custo;
+    int total = planejarAte(caso, sessao, planejador, nome, &caminho, &custo);
+
+    for (int i = 0; i < total; ++i) {
+        int r = atravessarPorta(caso, sessao, portaMaisBarata(caso, caminho[i], caminho[i + 1]));
+        if (r < 0) {
+            total = r;
+            break;
+        }
+    }
+    return total;
+}
+
+int exibirRota(Caso* caso, const Sessao* sessao, PlanejadorRotas* planejador, const char* nome) {
+    int* caminho;
+    long custo;
+    int total = planejarAte(caso, sessao, planejador, nome, &caminho, &custo);
+
+    if (total >= 0) {
+        printf("%s", sessao->atual->nome);
+        for (int i = 0; i < total; ++i) {
+            Sala* u = caso->salasPorId[caminho[i]];
+            int porta = portaMaisBarata(caso, caminho[i], caminho[i + 1]);
+            printf(" -> [%s] %s", rotuloDaPorta(caso, u, porta), destinoDaPorta(caso, u, porta)->nome);
+        }
+        printf("\nCusto total: %ld\n", custo);
+    }
+    return total;
+}
+
+/* ----------------- Resumo por ala (Fenwick sobre a pré-ordem) ----------------- */
+
+/* Constrói a árvore de Fenwick em O(n) a partir dos valores pontuais */
+static void acumularFenwick(int* arvore, int n) {
+    for (int i = 1; i <= n; ++i) {
+        int pai = i + (i & -i);
+        if (pai <= n) arvore[pai] += arvore[i];
+    }
+}
+
+static void somarFenwick(int* arvore, int n, int posicao, int delta) {
+    for (int i = posicao; i <= n; i += i & -i) arvore[i] += delta;
+}
+
+/* Soma das posições 1..posicao */
+static int prefixoFenwick(const int* arvore, int posicao) {
+    int soma = 0;
+    for (int i = posicao; i > 0; i -= i & -i) soma += arvore[i];
+    return soma;
+}
+
+static int* alocarFenwick(CotaMemoria* cota, int n) {
+    return (int*) alocarNaCota(cota, (size_t)n + 1, sizeof(int));
+}
+
+/* Suspeito apontado pela pista da sala, ou -1 */
+static int suspeitoDaSala(const Caso* caso, const Sala* sala) {
+    if (sala->pista[0] == '\0') return -1;
+    SuspeitoNode* no = buscarNaHash((SuspeitoNode**) caso->tabela, sala->pista);
+    return no ? no->idSuspeito : -1;
+}
+
+static void liberarTotaisAlas(TotaisAlas* totais) {
+    if (!totais) return;
+    for (int s = 0; s < totais->totalSuspeitos && totais->porSuspeito; ++s) free(totais->porSuspeito[s]);
+    free(totais->porSuspeito);
+    free(totais->total);
+    free(totais);
+}
+
+static TotaisAlas* montarTotaisAlas(const Caso* caso) {
+    int n = caso->totalSalas;
+    TotaisAlas* totais = (TotaisAlas*) calloc(1, sizeof(TotaisAlas));
+    if (!totais) return NULL;
+
+    totais->totalSalas = n;
+    totais->totalSuspeitos = caso->totalSuspeitos;
+    totais->porSuspeito = (int**) calloc((size_t)caso->totalSuspeitos + 1, sizeof(int*));
+    totais->total = (int*) calloc((size_t)n + 1, sizeof(int));
+    int faltou = !totais->porSuspeito || !totais->total;
+    for (int s = 0; s < totais->totalSuspeitos && !faltou; ++s)
+        faltou = !(totais->porSuspeito[s] = (int*) calloc((size_t)n + 1, sizeof(int)));
+    if (faltou) {
+        liberarTotaisAlas(totais);
+        return NULL;
+    }
+
+    /* Valores pontuais; depois cada nó repassa a soma ao pai */
+    for (int id = 0; id < n; ++id) {
+        int suspeito = suspeitoDaSala(caso, caso->salasPorId[id]);
+        if (suspeito < 0 || suspeito >= totais->totalSuspeitos) continue;
+        totais->porSuspeito[suspeito][id + 1] = 1;
+        totais->total[id + 1] = 1;
+    }
+    for (int s = 0; s < totais->totalSuspeitos; ++s) acumularFenwick(totais->porSuspeito[s], n);
+    acumularFenwick(totais->total, n);
+    return totais;
+}
+
+/* Totais do caso; a primeira sessão monta e publica (corridas: quem perde descarta a sua) */
+static const TotaisAlas* totaisDasAlas(const Caso* caso) {
+    _Atomic(TotaisAlas*)* publicados = (_Atomic(TotaisAlas*)*) &caso->totaisAlas;
+    TotaisAlas* totais = atomic_load_explicit(publicados, memory_order_acquire);
+    if (totais) return totais;
+
+    TotaisAlas* novos = montarTotaisAlas(caso);
+    if (!novos) return NULL;
+    if (!atomic_compare_exchange_strong_explicit(publicados, &totais, novos,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        liberarTotaisAlas(novos);
+        return totais;
+    }
+    return novos;
+}
+
+int construirAlas(ContagemAlas* alas, const Caso* caso, const unsigned char* visitadas) {
+    int n = caso->totalSalas;
+    const TotaisAlas* totais = totaisDasAlas(caso);
+
+    if (!totais) {
+        if (alas->encontradasTotal) liberarAlas(alas);
+        return SESSAO_ERRO_MEMORIA;
+    }
+    if (alas->encontradasTotal && alas->totalSalas == n && alas->totalSuspeitos == caso->totalSuspeitos) {
+        /* Mesmo caso (sessão restaurada): reaproveita os vetores */
+        if (alas->marcadas > 0) {
+            for (int s = 0; s < alas->totalSuspeitos; ++s)
+                memset(alas->encontradas[s], 0, sizeof(int) * ((size_t)n + 1));
+            memset(alas->encontradasTotal, 0, sizeof(int) * ((size_t)n + 1));
+        }
+    } else {
+        if (alas->encontradasTotal) liberarAlas(alas);
+        alas->totalSalas = n;
+        alas->totalSuspeitos = caso->totalSuspeitos;
+        alas->encontradas = (int**) alocarNaCota(alas->cota, (size_t)alas->totalSuspeitos + 1, sizeof(int*));
+        int faltou = !alas->encontradas;
+        for (int s = 0; s < alas->totalSuspeitos && !faltou; ++s)
+            faltou = !(alas->encontradas[s] = alocarFenwick(alas->cota, n));
+        if (!faltou) alas->encontradasTotal = alocarFenwick(alas->cota, n);
+        if (faltou || !alas->encontradasTotal) {
+            liberarAlas(alas);
+            return SESSAO_ERRO_MEMORIA;
+        }
+    }
+    alas->totais = totais;
+    alas->marcadas = 0;
+
+    /* Só as salas visitadas (bytes zerados do bitset são pulados de 8 em 8) */
+    for (int byte = 0; byte < (n + 7) / 8; ++byte) {
+        if (!visitadas[byte]) continue;
+        for (int id = byte * 8; id < byte * 8 + 8 && id < n; ++id)
+            if (visitadas[byte] & (1u << (id & 7)))
+                marcarVisitaNasAlas(alas, id, suspeitoDaSala(caso, caso->salasPorId[id]));
+    }
+    return SESSAO_OK;
+}
+
+void liberarAlas(ContagemAlas* alas) {
+    for (int s = 0; s < alas->totalSuspeitos && alas->encontradas; ++s) liberarDaCota(alas->encontradas[s]);
+    liberarDaCota(alas->encontradas);
+    liberarDaCota(alas->encontradasTotal);
+    alas->encontradas = NULL;
+    alas->encontradasTotal = NULL;
+    alas->totais = NULL;
+    alas->totalSuspeitos = alas->totalSalas = alas->marcadas = 0;
+}
+
+void marcarVisitaNasAlas(ContagemAlas* alas, int idSala, int idSuspeito) {
+    if (idSuspeito < 0 || idSuspeito >= alas->totalSuspeitos) return;
+
+    somarFenwick(alas->encontradas[idSuspeito], alas->totalSalas, idSala + 1, 1);
+    somarFenwick(alas->encontradasTotal, alas->totalSalas, idSala + 1, 1);
+    alas->marcadas++;
+}
+
+int somarNaAla(const int* arvore, const Sala* ala) {
+    return prefixoFenwick(arvore, ala->id + ala->tamanhoAla) - prefixoFenwick(arvore, ala->id);
+}
+
+int listarPendentesNaAla(const Caso* caso, const ContagemAlas* alas, const Sala* ala, Sala** saida, int maximo) {
+    /* Fenwick é linear: a árvore das pendentes é totais - encontradas, nó a nó */
+    const int* totais = alas->totais->total;
+    const int* encontradas = alas->encontradasTotal;
+    int n = alas->totalSalas;
+    int fim = ala->id + ala->tamanhoAla;
+    int antes = prefixoFenwick(totais, ala->id) - prefixoFenwick(encontradas, ala->id);   /* pendentes antes da ala */
+    int maiorPasso = 1, total = 0;
+
+    while (maiorPasso * 2 <= n) maiorPasso *= 2;
+    while (total < maximo) {
+        /* Descida: maior posição cuja soma de prefixo ainda é <= antes */
+        int posicao = 0, resto = antes + 1;
+        for (int passo = maiorPasso; passo > 0; passo >>= 1)
+            if (posicao + passo <= n && totais[posicao + passo] - encontradas[posicao + passo] < resto) {
+                posicao += passo;
+                resto -= totais[posicao] - encontradas[posicao];
+            }
+        if (posicao >= fim) break;   /* a próxima pendente (ID = posicao) já está fora da ala */
+        saida[total++] = caso->salasPorId[posicao];
+        antes++;
+    }
+    return total;
+}
+
+void exibirResumoAla(const Caso* caso, const Sessao* sessao) {
+    const Sala* ala = sessao->atual;
+    Sala* pendentes[PISTAS_POR_PAGINA];
+
+    printf("\nAla de %s (%d sala(s)):\n", ala->nome, ala->tamanhoAla);
+    for (int s = 0; s < sessao->alas.totalSuspeitos; ++s) {
+        int achadas = somarNaAla(sessao->alas.encontradas[s], ala);
+        int faltam = somarNaAla(sessao->alas.totais->porSuspeito[s], ala) - achadas;
+        if (achadas + faltam > 0)
+            printf(" - %s: %d encontrada(s), %d pendente(s)\n", caso->suspeitosPorId[s]->nome, achadas, faltam);
+    }
+
+    int n = listarPendentesNaAla(caso, &sessao->alas, ala, pendentes, PISTAS_POR_PAGINA);
+    if (n == 0) {
+        printf("Nenhuma pista pendente nesta ala.\n");
+        return;
+    }
+    printf("Ainda há pistas em:");
+    for (int i = 0; i < n; ++i) printf("%s %s", i ? "," : "", pendentes[i]->nome);
+    int restantes = somarNaAla(sessao->alas.totais->total, ala) - somarNaAla(sessao->alas.encontradasTotal, ala) - n;
+    if (restantes > 0) printf(" (e mais %d)", restantes);
+    printf("\n");
+}
+
+PistaNode* inserirPista(PistaNode* raiz, const char* pista) {
+    int erro = SESSAO_OK;
+    raiz = inserirPistaNaCota(raiz, pista, NULL, &erro);
+    if (erro != SESSAO_OK) {
+        fprintf(stderr, "Erro: falha na alocação de memória para PistaNode\n");
+        exit(EXIT_FAILURE);
+    }
+    return raiz;
+}
+
+PistaNode* inserirPistaNaCota(PistaNode* raiz, const char* pista, CotaMemoria* cota, int* erro) {
+    if (pista == NULL || pista[0] == '\0') return raiz; /* nada a inserir */
+
+    if (raiz == NULL) {
+        PistaNode* novo = (PistaNode*) alocarNaCota(cota, 1, sizeof(PistaNode));
+        if (!novo) {
+            *erro = SESSAO_ERRO_MEMORIA;   /* o pai religa NULL: a árvore não muda */
+            return NULL;
+        }
+        strncpy(novo->pista, pista, MAX_PISTA - 1);
+        novo->pista[MAX_PISTA - 1] = '\0';
+        novo->altura = novo->tamanho = 1;
+        novo->esquerda = novo->direita = NULL;
+        return novo;
+    }
+
+    int cmp = strcmp(pista, raiz->pista);
+    if (cmp < 0) {
+        raiz->esquerda = inserirPistaNaCota(raiz->esquerda, pista, cota, erro);
+    } else if (cmp > 0) {
+        raiz->direita = inserirPistaNaCota(raiz->direita, pista, cota, erro);
+    } else {
+        /* duplicata: não insere novamente */
+        return raiz;
+    }
+
+    return balancearPista(raiz);
+}
+
+int tamanhoPistas(PistaNode* raiz) {
+    return raiz ? raiz->tamanho : 0;
+}
+
+void atualizarPistaNode(PistaNode* no) {
+    int he = no->esquerda ? no->esquerda->altura : 0;
+    int hd = no->direita ? no->direita->altura : 0;
+    no->altura = 1 + (he > hd ? he : hd);
+    no->tamanho = 1 + tamanhoPistas(no->esquerda) + tamanhoPistas(no->direita);
+}
+
+PistaNode* rotacionarDireita(PistaNode* no) {
+    PistaNode* nova = no->esquerda;
+    no->esquerda = nova->direita;
+    nova->direita = no;
+    atualizarPistaNode(no);
+    atualizarPistaNode(nova);
+    return nova;
+}
+
+PistaNode* rotacionarEsquerda(PistaNode* no) {
+    PistaNode* nova = no->direita;
+    no->direita = nova->esquerda;
+    nova->esquerda = no;
+    atualizarPistaNode(no);
+    atualizarPistaNode(nova);
+    return nova;
+}
+
+PistaNode* balancearPista(PistaNode* no) {
+    atualizarPistaNode(no);
+    int he = no->esquerda ? no->esquerda->altura : 0;
+    int hd = no->direita ? no->direita->altura : 0;
+
+    if (he - hd > 1) {
+        PistaNode* e = no->esquerda;
+        if ((e->direita ? e->direita->altura : 0) > (e->esquerda ? e->esquerda->altura : 0))
+            no->esquerda = rotacionarEsquerda(e);   /* caso esquerda-direita */
+        return rotacionarDireita(no);
+    }
+    if (hd - he > 1) {
+        PistaNode* d = no->direita;
+        if ((d->esquerda ? d->esquerda->altura : 0) > (d->direita ? d->direita->altura : 0))
+            no->direita = rotacionarDireita(d);     /* caso direita-esquerda */
+        return rotacionarEsquerda(no);
+    }
+    return no;
+}
+
+int posicaoPista(PistaNode* raiz, const char* pista) {
+    int menores = 0;
+    while (raiz) {
+        if (strcmp(pista, raiz->pista) <= 0) {
+            raiz = raiz->esquerda;
+        } else {
+            menores += tamanhoPistas(raiz->esquerda) + 1;
+            raiz = raiz->direita;
+        }
+    }
+    return menores;
+}
+
+const char* selecionarPista(PistaNode* raiz, int k) {
+    if (k < 1 || k > tamanhoPistas(raiz)) return NULL;
+    while (raiz) {
+        int esq = tamanhoPistas(raiz->esquerda);
+        if (k <= esq) {
+            raiz = raiz->esquerda;
+        } else if (k == esq + 1) {
+            return raiz->pista;
+        } else {
+            k -= esq + 1;
+            raiz = raiz->direita;
+        }
+    }
+    return NULL;
+}
+
+int contarPistasNoIntervalo(PistaNode* raiz, const char* inicio, const char* fim) {
+    int ate = fim ? posicaoPista(raiz, fim) : tamanhoPistas(raiz);
+    int antes = inicio ? posicaoPista(raiz, inicio) : 0;
+    return ate > antes ? ate - antes : 0;
+}
+
+int exibirFaixaPistas(PistaNode* raiz, int inicio, int quantidade) {
+    if (!raiz || quantidade <= 0) return 0;
+
+    int esq = tamanhoPistas(raiz->esquerda);
+    int exibidas = 0;
+
+    /* Desce à esquerda só se a faixa começa dentro dela */
+    if (inicio < esq) exibidas += exibirFaixaPistas(raiz->esquerda, inicio, quantidade);
+
+    if (inicio <= esq && exibidas < quantidade) {
+        printf("- %s\n", raiz->pista);
+        exibidas++;
+    }
+
+    if (exibidas < quantidade) {
+        int inicioDir = inicio > esq ? inicio - esq - 1 : 0;
+        exibidas += exibirFaixaPistas(raiz->direita, inicioDir, quantidade - exibidas);
+    }
+    return exibidas;
+}
+
+int exibirPaginaPistas(PistaNode* raiz, int pagina, int porPagina) {
+    if (pagina < 1 || porPagina <= 0) return 0;
+    return exibirFaixaPistas(raiz, (pagina - 1) * porPagina, porPagina);
+}
+
+void exibirPistas(PistaNode* raiz) {
+    if (!raiz) return;
+    exibirPistas(raiz->esquerda);
+    printf("- %s\n", raiz->pista);
+    exibirPistas(raiz->direita);
+}
+
+void iniciarIteradorPistas(IteradorPistas* it, PistaNode* raiz, const char* inicio) {
+    it->topo = 0;
+    it->ultima[0] = '\0';
+    /* Um caractere além da maior pista: cortar o limite ali não muda quais pistas são >= ele */
+    snprintf(it->inicio, sizeof(it->inicio), "%s", inicio ? inicio : "");
+
+    /* Empilha os nós >= inicio no caminho de busca do limite inferior */
+    while (raiz) {
+        if (inicio == NULL || strcmp(raiz->pista, inicio) >= 0) {
+            it->pilha[it->topo++] = raiz;
+            raiz = raiz->esquerda;
+        } else {
+            raiz = raiz->direita;
+        }
+    }
+}
+
+void retomarIteradorPistas(IteradorPistas* it, PistaNode* raiz) {
+    if (it->ultima[0] == '\0') {
+        /* Nada entregue ainda: recomeça do limite inferior original */
+        char inicio[sizeof(it->inicio)];
+        memcpy(inicio, it->inicio, sizeof(inicio));
+        iniciarIteradorPistas(it, raiz, inicio);
+        return;
+    }
+
+    /* Mesmo caminho de iniciarIteradorPistas, mas estritamente após `ultima` */
+    it->topo = 0;
+    while (raiz) {
+        if (strcmp(raiz->pista, it->ultima) > 0) {
+            it->pilha[it->topo++] = raiz;
+            raiz = raiz->esquerda;
+        } else {
+            raiz = raiz->direita;
+        }
+    }
+}
+
+const char* proximaPista(IteradorPistas* it) {
+    if (it->topo == 0) return NULL;
+
+    PistaNode* no = it->pilha[--it->topo];
+    for (PistaNode* p = no->direita; p; p = p->esquerda)
+        it->pilha[it->topo++] = p;
+
+    strcpy(it->ultima, no->pista);
+    return no->pista;
+}
+
+int exibirProximasPistas(IteradorPistas* it, int porPagina) {
+    int exibidas = 0;
+    const char* pista;
+    while (exibidas < porPagina && (pista = proximaPista(it)) != NULL) {
+        printf("- %s\n", pista);
+        exibidas++;
+    }
+    return exibidas;
+}
+
+void liberarPistas(PistaNode* raiz) {
+    if (!raiz) return;
+    liberarPistas(raiz->esquerda);
+    liberarPistas(raiz->direita);
+    liberarDaCota(raiz);
+}
+
+/* ----------------- Tabela hash ----------------- */
+
+void inicializarHash(SuspeitoNode* tabela[]) {
+    for (int i = 0; i < TAM_HASH; ++i) tabela[i] = NULL;
+}
+
+int hash(const char* pista) {
+    unsigned int soma = 0;
+    for (const unsigned char* p = (const unsigned char*)pista; *p != '\0'; ++p)
+        soma += *p;
+    return (int)(soma % (unsigned int)TAM_HASH);
+}
+
+SuspeitoNode* inserirNaHash(SuspeitoNode* tabela[], const char* pista, const char* suspeito) {
+    if (!pista || !suspeito) return NULL;
+
+    int idx = hash(pista);
+    SuspeitoNode* novo = (SuspeitoNode*) malloc(sizeof(SuspeitoNode));
+    if (!novo) {
+        fprintf(stderr, "Erro: falha na alocação de memória para SuspeitoNode\n");
+        exit(EXIT_FAILURE);
+    }
+    strncpy(novo->pista, pista, MAX_PISTA - 1);
+    novo->pista[MAX_PISTA - 1] = '\0';
+    strncpy(novo->suspeito, suspeito, MAX_NOME - 1);
+    novo->suspeito[MAX_NOME - 1] = '\0';
+    novo->id = novo->idSuspeito = -1;
+
+    novo->prox = tabela[idx];
+    tabela[idx] = novo;
+    return novo;
+}
+
+SuspeitoNode* buscarNaHash(SuspeitoNode* tabela[], const char* pista) {
+    if (!pista) return NULL;
+    for (SuspeitoNode* cur = tabela[hash(pista)]; cur; cur = cur->prox)
+        if (strcmp(cur->pista, pista) == 0) return cur;
+    return NULL;
+}
+
+const char* encontrarSuspeito(SuspeitoNode* tabela[], const char* pista) {
+    if (!pista) return "Desconhecido";
+    int idx = hash(pista);
+    SuspeitoNode* cur = tabela[idx];
+    while (cur) {
+        if (strcmp(cur->pista, pista) == 0) return cur->suspeito;
+        cur = cur->prox;
+    }
+    return "Desconhecido";
+}
+
+void liberarHash(SuspeitoNode* tabela[]) {
+    for (int i = 0; i < TAM_HASH; ++i) {
+        SuspeitoNode* cur = tabela[i];
+        while (cur) {
+            SuspeitoNode* tmp = cur;
+            cur = cur->prox;
+            free(tmp);
+        }
+        tabela[i] = NULL;
+    }
+}
+
+/* ----------------- Índice de prefixos (árvore radix) ----------------- */
+
+NoRadix* criarNoRadix(const char* rotulo, int tam) {
+    NoRadix* no = (NoRadix*) malloc(sizeof(NoRadix));
+    char* copia = (char*) malloc((size_t)tam + 1);
+    if (!no || !copia) {
+        fprintf(stderr, "Erro: falha na alocação de memória para NoRadix\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copia, rotulo, (size_t)tam);
+    copia[tam] = '\0';
+
+    no->rotulo = copia;
+    no->tamRotulo = tam;
+    no->chave = NULL;
+    no->filho = no->irmao = NULL;
+    return no;
+}
+
+NoRadix* inserirNoRadix(NoRadix* raiz, const char* texto) {
+    if (texto == NULL || texto[0] == '\0') return raiz;
+    if (raiz == NULL) raiz = criarNoRadix("", 0);
+
+    NoRadix* no = raiz;
+    const char* resto = texto;
+
+    for (;;) {
+        if (*resto == '\0') {
+            if (!no->chave) {
+                no->chave = (char*) malloc(strlen(texto) + 1);
+                if (!no->chave) {
+                    fprintf(stderr, "Erro: falha na alocação de memória para NoRadix\n");
+                    exit(EXIT_FAILURE);
+                }
+                strcpy(no->chave, texto);
+            }
+            return raiz;
+        }
+
+        /* Procura o filho que começa com o mesmo byte (lista ordenada) */
+        NoRadix** elo = &no->filho;
+        while (*elo && (unsigned char)(*elo)->rotulo[0] < (unsigned char)*resto)
+            elo = &(*elo)->irmao;
+
+        NoRadix* f = *elo;
+        if (!f || f->rotulo[0] != *resto) {
+            /* Nenhuma aresta compartilha o byte: o restante vira uma folha */
+            NoRadix* folha = criarNoRadix(resto, (int)strlen(resto));
+            folha->irmao = f;
+            *elo = folha;
+            no = folha;
+            resto += folha->tamRotulo;
+            continue;
+        }
+
+        int i = 0;
+        while (i < f->tamRotulo && resto[i] != '\0' && f->rotulo[i] == resto[i]) i++;
+
+        if (i < f->tamRotulo) {
+            /* Divide a aresta: f passa a ser filho de um nó intermediário */
+            NoRadix* meio = criarNoRadix(f->rotulo, i);
+            meio->irmao = f->irmao;
+            meio->filho = f;
+            f->irmao = NULL;
+            memmove(f->rotulo, f->rotulo + i, (size_t)(f->tamRotulo - i) + 1);
+            f->tamRotulo -= i;
+            *elo = meio;
+            f = meio;
+        }
+
+        no = f;
+        resto += i;
+    }
+}
+
+NoRadix* buscarPrefixoRadix(NoRadix* raiz, const char* prefixo, int* consumidos) {
+    NoRadix* no = raiz;
+    const char* resto = prefixo;
+    int casados = 0;
+
+    while (no && *resto != '\0') {
+        NoRadix* f = no->filho;
+        while (f && f->rotulo[0] != *resto) f = f->irmao;
+        if (!f) return NULL;
+
+        int i = 0;
+        while (i < f->tamRotulo && resto[i] != '\0') {
+            if (f->rotulo[i] != resto[i]) return NULL;
+            i++;
+        }
+        no = f;
+        resto += i;
+        casados = i;
+    }
+
+    if (consumidos) *consumidos = casados;
+    return no;
+}
+
+/* Percurso pré-ordem: nó terminal antes dos filhos = ordem alfabética */
+static int coletarRadix(NoRadix* no, const char* saida[], int n, int max) {
+    for (; no && n < max; no = no->irmao) {
+        if (no->chave) saida[n++] = no->chave;
+        n = coletarRadix(no->filho, saida, n, max);
+    }
+    return n;
+}
+
+int listarPorPrefixo(NoRadix* raiz, const char* prefixo, const char* saida[], int max) {
+    NoRadix* no = buscarPrefixoRadix(raiz, prefixo, NULL);
+    if (!no || max <= 0) return 0;
+
+    int n = 0;
+    if (no->chave) saida[n++] = no->chave;
+    return coletarRadix(no->filho, saida, n, max);
+}
+
+int completarPrefixo(NoRadix* raiz, const char* prefixo, char* saida, size_t tam) {
+    int consumidos = 0;
+    NoRadix* no = buscarPrefixoRadix(raiz, prefixo, &consumidos);
+    if (!no || tam == 0) return 0;
+
+    size_t len = strlen(prefixo);
+    if (len >= tam) len = tam - 1;
+    memcpy(saida, prefixo, len);
+
+    /* Termina a aresta em que o prefixo parou e segue enquanto não houver escolha */
+    const char* resto = no->rotulo + consumidos;
+    for (;;) {
+        size_t n = strlen(resto);
+        if (len + n >= tam) n = tam - 1 - len;
+        memcpy(saida + len, resto, n);
+        len += n;
+
+        if (no->chave || !no->filho || no->filho->irmao) break;
+        no = no->filho;
+        resto = no->rotulo;
+    }
+    saida[len] = '\0';
+    return 1;
+}
+
+void liberarRadix(NoRadix* raiz) {
+    while (raiz) {
+        NoRadix* prox = raiz->irmao;
+        liberarRadix(raiz->filho);
+        free(raiz->rotulo);
+        free(raiz->chave);
+        free(raiz);
+        raiz = prox;
+    }
+}
+
+int exibirPistasComPrefixo(PistaNode* raiz, const char* prefixo) {
+    IteradorPistas it;
+    const char* pista;
+    size_t len = strlen(prefixo);
+    int exibidas = 0;
+
+    iniciarIteradorPistas(&it, raiz, prefixo);
+    while ((pista = proximaPista(&it)) != NULL && strncmp(pista, prefixo, len) == 0) {
+        printf("- %s\n", pista);
+        exibidas++;
+    }
+    return exibidas;
+}
+
+int pistaColetada(PistaNode* raiz, const char* pista) {
+    while (raiz) {
+        int cmp = strcmp(pista, raiz->pista);
+        if (cmp == 0) return 1;
+        raiz = cmp < 0 ? raiz->esquerda : raiz->direita;
+    }
+    return 0;
+}
+
+/* ----------------- Busca textual (índice invertido) ----------------- */
+
+char normalizarCaractere(const char** cursor) {
+    /* Letras de 0xC3 0x80 a 0xC3 0xBF (À..ÿ); ' ' marca símbolos como × e ÷ */
+    static const char latin1[] = "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+                                 "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+    const unsigned char* p = (const unsigned char*) *cursor;
+    unsigned char c = *p++;
+
+    if (c < 0x80) {
+        *cursor = (const char*) p;
+        if (c >= 'A' && c <= 'Z') return (char)(c - 'A' + 'a');
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) return (char)c;
+        return 0;
+    }
+
+    if (c == 0xC3 && *p >= 0x80 && *p <= 0xBF) {
+        char r = latin1[*p - 0x80];
+        *cursor = (const char*)(p + 1);
+        return r == ' ' ? 0 : r;
+    }
+
+    /* Outros caracteres multibyte: pula os bytes de continuação */
+    while ((*p & 0xC0) == 0x80) p++;
+    *cursor = (const char*) p;
+    return 0;
+}
+
+int proximaPalavra(const char** cursor, char* palavra) {
+    int len = 0;
+    char c = 0;
+
+    /* Pula separadores */
+    while (**cursor != '\0' && (c = normalizarCaractere(cursor)) == 0) { }
+    if (c == 0) return 0;
+
+    do {
+        if (len < MAX_PALAVRA - 1) palavra[len++] = c;
+    } while (**cursor != '\0' && (c = normalizarCaractere(cursor)) != 0);
+
+    palavra[len] = '\0';
+    return 1;
+}
+
+int hashPalavra(const char* palavra) {
+    unsigned long h = 5381;
+    for (const unsigned char* p = (const unsigned char*)palavra; *p != '\0'; ++p)
+        h = h * 33 + *p;
+    return (int)(h % TAM_INDICE_PALAVRAS);
+}
+
+Postagem* buscarPostagem(Postagem* indice[], const char* palavra) {
+    for (Postagem* cur = indice[hashPalavra(palavra)]; cur; cur = cur->prox)
+        if (strcmp(cur->palavra, palavra) == 0) return cur;
+    return NULL;
+}
+
+void indexarPalavras(Postagem* indice[], int id, const char* texto) {
+    char palavra[MAX_PALAVRA];
+    const char* cursor = texto;
+
+    while (proximaPalavra(&cursor, palavra)) {
+        Postagem* post = buscarPostagem(indice, palavra);
+        if (!post) {
+            int idx = hashPalavra(palavra);
+            post = (Postagem*) calloc(1, sizeof(Postagem));
+            if (!post) {
+                fprintf(stderr, "Erro: falha na alocação de memória para Postagem\n");
+                exit(EXIT_FAILURE);
+            }
+            strcpy(post->palavra, palavra);
+            post->prox = indice[idx];
+            indice[idx] = post;
+        }
+
+        /* Palavra repetida na mesma pista: já registrada */
+        if (post->total > 0 && post->ids[post->total - 1] == id) continue;
+
+        if (post->total == post->capacidade) {
+            int nova = post->capacidade ? post->capacidade * 2 : 4;
+            int* ids = (int*) realloc(post->ids, (size_t)nova * sizeof(int));
+            if (!ids) {
+                fprintf(stderr, "Erro: falha na alocação de memória para Postagem\n");
+                exit(EXIT_FAILURE);
+            }
+            post->ids = ids;
+            post->capacidade = nova;
+        }
+        post->ids[post->total++] = id;
+    }
+}
+
+int intersectarIds(const int* a, int na, const int* b, int nb, int* saida) {
+    int i = 0, j = 0, n = 0;
+
+#if defined(__SSE2__)
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+
+        /* Compara cada ID de `a` com as 4 rotações do bloco de `b` */
+        __m128i eq = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int mascara = _mm_movemask_ps(_mm_castsi128_ps(eq));
+
+        /* Lê o bloco antes de escrever: `saida` pode coincidir com `a` */
+        int bloco[4] = { a[i], a[i + 1], a[i + 2], a[i + 3] };
+        int maxA = bloco[3], maxB = b[j + 3];
+        for (int k = 0; k < 4; ++k)
+            if (mascara & (1 << k)) saida[n++] = bloco[k];
+
+        if (maxA <= maxB) i += 4;
+        if (maxB <= maxA) j += 4;
+    }
+#endif
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else { saida[n++] = a[i]; i++; j++; }
+    }
+    return n;
+}
+
+int buscarPorPalavras(Postagem* indice[], const char* consulta, int* saida, int max) {
+    /* Cada palavra ocupa ao menos um caractere mais um separador: isto cabe todas */
+    Postagem** listas = (Postagem**) malloc((strlen(consulta) / 2 + 1) * sizeof(Postagem*));
+    int nListas = 0;
+    char palavra[MAX_PALAVRA];
+    const char* cursor = consulta;
+
+    if (!listas) return SESSAO_ERRO_MEMORIA;
+    while (proximaPalavra(&cursor, palavra)) {
+        Postagem* post = buscarPostagem(indice, palavra);
+        if (!post) { nListas = 0; break; }  /* palavra ausente: interseção vazia */
+        listas[nListas++] = post;
+    }
+    if (nListas == 0 || max <= 0) {
+        free(listas);
+        return 0;
+    }
+
+    /* Ordena por tamanho: a menor lista limita todo o trabalho */
+    for (int i = 1; i < nListas; ++i)
+        for (int k = i; k > 0 && listas[k]->total < listas[k - 1]->total; --k) {
+            Postagem* t = listas[k]; listas[k] = listas[k - 1]; listas[k - 1] = t;
+        }
+
+    int* atual = (int*) malloc((size_t)listas[0]->total * sizeof(int));
+    if (!atual) {
+        free(listas);
+        return SESSAO_ERRO_MEMORIA;
+    }
+    memcpy(atual, listas[0]->ids, (size_t)listas[0]->total * sizeof(int));
+    int n = listas[0]->total;
+
+    for (int i = 1; i < nListas && n > 0; ++i)
+        n = intersectarIds(atual, n, listas[i]->ids, listas[i]->total, atual);
+
+    if (n > max) n = max;
+    memcpy(saida, atual, (size_t)n * sizeof(int));
+    free(atual);
+    free(listas);
+    return n;
+}
+
+void liberarIndicePalavras(Postagem* indice[]) {
+    for (int i = 0; i < TAM_INDICE_PALAVRAS; ++i) {
+        Postagem* cur = indice[i];
+        while (cur) {
+            Postagem* tmp = cur;
+            cur = cur->prox;
+            free(tmp->ids);
+            free(tmp);
+        }
+        indice[i] = NULL;
+    }
+}
+
+/* ----------------- Suspeitos (BK-tree) ----------------- */
+
+void normalizarNome(const char* nome, char* saida, size_t tam) {
+    char palavra[MAX_PALAVRA];
+    const char* cursor = nome;
+    size_t len = 0;
+
+    if (tam == 0) return;
+    while (proximaPalavra(&cursor, palavra)) {
+        size_t n = strlen(palavra);
+        if (len > 0 && len + 1 < tam) saida[len++] = ' ';
+        if (len + n >= tam) n = tam - 1 - len;
+        memcpy(saida + len, palavra, n);
+        len += n;
+    }
+    saida[len] = '\0';
+}
+
+/* Máscaras de ocorrência de cada byte de `a` (bit i = posição i), para distanciaBitParalela() */
+static int montarMascarasEdicao(const char* a, uint64_t mascaras[256]) {
+    int la = (int)strlen(a);
+    if (la > MAX_NOME) la = MAX_NOME;
+    memset(mascaras, 0, sizeof(uint64_t) * 256);
+    for (int i = 0; i < la; ++i) mascaras[(unsigned char) a[i]] |= 1ULL << i;
+    return la;
+}
+
+/*
+ * Levenshtein bit-paralelo (Myers/Hyyrö): uma coluna da matriz por palavra
+ * de 64 bits, então cada letra de `b` custa meia dúzia de operações. Os
+ * nomes cabem numa palavra (MAX_NOME = 64).
+ */
+static int distanciaBitParalela(const uint64_t mascaras[256], int la, const char* b, int limite) {
+    int lb = (int)strlen(b);
+
+    if (lb > MAX_NOME) lb = MAX_NOME;
+    if (la - lb > limite || lb - la > limite) return limite + 1;
+    if (la == 0) return lb;
+
+    uint64_t pv = ~0ULL, mv = 0, ultimo = 1ULL << (la - 1);
+    int distancia = la;
+    for (int j = 0; j < lb; ++j) {
+        uint64_t eq = mascaras[(unsigned char) b[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & ultimo) distancia++;
+        else if (mh & ultimo) distancia--;
+        /* Cada letra restante baixa a distância em no máximo 1 */
+        if (distancia - (lb - 1 - j) > limite) return limite + 1;
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return distancia <= limite ? distancia : limite + 1;
+}
+
+int distanciaEdicao(const char* a, const char* b, int limite) {
+    uint64_t mascaras[256];
+    int la = montarMascarasEdicao(a, mascaras);
+    return distanciaBitParalela(mascaras, la, b, limite);
+}
+
+/* Primeiro nó a até `raio` da chave (DFS com corte triangular); *erro = 1 se a pilha não pôde crescer */
+static NoBK* buscarNoRaioBK(NoBK* raiz, const uint64_t mascaras[256], int la, int raio, int* achada, int* erro) {
+    NoBK* local[256];
+    NoBK** pilha = local;          /* cresce no heap se a árvore for larga demais */
+    int topo = 0, capacidade = 256;
+    NoBK* achado = NULL;
+
+    if (raiz) pilha[topo++] = raiz;
+    while (topo > 0 && !achado) {
+        NoBK* no = pilha[--topo];
+        int maiorAresta = 0;
+        for (NoBK* f = no->filho; f; f = f->irmao)
+            if (f->distancia > maiorAresta) maiorAresta = f->distancia;
+        /* Acima de raio + maiorAresta nem o nó nem filho algum interessam: corta a matriz */
+        int d = distanciaBitParalela(mascaras, la, no->chave, raio + maiorAresta);
+        if (d > raio + maiorAresta) continue;
+        if (d <= raio) {
+            achado = no;
+            *achada = d;
+            break;
+        }
+
+        /* Desigualdade triangular: só filhos em [d - raio, d + raio] */
+        for (NoBK* f = no->filho; f; f = f->irmao) {
+            if (f->distancia < d - raio || f->distancia > d + raio) continue;
+            if (topo == capacidade) {
+                NoBK** maior = (NoBK**) malloc(sizeof(NoBK*) * (size_t)capacidade * 2);
+                if (!maior) {
+                    *erro = 1;
+                    topo = 0;
+                    break;
+                }
+                memcpy(maior, pilha, sizeof(NoBK*) * (size_t)topo);
+                if (pilha != local) free(pilha);
+                pilha = maior;
+                capacidade *= 2;
+            }
+            pilha[topo++] = f;
+        }
+    }
+
+    if (pilha != local) free(pilha);
+    return achado;
+}
+
+NoBK* buscarSuspeitoAproximado(NoBK* raiz, const char* nome, int tolerancia, int* distancia) {
+    char chave[MAX_NOME];
+    uint64_t mascaras[256];
+    NoBK* melhor = NULL;
+    int melhorDist = -1, erro = 0;
+
+    normalizarNome(nome, chave, sizeof(chave));
+    int la = montarMascarasEdicao(chave, mascaras);
+    /* Aprofundamento iterativo: quase todo erro de digitação está a 1, e raios
+     * pequenos visitam uma fração mínima da árvore. Sem achado no raio k - 1,
+     * qualquer achado no raio k está exatamente a k. */
+    for (int raio = 0; raio <= tolerancia && !melhor && !erro; ++raio)
+        melhor = buscarNoRaioBK(raiz, mascaras, la, raio, &melhorDist, &erro);
+
+    if (erro) melhor = NULL;   /* busca incompleta: melhor não responder que responder errado */
+    if (distancia) *distancia = melhor ? melhorDist : -1;
+    return melhor;
+}
+
+int registrarSuspeito(Caso* caso, const char* nome) {
+    NoBK* novo = (NoBK*) malloc(sizeof(NoBK));
+    if (!novo) {
+        fprintf(stderr, "Erro: falha na alocação de memória para NoBK\n");
+        exit(EXIT_FAILURE);
+    }
+    strncpy(novo->nome, nome, MAX_NOME - 1);
+    novo->nome[MAX_NOME - 1] = '\0';
+    normalizarNome(nome, novo->chave, sizeof(novo->chave));
+    novo->distancia = 0;
+    novo->filho = novo->irmao = NULL;
+
+    /* Desce pela aresta de mesma distância até achar posição livre */
+    NoBK** elo = &caso->suspeitos;
+    while (*elo) {
+        NoBK* no = *elo;
+        int d = distanciaEdicao(novo->chave, no->chave, MAX_NOME);
+        if (d == 0) {
+            free(novo);
+            return no->id;
+        }
+        elo = &no->filho;
+        while (*elo && (*elo)->distancia != d) elo = &(*elo)->irmao;
+        if (!*elo) {
+            novo->distancia = d;
+            break;
+        }
+    }
+
+    if (caso->totalSuspeitos == caso->capacidadeSuspeitos) {
+        int nova = caso->capacidadeSuspeitos ? caso->capacidadeSuspeitos * 2 : 8;
+        NoBK** v = (NoBK**) realloc(caso->suspeitosPorId, (size_t)nova * sizeof(NoBK*));
+        if (!v) {
+            fprintf(stderr, "Erro: falha na alocação de memória para o registro de suspeitos\n");
+            exit(EXIT_FAILURE);
+        }
+        caso->suspeitosPorId = v;
+        caso->capacidadeSuspeitos = nova;
+    }
+
+    novo->id = caso->totalSuspeitos++;
+    caso->suspeitosPorId[novo->id] = novo;
+    *elo = novo;
+    return novo->id;
+}
+
+NoBK* resolverSuspeito(Caso* caso, const char* nome, int* distancia) {
+    char chave[MAX_NOME];
+    normalizarNome(nome, chave, sizeof(chave));
+
+    int tolerancia = (int)strlen(chave) / 4;
+    if (tolerancia < 1) tolerancia = 1;
+    return buscarSuspeitoAproximado(caso->suspeitos, chave, tolerancia, distancia);
+}
+
+void liberarBK(NoBK* raiz) {
+    while (raiz) {
+        NoBK* prox = raiz->irmao;
+        liberarBK(raiz->filho);
+        free(raiz);
+        raiz = prox;
+    }
+}
+
+/* ----------------- Caso ----------------- */
+
+void inicializarCaso(Caso* caso, Sala* mansao) {
+    caso->mansao = mansao;
+    inicializarHash(caso->tabela);
+    caso->prefixos = NULL;
+    for (int i = 0; i < TAM_INDICE_PALAVRAS; ++i) caso->palavras[i] = NULL;
+    caso->pistasPorId = NULL;
+    caso->totalPistas = caso->capacidadePistas = 0;
+    caso->suspeitos = NULL;
+    caso->suspeitosPorId = NULL;
+    caso->totalSuspeitos = caso->capacidadeSuspeitos = 0;
+    caso->salasPorId = NULL;
+    caso->totalSalas = 0;
+    caso->salasPorNome = NULL;
+    caso->hashNomes = NULL;
+    caso->capacidadeNomes = 0;
+    caso->inicioPortas = caso->destinoPortas = NULL;
+    caso->rotuloPortas = caso->custoPortas = NULL;
+    caso->totalPortas = 0;
+    caso->avulsasOrigem = caso->avulsasDestino = NULL;
+    caso->avulsasRotulo = caso->avulsasCusto = NULL;
+    caso->totalAvulsas = caso->capacidadeAvulsas = 0;
+    caso->rotulos = NULL;
+    caso->totalRotulos = 0;
+    caso->assinatura = 2166136261u;
+    atomic_init(&caso->totaisAlas, NULL);
+    indexarSalas(caso);
+
+    /* Rótulos reservados (ROTULO_*) e portas derivadas da árvore */
+    registrarRotulo(caso, "esquerda");
+    registrarRotulo(caso, "direita");
+    registrarRotulo(caso, "voltar");
+    construirPortas(caso);
+}
+
+uint32_t acumularAssinatura(uint32_t h, const char* texto) {
+    const unsigned char* p = (const unsigned char*) texto;
+    do {
+        h ^= *p;
+        h *= 16777619u;
+    } while (*p++ != '\0');
+    return h;
+}
+
+void indexarSalas(Caso* caso) {
+    int capacidade = 16;
+    Sala** pilha = (Sala**) malloc((size_t)capacidade * sizeof(Sala*));
+    int topo = 0;
+
+    free(caso->salasPorId);
+    caso->salasPorId = NULL;
+    caso->totalSalas = 0;
+    if (!pilha) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o índice de salas\n");
+        exit(EXIT_FAILURE);
+    }
+    if (caso->mansao) {
+        caso->mansao->pai = NULL;
+        caso->mansao->profundidade = 0;
+        caso->mansao->rota = 0;
+        pilha[topo++] = caso->mansao;
+    }
+
+    /* Pré-ordem iterativa (esquerda antes da direita) */
+    while (topo > 0) {
+        Sala* s = pilha[--topo];
+        if (caso->totalSalas % 16 == 0) {
+            Sala** v = (Sala**) realloc(caso->salasPorId, (size_t)(caso->totalSalas + 16) * sizeof(Sala*));
+            if (!v) {
+                fprintf(stderr, "Erro: falha na alocação de memória para o índice de salas\n");
+                exit(EXIT_FAILURE);
+            }
+            caso->salasPorId = v;
+        }
+        s->id = caso->totalSalas;
+        caso->salasPorId[caso->totalSalas++] = s;
+        caso->assinatura = acumularAssinatura(caso->assinatura, s->nome);
+        caso->assinatura = acumularAssinatura(caso->assinatura, s->pista);
+
+        if (topo + 2 > capacidade) {
+            capacidade *= 2;
+            Sala** v = (Sala**) realloc(pilha, (size_t)capacidade * sizeof(Sala*));
+            if (!v) {
+                fprintf(stderr, "Erro: falha na alocação de memória para o índice de salas\n");
+                exit(EXIT_FAILURE);
+            }
+            pilha = v;
+        }
+        if (s->direita) {
+            s->direita->pai = s;
+            s->direita->profundidade = s->profundidade + 1;
+            s->direita->rota = s->rota | (s->profundidade < 64 ? (uint64_t)1 << s->profundidade : 0);
+            pilha[topo++] = s->direita;
+        }
+        if (s->esquerda) {
+            s->esquerda->pai = s;
+            s->esquerda->profundidade = s->profundidade + 1;
+            s->esquerda->rota = s->rota;
+            pilha[topo++] = s->esquerda;
+        }
+    }
+    free(pilha);
+
+    /* Tamanho das alas: em pré-ordem inversa, cada filho já está completo */
+    for (int id = caso->totalSalas - 1; id >= 0; --id) {
+        Sala* s = caso->salasPorId[id];
+        s->tamanhoAla = 1 + (s->esquerda ? s->esquerda->tamanhoAla : 0) + (s->direita ? s->direita->tamanhoAla : 0);
+    }
+    indexarNomesSalas(caso);
+}
+
+void indexarNomesSalas(Caso* caso) {
+    char chave[MAX_NOME];
+    int capacidade = 16;
+
+    while (capacidade < 2 * caso->totalSalas) capacidade *= 2;
+    free(caso->salasPorNome);
+    free(caso->hashNomes);
+    caso->salasPorNome = (int*) malloc(sizeof(int) * (size_t)capacidade);
+    caso->hashNomes = (uint32_t*) malloc(sizeof(uint32_t) * (size_t)capacidade);
+    caso->capacidadeNomes = capacidade;
+    if (!caso->salasPorNome || !caso->hashNomes) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o índice de nomes\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < capacidade; ++i) caso->salasPorNome[i] = -1;
+
+    for (int id = 0; id < caso->totalSalas; ++id) {
+        normalizarNome(caso->salasPorId[id]->nome, chave, sizeof(chave));
+        if (buscarSala(caso, chave)) continue;   /* nome repetido: fica a primeira */
+
+        uint32_t h = acumularAssinatura(2166136261u, chave);
+        int i = (int)(h & (uint32_t)(capacidade - 1));
+        while (caso->salasPorNome[i] >= 0) i = (i + 1) & (capacidade - 1);
+        caso->salasPorNome[i] = id;
+        caso->hashNomes[i] = h;
+    }
+}
+
+Sala* buscarSala(const Caso* caso, const char* nome) {
+    char chave[MAX_NOME], outra[MAX_NOME];
+
+    if (caso->capacidadeNomes == 0) return NULL;
+    normalizarNome(nome, chave, sizeof(chave));
+    uint32_t h = acumularAssinatura(2166136261u, chave);
+    int mascara = caso->capacidadeNomes - 1;
+
+    /* Sondagem linear; o hash guardado evita normalizar nomes que não batem */
+    for (int i = (int)(h & (uint32_t)mascara); caso->salasPorNome[i] >= 0; i = (i + 1) & mascara) {
+        if (caso->hashNomes[i] != h) continue;
+        Sala* sala = caso->salasPorId[caso->salasPorNome[i]];
+        normalizarNome(sala->nome, outra, sizeof(outra));
+        if (strcmp(chave, outra) == 0) return sala;
+    }
+    return NULL;
+}
+
+/* Incorpora um inteiro (4 bytes, little-endian) ao hash FNV-1a */
+static uint32_t acumularInteiro(uint32_t h, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        h ^= (v >> (8 * i)) & 0xFF;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+int registrarRotulo(Caso* caso, const char* rotulo) {
+    for (int i = 0; i < caso->totalRotulos; ++i)
+        if (strcmp(caso->rotulos[i], rotulo) == 0) return i;
+    if (caso->totalRotulos > UINT16_MAX) {
+        fprintf(stderr, "Erro: rótulos de porta demais\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char** v = (char**) realloc(caso->rotulos, sizeof(char*) * (size_t)(caso->totalRotulos + 1));
+    char* copia = (char*) malloc(strlen(rotulo) + 1);
+    if (!v || !copia) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o rótulo '%s'\n", rotulo);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(copia, rotulo);
+    caso->rotulos = v;
+    caso->rotulos[caso->totalRotulos] = copia;
+    caso->assinatura = acumularAssinatura(caso->assinatura, rotulo);
+    return caso->totalRotulos++;
+}
+
+void adicionarPorta(Caso* caso, int origem, int destino, int rotulo, int custo) {
+    if (origem < 0 || origem >= caso->totalSalas || destino < 0 || destino >= caso->totalSalas
+        || rotulo < 0 || rotulo >= caso->totalRotulos || custo < 1 || custo > UINT16_MAX)
+        return;
+
+    if (caso->totalAvulsas == caso->capacidadeAvulsas) {
+        int nova = caso->capacidadeAvulsas ? caso->capacidadeAvulsas * 2 : 16;
+        int* o = (int*) realloc(caso->avulsasOrigem, sizeof(int) * (size_t)nova);
+        if (o) caso->avulsasOrigem = o;
+        int* d = (int*) realloc(caso->avulsasDestino, sizeof(int) * (size_t)nova);
+        if (d) caso->avulsasDestino = d;
+        uint16_t* r = (uint16_t*) realloc(caso->avulsasRotulo, sizeof(uint16_t) * (size_t)nova);
+        if (r) caso->avulsasRotulo = r;
+        uint16_t* c = (uint16_t*) realloc(caso->avulsasCusto, sizeof(uint16_t) * (size_t)nova);
+        if (c) caso->avulsasCusto = c;
+        if (!o || !d || !r || !c) {
+            fprintf(stderr, "Erro: falha na alocação de memória para as portas\n");
+            exit(EXIT_FAILURE);
+        }
+        caso->capacidadeAvulsas = nova;
+    }
+    caso->avulsasOrigem[caso->totalAvulsas] = origem;
+    caso->avulsasDestino[caso->totalAvulsas] = destino;
+    caso->avulsasRotulo[caso->totalAvulsas] = (uint16_t)rotulo;
+    caso->avulsasCusto[caso->totalAvulsas] = (uint16_t)custo;
+    caso->totalAvulsas++;
+
+    caso->assinatura = acumularInteiro(caso->assinatura, (uint32_t)origem);
+    caso->assinatura = acumularInteiro(caso->assinatura, (uint32_t)destino);
+    caso->assinatura = acumularInteiro(caso->assinatura, (uint32_t)rotulo);
+    caso->assinatura = acumularInteiro(caso->assinatura, (uint32_t)custo);
+}
+
+/* Portas que a própria árvore da planta dá a uma sala */
+static int portasDaArvore(const Sala* s) {
+    return (s->esquerda != NULL) + (s->direita != NULL) + (s->pai != NULL);
+}
+
+void construirPortas(Caso* caso) {
+    int n = caso->totalSalas;
+    int* inicio = (int*) calloc((size_t)n + 1, sizeof(int));
+    int* cursor = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+
+    if (!inicio || !cursor) {
+        fprintf(stderr, "Erro: falha na alocação de memória para as portas\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* 1) Contagem por sala: árvore + extras já no CSR + extras pendentes */
+    for (int id = 0; id < n; ++id) {
+        const Sala* s = caso->salasPorId[id];
+        int extras = caso->inicioPortas
+            ? caso->inicioPortas[id + 1] - caso->inicioPortas[id] - portasDaArvore(s) : 0;
+        inicio[id + 1] = portasDaArvore(s) + extras;
+    }
+    for (int i = 0; i < caso->totalAvulsas; ++i) inicio[caso->avulsasOrigem[i] + 1]++;
+    for (int id = 0; id < n; ++id) inicio[id + 1] += inicio[id];
+
+    int total = inicio[n];
+    int* destino = (int*) malloc(sizeof(int) * ((size_t)total + 1));
+    uint16_t* rotulo = (uint16_t*) malloc(sizeof(uint16_t) * ((size_t)total + 1));
+    uint16_t* custo = (uint16_t*) malloc(sizeof(uint16_t) * ((size_t)total + 1));
+    if (!destino || !rotulo || !custo) {
+        fprintf(stderr, "Erro: falha na alocação de memória para as portas\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* 2) Preenchimento: árvore, extras antigas e, por fim, as pendentes */
+    for (int id = 0; id < n; ++id) {
+        const Sala* s = caso->salasPorId[id];
+        int p = inicio[id];
+        if (s->esquerda) { destino[p] = s->esquerda->id; custo[p] = 1; rotulo[p++] = ROTULO_ESQUERDA; }
+        if (s->direita)  { destino[p] = s->direita->id;  custo[p] = 1; rotulo[p++] = ROTULO_DIREITA; }
+        if (s->pai)      { destino[p] = s->pai->id;      custo[p] = 1; rotulo[p++] = ROTULO_VOLTAR; }
+        if (caso->inicioPortas) {
+            for (int q = caso->inicioPortas[id] + portasDaArvore(s); q < caso->inicioPortas[id + 1]; ++q) {
+                destino[p] = caso->destinoPortas[q];
+                custo[p] = caso->custoPortas[q];
+                rotulo[p++] = caso->rotuloPortas[q];
+            }
+        }
+        cursor[id] = p;
+    }
+    for (int i = 0; i < caso->totalAvulsas; ++i) {
+        int p = cursor[caso->avulsasOrigem[i]]++;
+        destino[p] = caso->avulsasDestino[i];
+        rotulo[p] = caso->avulsasRotulo[i];
+        custo[p] = caso->avulsasCusto[i];
+    }
+
+    free(cursor);
+    free(caso->inicioPortas);
+    free(caso->destinoPortas);
+    free(caso->rotuloPortas);
+    free(caso->custoPortas);
+    free(caso->avulsasOrigem);
+    free(caso->avulsasDestino);
+    free(caso->avulsasRotulo);
+    free(caso->avulsasCusto);
+    caso->inicioPortas = inicio;
+    caso->destinoPortas = destino;
+    caso->rotuloPortas = rotulo;
+    caso->custoPortas = custo;
+    caso->totalPortas = total;
+    caso->avulsasOrigem = caso->avulsasDestino = NULL;
+    caso->avulsasRotulo = caso->avulsasCusto = NULL;
+    caso->totalAvulsas = caso->capacidadeAvulsas = 0;
+}
+
+int portasDaSala(const Caso* caso, const Sala* sala) {
+    return caso->inicioPortas[sala->id + 1] - caso->inicioPortas[sala->id];
+}
+
+Sala* destinoDaPorta(const Caso* caso, const Sala* sala, int porta) {
+    return caso->salasPorId[caso->destinoPortas[caso->inicioPortas[sala->id] + porta]];
+}
+
+const char* rotuloDaPorta(const Caso* caso, const Sala* sala, int porta) {
+    return caso->rotulos[caso->rotuloPortas[caso->inicioPortas[sala->id] + porta]];
+}
+
+int cadastrarPista(Caso* caso, const char* pista, const char* suspeito) {
+    SuspeitoNode* no = buscarNaHash(caso->tabela, pista);
+    if (no) return no->id;
+
+    if (caso->totalPistas == caso->capacidadePistas) {
+        int nova = caso->capacidadePistas ? caso->capacidadePistas * 2 : 16;
+        SuspeitoNode** v = (SuspeitoNode**) realloc(caso->pistasPorId, (size_t)nova * sizeof(SuspeitoNode*));
+        if (!v) {
+            fprintf(stderr, "Erro: falha na alocação de memória para o catálogo de pistas\n");
+            exit(EXIT_FAILURE);
+        }
+        caso->pistasPorId = v;
+        caso->capacidadePistas = nova;
+    }
+
+    /* Caso ainda em montagem: os totais por ala (se já existirem) ficaram velhos */
+    liberarTotaisAlas(atomic_exchange(&caso->totaisAlas, NULL));
+
+    no = inserirNaHash(caso->tabela, pista, suspeito);
+    no->id = caso->totalPistas++;
+    no->idSuspeito = registrarSuspeito(caso, suspeito);
+    caso->pistasPorId[no->id] = no;
+    caso->assinatura = acumularAssinatura(caso->assinatura, pista);
+    caso->assinatura = acumularAssinatura(caso->assinatura, suspeito);
+
+    caso->prefixos = inserirNoRadix(caso->prefixos, pista);
+    indexarPalavras(caso->palavras, no->id, pista);
+    return no->id;
+}
+
+void liberarCaso(Caso* caso) {
+    liberarTotaisAlas(atomic_exchange(&caso->totaisAlas, NULL));
+    liberarHash(caso->tabela);
+    liberarRadix(caso->prefixos);
+    liberarIndicePalavras(caso->palavras);
+    free(caso->pistasPorId);
+    caso->pistasPorId = NULL;
+    caso->totalPistas = caso->capacidadePistas = 0;
+    liberarBK(caso->suspeitos);
+    free(caso->suspeitosPorId);
+    caso->suspeitos = NULL;
+    caso->suspeitosPorId = NULL;
+    caso->totalSuspeitos = caso->capacidadeSuspeitos = 0;
+    free(caso->salasPorId);
+    free(caso->salasPorNome);
+    free(caso->hashNomes);
+    caso->salasPorId = NULL;
+    caso->salasPorNome = NULL;
+    caso->hashNomes = NULL;
+    caso->totalSalas = caso->capacidadeNomes = 0;
+    free(caso->inicioPortas);
+    free(caso->destinoPortas);
+    free(caso->rotuloPortas);
+    free(caso->custoPortas);
+    free(caso->avulsasOrigem);
+    free(caso->avulsasDestino);
+    free(caso->avulsasRotulo);
+    free(caso->avulsasCusto);
+    caso->inicioPortas = caso->destinoPortas = NULL;
+    caso->rotuloPortas = caso->custoPortas = NULL;
+    caso->avulsasOrigem = caso->avulsasDestino = NULL;
+    caso->avulsasRotulo = caso->avulsasCusto = NULL;
+    caso->totalPortas = caso->totalAvulsas = caso->capacidadeAvulsas = 0;
+    for (int i = 0; i < caso->totalRotulos; ++i) free(caso->rotulos[i]);
+    free(caso->rotulos);
+    caso->rotulos = NULL;
+    caso->totalRotulos = 0;
+    liberarMansao(caso->mansao);
+    caso->prefixos = NULL;
+    caso->mansao = NULL;
+}
+
+/* ----------------- Cotas de memória por sessão ----------------- */
+
+/* Cabeçalho escondido antes de cada bloco: cota dona, bytes cobrados e reserva de origem */
+typedef union {
+    struct {
+        CotaMemoria* cota;
+        size_t tamanho;
+        ReservaMemoria* reserva;   /* != NULL: bloco emprestado da reserva */
+    } info;
+    max_align_t alinhamento;
+} CabecalhoCota;
+
+void iniciarReservaMemoria(ReservaMemoria* reserva, int blocos) {
+    reserva->blocos = (unsigned char*) malloc((size_t)blocos * RESERVA_BLOCO);
+    reserva->livres = (int*) malloc(sizeof(int) * (size_t)blocos);
+    if (!reserva->blocos || !reserva->livres) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a reserva de memória\n");
+        exit(EXIT_FAILURE);
+    }
+    /* Páginas tocadas agora: na hora do aperto a reserva já é memória de verdade */
+    memset(reserva->blocos, 0, (size_t)blocos * RESERVA_BLOCO);
+    for (int i = 0; i < blocos; ++i) reserva->livres[i] = blocos - 1 - i;
+    reserva->totalLivres = reserva->total = blocos;
+    reserva->emprestimos = 0;
+    pthread_mutex_init(&reserva->trava, NULL);
+}
+
+void liberarReservaMemoria(ReservaMemoria* reserva) {
+    pthread_mutex_destroy(&reserva->trava);
+    free(reserva->blocos);
+    free(reserva->livres);
+    reserva->blocos = NULL;
+    reserva->livres = NULL;
+    reserva->total = reserva->totalLivres = 0;
+}
+
+void iniciarCotaMemoria(CotaMemoria* cota, size_t limite, ReservaMemoria* reserva) {
+    memset(cota, 0, sizeof(*cota));
+    cota->limite = limite;
+    cota->reserva = reserva;
+}
+
+static void* emprestarDaReserva(ReservaMemoria* reserva) {
+    void* bloco = NULL;
+
+    pthread_mutex_lock(&reserva->trava);
+    if (reserva->totalLivres > 0) {
+        bloco = reserva->blocos + (size_t)reserva->livres[--reserva->totalLivres] * RESERVA_BLOCO;
+        reserva->emprestimos++;
+    }
+    pthread_mutex_unlock(&reserva->trava);
+    return bloco;
+}
+
+static void devolverAReserva(ReservaMemoria* reserva, void* bloco) {
+    pthread_mutex_lock(&reserva->trava);
+    reserva->livres[reserva->totalLivres++] = (int)(((unsigned char*) bloco - reserva->blocos) / RESERVA_BLOCO);
+    pthread_mutex_unlock(&reserva->trava);
+}
+
+void* alocarNaCota(CotaMemoria* cota, size_t quantidade, size_t tamanho) {
+    if (tamanho && quantidade > (SIZE_MAX - sizeof(CabecalhoCota)) / tamanho) {
+        if (cota) cota->recusas++;
+        return NULL;
+    }
+    size_t total = sizeof(CabecalhoCota) + quantidade * tamanho;
+    if (cota && cota->limite != COTA_ILIMITADA
+        && (cota->usados > cota->limite || total > cota->limite - cota->usados)) {
+        cota->recusas++;
+        return NULL;
+    }
+
+    CabecalhoCota* c = (CabecalhoCota*) calloc(1, total);
+    ReservaMemoria* reserva = NULL;
+    if (!c && cota && cota->reserva && total <= RESERVA_BLOCO && cota->emprestados < RESERVA_POR_SESSAO) {
+        c = (CabecalhoCota*) emprestarDaReserva(cota->reserva);
+        if (c) {
+            memset(c, 0, total);
+            reserva = cota->reserva;
+            cota->emprestados++;
+            cota->socorros++;
+        }
+    }
+    if (!c) {
+        if (cota) cota->recusas++;
+        return NULL;
+    }
+
+    c->info.cota = cota;
+    c->info.tamanho = total;
+    c->info.reserva = reserva;
+    if (cota) {
+        cota->usados += total;
+        if (cota->usados > cota->pico) cota->pico = cota->usados;
+    }
+    return c + 1;
+}
+
+void liberarDaCota(void* bloco) {
+    if (!bloco) return;
+
+    CabecalhoCota* c = (CabecalhoCota*) bloco - 1;
+    if (c->info.cota) c->info.cota->usados -= c->info.tamanho;
+    if (c->info.reserva) {
+        c->info.cota->emprestados--;
+        devolverAReserva(c->info.reserva, c);
+    } else {
+        free(c);
+    }
+}
+
+/* Placar de uma sessão do modo --estresse */
+typedef struct {
+    long ok;                       /* movimentos atendidos */
+    long recusados;                /* movimentos recusados com SESSAO_ERRO_MEMORIA */
+    long outros;                   /* qualquer outro código negativo (não deveria acontecer) */
+} PlacarEstresse;
+
+/* Até `comandos` movimentos "último ramo"; 0 quando a mansão inteira já foi explorada */
+static int rodadaEstresse(Caso* caso, Sessao* sessao, long comandos, PlacarEstresse* placar) {
+    for (long i = 0; i < comandos; ++i) {
+        int r = irUltimoRamo(caso, sessao);
+        if (r == 0) return 0;
+        if (r > 0) placar->ok++;
+        else if (r == SESSAO_ERRO_MEMORIA) placar->recusados++;
+        else placar->outros++;
+    }
+    return 1;
+}
+
+/* `comandos` rotas ('i') até salas sorteadas; toda sala é alcançável, então -1 conta como erro */
+static void rotasEstresse(Caso* caso, Sessao* sessao, PlanejadorRotas* planejador, unsigned long* semente,
+                          long comandos, PlacarEstresse* placar) {
+    for (long i = 0; i < comandos; ++i) {
+        *semente = *semente * 6364136223846793005UL + 1442695040888963407UL;
+        const Sala* destino = caso->salasPorId[(*semente >> 33) % (unsigned long)caso->totalSalas];
+        int r = irParaSala(caso, sessao, planejador, destino->nome);
+        if (r >= 0) placar->ok++;
+        else if (r == SESSAO_ERRO_MEMORIA) placar->recusados++;
+        else placar->outros++;
+    }
+}
+
+/* Mansão sintética: cada sala tem uma pista própria, então cada sala nova aloca um nó */
+static void montarCasoEstresse(Caso* caso) {
+    unsigned long semente = 0x5EED2025UL;
+    char pista[MAX_PISTA];
+    char suspeito[MAX_NOME];
+
+    inicializarCaso(caso, gerarMansaoAleatoria(ESTRESSE_SALAS, &semente));
+    for (int i = 0; i < caso->totalSalas; ++i) {
+        snprintf(pista, sizeof(pista), "Pista de estresse %d", i);
+        snprintf(suspeito, sizeof(suspeito), "Suspeito %d", i % 5);
+        strcpy(caso->salasPorId[i]->pista, pista);
+        cadastrarPista(caso, pista, suspeito);
+    }
+}
+
+#ifndef _WIN32
+/* Espaço de endereçamento em uso (primeiro campo de /proc/self/statm), 0 se indisponível */
+static size_t espacoEnderecadoBytes(void) {
+    long paginas = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    if (fscanf(f, "%ld", &paginas) != 1) paginas = 0;
+    fclose(f);
+    return (size_t)paginas * (size_t)sysconf(_SC_PAGESIZE);
+}
+#endif
+
+int executarEstresseMemoria(int sessoes) {
+    Caso caso;
+    ReservaMemoria reserva;
+    int ok = 1;
+
+    if (sessoes < 2) sessoes = 2;
+    montarCasoEstresse(&caso);
+    iniciarReservaMemoria(&reserva, RESERVA_BLOCOS);
+    Sessao* sessao = (Sessao*) calloc((size_t)sessoes, sizeof(Sessao));
+    PlacarEstresse* placar = (PlacarEstresse*) calloc((size_t)sessoes, sizeof(PlacarEstresse));
+    if (!sessao || !placar) {
+        fprintf(stderr, "Erro: falha na alocação de memória para as sessões do estresse\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t porPista = sizeof(CabecalhoCota) + sizeof(PistaNode);
+    printf("Estresse de memória: %d salas, %d pistas, %d sessões; reserva de %d blocos de %d bytes.\n\n",
+           caso.totalSalas, caso.totalPistas, sessoes, RESERVA_BLOCOS, RESERVA_BLOCO);
+
+    /* Fase 1: a sessão 0 tem cota para 1/4 das pistas; as demais, para todas */
+    for (int i = 0; i < sessoes; ++i) {
+        if (iniciarSessaoComCota(&sessao[i], &caso, COTA_ILIMITADA, &reserva) != SESSAO_OK) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+            exit(EXIT_FAILURE);
+        }
+        sessao[i].cota.limite = sessao[i].cota.usados + porPista * (size_t)(i == 0 ? caso.totalPistas / 4
+                                                                                   : caso.totalPistas);
+        entrarNaSala(&caso, &sessao[i], sessao[i].atual);
+    }
+    for (int ativas = sessoes; ativas > 0;) {
+        ativas = 0;
+        for (int i = 0; i < sessoes; ++i) {
+            if (!sessao[i].atual) continue;
+            long recusadosAntes = placar[i].recusados;
+            int continua = rodadaEstresse(&caso, &sessao[i], ESTRESSE_COMANDOS, &placar[i]);
+            /* Rodada inteira recusada: a sessão desiste (o processo segue) */
+            if (!continua || placar[i].recusados - recusadosAntes == ESTRESSE_COMANDOS) sessao[i].atual = NULL;
+            else ativas++;
+        }
+    }
+    printf("Fase 1 - cotas por sessão (a sessão 0 só comporta 1/4 das pistas):\n");
+    printf("  Sessão  Movimentos  Recusados  Pistas  Pico (KB)  Cota (KB)\n");
+    for (int i = 0; i < sessoes; ++i) {
+        int pistas = tamanhoPistas(sessao[i].pistas);
+        printf("  %6d %11ld %10ld %7d %10zu %10zu\n", i, placar[i].ok, placar[i].recusados, pistas,
+               sessao[i].cota.pico / 1024, sessao[i].cota.limite / 1024);
+        if (placar[i].outros || (i == 0 ? placar[i].recusados == 0 : pistas != caso.totalPistas)) ok = 0;
+        liberarSessao(&sessao[i]);
+    }
+    memset(placar, 0, sizeof(PlacarEstresse) * (size_t)sessoes);
+
+#ifndef _WIN32
+    /* Fase 2: memória do processo de verdade esgotada (limite de espaço de endereçamento) */
+    struct rlimit original, apertado;
+    PlanejadorRotas rotas;
+    unsigned long sorteio = 0xD1CE2025UL;
+    iniciarPlanejador(&rotas, &caso);   /* as filas do Dijkstra só crescem na primeira rota */
+    for (int i = 0; i < sessoes; ++i) {
+        if (iniciarSessaoComCota(&sessao[i], &caso, COTA_ILIMITADA, &reserva) != SESSAO_OK) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+            exit(EXIT_FAILURE);
+        }
+        entrarNaSala(&caso, &sessao[i], sessao[i].atual);
+    }
+    fflush(stdout);
+    getrlimit(RLIMIT_AS, &original);
+    apertado = original;
+    apertado.rlim_cur = espacoEnderecadoBytes() + (size_t)ESTRESSE_MARGEM_MB * 1024 * 1024;
+    if (original.rlim_cur != RLIM_INFINITY && original.rlim_cur < apertado.rlim_cur) apertado.rlim_cur = original.rlim_cur;
+    if (espacoEnderecadoBytes() == 0 || setrlimit(RLIMIT_AS, &apertado) != 0) {
+        printf("\nFase 2 indisponível: não foi possível limitar o espaço de endereçamento.\n");
+    } else {
+        /* A sessão 0, sem cota, anda até o processo não ter mais memória para ela */
+        while (rodadaEstresse(&caso, &sessao[0], ESTRESSE_COMANDOS, &placar[0])
+               && placar[0].recusados < ESTRESSE_COMANDOS) {}
+        long socorrosDesgovernada = sessao[0].cota.socorros;
+
+        /* As outras tentam andar com o processo sem memória */
+        PlacarEstresse durante = { 0, 0, 0 }, rotasDurante = { 0, 0, 0 };
+        long socorrosDurante = 0;
+        for (int i = 1; i < sessoes; ++i) {
+            rodadaEstresse(&caso, &sessao[i], ESTRESSE_COMANDOS, &placar[i]);
+            rotasEstresse(&caso, &sessao[i], &rotas, &sorteio, ESTRESSE_ROTAS, &rotasDurante);
+            durante.ok += placar[i].ok;
+            durante.recusados += placar[i].recusados;
+            durante.outros += placar[i].outros;
+            socorrosDurante += sessao[i].cota.socorros;
+        }
+
+        /* Encerrar a sessão desgovernada devolve a memória; as outras voltam a andar */
+        size_t devolvidos = sessao[0].cota.usados;
+        liberarSessao(&sessao[0]);
+        PlacarEstresse depois = { 0, 0, 0 }, rotasDepois = { 0, 0, 0 };
+        for (int i = 1; i < sessoes; ++i) {
+            PlacarEstresse p = { 0, 0, 0 };
+            rodadaEstresse(&caso, &sessao[i], ESTRESSE_COMANDOS, &p);
+            rotasEstresse(&caso, &sessao[i], &rotas, &sorteio, ESTRESSE_ROTAS, &rotasDepois);
+            depois.ok += p.ok;
+            depois.recusados += p.recusados;
+            depois.outros += p.outros;
+        }
+        setrlimit(RLIMIT_AS, &original);
+
+        printf("\nFase 2 - processo limitado a +%d MB de espaço de endereçamento:\n", ESTRESSE_MARGEM_MB);
+        printf("  Sessão 0 (sem cota): %ld movimentos, %ld recusados, %ld socorridos pela reserva\n",
+               placar[0].ok, placar[0].recusados, socorrosDesgovernada);
+        printf("  Demais, sem memória: %ld movimentos, %ld recusados, %ld socorridos pela reserva\n",
+               durante.ok, durante.recusados, socorrosDurante);
+        printf("  Sessão 0 encerrada: %zu KB devolvidos\n", devolvidos / 1024);
+        printf("  Demais, depois:      %ld movimentos, %ld recusados\n", depois.ok, depois.recusados);
+        printf("  Rotas ('i'):         %ld/%ld recusadas sem memória, %ld/%ld depois\n",
+               rotasDurante.recusados, rotasDurante.ok + rotasDurante.recusados,
+               rotasDepois.recusados, rotasDepois.ok + rotasDepois.recusados);
+        if (placar[0].recusados == 0)
+            printf("  (inconclusiva: o limite não esgotou a memória; alocadores como o do AddressSanitizer o ignoram)\n");
+        if (placar[0].outros || durante.outros || depois.outros || depois.recusados || depois.ok == 0) ok = 0;
+        if (rotasDurante.outros || rotasDepois.outros || rotasDepois.recusados || rotasDepois.ok == 0) ok = 0;
+    }
+    for (int i = 0; i < sessoes; ++i) liberarSessao(&sessao[i]);
+    liberarPlanejador(&rotas);
+#else
+    printf("\nFase 2 (memória do processo esgotada) indisponível nesta plataforma.\n");
+#endif
+
+    printf("\nO processo sobreviveu e só as sessões sem memória tiveram comandos recusados: %s\n",
+           ok ? "sim" : "NÃO");
+    free(sessao);
+    free(placar);
+    liberarReservaMemoria(&reserva);
+    liberarCaso(&caso);
+    return ok;
+}
+
+/* ----------------- Sessão: estado, salvar e retomar ----------------- */
+
+int iniciarSessao(Sessao* sessao, const Caso* caso) {
+    return iniciarSessaoComCota(sessao, caso, COTA_ILIMITADA, NULL);
+}
+
+int iniciarSessaoComCota(Sessao* sessao, const Caso* caso, size_t limite, ReservaMemoria* reserva) {
+    iniciarCotaMemoria(&sessao->cota, limite, reserva);
+    sessao->atual = caso->mansao;
+    sessao->pistas = NULL;
+    sessao->totalBits = caso->totalPistas;
+    sessao->coletadas = (unsigned char*) alocarNaCota(&sessao->cota, (size_t)(caso->totalPistas + 7) / 8 + 1, 1);
+    sessao->visitadas = (unsigned char*) alocarNaCota(&sessao->cota, (size_t)(caso->totalSalas + 7) / 8 + 1, 1);
+    sessao->ramos = (int*) alocarNaCota(&sessao->cota, (size_t)caso->totalSalas + 1, sizeof(int));
+    sessao->totalRamos = 0;
+    sessao->estadoAcusacao = ACUSACAO_PENDENTE;
+    sessao->acusado[0] = '\0';
+    iniciarIteradorPistas(&sessao->listagem, NULL, NULL);
+    memset(&sessao->alas, 0, sizeof(sessao->alas));
+    sessao->alas.cota = &sessao->cota;
+    if (!sessao->coletadas || !sessao->visitadas || !sessao->ramos
+        || construirAlas(&sessao->alas, caso, sessao->visitadas) != SESSAO_OK) {
+        liberarSessao(sessao);
+        return SESSAO_ERRO_MEMORIA;
+    }
+    return SESSAO_OK;
+}
+
+void liberarSessao(Sessao* sessao) {
+    liberarPistas(sessao->pistas);
+    liberarDaCota(sessao->coletadas);
+    liberarDaCota(sessao->visitadas);
+    liberarDaCota(sessao->ramos);
+    liberarAlas(&sessao->alas);
+    sessao->pistas = NULL;
+    sessao->coletadas = NULL;
+    sessao->visitadas = NULL;
+    sessao->ramos = NULL;
+    sessao->totalRamos = 0;
+    sessao->totalBits = 0;
+}
+
+int coletarPista(Caso* caso, Sessao* sessao, const char* pista) {
+    SuspeitoNode* no = buscarNaHash(caso->tabela, pista);
+    if (!no || no->id < 0 || no->id >= sessao->totalBits) return 0;
+
+    unsigned char bit = (unsigned char)(1u << (no->id & 7));
+    if (sessao->coletadas[no->id >> 3] & bit) return 0;
+
+    int erro = SESSAO_OK;
+    sessao->pistas = inserirPistaNaCota(sessao->pistas, no->pista, &sessao->cota, &erro);
+    if (erro != SESSAO_OK) return erro;
+    sessao->coletadas[no->id >> 3] |= bit;
+    return 1;
+}
+
+/* Escrita/leitura little-endian independente da arquitetura */
+static void gravarU32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t lerU32(const unsigned char* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+size_t serializarSessao(const Caso* caso, const Sessao* sessao, unsigned char* buffer, size_t capacidade) {
+    size_t lenNome = strlen(sessao->acusado);
+    size_t bytesBits = (size_t)(sessao->totalBits + 7) / 8;
+    size_t bytesSalas = (size_t)(caso->totalSalas + 7) / 8;
+    size_t total = 22 + lenNome + bytesBits + bytesSalas + 4;
+    if (total > capacidade) return 0;
+
+    memcpy(buffer, SESSAO_MAGICO, 4);
+    buffer[4] = (unsigned char)(SESSAO_VERSAO & 0xFF);
+    buffer[5] = (unsigned char)(SESSAO_VERSAO >> 8);
+    buffer[6] = buffer[7] = 0;
+    gravarU32(buffer + 8, caso->assinatura);
+    gravarU32(buffer + 12, (uint32_t)(sessao->atual ? sessao->atual->id : 0));
+    gravarU32(buffer + 16, (uint32_t)sessao->totalBits);
+    buffer[20] = (unsigned char)sessao->estadoAcusacao;
+    buffer[21] = (unsigned char)lenNome;
+    memcpy(buffer + 22, sessao->acusado, lenNome);
+    memcpy(buffer + 22 + lenNome, sessao->coletadas, bytesBits);
+    memcpy(buffer + 22 + lenNome + bytesBits, sessao->visitadas, bytesSalas);
+
+    /* Pilha de ramos na ordem das visitas; salas esgotadas nunca voltam a ter saídas, ficam de fora */
+    uint32_t ramos = 0;
+    for (int i = 0; i < sessao->totalRamos; ++i) {
+        if (!saidaInexplorada(caso, sessao, caso->salasPorId[sessao->ramos[i]])) continue;
+        if (total + 4 > capacidade) return 0;
+        gravarU32(buffer + total, (uint32_t)sessao->ramos[i]);
+        total += 4;
+        ramos++;
+    }
+    gravarU32(buffer + 22 + lenNome + bytesBits + bytesSalas, ramos);
+    return total;
+}
+
+size_t tamanhoMaximoSessao(const Caso* caso) {
+    return 22 + MAX_NOME + (size_t)(caso->totalPistas + 7) / 8 + (size_t)(caso->totalSalas + 7) / 8
+           + 4 + 4 * (size_t)caso->totalSalas;
+}
+
+int desserializarSessao(Caso* caso, Sessao* sessao, const unsigned char* buffer, size_t tamanho) {
+    if (tamanho < 22 || memcmp(buffer, SESSAO_MAGICO, 4) != 0) return SESSAO_ERRO_FORMATO;
+    int versao = buffer[4] | buffer[5] << 8;
+    if (versao < 1 || versao > SESSAO_VERSAO) return SESSAO_ERRO_VERSAO;
+    if (lerU32(buffer + 8) != caso->assinatura) return SESSAO_ERRO_CASO;
+
+    uint32_t idSala = lerU32(buffer + 12);
+    uint32_t bits = lerU32(buffer + 16);
+    size_t lenNome = buffer[21];
+    size_t bytesBits = ((size_t)bits + 7) / 8;
+    size_t bytesSalas = versao >= 2 ? (size_t)(caso->totalSalas + 7) / 8 : 0;
+    size_t inicioRamos = 22 + lenNome + bytesBits + bytesSalas;
+    uint32_t ramos = 0;
+
+    if (idSala >= (uint32_t)caso->totalSalas || bits != (uint32_t)sessao->totalBits
+        || lenNome >= MAX_NOME || buffer[20] > ACUSACAO_SEM_FUNDAMENTO
+        || tamanho < inicioRamos + (versao >= 3 ? 4 : 0))
+        return SESSAO_ERRO_FORMATO;
+    if (versao >= 3) {
+        const unsigned char* visitadasSalvas = buffer + 22 + lenNome + bytesBits;
+        ramos = lerU32(buffer + inicioRamos);
+        if (ramos > (uint32_t)caso->totalSalas || tamanho < inicioRamos + 4 + 4 * (size_t)ramos)
+            return SESSAO_ERRO_FORMATO;
+        for (uint32_t i = 0; i < ramos; ++i) {
+            uint32_t id = lerU32(buffer + inicioRamos + 4 + 4 * (size_t)i);
+            if (id >= (uint32_t)caso->totalSalas || !(visitadasSalvas[id >> 3] & (1u << (id & 7))))
+                return SESSAO_ERRO_FORMATO;
+        }
+    }
+
+    /* A BST e as contagens por ala novas são montadas antes de tocar na sessão: sem memória, nada muda */
+    const unsigned char* bitsSalvos = buffer + 22 + lenNome;
+    PistaNode* pistas = NULL;
+    int erro = SESSAO_OK;
+    for (int id = 0; id < sessao->totalBits && erro == SESSAO_OK; ++id)
+        if (bitsSalvos[id >> 3] & (1u << (id & 7)))
+            pistas = inserirPistaNaCota(pistas, caso->pistasPorId[id]->pista, &sessao->cota, &erro);
+    if (erro != SESSAO_OK) {
+        liberarPistas(pistas);
+        return erro;
+    }
+
+    /* Até a versão 1 as visitadas não eram salvas: o caminho do Hall até a sala atual */
+    size_t bytesVisitadas = (size_t)(caso->totalSalas + 7) / 8;
+    unsigned char* caminhoV1 = NULL;
+    const unsigned char* visitadas = buffer + 22 + lenNome + bytesBits;
+    if (versao < 2) {
+        caminhoV1 = (unsigned char*) calloc(bytesVisitadas + 1, 1);
+        if (!caminhoV1) {
+            liberarPistas(pistas);
+            return SESSAO_ERRO_MEMORIA;
+        }
+        for (Sala* s = caso->salasPorId[idSala]; s; s = s->pai)
+            caminhoV1[s->id >> 3] |= (unsigned char)(1u << (s->id & 7));
+        visitadas = caminhoV1;
+    }
+    /* Mesmo caso já indexado: construirAlas() só zera e remonta os vetores, sem
+     * alocar nem falhar (os totais do caso já estão publicados). Senão as
+     * contagens novas saem da cota numa cópia e só substituem as da sessão no fim */
+    const ContagemAlas* antigas = &sessao->alas;
+    int reaproveita = antigas->encontradasTotal && antigas->totais && antigas->totalSalas == caso->totalSalas
+                      && antigas->totalSuspeitos == caso->totalSuspeitos;
+    ContagemAlas alas;
+    if (reaproveita) {
+        alas = *antigas;
+    } else {
+        memset(&alas, 0, sizeof(alas));
+        alas.cota = &sessao->cota;
+    }
+    if (construirAlas(&alas, caso, visitadas) != SESSAO_OK) {
+        free(caminhoV1);
+        liberarPistas(pistas);
+        return SESSAO_ERRO_MEMORIA;
+    }
+
+    /* Tudo validado e alocado: agora substitui o estado */
+    liberarPistas(sessao->pistas);
+    sessao->pistas = pistas;
+    memcpy(sessao->coletadas, bitsSalvos, bytesBits);
+    if (!reaproveita) liberarAlas(&sessao->alas);
+    sessao->alas = alas;
+
+    sessao->atual = caso->salasPorId[idSala];
+    memcpy(sessao->visitadas, visitadas, bytesVisitadas);
+    free(caminhoV1);
+
+    /* Até a versão 2 a ordem das visitas não era salva: a pré-ordem das visitadas
+     * serve de pilha de ramos (salas esgotadas são descartadas em irUltimoRamo) */
+    sessao->totalRamos = 0;
+    if (versao >= 3) {
+        for (uint32_t i = 0; i < ramos; ++i)
+            sessao->ramos[sessao->totalRamos++] = (int) lerU32(buffer + inicioRamos + 4 + 4 * (size_t)i);
+    } else {
+        for (int id = 0; id < caso->totalSalas; ++id)
+            if (sessao->visitadas[id >> 3] & (1u << (id & 7))) sessao->ramos[sessao->totalRamos++] = id;
+    }
+
+    sessao->estadoAcusacao = buffer[20];
+    memcpy(sessao->acusado, buffer + 22, lenNome);
+    sessao->acusado[lenNome] = '\0';
+    return SESSAO_OK;
+}
+
+int salvarSessao(const Caso* caso, const Sessao* sessao, const char* arquivo) {
+    size_t capacidade = tamanhoMaximoSessao(caso);
+    unsigned char* buffer = (unsigned char*) malloc(capacidade);
+    char temporario[FILENAME_MAX];
+    int status = SESSAO_ERRO_ARQUIVO;
+
+    if (!buffer) return SESSAO_ERRO_ARQUIVO;
+    size_t tamanho = serializarSessao(caso, sessao, buffer, capacidade);
+    snprintf(temporario, sizeof(temporario), "%s.tmp", arquivo);
+
+    /* Grava tudo no temporário; só então substitui o arquivo final */
+    FILE* f = fopen(temporario, "wb");
+    if (f) {
+        int ok = fwrite(buffer, 1, tamanho, f) == tamanho && fflush(f) == 0;
+#ifndef _WIN32
+        ok = ok && fsync(fileno(f)) == 0;
+#endif
+        ok = (fclose(f) == 0) && ok;
+#ifdef _WIN32
+        if (ok) remove(arquivo);   /* rename() no Windows não sobrescreve */
+#endif
+        if (ok && rename(temporario, arquivo) == 0) status = SESSAO_OK;
+        else remove(temporario);
+    }
+    free(buffer);
+    return status;
+}
+
+int carregarSessao(Caso* caso, Sessao* sessao, const char* arquivo) {
+    size_t capacidade = tamanhoMaximoSessao(caso);
+    unsigned char* buffer = (unsigned char*) malloc(capacidade);
+    if (!buffer) return SESSAO_ERRO_ARQUIVO;
+
+    FILE* f = fopen(arquivo, "rb");
+    if (!f) {
+        free(buffer);
+        return SESSAO_ERRO_ARQUIVO;
+    }
+    size_t lidos = fread(buffer, 1, capacidade, f);
+    fclose(f);
+
+    int status = desserializarSessao(caso, sessao, buffer, lidos);
+    free(buffer);
+    return status;
+}
+
+/* ----------------- Diário de comandos (gravação e reprodução) ----------------- */
+
+static void gravarVarint(FILE* f, unsigned long long v) {
+    while (v >= 0x80) {
+        fputc((int)(v & 0x7F) | 0x80, f);
+        v >>= 7;
+    }
+    fputc((int)v, f);
+}
+
+static int lerVarint(FILE* f, unsigned long long* v) {
+    int c, deslocamento = 0;
+    *v = 0;
+    do {
+        if ((c = fgetc(f)) == EOF || deslocamento > 63) return 0;
+        *v |= (unsigned long long)(c & 0x7F) << deslocamento;
+        deslocamento += 7;
+    } while (c & 0x80);
+    return 1;
+}
+
+/* Registros que carregam um parâmetro textual */
+static int diarioTemTexto(int codigo) {
+    return codigo == DIARIO_PREFIXO || codigo == DIARIO_PALAVRAS || codigo == DIARIO_ACUSAR
+        || codigo == DIARIO_INVALIDO || codigo == DIARIO_IR_PARA || codigo == DIARIO_ROTA
+        || codigo == DIARIO_PORTA_TEXTO || codigo == DIARIO_DICA;
+}
+
+int abrirDiario(Diario* diario, const char* arquivo, const Caso* caso, const Sessao* sessao) {
+    size_t capacidade = tamanhoMaximoSessao(caso);
+    unsigned char* estado = (unsigned char*) malloc(capacidade);
+    if (!estado) return 0;
+
+    diario->arquivo = fopen(arquivo, "ab");
+    if (!diario->arquivo) {
+        free(estado);
+        return 0;
+    }
+
+    /* Arquivo novo: grava o cabeçalho; sessões seguintes apenas se somam */
+    fseek(diario->arquivo, 0, SEEK_END);
+    if (ftell(diario->arquivo) == 0) fwrite(DIARIO_MAGICO, 1, 4, diario->arquivo);
+
+    diario->ultimoMs = agoraMs();
+    registrarNoDiario(diario, DIARIO_INICIO, NULL);
+    size_t tamanho = serializarSessao(caso, sessao, estado, capacidade);
+    gravarVarint(diario->arquivo, tamanho);
+    fwrite(estado, 1, tamanho, diario->arquivo);
+    fflush(diario->arquivo);
+    free(estado);
+    return 1;
+}
+
+/* Byte de registro: código nos 3 bits baixos (7 = extensão) e o intervalo em ms nos 5 altos */
+static void gravarCabecalhoRegistro(Diario* diario, int codigo) {
+    long long agora = agoraMs();
+    long long delta = agora - diario->ultimoMs;
+    diario->ultimoMs = agora;
+    if (delta < 0) delta = 0;
+
+    int base = codigo < DIARIO_EXTENSAO ? codigo : DIARIO_EXTENSAO;
+    fputc(base | (int)(delta < 31 ? delta : 31) << 3, diario->arquivo);
+    if (delta >= 31) gravarVarint(diario->arquivo, (unsigned long long)delta);
+    if (base == DIARIO_EXTENSAO) fputc(codigo - DIARIO_EXTENSAO, diario->arquivo);
+}
+
+void registrarNoDiario(Diario* diario, int codigo, const char* texto) {
+    if (!diario || !diario->arquivo) return;
+
+    gravarCabecalhoRegistro(diario, codigo);
+    if (diarioTemTexto(codigo)) {
+        size_t len = texto ? strlen(texto) : 0;
+        gravarVarint(diario->arquivo, len);
+        fwrite(texto, 1, len, diario->arquivo);
+    }
+
+    /* Um comando por vez: o diário sobrevive a uma queda do processo */
+    if (codigo != DIARIO_INICIO) fflush(diario->arquivo);
+}
+
+void registrarPortaNoDiario(Diario* diario, int porta) {
+    if (!diario || !diario->arquivo) return;
+
+    gravarCabecalhoRegistro(diario, DIARIO_PORTA);
+    gravarVarint(diario->arquivo, porta < 0 ? 0 : (unsigned long long)porta + 1);
+    fflush(diario->arquivo);
+}
+
+void fecharDiario(Diario* diario) {
+    if (diario->arquivo) fclose(diario->arquivo);
+    diario->arquivo = NULL;
+}
+
+/* Resumo determinístico da sessão reproduzida (oráculo de regressão) */
+static void resumirReproducao(int numero, const Sessao* sessao, long comandos) {
+    static const char* estados[] = { "pendente", "confirmada", "frágil", "sem fundamento" };
+    printf("sessão %d: %ld comando(s), sala='%s', pistas=%d, acusação=%s",
+           numero, comandos, sessao->atual->nome, tamanhoPistas(sessao->pistas),
+           estados[sessao->estadoAcusacao]);
+    if (sessao->acusado[0] != '\0') printf(" ('%s')", sessao->acusado);
+    printf("\n");
+}
+
+/* Categoria de latência de cada código do diário (-1: não mede) */
+static int comandoDoDiario(int codigo) {
+    switch (codigo) {
+    case DIARIO_ESQUERDA: case DIARIO_DIREITA: case DIARIO_VOLTAR:
+    case DIARIO_ULTIMO_RAMO: case DIARIO_IR_PARA: case DIARIO_PORTA: case DIARIO_PORTA_TEXTO:
+        return COMANDO_MOVER;
+    case DIARIO_LISTAR: return COMANDO_LISTAR;
+    case DIARIO_PREFIXO: case DIARIO_PALAVRAS: return COMANDO_BUSCAR;
+    case DIARIO_ROTA: case DIARIO_ALA: case DIARIO_DICA: return COMANDO_PLANEJAR;
+    case DIARIO_ACUSAR: return COMANDO_ACUSAR;
+    default: return -1;
+    }
+}
+
+int reproduzirDiario(Caso* caso, const char* arquivo) {
+    FILE* f = fopen(arquivo, "rb");
+    char magico[4];
+    char texto[MAX_PISTA];
+    size_t capacidade = tamanhoMaximoSessao(caso);
+    unsigned char* estado;
+    PlanejadorRotas planejador;
+    PlanejadorEvidencias evidencias;
+    Sessao sessao;
+    int sessoes = 0, ativa = 0, erro = 0;
+    long comandos = 0, comandosTotal = 0;
+
+    if (!f) {
+        fprintf(stderr, "Erro: não foi possível abrir o diário '%s'\n", arquivo);
+        return -1;
+    }
+    if (fread(magico, 1, 4, f) != 4 || memcmp(magico, DIARIO_MAGICO, 4) != 0) {
+        fprintf(stderr, "Erro: '%s' não é um diário do Detective Quest\n", arquivo);
+        fclose(f);
+        return -1;
+    }
+    estado = (unsigned char*) malloc(capacidade);
+    if (!estado) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o diário\n");
+        exit(EXIT_FAILURE);
+    }
+    iniciarPlanejador(&planejador, caso);
+    iniciarPlanejadorEvidencias(&evidencias, caso, &planejador);
+
+    long long inicio = agoraMs();
+    int c;
+    while (!erro && (c = fgetc(f)) != EOF) {
+        unsigned long long v;
+        int codigo = c & 7;
+
+        if ((c >> 3) == 31 && !lerVarint(f, &v)) { erro = 1; break; }
+        if (codigo == DIARIO_EXTENSAO) {
+            int ext = fgetc(f);
+            if (ext == EOF) { erro = 1; break; }
+            codigo = DIARIO_EXTENSAO + ext;
+        }
+
+        texto[0] = '\0';
+        if (diarioTemTexto(codigo)) {
+            if (!lerVarint(f, &v) || v >= sizeof(texto) || fread(texto, 1, (size_t)v, f) != v) {
+                erro = 1;
+                break;
+            }
+            texto[v] = '\0';
+        }
+        long long porta = -1;
+        if (codigo == DIARIO_PORTA) {
+            if (!lerVarint(f, &v)) { erro = 1; break; }
+            porta = v > (unsigned long long)INT32_MAX ? -1 : (long long)v - 1;
+        }
+
+        if (codigo == DIARIO_INICIO) {
+            if (!lerVarint(f, &v) || v > capacidade || fread(estado, 1, (size_t)v, f) != v) {
+                erro = 1;
+                break;
+            }
+            if (ativa) {
+                resumirReproducao(sessoes, &sessao, comandos);
+                liberarSessao(&sessao);
+            }
+            ativa = iniciarSessao(&sessao, caso) == SESSAO_OK;
+            int status = ativa ? desserializarSessao(caso, &sessao, estado, (size_t)v) : SESSAO_ERRO_MEMORIA;
+            if (status != SESSAO_OK) {
+                fprintf(stderr, status == SESSAO_ERRO_MEMORIA ? "Erro: sem memória para reproduzir a sessão\n"
+                                                              : "Erro: diário gravado para outro caso\n");
+                erro = 1;
+                break;
+            }
+            entrarNaSala(caso, &sessao, sessao.atual);
+            sessoes++;
+            comandos = 0;
+            continue;
+        }
+        if (!ativa) { erro = 1; break; }
+        comandos++;
+        comandosTotal++;
+
+        /* Mesma lógica da partida interativa, sem nenhuma saída na tela */
+        long long inicioComandoAtual = inicioComando();
+        switch (codigo) {
+        case DIARIO_ESQUERDA: moverSessao(caso, &sessao, 'e'); break;
+        case DIARIO_DIREITA:  moverSessao(caso, &sessao, 'd'); break;
+        case DIARIO_VOLTAR:   voltarSessao(caso, &sessao); break;
+        case DIARIO_ULTIMO_RAMO: irUltimoRamo(caso, &sessao); break;
+        case DIARIO_IR_PARA:  irParaSala(caso, &sessao, &planejador, texto); break;
+        case DIARIO_ROTA:     buscarSala(caso, texto); break;
+        case DIARIO_PORTA:    atravessarPorta(caso, &sessao, (int)porta); break;
+        case DIARIO_PORTA_TEXTO: atravessarPorta(caso, &sessao, atoi(texto)); break;
+        case DIARIO_ALA: {
+            Sala* pendentes[PISTAS_POR_PAGINA];
+            listarPendentesNaAla(caso, &sessao.alas, sessao.atual, pendentes, PISTAS_POR_PAGINA);
+            break;
+        }
+        case DIARIO_LISTAR: {
+            int n = 0;
+            retomarIteradorPistas(&sessao.listagem, sessao.pistas);
+            while (n < PISTAS_POR_PAGINA && proximaPista(&sessao.listagem)) n++;
+            if (n < PISTAS_POR_PAGINA) iniciarIteradorPistas(&sessao.listagem, NULL, NULL);
+            break;
+        }
+        case DIARIO_PREFIXO: {
+            const char* achadas[PISTAS_POR_PAGINA];
+            char completo[MAX_PISTA];
+            completarPrefixo(caso->prefixos, texto, completo, sizeof(completo));
+            listarPorPrefixo(caso->prefixos, texto, achadas, PISTAS_POR_PAGINA);
+            break;
+        }
+        case DIARIO_PALAVRAS: {
+            int ids[PISTAS_POR_PAGINA];
+            buscarPorPalavras(caso->palavras, texto, ids, PISTAS_POR_PAGINA);
+            break;
+        }
+        case DIARIO_DICA: {
+            NoBK* suspeito = texto[0] ? resolverSuspeito(caso, texto, NULL) : NULL;
+            for (int s = 0; s < caso->totalSuspeitos; ++s)
+                if (!texto[0] || (suspeito && suspeito->id == s))
+                    planejarEvidencias(&evidencias, &sessao, s, PISTAS_PARA_CONDENAR, NULL, 0, NULL);
+            break;
+        }
+        case DIARIO_ACUSAR: avaliarAcusacao(caso, &sessao, texto); break;
+        default: break;     /* sair, gravar, oráculo, tecla inválida: sem efeito no estado */
+        }
+        if (comandoDoDiario(codigo) >= 0) registrarComando(comandoDoDiario(codigo), inicioComandoAtual);
+    }
+    long long duracao = agoraMs() - inicio;
+
+    if (ativa) {
+        resumirReproducao(sessoes, &sessao, comandos);
+        liberarSessao(&sessao);
+    }
+    free(estado);
+    liberarPlanejadorEvidencias(&evidencias);
+    liberarPlanejador(&planejador);
+    fclose(f);
+    if (erro) {
+        fprintf(stderr, "Erro: diário '%s' truncado ou corrompido\n", arquivo);
+        return -1;
+    }
+    printf("Reproduzidos %ld comando(s) de %d sessão(ões) em %lld ms.\n", comandosTotal, sessoes, duracao);
+    return sessoes;
+}
+
+/* ----------------- Ancestral comum e distâncias (LCA) ----------------- */
+
+/* floor(log2(x)) para x >= 1 */
+static int log2Inteiro(unsigned int x) {
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(x);
+#else
+    int k = 0;
+    while (x >>= 1) k++;
+    return k;
+#endif
+}
+
+void construirIndiceLCA(IndiceLCA* indice, const Caso* caso) {
+    int n = caso->totalSalas;
+
+    indice->totalSalas = n;
+    indice->totalNiveis = n > 0 ? log2Inteiro((unsigned int)n) + 1 : 0;
+    indice->niveis = (uint64_t**) calloc((size_t)indice->totalNiveis + 1, sizeof(uint64_t*));
+    indice->profundidades = (int*) malloc(sizeof(int) * (size_t)(n + 1));
+    if (!indice->niveis || !indice->profundidades) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o índice de LCA\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int k = 0; k < indice->totalNiveis; ++k) {
+        int largura = n - (1 << k) + 1;
+        uint64_t* nivel = (uint64_t*) malloc(sizeof(uint64_t) * (size_t)largura);
+        if (!nivel) {
+            fprintf(stderr, "Erro: falha na alocação de memória para o índice de LCA\n");
+            exit(EXIT_FAILURE);
+        }
+        indice->niveis[k] = nivel;
+
+        if (k == 0) {
+            for (int id = 0; id < n; ++id) {
+                const Sala* s = caso->salasPorId[id];
+                indice->profundidades[id] = s->profundidade;
+                nivel[id] = (uint64_t)s->profundidade << 32 | (uint32_t)(s->pai ? s->pai->id : id);
+            }
+        } else {
+            const uint64_t* anterior = indice->niveis[k - 1];
+            int meio = 1 << (k - 1);
+            for (int i = 0; i < largura; ++i)
+                nivel[i] = anterior[i] < anterior[i + meio] ? anterior[i] : anterior[i + meio];
+        }
+    }
+}
+
+void liberarIndiceLCA(IndiceLCA* indice) {
+    for (int k = 0; k < indice->totalNiveis; ++k) free(indice->niveis[k]);
+    free(indice->niveis);
+    free(indice->profundidades);
+    indice->niveis = NULL;
+    indice->profundidades = NULL;
+    indice->totalNiveis = indice->totalSalas = 0;
+}
+
+int ancestralComum(const IndiceLCA* indice, int a, int b) {
+    if (a == b) return a;
+    if (a > b) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+
+    /* Intervalo (a, b] coberto por dois blocos de 2^k que se sobrepõem */
+    int k = log2Inteiro((unsigned int)(b - a));
+    uint64_t x = indice->niveis[k][a + 1];
+    uint64_t y = indice->niveis[k][b - (1 << k) + 1];
+    return (int)(uint32_t)(x < y ? x : y);
+}
+
+int distanciaEntreSalas(const IndiceLCA* indice, int a, int b) {
+    int c = ancestralComum(indice, a, b);
+    return indice->profundidades[a] + indice->profundidades[b] - 2 * indice->profundidades[c];
+}
+
+typedef struct {
+    const IndiceLCA* indice;
+    ConsultaLCA* consultas;
+} LoteLCA;
+
+static void responderFaixaLCA(void* arg, long inicio, long fim) {
+    LoteLCA* lote = (LoteLCA*) arg;
+    const IndiceLCA* indice = lote->indice;
+
+    for (long i = inicio; i < fim; ++i) {
+        ConsultaLCA* q = &lote->consultas[i];
+        q->ancestral = ancestralComum(indice, q->a, q->b);
+        q->distancia = indice->profundidades[q->a] + indice->profundidades[q->b]
+                     - 2 * indice->profundidades[q->ancestral];
+    }
+}
+
+void responderConsultasLCA(const IndiceLCA* indice, ConsultaLCA* consultas, long total, int threads) {
+    LoteLCA lote = { indice, consultas };
+
+    /* Lotes pequenos (ou uma thread pedida) ficam na thread chamadora */
+    if (threads == 1 || total <= 4096) responderFaixaLCA(&lote, 0, total);
+    else paraCadaParalelo(escalonadorGlobal(), 0, total, 4096, responderFaixaLCA, &lote);
+}
+
+int numeroDeNucleos(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+/* ----------------- Escalonador de tarefas (work stealing) ----------------- */
+
+/* Trabalhador que a thread atual representa (NULL fora de qualquer escalonador) */
+static _Thread_local Trabalhador* trabalhadorDaThread = NULL;
+
+static long long agoraNs(void) {
+#ifdef _WIN32
+    return agoraMs() * 1000000LL;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/* Estatística escrita só pelo dono; relaxed basta para ser lida por outra thread */
+static void somarEstatistica(atomic_llong* contador, long long valor) {
+    atomic_fetch_add_explicit(contador, valor, memory_order_relaxed);
+}
+
+static VetorDeque* criarVetorDeque(long capacidade) {
+    VetorDeque* v = (VetorDeque*) malloc(sizeof(VetorDeque) + sizeof(_Atomic(Tarefa*)) * (size_t)capacidade);
+    if (!v) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o deque de tarefas\n");
+        exit(EXIT_FAILURE);
+    }
+    v->capacidade = capacidade;
+    v->anterior = NULL;
+    for (long i = 0; i < capacidade; ++i) atomic_init(&v->itens[i], NULL);
+    return v;
+}
+
+/* Dono: empilha na base; o buffer dobra quando enche (o antigo fica para os ladrões atrasados) */
+static void empilharNoDeque(DequeTarefas* deque, Tarefa* tarefa) {
+    long b = atomic_load_explicit(&deque->base, memory_order_relaxed);
+    long t = atomic_load_explicit(&deque->topo, memory_order_acquire);
+    VetorDeque* v = atomic_load_explicit(&deque->vetor, memory_order_relaxed);
+
+    if (b - t > v->capacidade - 1) {
+        VetorDeque* maior = criarVetorDeque(v->capacidade * 2);
+        for (long i = t; i < b; ++i)
+            atomic_store_explicit(&maior->itens[i & (maior->capacidade - 1)],
+                                  atomic_load_explicit(&v->itens[i & (v->capacidade - 1)], memory_order_relaxed),
+                                  memory_order_relaxed);
+        maior->anterior = v;
+        atomic_store_explicit(&deque->vetor, maior, memory_order_release);
+        v = maior;
+    }
+    atomic_store_explicit(&v->itens[b & (v->capacidade - 1)], tarefa, memory_order_relaxed);
+    atomic_store_explicit(&deque->base, b + 1, memory_order_release);   /* publica a tarefa para os ladrões */
+}
+
+/* Dono: desempilha da base (LIFO: a tarefa mais recente, ainda quente no cache) */
+static Tarefa* desempilharDoDeque(DequeTarefas* deque) {
+    long b = atomic_load_explicit(&deque->base, memory_order_relaxed) - 1;
+    VetorDeque* v = atomic_load_explicit(&deque->vetor, memory_order_relaxed);
+    atomic_store_explicit(&deque->base, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&deque->topo, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&deque->base, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    Tarefa* tarefa = atomic_load_explicit(&v->itens[b & (v->capacidade - 1)], memory_order_relaxed);
+    if (t == b) {
+        /* Último item: disputa o topo com os ladrões */
+        if (!atomic_compare_exchange_strong_explicit(&deque->topo, &t, t + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed))
+            tarefa = NULL;
+        atomic_store_explicit(&deque->base, b + 1, memory_order_relaxed);
+    }
+    return tarefa;
+}
+
+/* Ladrão: tira do topo (a tarefa mais antiga, em geral a maior fatia que sobrou) */
+static Tarefa* roubarDoDeque(DequeTarefas* deque) {
+    long t = atomic_load_explicit(&deque->topo, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&deque->base, memory_order_acquire);
+
+    if (t >= b) return NULL;
+    VetorDeque* v = atomic_load_explicit(&deque->vetor, memory_order_acquire);
+    Tarefa* tarefa = atomic_load_explicit(&v->itens[t & (v->capacidade - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->topo, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed))
+        return NULL;   /* outro ladrão (ou o dono) levou */
+    return tarefa;
+}
+
+/* Uma rodada de roubo: todos os outros deques, a partir de uma vítima sorteada */
+static Tarefa* roubarTarefa(Trabalhador* ladrao) {
+    Escalonador* e = ladrao->escalonador;
+    if (e->total < 2) return NULL;
+
+    ladrao->sorteio ^= ladrao->sorteio << 13;
+    ladrao->sorteio ^= ladrao->sorteio >> 7;
+    ladrao->sorteio ^= ladrao->sorteio << 17;
+    int inicio = (int)(ladrao->sorteio % (uint64_t)e->total);
+    for (int k = 0; k < e->total; ++k) {
+        int vitima = (inicio + k) % e->total;
+        if (vitima == ladrao->indice) continue;
+        Tarefa* tarefa = roubarDoDeque(&e->trabalhadores[vitima].deque);
+        if (tarefa) {
+            somarEstatistica(&ladrao->roubos, 1);
+            return tarefa;
+        }
+    }
+    somarEstatistica(&ladrao->roubosFalhos, 1);
+    return NULL;
+}
+
+static Tarefa* procurarTarefa(Trabalhador* w) {
+    Tarefa* tarefa = desempilharDoDeque(&w->deque);
+    return tarefa ? tarefa : roubarTarefa(w);
+}
+
+static void executarTarefa(Trabalhador* w, Tarefa* tarefa) {
+    GrupoTarefas* grupo = tarefa->grupo;
+    tarefa->executar(tarefa->arg);
+    somarEstatistica(&w->tarefas, 1);
+    /* Último acesso: a tarefa vive na pilha de quem espera no join */
+    atomic_fetch_sub_explicit(&grupo->pendentes, 1, memory_order_release);
+}
+
+static int haTarefaVisivel(Escalonador* e) {
+    for (int i = 0; i < e->total; ++i)
+        if (atomic_load(&e->trabalhadores[i].deque.base) > atomic_load(&e->trabalhadores[i].deque.topo)) return 1;
+    return 0;
+}
+
+/* Depois de empilhar: acorda um trabalhador dormindo (a cerca casa com o incremento de `dormindo`) */
+static void avisarTrabalhadores(Escalonador* e) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&e->dormindo) == 0) return;
+    pthread_mutex_lock(&e->trava);
+    pthread_cond_signal(&e->acordar);
+    pthread_mutex_unlock(&e->trava);
+}
+
+static void* executarTrabalhador(void* arg) {
+    Trabalhador* w = (Trabalhador*) arg;
+    Escalonador* e = w->escalonador;
+
+    trabalhadorDaThread = w;
+    while (!atomic_load_explicit(&e->encerrar, memory_order_acquire)) {
+        Tarefa* tarefa = procurarTarefa(w);
+        if (tarefa) {
+            executarTarefa(w, tarefa);
+            continue;
+        }
+
+        /* Sem trabalho: mais algumas rodadas de roubo e depois dorme até alguém bifurcar */
+        long long inicio = agoraNs();
+        for (int r = 0; r < ESCALONADOR_RODADAS_OCIOSAS && !tarefa; ++r) {
+            sched_yield();
+            tarefa = roubarTarefa(w);
+        }
+        if (!tarefa) {
+            pthread_mutex_lock(&e->trava);
+            atomic_fetch_add(&e->dormindo, 1);
+            if (!haTarefaVisivel(e) && !atomic_load(&e->encerrar)) pthread_cond_wait(&e->acordar, &e->trava);
+            atomic_fetch_sub(&e->dormindo, 1);
+            pthread_mutex_unlock(&e->trava);
+        }
+        somarEstatistica(&w->ociosoNs, agoraNs() - inicio);
+        if (tarefa) executarTarefa(w, tarefa);
+    }
+    trabalhadorDaThread = NULL;
+    return NULL;
+}
+
+void iniciarEscalonador(Escalonador* escalonador, int trabalhadores) {
+    if (trabalhadores <= 0) trabalhadores = numeroDeNucleos();
+    escalonador->total = trabalhadores;
+    escalonador->trabalhadores = (Trabalhador*) aligned_alloc(_Alignof(Trabalhador),
+                                                              sizeof(Trabalhador) * (size_t)trabalhadores);
+    if (!escalonador->trabalhadores) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o escalonador\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&escalonador->encerrar, 0);
+    atomic_init(&escalonador->dormindo, 0);
+    pthread_mutex_init(&escalonador->trava, NULL);
+    pthread_cond_init(&escalonador->acordar, NULL);
+    pthread_mutex_init(&escalonador->entrada, NULL);
+
+    for (int i = 0; i < trabalhadores; ++i) {
+        Trabalhador* w = &escalonador->trabalhadores[i];
+        atomic_init(&w->deque.topo, 0);
+        atomic_init(&w->deque.base, 0);
+        atomic_init(&w->deque.vetor, criarVetorDeque(ESCALONADOR_CAPACIDADE_DEQUE));
+        w->escalonador = escalonador;
+        w->indice = i;
+        w->sorteio = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+        w->criada = 0;
+        atomic_init(&w->tarefas, 0);
+        atomic_init(&w->roubos, 0);
+        atomic_init(&w->roubosFalhos, 0);
+        atomic_init(&w->ociosoNs, 0);
+    }
+    /* Thread que não sobe só deixa o seu deque vazio: os outros fazem o trabalho */
+    for (int i = 1; i < trabalhadores; ++i) {
+        Trabalhador* w = &escalonador->trabalhadores[i];
+        w->criada = pthread_create(&w->thread, NULL, executarTrabalhador, w) == 0;
+    }
+}
+
+void encerrarEscalonador(Escalonador* escalonador) {
+    atomic_store(&escalonador->encerrar, 1);
+    pthread_mutex_lock(&escalonador->trava);
+    pthread_cond_broadcast(&escalonador->acordar);
+    pthread_mutex_unlock(&escalonador->trava);
+
+    for (int i = 0; i < escalonador->total; ++i) {
+        Trabalhador* w = &escalonador->trabalhadores[i];
+        if (w->criada) pthread_join(w->thread, NULL);
+        VetorDeque* v = atomic_load(&w->deque.vetor);
+        while (v) {
+            VetorDeque* anterior = v->anterior;
+            free(v);
+            v = anterior;
+        }
+    }
+    pthread_mutex_destroy(&escalonador->trava);
+    pthread_cond_destroy(&escalonador->acordar);
+    pthread_mutex_destroy(&escalonador->entrada);
+    free(escalonador->trabalhadores);
+    escalonador->trabalhadores = NULL;
+    escalonador->total = 0;
+}
+
+static Escalonador escalonadorProcesso;
+static pthread_once_t escalonadorProcessoIniciado = PTHREAD_ONCE_INIT;
+
+static void iniciarEscalonadorProcesso(void) {
+    iniciarEscalonador(&escalonadorProcesso, 0);
+}
+
+/* Vive até o fim do processo (as threads dormem quando não há tarefa) */
+Escalonador* escalonadorGlobal(void) {
+    pthread_once(&escalonadorProcessoIniciado, iniciarEscalonadorProcesso);
+    return &escalonadorProcesso;
+}
+
+void executarNoEscalonador(Escalonador* escalonador, void (*raiz)(void* arg), void* arg) {
+    if (trabalhadorDaThread) {
+        raiz(arg);
+        return;
+    }
+    pthread_mutex_lock(&escalonador->entrada);
+    trabalhadorDaThread = &escalonador->trabalhadores[0];
+    raiz(arg);
+    trabalhadorDaThread = NULL;
+    pthread_mutex_unlock(&escalonador->entrada);
+}
+
+void iniciarGrupoTarefas(GrupoTarefas* grupo) {
+    atomic_init(&grupo->pendentes, 0);
+}
+
+void bifurcarTarefa(GrupoTarefas* grupo, Tarefa* tarefa) {
+    Trabalhador* w = trabalhadorDaThread;
+    if (!w) {
+        tarefa->executar(tarefa->arg);   /* fora do escalonador: sem paralelismo */
+        return;
+    }
+    tarefa->grupo = grupo;
+    atomic_fetch_add_explicit(&grupo->pendentes, 1, memory_order_relaxed);
+    empilharNoDeque(&w->deque, tarefa);
+    avisarTrabalhadores(w->escalonador);
+}
+
+void juntarTarefas(GrupoTarefas* grupo) {
+    Trabalhador* w = trabalhadorDaThread;
+
+    /* Enquanto espera, trabalha: primeiro no próprio deque, depois roubando */
+    while (atomic_load_explicit(&grupo->pendentes, memory_order_acquire) > 0) {
+        Tarefa* tarefa = procurarTarefa(w);
+        if (tarefa) {
+            executarTarefa(w, tarefa);
+            continue;
+        }
+        long long inicio = agoraNs();
+        sched_yield();
+        somarEstatistica(&w->ociosoNs, agoraNs() - inicio);
+    }
+}
+
+int trabalhadorAtual(void) {
+    return trabalhadorDaThread ? trabalhadorDaThread->indice : -1;
+}
+
+typedef struct {
+    long inicio, fim, grao;
+    void (*corpo)(void* arg, long de, long ate);
+    void* arg;
+} FaixaParalela;
+
+static void dividirFaixa(void* arg) {
+    FaixaParalela* faixa = (FaixaParalela*) arg;
+
+    if (faixa->fim - faixa->inicio <= faixa->grao) {
+        faixa->corpo(faixa->arg, faixa->inicio, faixa->fim);
+        return;
+    }
+    FaixaParalela esquerda = *faixa, direita = *faixa;
+    esquerda.fim = direita.inicio = faixa->inicio + (faixa->fim - faixa->inicio) / 2;
+
+    GrupoTarefas grupo;
+    Tarefa tarefa = { dividirFaixa, &direita, NULL };
+    iniciarGrupoTarefas(&grupo);
+    bifurcarTarefa(&grupo, &tarefa);
+    dividirFaixa(&esquerda);
+    juntarTarefas(&grupo);
+}
+
+void paraCadaParalelo(Escalonador* escalonador, long inicio, long fim, long grao,
+                      void (*corpo)(void* arg, long de, long ate), void* arg) {
+    if (fim <= inicio) return;
+    FaixaParalela faixa = { inicio, fim, grao < 1 ? 1 : grao, corpo, arg };
+    executarNoEscalonador(escalonador, dividirFaixa, &faixa);
+}
+
+typedef struct {
+    Sala* sala;
+    int (*visitar)(Sala* sala, void* arg);
+    void* arg;
+    int corte;
+} VisitaSalas;
+
+/* Pré-ordem sem pilha (sobe pelos ponteiros `pai`): a planta pode ser uma corrente de 1M salas */
+static void visitarSalasSequencial(Sala* raiz, const VisitaSalas* visita) {
+    Sala* s = raiz;
+    while (s) {
+        int descer = visita->visitar(s, visita->arg);
+        if (descer && s->esquerda) {
+            s = s->esquerda;
+            continue;
+        }
+        if (descer && s->direita) {
+            s = s->direita;
+            continue;
+        }
+        while (s != raiz && !(s == s->pai->esquerda && s->pai->direita)) s = s->pai;
+        s = s == raiz ? NULL : s->pai->direita;
+    }
+}
+
+/* Desce pelo filho maior; o menor vira tarefa se tiver ao menos `corte` salas */
+static void visitarSubarvoreSalas(void* arg) {
+    const VisitaSalas* visita = (const VisitaSalas*) arg;
+    int maximo = visita->sala->tamanhoAla / visita->corte + 1;
+    VisitaSalas* filhos = (VisitaSalas*) malloc(sizeof(VisitaSalas) * (size_t)maximo);
+    Tarefa* tarefas = (Tarefa*) malloc(sizeof(Tarefa) * (size_t)maximo);
+    GrupoTarefas grupo;
+    int total = 0;
+
+    if (!filhos || !tarefas) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a visita paralela\n");
+        exit(EXIT_FAILURE);
+    }
+    iniciarGrupoTarefas(&grupo);
+    for (Sala* s = visita->sala; s;) {
+        if (s->tamanhoAla < visita->corte) {
+            visitarSalasSequencial(s, visita);
+            break;
+        }
+        if (!visita->visitar(s, visita->arg)) break;
+        Sala* maior = s->esquerda;
+        Sala* menor = s->direita;
+        if (!maior || (menor && menor->tamanhoAla > maior->tamanhoAla)) {
+            maior = s->direita;
+            menor = s->esquerda;
+        }
+        if (menor && menor->tamanhoAla >= visita->corte) {
+            filhos[total] = *visita;
+            filhos[total].sala = menor;
+            tarefas[total].executar = visitarSubarvoreSalas;
+            tarefas[total].arg = &filhos[total];
+            bifurcarTarefa(&grupo, &tarefas[total]);
+            total++;
+        } else if (menor) {
+            visitarSalasSequencial(menor, visita);
+        }
+        s = maior;
+    }
+    juntarTarefas(&grupo);
+    free(filhos);
+    free(tarefas);
+}
+
+void visitarSalasParalelo(Escalonador* escalonador, Sala* raiz, int (*visitar)(Sala* sala, void* arg), void* arg,
+                          int corte) {
+    if (!raiz) return;
+    VisitaSalas visita = { raiz, visitar, arg, corte > 0 ? corte : ESCALONADOR_CORTE_ARVORE };
+    executarNoEscalonador(escalonador, visitarSubarvoreSalas, &visita);
+}
+
+typedef struct {
+    PistaNode* no;
+    int (*visitar)(PistaNode* no, void* arg);
+    void* arg;
+    int corte;
+} VisitaPistas;
+
+/* A BST é AVL (altura ~1.44 log n), então a recursão direta é segura */
+static void visitarSubarvorePistas(void* arg) {
+    const VisitaPistas* visita = (const VisitaPistas*) arg;
+    PistaNode* no = visita->no;
+
+    if (!no || !visita->visitar(no, visita->arg)) return;
+    VisitaPistas esquerda = *visita, direita = *visita;
+    esquerda.no = no->esquerda;
+    direita.no = no->direita;
+    if (no->esquerda && no->direita && no->esquerda->tamanho >= visita->corte) {
+        GrupoTarefas grupo;
+        Tarefa tarefa = { visitarSubarvorePistas, &esquerda, NULL };
+        iniciarGrupoTarefas(&grupo);
+        bifurcarTarefa(&grupo, &tarefa);
+        visitarSubarvorePistas(&direita);
+        juntarTarefas(&grupo);
+    } else {
+        visitarSubarvorePistas(&esquerda);
+        visitarSubarvorePistas(&direita);
+    }
+}
+
+void visitarPistasParalelo(Escalonador* escalonador, PistaNode* raiz, int (*visitar)(PistaNode* no, void* arg),
+                           void* arg, int corte) {
+    if (!raiz) return;
+    VisitaPistas visita = { raiz, visitar, arg, corte > 0 ? corte : ESCALONADOR_CORTE_ARVORE };
+    executarNoEscalonador(escalonador, visitarSubarvorePistas, &visita);
+}
+
+void zerarEstatisticasEscalonador(Escalonador* escalonador) {
+    for (int i = 0; i < escalonador->total; ++i) {
+        Trabalhador* w = &escalonador->trabalhadores[i];
+        atomic_store(&w->tarefas, 0);
+        atomic_store(&w->roubos, 0);
+        atomic_store(&w->roubosFalhos, 0);
+        atomic_store(&w->ociosoNs, 0);
+    }
+}
+
+void exibirEstatisticasEscalonador(Escalonador* escalonador) {
+    printf("  Trabalhador     Tarefas     Roubos     Falhas   Ocioso (ms)\n");
+    for (int i = 0; i < escalonador->total; ++i) {
+        Trabalhador* w = &escalonador->trabalhadores[i];
+        printf("  %11d %11lld %10lld %10lld %13.1f%s\n", i, (long long)atomic_load(&w->tarefas),
+               (long long)atomic_load(&w->roubos), (long long)atomic_load(&w->roubosFalhos),
+               (double)atomic_load(&w->ociosoNs) / 1e6, i == 0 ? "  (thread chamadora)" : "");
+    }
+}
+
+/* ----------------- Conjunto concorrente de pistas (skiplist) ----------------- */
+
+/* Altura do nó sorteada pelo hash do texto (p = 1/2 por nível): a forma da
+ * lista não depende da ordem nem da thread das inserções */
+static int niveisDaPista(const char* pista) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char* c = (const unsigned char*) pista; *c; ++c) h = (h ^ *c) * 1099511628211ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    int niveis = 1;
+    while ((h & 1) && niveis < CONJUNTO_MAX_NIVEIS) {
+        niveis++;
+        h >>= 1;
+    }
+    return niveis;
+}
+
+static NoConjunto* criarNoConjunto(const char* pista, int niveis) {
+    size_t tamanho = pista ? strlen(pista) + 1 : 0;
+    NoConjunto* no = (NoConjunto*) malloc(sizeof(NoConjunto) + sizeof(_Atomic(NoConjunto*)) * (size_t)niveis + tamanho);
+
+    if (!no) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o conjunto de pistas\n");
+        exit(EXIT_FAILURE);
+    }
+    no->niveis = niveis;
+    no->pista = NULL;
+    for (int l = 0; l < niveis; ++l) atomic_init(&no->proximo[l], NULL);
+    if (pista) {
+        char* texto = (char*) &no->proximo[niveis];
+        memcpy(texto, pista, tamanho);
+        no->pista = texto;
+    }
+    return no;
+}
+
+/* Anda no nível a partir de *anterior até o primeiro nó >= pista; *anterior fica no último < pista */
+static NoConjunto* avancarNoConjunto(NoConjunto** anterior, int nivel, const char* pista) {
+    NoConjunto* atual = atomic_load_explicit(&(*anterior)->proximo[nivel], memory_order_acquire);
+    while (atual && strcmp(atual->pista, pista) < 0) {
+        *anterior = atual;
+        atual = atomic_load_explicit(&atual->proximo[nivel], memory_order_acquire);
+    }
+    return atual;
+}
+
+void iniciarConjuntoPistas(ConjuntoPistas* conjunto) {
+    conjunto->cabeca = criarNoConjunto(NULL, CONJUNTO_MAX_NIVEIS);
+}
+
+void liberarConjuntoPistas(ConjuntoPistas* conjunto) {
+    NoConjunto* no = conjunto->cabeca;
+    while (no) {
+        NoConjunto* proximo = atomic_load_explicit(&no->proximo[0], memory_order_relaxed);
+        free(no);
+        no = proximo;
+    }
+    conjunto->cabeca = NULL;
+}
+
+int inserirNoConjuntoPistas(ConjuntoPistas* conjunto, const char* pista) {
+    NoConjunto* antes[CONJUNTO_MAX_NIVEIS];
+    NoConjunto* depois[CONJUNTO_MAX_NIVEIS];
+    NoConjunto* anterior = conjunto->cabeca;
+
+    for (int l = CONJUNTO_MAX_NIVEIS - 1; l >= 0; --l) {
+        depois[l] = avancarNoConjunto(&anterior, l, pista);
+        antes[l] = anterior;
+    }
+    if (depois[0] && strcmp(depois[0]->pista, pista) == 0) return 0;
+
+    int niveis = niveisDaPista(pista);
+    NoConjunto* no = criarNoConjunto(pista, niveis);
+
+    /* Nível 0: o CAS publica o nó (release) e decide quem inseriu; quem perde para
+     * a mesma pista descarta o próprio nó, que ninguém chegou a ver */
+    for (;;) {
+        atomic_store_explicit(&no->proximo[0], depois[0], memory_order_relaxed);
+        if (atomic_compare_exchange_strong_explicit(&antes[0]->proximo[0], &depois[0], no,
+                                                    memory_order_release, memory_order_relaxed))
+            break;
+        depois[0] = avancarNoConjunto(&antes[0], 0, pista);
+        if (depois[0] && strcmp(depois[0]->pista, pista) == 0) {
+            free(no);
+            return 0;
+        }
+    }
+
+    /* Atalhos, de baixo para cima: o nó só é alcançável no nível l depois de estar em l - 1 */
+    for (int l = 1; l < niveis; ++l) {
+        for (;;) {
+            atomic_store_explicit(&no->proximo[l], depois[l], memory_order_relaxed);
+            if (atomic_compare_exchange_strong_explicit(&antes[l]->proximo[l], &depois[l], no,
+                                                        memory_order_release, memory_order_relaxed))
+                break;
+            depois[l] = avancarNoConjunto(&antes[l], l, pista);
+        }
+    }
+    return 1;
+}
+
+int conjuntoContemPista(const ConjuntoPistas* conjunto, const char* pista) {
+    NoConjunto* anterior = conjunto->cabeca;
+    NoConjunto* atual = NULL;
+
+    for (int l = CONJUNTO_MAX_NIVEIS - 1; l >= 0; --l) atual = avancarNoConjunto(&anterior, l, pista);
+    return atual && strcmp(atual->pista, pista) == 0;
+}
+
+const char** fotografarConjuntoPistas(const ConjuntoPistas* conjunto, long* total) {
+    long capacidade = 64, n = 0;
+    const char** lista = (const char**) malloc(sizeof(const char*) * (size_t)capacidade);
+
+    if (!lista) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o conjunto de pistas\n");
+        exit(EXIT_FAILURE);
+    }
+    for (NoConjunto* no = atomic_load_explicit(&conjunto->cabeca->proximo[0], memory_order_acquire); no;
+         no = atomic_load_explicit(&no->proximo[0], memory_order_acquire)) {
+        if (n == capacidade) {
+            capacidade *= 2;
+            const char** maior = (const char**) realloc(lista, sizeof(const char*) * (size_t)capacidade);
+            if (!maior) {
+                fprintf(stderr, "Erro: falha na alocação de memória para o conjunto de pistas\n");
+                exit(EXIT_FAILURE);
+            }
+            lista = maior;
+        }
+        lista[n++] = no->pista;
+    }
+    *total = n;
+    return lista;
+}
+
+void exibirConjuntoPistas(const ConjuntoPistas* conjunto) {
+    long total;
+    const char** lista = fotografarConjuntoPistas(conjunto, &total);
+    for (long i = 0; i < total; ++i) printf("- %s\n", lista[i]);
+    free(lista);
+}
+
+/* ----------------- RCU e tabela de suspeitos concorrente ----------------- */
+
+/* Fatia de contadores da thread: sorteada em rodízio no primeiro uso */
+static _Thread_local int fatiaRCUDaThread = -1;
+static atomic_int proximaFatiaRCU;
+
+void iniciarDominioRCU(DominioRCU* dominio) {
+    atomic_init(&dominio->paridade, 0);
+    atomic_init(&dominio->periodos, 0);
+    for (int f = 0; f < RCU_FATIAS; ++f) {
+        atomic_init(&dominio->fatias[f].leitores[0], 0);
+        atomic_init(&dominio->fatias[f].leitores[1], 0);
+    }
+}
+
+int entrarLeituraRCU(DominioRCU* dominio) {
+    if (fatiaRCUDaThread < 0)
+        fatiaRCUDaThread = (int)((unsigned)atomic_fetch_add_explicit(&proximaFatiaRCU, 1, memory_order_relaxed) % RCU_FATIAS);
+
+    /* seq_cst: o incremento fica antes, na ordem total, de qualquer leitura de ponteiro da seção */
+    int paridade = atomic_load(&dominio->paridade);
+    atomic_fetch_add(&dominio->fatias[fatiaRCUDaThread].leitores[paridade], 1);
+    return paridade * RCU_FATIAS + fatiaRCUDaThread;
+}
+
+void sairLeituraRCU(DominioRCU* dominio, int marca) {
+    atomic_fetch_sub_explicit(&dominio->fatias[marca % RCU_FATIAS].leitores[marca / RCU_FATIAS], 1,
+                              memory_order_release);
+}
+
+void sincronizarRCU(DominioRCU* dominio) {
+    /* Duas viradas: um leitor que leu a paridade antes da primeira e só incrementou depois
+     * cai na paridade esperada pela segunda (ou já enxerga a publicação nova) */
+    for (int rodada = 0; rodada < 2; ++rodada) {
+        int antiga = atomic_load(&dominio->paridade);
+        atomic_store(&dominio->paridade, antiga ^ 1);
+        for (int f = 0; f < RCU_FATIAS; ++f)
+            while (atomic_load(&dominio->fatias[f].leitores[antiga]) != 0) sched_yield();
+    }
+    atomic_fetch_add_explicit(&dominio->periodos, 1, memory_order_relaxed);
+}
+
+static VersaoTabelaRCU* criarVersaoTabelaRCU(int capacidade) {
+    VersaoTabelaRCU* versao = (VersaoTabelaRCU*) malloc(sizeof(VersaoTabelaRCU) +
+                                                        sizeof(_Atomic(SuspeitoNode*)) * (size_t)capacidade);
+    if (!versao) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a tabela de suspeitos\n");
+        exit(EXIT_FAILURE);
+    }
+    versao->capacidade = capacidade;
+    versao->total = 0;
+    for (int b = 0; b < capacidade; ++b) atomic_init(&versao->baldes[b], NULL);
+    return versao;
+}
+
+static SuspeitoNode* copiarSuspeitoNode(const SuspeitoNode* origem, const char* pista, const char* suspeito,
+                                        SuspeitoNode* prox) {
+    SuspeitoNode* no = (SuspeitoNode*) malloc(sizeof(SuspeitoNode));
+    if (!no) {
+        fprintf(stderr, "Erro: falha na alocação de memória para SuspeitoNode\n");
+        exit(EXIT_FAILURE);
+    }
+    if (origem) *no = *origem;
+    else no->id = no->idSuspeito = -1;
+    if (pista) {
+        strncpy(no->pista, pista, MAX_PISTA - 1);
+        no->pista[MAX_PISTA - 1] = '\0';
+    }
+    if (suspeito) {
+        strncpy(no->suspeito, suspeito, MAX_NOME - 1);
+        no->suspeito[MAX_NOME - 1] = '\0';
+        if (origem && strcmp(origem->suspeito, no->suspeito) != 0) no->idSuspeito = -1;
+    }
+    no->prox = prox;
+    return no;
+}
+
+static int baldeRCU(const VersaoTabelaRCU* versao, const char* pista) {
+    return (int)(acumularAssinatura(2166136261u, pista) & (uint32_t)(versao->capacidade - 1));
+}
+
+static void liberarCadeiaRCU(SuspeitoNode* no) {
+    while (no) {
+        SuspeitoNode* prox = no->prox;
+        free(no);
+        no = prox;
+    }
+}
+
+static void liberarVersaoTabelaRCU(VersaoTabelaRCU* versao) {
+    for (int b = 0; b < versao->capacidade; ++b)
+        liberarCadeiaRCU(atomic_load_explicit(&versao->baldes[b], memory_order_relaxed));
+    free(versao);
+}
+
+/* Copia todas as cadeias para `capacidade` baldes (a versão antiga continua intacta) */
+static VersaoTabelaRCU* redistribuirTabelaRCU(const VersaoTabelaRCU* antiga, int capacidade) {
+    VersaoTabelaRCU* nova = criarVersaoTabelaRCU(capacidade);
+    for (int b = 0; b < antiga->capacidade; ++b)
+        for (SuspeitoNode* no = atomic_load_explicit(&antiga->baldes[b], memory_order_relaxed); no; no = no->prox) {
+            int destino = baldeRCU(nova, no->pista);
+            SuspeitoNode* copia = copiarSuspeitoNode(no, NULL, NULL,
+                                                     atomic_load_explicit(&nova->baldes[destino], memory_order_relaxed));
+            atomic_store_explicit(&nova->baldes[destino], copia, memory_order_relaxed);
+        }
+    nova->total = antiga->total;
+    return nova;
+}
+
+void iniciarTabelaSuspeitosRCU(TabelaSuspeitosRCU* tabela, const Caso* caso) {
+    int capacidade = RCU_CAPACIDADE_MINIMA;
+    int pistas = caso ? caso->totalPistas : 0;
+    while (capacidade * RCU_CARGA_MAXIMA < pistas) capacidade *= 2;
+
+    VersaoTabelaRCU* versao = criarVersaoTabelaRCU(capacidade);
+    for (int p = 0; p < pistas; ++p) {
+        const SuspeitoNode* origem = caso->pistasPorId[p];
+        int b = baldeRCU(versao, origem->pista);
+        SuspeitoNode* no = copiarSuspeitoNode(origem, NULL, NULL, atomic_load_explicit(&versao->baldes[b], memory_order_relaxed));
+        atomic_store_explicit(&versao->baldes[b], no, memory_order_relaxed);
+    }
+    versao->total = pistas;
+
+    atomic_init(&tabela->atual, versao);
+    pthread_mutex_init(&tabela->escrita, NULL);
+    iniciarDominioRCU(&tabela->rcu);
+    tabela->redimensionamentos = 0;
+}
+
+void liberarTabelaSuspeitosRCU(TabelaSuspeitosRCU* tabela) {
+    liberarVersaoTabelaRCU(atomic_load_explicit(&tabela->atual, memory_order_relaxed));
+    atomic_store_explicit(&tabela->atual, NULL, memory_order_relaxed);
+    pthread_mutex_destroy(&tabela->escrita);
+}
+
+/* Busca do lado de quem escreve (com `escrita` travada, nada muda por baixo) */
+static SuspeitoNode* buscarNaVersaoRCU(const VersaoTabelaRCU* versao, const char* pista) {
+    for (SuspeitoNode* no = atomic_load_explicit(&versao->baldes[baldeRCU(versao, pista)], memory_order_relaxed); no;
+         no = no->prox)
+        if (strcmp(no->pista, pista) == 0) return no;
+    return NULL;
+}
+
+/* Troca a cadeia do balde por uma cópia sem `pista` e, se `suspeito` != NULL, com o novo
+ * nó na frente; a cadeia velha só é liberada depois do período de graça */
+static void trocarBaldeRCU(TabelaSuspeitosRCU* tabela, VersaoTabelaRCU* versao, const char* pista,
+                           const char* suspeito) {
+    int b = baldeRCU(versao, pista);
+    SuspeitoNode* velha = atomic_load_explicit(&versao->baldes[b], memory_order_relaxed);
+    SuspeitoNode* nova = NULL;
+    const SuspeitoNode* anterior = NULL;
+
+    for (SuspeitoNode* no = velha; no; no = no->prox) {
+        if (strcmp(no->pista, pista) == 0) anterior = no;
+        else nova = copiarSuspeitoNode(no, NULL, NULL, nova);
+    }
+    if (suspeito) nova = copiarSuspeitoNode(anterior, pista, suspeito, nova);
+    versao->total += (suspeito ? 1 : 0) - (anterior ? 1 : 0);
+
+    atomic_store(&versao->baldes[b], nova);
+    sincronizarRCU(&tabela->rcu);
+    liberarCadeiaRCU(velha);
+}
+
+int publicarSuspeitoRCU(TabelaSuspeitosRCU* tabela, const char* pista, const char* suspeito) {
+    if (!pista || !suspeito) return 0;
+
+    pthread_mutex_lock(&tabela->escrita);
+    VersaoTabelaRCU* versao = atomic_load_explicit(&tabela->atual, memory_order_relaxed);
+    int nova = buscarNaVersaoRCU(versao, pista) == NULL;
+    if (nova && versao->total + 1 > versao->capacidade * RCU_CARGA_MAXIMA) {
+        /* Cresce: a versão nova só fica visível inteira, já com a pista */
+        VersaoTabelaRCU* maior = redistribuirTabelaRCU(versao, versao->capacidade * 2);
+        int b = baldeRCU(maior, pista);
+        SuspeitoNode* no = copiarSuspeitoNode(NULL, pista, suspeito,
+                                              atomic_load_explicit(&maior->baldes[b], memory_order_relaxed));
+        atomic_store_explicit(&maior->baldes[b], no, memory_order_relaxed);
+        maior->total++;
+        atomic_store(&tabela->atual, maior);
+        tabela->redimensionamentos++;
+        sincronizarRCU(&tabela->rcu);
+        liberarVersaoTabelaRCU(versao);
+    } else {
+        trocarBaldeRCU(tabela, versao, pista, suspeito);
+    }
+    pthread_mutex_unlock(&tabela->escrita);
+    return nova;
+}
+
+int removerPistaRCU(TabelaSuspeitosRCU* tabela, const char* pista) {
+    if (!pista) return 0;
+
+    pthread_mutex_lock(&tabela->escrita);
+    VersaoTabelaRCU* versao = atomic_load_explicit(&tabela->atual, memory_order_relaxed);
+    int existia = buscarNaVersaoRCU(versao, pista) != NULL;
+    if (existia) trocarBaldeRCU(tabela, versao, pista, NULL);
+    pthread_mutex_unlock(&tabela->escrita);
+    return existia;
+}
+
+const char* encontrarSuspeitoRCU(TabelaSuspeitosRCU* tabela, const char* pista, char* saida) {
+    strcpy(saida, "Desconhecido");
+    if (!pista) return saida;
+
+    int marca = entrarLeituraRCU(&tabela->rcu);
+    VersaoTabelaRCU* versao = atomic_load(&tabela->atual);
+    for (const SuspeitoNode* no = atomic_load(&versao->baldes[baldeRCU(versao, pista)]); no; no = no->prox)
+        if (strcmp(no->pista, pista) == 0) {
+            memcpy(saida, no->suspeito, MAX_NOME);
+            break;
+        }
+    sairLeituraRCU(&tabela->rcu, marca);
+    return saida;
+}
+
+/* ----------------- Planejador de rotas (grafo de portas) ----------------- */
+
+static void iniciarHeapRadix(HeapRadix* heap) {
+    memset(heap, 0, sizeof(*heap));
+}
+
+static void liberarHeapRadix(HeapRadix* heap) {
+    for (int b = 0; b < 33; ++b) {
+        free(heap->chaves[b]);
+        free(heap->salas[b]);
+    }
+    memset(heap, 0, sizeof(*heap));
+}
+
+static void esvaziarHeapRadix(HeapRadix* heap) {
+    for (int b = 0; b < 33; ++b) heap->tamanho[b] = 0;
+    heap->total = 0;
+    heap->ultima = 0;
+    heap->semMemoria = 0;
+}
+
+/* Balde de uma chave em relação à última retirada */
+static int baldeRadix(const HeapRadix* heap, uint32_t chave) {
+    return chave == heap->ultima ? 0 : log2Inteiro(chave ^ heap->ultima) + 1;
+}
+
+static void inserirHeapRadix(HeapRadix* heap, uint32_t chave, int sala) {
+    int b = baldeRadix(heap, chave);
+    if (heap->tamanho[b] == heap->capacidade[b]) {
+        int nova = heap->capacidade[b] ? heap->capacidade[b] * 2 : 64;
+        uint32_t* c = (uint32_t*) realloc(heap->chaves[b], sizeof(uint32_t) * (size_t)nova);
+        if (c) heap->chaves[b] = c;
+        int* s = (int*) realloc(heap->salas[b], sizeof(int) * (size_t)nova);
+        if (s) heap->salas[b] = s;
+        if (!c || !s) {
+            heap->semMemoria = 1;   /* a entrada se perde; quem busca descarta o resultado */
+            return;
+        }
+        heap->capacidade[b] = nova;
+    }
+    heap->chaves[b][heap->tamanho[b]] = chave;
+    heap->salas[b][heap->tamanho[b]++] = sala;
+    heap->total++;
+}
+
+/* Garante que o balde 0 tenha o mínimo; devolve a menor chave (fila não vazia) */
+static uint32_t topoHeapRadix(HeapRadix* heap) {
+    if (heap->tamanho[0] > 0) return heap->ultima;
+
+    int b = 1;
+    while (heap->tamanho[b] == 0) b++;
+    uint32_t menor = UINT32_MAX;
+    for (int i = 0; i < heap->tamanho[b]; ++i)
+        if (heap->chaves[b][i] < menor) menor = heap->chaves[b][i];
+
+    /* Redistribui o balde: todas as entradas caem para baldes menores */
+    heap->ultima = menor;
+    int n = heap->tamanho[b];
+    heap->tamanho[b] = 0;
+    heap->total -= n;
+    for (int i = 0; i < n; ++i) inserirHeapRadix(heap, heap->chaves[b][i], heap->salas[b][i]);
+    return menor;
+}
+
+static int retirarHeapRadix(HeapRadix* heap, uint32_t* chave) {
+    *chave = topoHeapRadix(heap);
+    heap->total--;
+    return heap->salas[0][--heap->tamanho[0]];
+}
+
+void iniciarPlanejador(PlanejadorRotas* planejador, const Caso* caso) {
+    int n = caso->totalSalas, m = caso->totalPortas;
+
+    planejador->caso = caso;
+    planejador->inicioReverso = (int*) calloc((size_t)n + 1, sizeof(int));
+    planejador->origemReversa = (int*) malloc(sizeof(int) * ((size_t)m + 1));
+    planejador->custoReverso = (uint16_t*) malloc(sizeof(uint16_t) * ((size_t)m + 1));
+    planejador->caminho = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    int* cursor = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    for (int lado = 0; lado < 2; ++lado) {
+        planejador->distancia[lado] = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t)n + 1));
+        planejador->marca[lado] = (uint32_t*) calloc((size_t)n + 1, sizeof(uint32_t));
+        planejador->anterior[lado] = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+        planejador->fila[lado] = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+        if (!planejador->distancia[lado] || !planejador->marca[lado]
+            || !planejador->anterior[lado] || !planejador->fila[lado]) {
+            fprintf(stderr, "Erro: falha na alocação de memória para o planejador de rotas\n");
+            exit(EXIT_FAILURE);
+        }
+        iniciarHeapRadix(&planejador->heaps[lado]);
+    }
+    if (!planejador->inicioReverso || !planejador->origemReversa || !planejador->custoReverso
+        || !planejador->caminho || !cursor) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o planejador de rotas\n");
+        exit(EXIT_FAILURE);
+    }
+    planejador->geracao = 0;
+
+    /* CSR reverso por contagem: portas agrupadas pela sala de chegada */
+    for (int p = 0; p < m; ++p) planejador->inicioReverso[caso->destinoPortas[p] + 1]++;
+    for (int id = 0; id < n; ++id) planejador->inicioReverso[id + 1] += planejador->inicioReverso[id];
+    memcpy(cursor, planejador->inicioReverso, sizeof(int) * (size_t)n);
+    for (int u = 0; u < n; ++u)
+        for (int p = caso->inicioPortas[u]; p < caso->inicioPortas[u + 1]; ++p) {
+            int q = cursor[caso->destinoPortas[p]]++;
+            planejador->origemReversa[q] = u;
+            planejador->custoReverso[q] = caso->custoPortas[p];
+        }
+    free(cursor);
+}
+
+void liberarPlanejador(PlanejadorRotas* planejador) {
+    free(planejador->inicioReverso);
+    free(planejador->origemReversa);
+    free(planejador->custoReverso);
+    free(planejador->caminho);
+    for (int lado = 0; lado < 2; ++lado) {
+        free(planejador->distancia[lado]);
+        free(planejador->marca[lado]);
+        free(planejador->anterior[lado]);
+        free(planejador->fila[lado]);
+        liberarHeapRadix(&planejador->heaps[lado]);
+    }
+    memset(planejador, 0, sizeof(*planejador));
+}
+
+/* Nova consulta: invalida todas as distâncias sem tocar nos vetores */
+static void novaGeracao(PlanejadorRotas* planejador) {
+    if (++planejador->geracao == 0) {
+        for (int lado = 0; lado < 2; ++lado)
+            memset(planejador->marca[lado], 0, sizeof(uint32_t) * ((size_t)planejador->caso->totalSalas + 1));
+        planejador->geracao = 1;
+    }
+}
+
+static int alcancada(const PlanejadorRotas* planejador, int lado, int sala) {
+    return planejador->marca[lado][sala] == planejador->geracao;
+}
+
+static void alcancar(PlanejadorRotas* planejador, int lado, int sala, uint32_t distancia, int anterior) {
+    planejador->marca[lado][sala] = planejador->geracao;
+    planejador->distancia[lado][sala] = distancia;
+    planejador->anterior[lado][sala] = anterior;
+}
+
+/* Remonta origem -> encontro -> destino a partir das duas árvores de busca */
+static int montarCaminho(const PlanejadorRotas* planejador, int encontro, int* caminho, int capacidade) {
+    int ida = 0, volta = 0;
+
+    for (int u = encontro; u >= 0; u = planejador->anterior[0][u]) ida++;
+    for (int u = planejador->anterior[1][encontro]; u >= 0; u = planejador->anterior[1][u]) volta++;
+    if (!caminho) return ida + volta - 1;
+    if (ida + volta > capacidade) return -1;
+
+    int j = ida;
+    for (int u = encontro; u >= 0; u = planejador->anterior[0][u]) caminho[--j] = u;
+    j = ida;
+    for (int u = planejador->anterior[1][encontro]; u >= 0; u = planejador->anterior[1][u]) caminho[j++] = u;
+    return ida + volta - 1;
+}
+
+int rotaMenosPortas(PlanejadorRotas* planejador, int origem, int destino, int* caminho, int capacidade) {
+    const Caso* caso = planejador->caso;
+    int inicio[2] = { 0, 0 }, fim[2] = { 1, 1 };   /* fila[lado][inicio, fim) = nível corrente */
+
+    novaGeracao(planejador);
+    alcancar(planejador, 0, origem, 0, -1);
+    alcancar(planejador, 1, destino, 0, -1);
+    planejador->fila[0][0] = origem;
+    planejador->fila[1][0] = destino;
+    if (origem == destino) return montarCaminho(planejador, origem, caminho, capacidade);
+
+    while (inicio[0] < fim[0] && inicio[1] < fim[1]) {
+        int lado = fim[0] - inicio[0] <= fim[1] - inicio[1] ? 0 : 1;
+        const int* comeco = lado == 0 ? caso->inicioPortas : planejador->inicioReverso;
+        const int* vizinho = lado == 0 ? caso->destinoPortas : planejador->origemReversa;
+        int novoFim = fim[lado], encontro = -1;
+
+        for (int i = inicio[lado]; i < fim[lado]; ++i) {
+            int u = planejador->fila[lado][i];
+            uint32_t d = planejador->distancia[lado][u] + 1;
+            for (int p = comeco[u]; p < comeco[u + 1]; ++p) {
+                int v = vizinho[p];
+                if (alcancada(planejador, lado, v)) continue;
+                alcancar(planejador, lado, v, d, u);
+                planejador->fila[lado][novoFim++] = v;
+                /* Sem encontro nos níveis anteriores, qualquer encontro neste nível é ótimo */
+                if (encontro < 0 && alcancada(planejador, 1 - lado, v)) encontro = v;
+            }
+        }
+        inicio[lado] = fim[lado];
+        fim[lado] = novoFim;
+        if (encontro >= 0) return montarCaminho(planejador, encontro, caminho, capacidade);
+    }
+    return -1;
+}
+
+long rotaMaisRapida(PlanejadorRotas* planejador, int origem, int destino, int* caminho, int capacidade, int* tamanho) {
+    const Caso* caso = planejador->caso;
+    uint64_t melhor = UINT64_MAX;
+    int encontro = -1;
+
+    novaGeracao(planejador);
+    for (int lado = 0; lado < 2; ++lado) esvaziarHeapRadix(&planejador->heaps[lado]);
+    alcancar(planejador, 0, origem, 0, -1);
+    alcancar(planejador, 1, destino, 0, -1);
+    inserirHeapRadix(&planejador->heaps[0], 0, origem);
+    inserirHeapRadix(&planejador->heaps[1], 0, destino);
+    if (origem == destino) {
+        melhor = 0;
+        encontro = origem;
+    }
+
+    while (planejador->heaps[0].total > 0 && planejador->heaps[1].total > 0) {
+        uint32_t topo0 = topoHeapRadix(&planejador->heaps[0]);
+        uint32_t topo1 = topoHeapRadix(&planejador->heaps[1]);
+        if (planejador->heaps[0].semMemoria || planejador->heaps[1].semMemoria) break;
+        if ((uint64_t)topo0 + topo1 >= melhor) break;   /* nenhuma rota melhor pode surgir */
+
+        int lado = planejador->heaps[0].total <= planejador->heaps[1].total ? 0 : 1;
+        const int* comeco = lado == 0 ? caso->inicioPortas : planejador->inicioReverso;
+        const int* vizinho = lado == 0 ? caso->destinoPortas : planejador->origemReversa;
+        const uint16_t* custo = lado == 0 ? caso->custoPortas : planejador->custoReverso;
+        uint32_t d;
+        int u = retirarHeapRadix(&planejador->heaps[lado], &d);
+        if (d != planejador->distancia[lado][u]) continue;   /* entrada obsoleta */
+
+        for (int p = comeco[u]; p < comeco[u + 1]; ++p) {
+            int v = vizinho[p];
+            uint32_t nd = d + custo[p];
+            if (alcancada(planejador, lado, v) && planejador->distancia[lado][v] <= nd) continue;
+            alcancar(planejador, lado, v, nd, u);
+            inserirHeapRadix(&planejador->heaps[lado], nd, v);
+            if (alcancada(planejador, 1 - lado, v) && (uint64_t)nd + planejador->distancia[1 - lado][v] < melhor) {
+                melhor = (uint64_t)nd + planejador->distancia[1 - lado][v];
+                encontro = v;
+            }
+        }
+    }
+    if (planejador->heaps[0].semMemoria || planejador->heaps[1].semMemoria) return SESSAO_ERRO_MEMORIA;
+    if (encontro < 0) return -1;
+
+    int n = montarCaminho(planejador, encontro, caminho, capacidade);
+    if (n < 0) return -1;
+    if (tamanho) *tamanho = n;
+    return (long)melhor;
+}
+
+int construirTabelaAla(TabelaAla* tabela, const Caso* caso, const Sala* ala) {
+    int k = ala->tamanhoAla, base = ala->id;
+    if (k > MAX_SALAS_TABELA_ALA) return 0;
+
+    tabela->base = base;
+    tabela->tamanho = k;
+    tabela->custo = (uint32_t*) malloc(sizeof(uint32_t) * (size_t)k * (size_t)k);
+    tabela->proximo = (int*) malloc(sizeof(int) * (size_t)k * (size_t)k);
+    if (!tabela->custo || !tabela->proximo) {
+        fprintf(stderr, "Erro: falha na alocação de memória para TabelaAla\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < k * k; ++i) {
+        tabela->custo[i] = UINT32_MAX;
+        tabela->proximo[i] = -1;
+    }
+
+    /* Portas internas à ala (a ala é o intervalo de IDs [base, base + k)) */
+    for (int i = 0; i < k; ++i) {
+        tabela->custo[i * k + i] = 0;
+        tabela->proximo[i * k + i] = i;
+        for (int p = caso->inicioPortas[base + i]; p < caso->inicioPortas[base + i + 1]; ++p) {
+            int j = caso->destinoPortas[p] - base;
+            if (j < 0 || j >= k || caso->custoPortas[p] >= tabela->custo[i * k + j]) continue;
+            tabela->custo[i * k + j] = caso->custoPortas[p];
+            tabela->proximo[i * k + j] = j;
+        }
+    }
+
+    /* Floyd-Warshall com matriz de próximo salto */
+    for (int m = 0; m < k; ++m)
+        for (int i = 0; i < k; ++i) {
+            uint32_t im = tabela->custo[i * k + m];
+            if (im == UINT32_MAX) continue;
+            for (int j = 0; j < k; ++j) {
+                uint32_t mj = tabela->custo[m * k + j];
+                if (mj != UINT32_MAX && im + mj < tabela->custo[i * k + j]) {
+                    tabela->custo[i * k + j] = im + mj;
+                    tabela->proximo[i * k + j] = tabela->proximo[i * k + m];
+                }
+            }
+        }
+    return 1;
+}
+
+typedef struct {
+    const Caso* caso;
+    int limite;
+    TabelaAla* tabelas;
+    const int* raizes;             /* IDs das raízes das alas, em ordem crescente */
+    int total;
+} MontagemAlas;
+
+/* Raiz de ala maximal: monta a tabela na posição dela (busca binária pelo ID) e poda a descida */
+static int montarAlaVisitada(Sala* sala, void* arg) {
+    const MontagemAlas* m = (const MontagemAlas*) arg;
+    if (sala->tamanhoAla > m->limite) return 1;
+
+    int lo = 0, hi = m->total - 1;
+    while (lo < hi) {
+        int meio = (lo + hi) / 2;
+        if (m->raizes[meio] < sala->id) lo = meio + 1;
+        else hi = meio;
+    }
+    construirTabelaAla(&m->tabelas[lo], m->caso, sala);
+    return 0;
+}
+
+TabelaAla* construirTabelasAlas(const Caso* caso, int limite, int* total) {
+    int capacidade = 16;
+    int* raizes = (int*) malloc(sizeof(int) * (size_t)capacidade);
+
+    if (!raizes) {
+        fprintf(stderr, "Erro: falha na alocação de memória para as tabelas de alas\n");
+        exit(EXIT_FAILURE);
+    }
+    if (limite > MAX_SALAS_TABELA_ALA) limite = MAX_SALAS_TABELA_ALA;
+    *total = 0;
+
+    /* Em pré-ordem, a primeira sala pequena de cada ramo é a raiz de uma ala maximal */
+    for (int id = 0; id < caso->totalSalas;) {
+        const Sala* s = caso->salasPorId[id];
+        if (s->tamanhoAla > limite) {
+            id++;
+            continue;
+        }
+        if (*total == capacidade) {
+            capacidade *= 2;
+            int* v = (int*) realloc(raizes, sizeof(int) * (size_t)capacidade);
+            if (!v) {
+                fprintf(stderr, "Erro: falha na alocação de memória para as tabelas de alas\n");
+                exit(EXIT_FAILURE);
+            }
+            raizes = v;
+        }
+        raizes[(*total)++] = id;
+        id += s->tamanhoAla;
+    }
+
+    /* As tabelas (Floyd-Warshall por ala) são montadas em paralelo, descendo a planta com fork/join */
+    TabelaAla* tabelas = (TabelaAla*) malloc(sizeof(TabelaAla) * ((size_t)*total + 1));
+    if (!tabelas) {
+        fprintf(stderr, "Erro: falha na alocação de memória para as tabelas de alas\n");
+        exit(EXIT_FAILURE);
+    }
+    MontagemAlas montagem = { caso, limite, tabelas, raizes, *total };
+    if (*total > 0) visitarSalasParalelo(escalonadorGlobal(), caso->mansao, montarAlaVisitada, &montagem, 0);
+    free(raizes);
+    return tabelas;
+}
+
+int rotaNaTabelaAla(const TabelaAla* tabela, int origem, int destino, int* caminho, int capacidade) {
+    int k = tabela->tamanho;
+    int i = origem - tabela->base, j = destino - tabela->base;
+
+    if (i < 0 || i >= k || j < 0 || j >= k || tabela->custo[i * k + j] == UINT32_MAX) return -1;
+    int n = 0;
+    while (1) {
+        if (n >= capacidade) return -1;
+        caminho[n++] = tabela->base + i;
+        if (i == j) break;
+        i = tabela->proximo[i * k + j];
+    }
+    return n - 1;
+}
+
+void liberarTabelasAlas(TabelaAla* tabelas, int total) {
+    for (int i = 0; i < total; ++i) {
+        free(tabelas[i].custo);
+        free(tabelas[i].proximo);
+    }
+    free(tabelas);
+}
+
+/* ----------------- Planejador de evidências ----------------- */
+
+static int contarBits(unsigned int x) {
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    int k = 0;
+    for (; x; x &= x - 1) k++;
+    return k;
+#endif
+}
+
+void iniciarPlanejadorEvidencias(PlanejadorEvidencias* planejador, const Caso* caso, const PlanejadorRotas* rotas) {
+    int n = caso->totalSalas, s = caso->totalSuspeitos;
+
+    planejador->caso = caso;
+    planejador->rotas = rotas;
+    planejador->totalSuspeitos = s;
+    planejador->suspeitos = (PlanoSuspeito*) calloc((size_t)s + 1, sizeof(PlanoSuspeito));
+    planejador->pistaDaSala = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    planejador->distancia = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    planejador->fila = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    if (!planejador->suspeitos || !planejador->pistaDaSala || !planejador->distancia || !planejador->fila) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o planejador de evidências\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Catálogo sala -> pista e contagem de terminais por suspeito */
+    for (int id = 0; id < n; ++id) {
+        const Sala* sala = caso->salasPorId[id];
+        SuspeitoNode* no = sala->pista[0] != '\0' ? buscarNaHash((SuspeitoNode**) caso->tabela, sala->pista) : NULL;
+        planejador->pistaDaSala[id] = no ? no->id : -1;
+        planejador->distancia[id] = -1;
+        if (no) planejador->suspeitos[no->idSuspeito].total++;
+    }
+    for (int i = 0; i < s; ++i) {
+        PlanoSuspeito* plano = &planejador->suspeitos[i];
+        plano->salas = (int*) malloc(sizeof(int) * ((size_t)plano->total + 1));
+        plano->pistas = (int*) malloc(sizeof(int) * ((size_t)plano->total + 1));
+        if (!plano->salas || !plano->pistas) {
+            fprintf(stderr, "Erro: falha na alocação de memória para o planejador de evidências\n");
+            exit(EXIT_FAILURE);
+        }
+        plano->total = 0;
+    }
+    for (int id = 0; id < n; ++id) {
+        int pista = planejador->pistaDaSala[id];
+        if (pista < 0) continue;
+        PlanoSuspeito* plano = &planejador->suspeitos[caso->pistasPorId[pista]->idSuspeito];
+        plano->salas[plano->total] = id;
+        plano->pistas[plano->total++] = pista;
+    }
+}
+
+void liberarPlanejadorEvidencias(PlanejadorEvidencias* planejador) {
+    for (int i = 0; i < planejador->totalSuspeitos; ++i) {
+        PlanoSuspeito* plano = &planejador->suspeitos[i];
+        free(plano->salas);
+        free(plano->pistas);
+        free(plano->mesmaPista);
+        free(plano->ate);
+        free(plano->cadeia);
+    }
+    free(planejador->suspeitos);
+    free(planejador->pistaDaSala);
+    free(planejador->distancia);
+    free(planejador->fila);
+    memset(planejador, 0, sizeof(*planejador));
+}
+
+/* Distâncias até cada terminal (BFS reversa) e DP dos passeios entre terminais */
+static void montarPlanoSuspeito(PlanejadorEvidencias* planejador, PlanoSuspeito* plano) {
+    const PlanejadorRotas* rotas = planejador->rotas;
+    int n = planejador->caso->totalSalas, t = plano->total;
+
+    plano->pronto = 1;
+    if (t > MAX_TERMINAIS_PLANO) return;
+
+    size_t mascaras = (size_t)1 << t;
+    plano->mesmaPista = (int*) calloc((size_t)t + 1, sizeof(int));
+    plano->ate = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t)t * (size_t)n + 1));
+    plano->cadeia = (uint32_t*) malloc(sizeof(uint32_t) * (mascaras * (size_t)t + 1));
+    if (!plano->mesmaPista || !plano->ate || !plano->cadeia) {
+        /* Sem tabela: esta consulta usa a estimativa e a próxima tenta de novo */
+        free(plano->mesmaPista);
+        free(plano->ate);
+        free(plano->cadeia);
+        plano->mesmaPista = NULL;
+        plano->ate = NULL;
+        plano->cadeia = NULL;
+        plano->pronto = 0;
+        return;
+    }
+
+    for (int i = 0; i < t; ++i) {
+        uint32_t* ate = plano->ate + (size_t)i * (size_t)n;
+        int* fila = planejador->fila;
+        int cabeca = 0, cauda = 0;
+
+        for (int j = 0; j < t; ++j)
+            if (j != i && plano->pistas[j] == plano->pistas[i]) plano->mesmaPista[i] |= 1 << j;
+        memset(ate, 0xFF, sizeof(uint32_t) * (size_t)n);
+        ate[plano->salas[i]] = 0;
+        fila[cauda++] = plano->salas[i];
+        while (cabeca < cauda) {
+            int v = fila[cabeca++];
+            for (int p = rotas->inicioReverso[v]; p < rotas->inicioReverso[v + 1]; ++p) {
+                int u = rotas->origemReversa[p];
+                if (ate[u] != UINT32_MAX) continue;
+                ate[u] = ate[v] + 1;
+                fila[cauda++] = u;
+            }
+        }
+    }
+
+    /* cadeia[m][i] = menor passeio que começa no terminal i (em m) e visita todo m */
+    for (size_t m = 1; m < mascaras; ++m)
+        for (int i = 0; i < t; ++i) {
+            uint32_t* celula = &plano->cadeia[m * (size_t)t + (size_t)i];
+            if (!((m >> i) & 1)) continue;
+            size_t resto = m & ~((size_t)1 << i);
+            *celula = resto ? UINT32_MAX : 0;
+            for (int j = 0; j < t; ++j) {
+                if (!((resto >> j) & 1)) continue;
+                uint32_t passo = plano->ate[(size_t)j * (size_t)n + (size_t)plano->salas[i]];
+                uint32_t depois = plano->cadeia[resto * (size_t)t + (size_t)j];
+                if (passo == UINT32_MAX || depois == UINT32_MAX) continue;
+                if (passo + depois < *celula) *celula = passo + depois;
+            }
+        }
+}
+
+int pistasColetadasContra(const Caso* caso, const Sessao* sessao, int suspeito) {
+    int total = 0;
+    for (int id = 0; id < caso->totalPistas && id < sessao->totalBits; ++id)
+        if (((sessao->coletadas[id >> 3] >> (id & 7)) & 1) && caso->pistasPorId[id]->idSuspeito == suspeito)
+            total++;
+    return total;
+}
+
+static int pistaColetadaPorId(const Sessao* sessao, int id) {
+    return id < sessao->totalBits && ((sessao->coletadas[id >> 3] >> (id & 7)) & 1);
+}
+
+/* Sala com pista nova mais próxima, repetidamente (suspeitos com muitas salas) */
+static long planoGuloso(PlanejadorEvidencias* planejador, const Sessao* sessao, int suspeito, int faltam,
+                        int* ordem, int capacidade) {
+    const Caso* caso = planejador->caso;
+    int* escolhidas = (int*) malloc(sizeof(int) * ((size_t)faltam + 1));
+    int* distancia = planejador->distancia;
+    int* fila = planejador->fila;
+    int origem = sessao->atual->id;
+    long total = 0;
+
+    if (!escolhidas) return SESSAO_ERRO_MEMORIA;
+    for (int k = 0; k < faltam; ++k) {
+        int cabeca = 0, cauda = 0, achada = -1;
+
+        distancia[origem] = 0;
+        fila[cauda++] = origem;
+        while (cabeca < cauda && achada < 0) {
+            int u = fila[cabeca++], pista = planejador->pistaDaSala[u];
+            if (pista >= 0 && caso->pistasPorId[pista]->idSuspeito == suspeito && !pistaColetadaPorId(sessao, pista)) {
+                int repetida = 0;
+                for (int j = 0; j < k && !repetida; ++j) repetida = planejador->pistaDaSala[escolhidas[j]] == pista;
+                if (!repetida) { achada = u; break; }
+            }
+            for (int p = caso->inicioPortas[u]; p < caso->inicioPortas[u + 1]; ++p) {
+                int v = caso->destinoPortas[p];
+                if (distancia[v] >= 0) continue;
+                distancia[v] = distancia[u] + 1;
+                fila[cauda++] = v;
+            }
+        }
+        if (achada >= 0) total += distancia[achada];
+        for (int i = 0; i < cauda; ++i) distancia[fila[i]] = -1;   /* limpa só o que foi tocado */
+        if (achada < 0) { total = -1; break; }
+
+        escolhidas[k] = origem = achada;
+        if (ordem && k < capacidade) ordem[k] = achada;
+    }
+    free(escolhidas);
+    return total;
+}
+
+long planejarEvidencias(PlanejadorEvidencias* planejador, const Sessao* sessao, int suspeito, int limiar,
+                        int* ordem, int capacidade, int* faltam) {
+    const Caso* caso = planejador->caso;
+    PlanoSuspeito* plano = &planejador->suspeitos[suspeito];
+    int k = limiar - pistasColetadasContra(caso, sessao, suspeito);
+
+    if (faltam) *faltam = k > 0 ? k : 0;
+    if (k <= 0) return 0;
+    if (!plano->pronto) montarPlanoSuspeito(planejador, plano);
+    if (!plano->ate) return planoGuloso(planejador, sessao, suspeito, k, ordem, capacidade);
+
+    int n = caso->totalSalas, t = plano->total, atual = sessao->atual->id;
+    unsigned int restantes = 0;
+    for (int i = 0; i < t; ++i)
+        if (!pistaColetadaPorId(sessao, plano->pistas[i])) restantes |= 1u << i;
+
+    /* Conjuntos de k terminais com pistas distintas, ainda não coletadas */
+    uint64_t melhor = UINT64_MAX;
+    unsigned int melhorMascara = 0;
+    int melhorInicio = -1;
+    for (unsigned int m = restantes; m; m = (m - 1) & restantes) {
+        if (contarBits(m) != k) continue;
+        int valida = 1;
+        for (int i = 0; i < t && valida; ++i)
+            if ((m >> i) & 1) valida = (m & (unsigned int)plano->mesmaPista[i]) == 0;
+        if (!valida) continue;
+        for (int i = 0; i < t; ++i) {
+            if (!((m >> i) & 1)) continue;
+            uint32_t ida = plano->ate[(size_t)i * (size_t)n + (size_t)atual];
+            uint32_t passeio = plano->cadeia[(size_t)m * (size_t)t + (size_t)i];
+            if (ida == UINT32_MAX || passeio == UINT32_MAX) continue;
+            if ((uint64_t)ida + passeio < melhor) {
+                melhor = (uint64_t)ida + passeio;
+                melhorMascara = m;
+                melhorInicio = i;
+            }
+        }
+    }
+    if (melhorInicio < 0) return -1;
+
+    /* Reconstrói a ordem de visita seguindo a DP */
+    int i = melhorInicio, visitados = 0;
+    unsigned int m = melhorMascara;
+    for (;;) {
+        if (ordem && visitados < capacidade) ordem[visitados] = plano->salas[i];
+        visitados++;
+        unsigned int resto = m & ~(1u << i);
+        if (!resto) break;
+        uint32_t alvo = plano->cadeia[(size_t)m * (size_t)t + (size_t)i];
+        for (int j = 0; j < t; ++j) {
+            if (!((resto >> j) & 1)) continue;
+            uint32_t passo = plano->ate[(size_t)j * (size_t)n + (size_t)plano->salas[i]];
+            uint32_t depois = plano->cadeia[(size_t)resto * (size_t)t + (size_t)j];
+            if (passo != UINT32_MAX && depois != UINT32_MAX && passo + depois == alvo) {
+                i = j;
+                break;
+            }
+        }
+        m = resto;
+    }
+    return (long)melhor;
+}
+
+int exibirDica(Caso* caso, const Sessao* sessao, PlanejadorEvidencias* planejador, const char* nome) {
+    int primeiro = 0, ultimo = caso->totalSuspeitos, resultado = 1;
+
+    if (nome[0] != '\0') {
+        NoBK* suspeito = resolverSuspeito(caso, nome, NULL);
+        if (!suspeito) {
+            printf("Nenhum suspeito parecido com \"%s\".\n", nome);
+            return 0;
+        }
+        primeiro = suspeito->id;
+        ultimo = primeiro + 1;
+    }
+
+    printf("\nMenor caminho para reunir %d pista(s) contra cada suspeito:\n", PISTAS_PARA_CONDENAR);
+    for (int s = primeiro; s < ultimo; ++s) {
+        int ordem[PISTAS_PARA_CONDENAR], faltam;
+        long passos = planejarEvidencias(planejador, sessao, s, PISTAS_PARA_CONDENAR, ordem, PISTAS_PARA_CONDENAR, &faltam);
+
+        printf(" - %s: ", caso->suspeitosPorId[s]->nome);
+        if (faltam == 0) {
+            printf("evidências suficientes.\n");
+        } else if (passos == SESSAO_ERRO_MEMORIA) {
+            printf("sem memória para calcular a dica agora.\n");
+            resultado = SESSAO_ERRO_MEMORIA;
+        } else if (passos < 0) {
+            printf("não há pistas suficientes alcançáveis (faltam %d).\n", faltam);
+        } else {
+            printf("faltam %d, %ld porta(s)%s:", faltam, passos,
+                   planejador->suspeitos[s].ate ? "" : " (estimativa)");
+            for (int i = 0; i < faltam && i < PISTAS_PARA_CONDENAR; ++i)
+                printf("%s %s", i ? " ->" : "", caso->salasPorId[ordem[i]]->nome);
+            printf("\n");
+        }
+    }
+    return resultado;
+}
+
+/* ----------------- Simulação Monte Carlo ----------------- */
+
+int montarMapaPistas(MapaPistas* mapa, const Caso* caso) {
+    int n = caso->totalSalas;
+
+    mapa->pistaDaSala = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    mapa->suspeitoDaPista = (int*) malloc(sizeof(int) * ((size_t)caso->totalPistas + 1));
+    mapa->mascaraSuspeito = (uint64_t*) calloc((size_t)caso->totalSuspeitos + 1, sizeof(uint64_t));
+    if (!mapa->pistaDaSala || !mapa->suspeitoDaPista || !mapa->mascaraSuspeito) {
+        liberarMapaPistas(mapa);
+        return 0;
+    }
+    for (int id = 0; id < n; ++id) {
+        const Sala* sala = caso->salasPorId[id];
+        SuspeitoNode* no = sala->pista[0] != '\0' ? buscarNaHash((SuspeitoNode**) caso->tabela, sala->pista) : NULL;
+        mapa->pistaDaSala[id] = no ? no->id : -1;
+    }
+    for (int p = 0; p < caso->totalPistas; ++p) mapa->suspeitoDaPista[p] = caso->pistasPorId[p]->idSuspeito;
+    mapa->cabeEm64 = caso->totalPistas <= 64;
+    if (mapa->cabeEm64)
+        for (int p = 0; p < caso->totalPistas; ++p) mapa->mascaraSuspeito[mapa->suspeitoDaPista[p]] |= 1ULL << p;
+    return 1;
+}
+
+void liberarMapaPistas(MapaPistas* mapa) {
+    free(mapa->pistaDaSala);
+    free(mapa->suspeitoDaPista);
+    free(mapa->mascaraSuspeito);
+    memset(mapa, 0, sizeof(*mapa));
+}
+
+static uint64_t rotacionar64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/* splitmix64: espalha a semente nos quatro estados do xoshiro */
+static uint64_t proximoSplitmix(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void semearXoshiro(GeradorXoshiro* gerador, uint64_t semente) {
+    for (int i = 0; i < 4; ++i) gerador->s[i] = proximoSplitmix(&semente);
+}
+
+uint64_t proximoXoshiro(GeradorXoshiro* gerador) {
+    uint64_t* s = gerador->s;
+    uint64_t resultado = rotacionar64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionar64(s[3], 45);
+    return resultado;
+}
+
+void saltarXoshiro(GeradorXoshiro* gerador) {
+    static const uint64_t salto[] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+    };
+    uint64_t s[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; ++i)
+        for (int b = 0; b < 64; ++b) {
+            if ((salto[i] >> b) & 1) {
+                s[0] ^= gerador->s[0];
+                s[1] ^= gerador->s[1];
+                s[2] ^= gerador->s[2];
+                s[3] ^= gerador->s[3];
+            }
+            proximoXoshiro(gerador);
+        }
+    memcpy(gerador->s, s, sizeof(s));
+}
+
+/* Inteiro uniforme em [0, n) (multiplicação de Lemire, sem divisão) */
+static int sortearAte(GeradorXoshiro* gerador, int n) {
+    return (int)(((proximoXoshiro(gerador) >> 32) * (uint64_t)n) >> 32);
+}
+
+int classificarAcusacao(int evidencias) {
+    if (evidencias >= PISTAS_PARA_CONDENAR) return ACUSACAO_CONFIRMADA;
+    if (evidencias > 0) return ACUSACAO_FRAGIL;
+    return ACUSACAO_SEM_FUNDAMENTO;
+}
+
+typedef struct {
+    const Caso* caso;
+    const int* pistaDaSala;
+    const int* suspeitoDaPista;
+    int politica;
+    long long partidas;
+    GeradorXoshiro gerador;
+    long long* contagens;          /* [suspeito * 4 + ACUSACAO_*] desta faixa */
+    uint32_t* visitada;            /* carimbo da partida em que a sala foi visitada */
+    uint32_t* coletada;            /* idem, por pista */
+    int* porSuspeito;              /* pistas coletadas contra cada suspeito */
+    const uint64_t* mascaraSuspeito; /* [suspeito]: bits das pistas dele (caminhante vetorial) */
+    int vetorial;                  /* usar simularFaixaAVX2() */
+} FaixaSimulacao;
+
+/* Desligado pelo benchmark para comparar com o caminhante escalar */
+static int simdHabilitado = 1;
+
+#if defined(SIMULACAO_AVX2)
+/* xoshiro128** em 8 pistas de 32 bits (multiplicações por 5 e 9 viram shift + soma) */
+__attribute__((target("avx2")))
+static inline __m256i proximoXoshiroAVX2(__m256i s[4]) {
+    __m256i x = _mm256_add_epi32(_mm256_slli_epi32(s[1], 2), s[1]);
+    x = _mm256_or_si256(_mm256_slli_epi32(x, 7), _mm256_srli_epi32(x, 25));
+    __m256i resultado = _mm256_add_epi32(_mm256_slli_epi32(x, 3), x);
+    __m256i t = _mm256_slli_epi32(s[1], 9);
+
+    s[2] = _mm256_xor_si256(s[2], s[0]);
+    s[3] = _mm256_xor_si256(s[3], s[1]);
+    s[1] = _mm256_xor_si256(s[1], s[2]);
+    s[0] = _mm256_xor_si256(s[0], s[3]);
+    s[2] = _mm256_xor_si256(s[2], t);
+    s[3] = _mm256_or_si256(_mm256_slli_epi32(s[3], 11), _mm256_srli_epi32(s[3], 21));
+    return resultado;
+}
+
+/*
+ * Jogador aleatório em 16 partidas simultâneas: dois grupos independentes de
+ * 8 pistas (um vetor cada), para que as leituras indiretas (gathers) de um
+ * grupo se sobreponham às do outro. Cada pista guarda sala, passos e o bitset
+ * de pistas coletadas (64 bits em duas metades); quando uma partida termina,
+ * a acusação é apurada em escalar e a pista recomeça no Hall. Mesmo modelo de
+ * simularFaixa(), outra sequência aleatória: as taxas coincidem
+ * estatisticamente, não partida a partida.
+ */
+__attribute__((target("avx2")))
+static void simularFaixaAVX2(FaixaSimulacao* faixa) {
+    const Caso* caso = faixa->caso;
+    const int* inicio = caso->inicioPortas;
+    const int hall = caso->mansao->id;
+    const int pistaHall = faixa->pistaDaSala[hall];
+    const uint64_t bitHall = pistaHall >= 0 ? 1ULL << pistaHall : 0;
+    int suspeitos = caso->totalSuspeitos;
+    uint32_t estado[4][8], baixo[8], alto[8];
+    int ativa[2][8];
+    long long iniciadas = 0;
+
+    const __m256i um = _mm256_set1_epi32(1), trinta2 = _mm256_set1_epi32(32), todos = _mm256_set1_epi32(-1);
+    const __m256i metade = _mm256_set1_epi32(0xFFFF), desistencia = _mm256_set1_epi32(SIMULACAO_DESISTENCIA);
+    const __m256i limite = _mm256_set1_epi32(SIMULACAO_MAX_PASSOS), zero = _mm256_setzero_si256();
+    const __m256i salaHall = _mm256_set1_epi32(hall);
+    const __m256i baixoHall = _mm256_set1_epi32((int)(uint32_t)bitHall);
+    const __m256i altoHall = _mm256_set1_epi32((int)(uint32_t)(bitHall >> 32));
+    __m256i s[2][4], sala[2], passo[2], coletadasBaixo[2], coletadasAlto[2], vivas[2];
+
+    for (int g = 0; g < 2; ++g) {
+        for (int i = 0; i < 4; ++i) {
+            for (int l = 0; l < 8; ++l) estado[i][l] = (uint32_t)proximoXoshiro(&faixa->gerador) | (i == 0);
+            s[g][i] = _mm256_loadu_si256((const __m256i*) estado[i]);
+        }
+        for (int l = 0; l < 8; ++l) {
+            ativa[g][l] = iniciadas < faixa->partidas ? -1 : 0;
+            if (ativa[g][l]) iniciadas++;
+        }
+        vivas[g] = _mm256_loadu_si256((const __m256i*) ativa[g]);
+        sala[g] = salaHall;
+        passo[g] = zero;
+        coletadasBaixo[g] = baixoHall;
+        coletadasAlto[g] = altoHall;
+    }
+
+    while (!_mm256_testz_si256(_mm256_or_si256(vivas[0], vivas[1]), todos)) {
+        for (int g = 0; g < 2; ++g) {
+            __m256i r = proximoXoshiroAVX2(s[g]);
+            __m256i primeira = _mm256_i32gather_epi32(inicio, sala[g], 4);
+            __m256i grau = _mm256_sub_epi32(_mm256_i32gather_epi32(inicio + 1, sala[g], 4), primeira);
+            __m256i semSaida = _mm256_cmpeq_epi32(grau, zero);
+
+            /* Fim da partida: sem portas, limite de passos ou desistência (16 bits baixos) */
+            __m256i sorteio = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_and_si256(r, metade), desistencia), 16);
+            __m256i desiste = _mm256_andnot_si256(_mm256_cmpeq_epi32(passo[g], zero), _mm256_cmpeq_epi32(sorteio, zero));
+            __m256i terminou = _mm256_or_si256(_mm256_or_si256(desiste, semSaida), _mm256_cmpeq_epi32(passo[g], limite));
+            terminou = _mm256_and_si256(terminou, vivas[g]);
+
+            int fim = _mm256_movemask_ps(_mm256_castsi256_ps(terminou));
+            if (fim) {
+                _mm256_storeu_si256((__m256i*) baixo, coletadasBaixo[g]);
+                _mm256_storeu_si256((__m256i*) alto, coletadasAlto[g]);
+                for (int l = 0; l < 8; ++l) {
+                    if (!((fim >> l) & 1)) continue;
+                    uint64_t coletadas = (uint64_t)alto[l] << 32 | baixo[l];
+                    int acusado = -1, maior = -1, empates = 0;
+                    for (int k = 0; k < suspeitos; ++k) {
+                        int total = __builtin_popcountll(coletadas & faixa->mascaraSuspeito[k]);
+                        if (total > maior) { maior = total; empates = 0; }
+                        if (total == maior && (++empates == 1 || sortearAte(&faixa->gerador, empates) == 0)) acusado = k;
+                    }
+                    if (acusado >= 0) faixa->contagens[acusado * 4 + classificarAcusacao(maior)]++;
+                    if (iniciadas < faixa->partidas) iniciadas++;
+                    else ativa[g][l] = 0;
+                }
+                vivas[g] = _mm256_loadu_si256((const __m256i*) ativa[g]);
+            }
+
+            /* Porta sorteada com os 16 bits altos; pistas encerradas ou sem saída não leem memória */
+            __m256i porta = _mm256_add_epi32(primeira, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(r, 16), grau), 16));
+            __m256i segue = _mm256_andnot_si256(_mm256_or_si256(terminou, semSaida), todos);
+            __m256i destino = _mm256_mask_i32gather_epi32(salaHall, caso->destinoPortas, porta, segue, 4);
+            __m256i pista = _mm256_mask_i32gather_epi32(todos, faixa->pistaDaSala, destino, segue, 4);
+
+            /* Deslocamentos >= 32 (e pista -1) zeram o bit: cada metade só recebe o seu */
+            __m256i novoBaixo = _mm256_or_si256(coletadasBaixo[g], _mm256_sllv_epi32(um, pista));
+            __m256i novoAlto = _mm256_or_si256(coletadasAlto[g], _mm256_sllv_epi32(um, _mm256_sub_epi32(pista, trinta2)));
+            sala[g] = _mm256_blendv_epi8(destino, salaHall, terminou);
+            passo[g] = _mm256_blendv_epi8(_mm256_add_epi32(passo[g], um), zero, terminou);
+            coletadasBaixo[g] = _mm256_blendv_epi8(novoBaixo, baixoHall, terminou);
+            coletadasAlto[g] = _mm256_blendv_epi8(novoAlto, altoHall, terminou);
+        }
+    }
+}
+#endif
+
+/* Uma faixa de partidas; toda a memória já vem alocada em `faixa` */
+static void simularFaixa(FaixaSimulacao* faixa) {
+    const Caso* caso = faixa->caso;
+    const int* inicio = caso->inicioPortas;
+    const int* destino = caso->destinoPortas;
+    int suspeitos = caso->totalSuspeitos;
+    GeradorXoshiro* g = &faixa->gerador;
+    uint32_t carimbo = 0;
+
+#if defined(SIMULACAO_AVX2)
+    if (faixa->vetorial) {
+        simularFaixaAVX2(faixa);
+        return;
+    }
+#endif
+
+    for (long long k = 0; k < faixa->partidas; ++k) {
+        if (++carimbo == 0) {          /* carimbos esgotados: limpa uma vez a cada 2^32 partidas */
+            memset(faixa->visitada, 0, sizeof(uint32_t) * (size_t)caso->totalSalas);
+            memset(faixa->coletada, 0, sizeof(uint32_t) * (size_t)caso->totalPistas);
+            carimbo = 1;
+        }
+        int sala = caso->mansao->id, maior = 0;
+
+        memset(faixa->porSuspeito, 0, sizeof(int) * (size_t)suspeitos);
+        for (int passo = 0; ; ++passo) {
+            /* Entrar na sala: coleta automática da pista, como entrarNaSala() */
+            if (faixa->visitada[sala] != carimbo) {
+                int pista = faixa->pistaDaSala[sala];
+                faixa->visitada[sala] = carimbo;
+                if (pista >= 0 && faixa->coletada[pista] != carimbo) {
+                    int s = faixa->suspeitoDaPista[pista];
+                    faixa->coletada[pista] = carimbo;
+                    if (++faixa->porSuspeito[s] > maior) maior = faixa->porSuspeito[s];
+                }
+            }
+
+            int portas = inicio[sala + 1] - inicio[sala];
+            if (passo == SIMULACAO_MAX_PASSOS || portas == 0) break;
+            if (faixa->politica != POLITICA_EXPLORADORA) {
+                if (passo > 0 && sortearAte(g, SIMULACAO_DESISTENCIA) == 0) break;
+                sala = destino[inicio[sala] + sortearAte(g, portas)];
+            } else {
+                /* Exploradora: para ao ter evidência; prefere portas para salas novas */
+                if (maior >= PISTAS_PARA_CONDENAR) break;
+                int novas = 0, escolhida = -1;
+                for (int p = inicio[sala]; p < inicio[sala + 1]; ++p)
+                    if (faixa->visitada[destino[p]] != carimbo && sortearAte(g, ++novas) == 0) escolhida = destino[p];
+                sala = escolhida >= 0 ? escolhida : destino[inicio[sala] + sortearAte(g, portas)];
+            }
+        }
+
+        /* Acusa quem tem mais pistas (empate sorteado; sem pistas, qualquer um) */
+        int acusado = -1, empates = 0;
+        if (faixa->politica == POLITICA_PALPITE && suspeitos > 0) acusado = sortearAte(g, suspeitos);
+        else
+            for (int s = 0; s < suspeitos; ++s)
+                if (faixa->porSuspeito[s] == maior && sortearAte(g, ++empates) == 0) acusado = s;
+        if (acusado >= 0)
+            faixa->contagens[acusado * 4 + classificarAcusacao(faixa->porSuspeito[acusado])]++;
+    }
+}
+
+static void simularFaixas(void* arg, long de, long ate) {
+    FaixaSimulacao* faixas = (FaixaSimulacao*) arg;
+    for (long t = de; t < ate; ++t) simularFaixa(&faixas[t]);
+}
+
+void simularPartidas(const Caso* caso, int politica, long long partidas, uint64_t semente, int threads,
+                     long long* contagens) {
+    int n = caso->totalSalas, suspeitos = caso->totalSuspeitos;
+    Escalonador* escalonador = escalonadorGlobal();
+
+    if (threads <= 0) threads = escalonador->total;
+    if (threads > partidas / 1024 + 1) threads = (int)(partidas / 1024 + 1);
+
+    MapaPistas mapa;
+    int mapaPronto = montarMapaPistas(&mapa, caso);
+    FaixaSimulacao* faixas = (FaixaSimulacao*) calloc((size_t)threads, sizeof(FaixaSimulacao));
+    if (!mapaPronto || !faixas) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a simulação\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Jogador aleatório com até 64 pistas: 16 partidas em paralelo nos vetores AVX2 */
+    int vetorial = 0;
+#if defined(SIMULACAO_AVX2)
+    vetorial = simdHabilitado && politica == POLITICA_ALEATORIA && mapa.cabeEm64 && __builtin_cpu_supports("avx2");
+#endif
+
+    /* Uma sequência independente por faixa: saltos de 2^128 no mesmo gerador (o resultado não
+     * depende de qual trabalhador executa cada faixa) */
+    GeradorXoshiro gerador;
+    semearXoshiro(&gerador, semente);
+    for (int t = 0; t < threads; ++t) {
+        FaixaSimulacao* f = &faixas[t];
+        f->caso = caso;
+        f->pistaDaSala = mapa.pistaDaSala;
+        f->suspeitoDaPista = mapa.suspeitoDaPista;
+        f->politica = politica;
+        f->partidas = partidas * (t + 1) / threads - partidas * t / threads;
+        f->gerador = gerador;
+        f->mascaraSuspeito = mapa.mascaraSuspeito;
+        f->vetorial = vetorial;
+        saltarXoshiro(&gerador);
+        f->contagens = (long long*) calloc((size_t)suspeitos * 4 + 1, sizeof(long long));
+        f->visitada = (uint32_t*) calloc((size_t)n + 1, sizeof(uint32_t));
+        f->coletada = (uint32_t*) calloc((size_t)caso->totalPistas + 1, sizeof(uint32_t));
+        f->porSuspeito = (int*) calloc((size_t)suspeitos + 1, sizeof(int));
+        if (!f->contagens || !f->visitada || !f->coletada || !f->porSuspeito) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a simulação\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    paraCadaParalelo(escalonador, 0, threads, 1, simularFaixas, faixas);
+
+    memset(contagens, 0, sizeof(long long) * (size_t)suspeitos * 4);
+    for (int t = 0; t < threads; ++t) {
+        for (int i = 0; i < suspeitos * 4; ++i) contagens[i] += faixas[t].contagens[i];
+        free(faixas[t].contagens);
+        free(faixas[t].visitada);
+        free(faixas[t].coletada);
+        free(faixas[t].porSuspeito);
+    }
+    free(faixas);
+    liberarMapaPistas(&mapa);
+}
+
+void executarSimulacao(const Caso* caso, long long partidas) {
+    static const char* politicas[] = { "aleatório", "explorador", "palpiteiro" };
+    int suspeitos = caso->totalSuspeitos, threads = escalonadorGlobal()->total;
+    long long* contagens = (long long*) malloc(sizeof(long long) * ((size_t)suspeitos * 4 + 1));
+
+    if (!contagens) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a simulação\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Simulando %lld partida(s) por política com %d trabalhador(es)...\n", partidas, threads);
+    for (int politica = POLITICA_ALEATORIA; politica <= POLITICA_PALPITE; ++politica) {
+        long long msUm = 0;
+        if (threads > 1) {
+            long long t0 = agoraMs();
+            simularPartidas(caso, politica, partidas, SIMULACAO_SEMENTE, 1, contagens);
+            msUm = agoraMs() - t0;
+        }
+        long long t0 = agoraMs();
+        simularPartidas(caso, politica, partidas, SIMULACAO_SEMENTE, threads, contagens);
+        long long ms = agoraMs() - t0;
+
+        printf("\nJogador %s (%.2f M partidas/s", politicas[politica],
+               ms > 0 ? (double)partidas / (double)ms / 1000.0 : 0.0);
+        if (threads > 1)
+            printf("; 1 trabalhador: %.2f M partidas/s, aceleração %.2fx",
+                   msUm > 0 ? (double)partidas / (double)msUm / 1000.0 : 0.0,
+                   ms > 0 ? (double)msUm / (double)ms : 0.0);
+        printf("):\n");
+        printf("  Acusado               Acusações Confirmada     Frágil  Sem fund.\n");   /* alinhado à mão (UTF-8) */
+        for (int s = 0; s < suspeitos; ++s) {
+            const long long* c = &contagens[s * 4];
+            long long total = c[ACUSACAO_CONFIRMADA] + c[ACUSACAO_FRAGIL] + c[ACUSACAO_SEM_FUNDAMENTO];
+            double base = partidas > 0 ? 100.0 / (double)partidas : 0.0;
+            printf("  %-20s %9.2f%% %9.2f%% %9.2f%% %9.2f%%\n", caso->suspeitosPorId[s]->nome,
+                   (double)total * base, (double)c[ACUSACAO_CONFIRMADA] * base,
+                   (double)c[ACUSACAO_FRAGIL] * base, (double)c[ACUSACAO_SEM_FUNDAMENTO] * base);
+        }
+    }
+    free(contagens);
+}
+
+typedef struct {
+    const Caso* caso;
+    const MapaPistas* mapa;
+    ConjuntoPistas* evidencias;    /* compartilhado por todos os detetives */
+    atomic_int* porSuspeito;       /* pistas no conjunto contra cada suspeito */
+    GeradorXoshiro gerador;
+    unsigned char* visitada;
+    int portas, encontradas, primeiras;
+} Detetive;
+
+static int grupoTemEvidencia(const Detetive* detetive) {
+    for (int s = 0; s < detetive->caso->totalSuspeitos; ++s)
+        if (atomic_load_explicit(&detetive->porSuspeito[s], memory_order_relaxed) >= PISTAS_PARA_CONDENAR) return 1;
+    return 0;
+}
+
+static void investigarCooperativo(void* arg, long de, long ate) {
+    Detetive* detetives = (Detetive*) arg;
+
+    for (long d = de; d < ate; ++d) {
+        Detetive* det = &detetives[d];
+        const Caso* caso = det->caso;
+        const int* inicio = caso->inicioPortas;
+        const int* destino = caso->destinoPortas;
+        int sala = caso->mansao->id;
+
+        for (det->portas = 0; ; ++det->portas) {
+            if (!det->visitada[sala]) {
+                int pista = det->mapa->pistaDaSala[sala];
+                det->visitada[sala] = 1;
+                if (pista >= 0) {
+                    det->encontradas++;
+                    /* Só quem insere primeiro conta a pista contra o suspeito */
+                    if (inserirNoConjuntoPistas(det->evidencias, caso->pistasPorId[pista]->pista)) {
+                        det->primeiras++;
+                        atomic_fetch_add(&det->porSuspeito[det->mapa->suspeitoDaPista[pista]], 1);
+                    }
+                }
+            }
+
+            int portas = inicio[sala + 1] - inicio[sala];
+            if (det->portas == SIMULACAO_MAX_PASSOS || portas == 0 || grupoTemEvidencia(det)) break;
+            int novas = 0, escolhida = -1;
+            for (int p = inicio[sala]; p < inicio[sala + 1]; ++p)
+                if (!det->visitada[destino[p]] && sortearAte(&det->gerador, ++novas) == 0) escolhida = destino[p];
+            sala = escolhida >= 0 ? escolhida : destino[inicio[sala] + sortearAte(&det->gerador, portas)];
+        }
+    }
+}
+
+int executarCooperativo(const Caso* caso, int detetives) {
+    static const char* desfechos[] = { "pendente", "confirmada", "frágil", "sem fundamento" };
+    int suspeitos = caso->totalSuspeitos;
+    MapaPistas mapa;
+    ConjuntoPistas evidencias;
+    GeradorXoshiro gerador;
+
+    int mapaPronto = montarMapaPistas(&mapa, caso);
+    iniciarConjuntoPistas(&evidencias);
+    semearXoshiro(&gerador, SIMULACAO_SEMENTE);
+    Detetive* grupo = (Detetive*) calloc((size_t)detetives, sizeof(Detetive));
+    atomic_int* porSuspeito = (atomic_int*) calloc((size_t)suspeitos + 1, sizeof(atomic_int));
+    if (!mapaPronto || !grupo || !porSuspeito) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a investigação cooperativa\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int d = 0; d < detetives; ++d) {
+        grupo[d].caso = caso;
+        grupo[d].mapa = &mapa;
+        grupo[d].evidencias = &evidencias;
+        grupo[d].porSuspeito = porSuspeito;
+        grupo[d].gerador = gerador;
+        saltarXoshiro(&gerador);
+        grupo[d].visitada = (unsigned char*) calloc((size_t)caso->totalSalas + 1, 1);
+        if (!grupo[d].visitada) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a investigação cooperativa\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    Escalonador* escalonador = escalonadorGlobal();
+    printf("Investigação cooperativa: %d detetive(s) em %d trabalhador(es).\n\n", detetives, escalonador->total);
+    paraCadaParalelo(escalonador, 0, detetives, 1, investigarCooperativo, grupo);
+
+    printf("  Detetive     Portas  Pistas achadas  Primeiro a achar\n");
+    for (int d = 0; d < detetives; ++d)
+        printf("  %8d %10d %15d %17d\n", d + 1, grupo[d].portas, grupo[d].encontradas, grupo[d].primeiras);
+
+    printf("\nEvidências compartilhadas (ordem alfabética):\n");
+    exibirConjuntoPistas(&evidencias);
+
+    int acusado = -1;
+    for (int s = 0; s < suspeitos; ++s)
+        if (acusado < 0 || atomic_load(&porSuspeito[s]) > atomic_load(&porSuspeito[acusado])) acusado = s;
+    if (acusado >= 0) {
+        int pistas = atomic_load(&porSuspeito[acusado]);
+        printf("\nAcusação do grupo: %s, com %d pista(s) -> %s.\n", caso->suspeitosPorId[acusado]->nome, pistas,
+               desfechos[classificarAcusacao(pistas)]);
+    }
+
+    for (int d = 0; d < detetives; ++d) free(grupo[d].visitada);
+    free(grupo);
+    free(porSuspeito);
+    liberarConjuntoPistas(&evidencias);
+    liberarMapaPistas(&mapa);
+    return acusado;
+}
+
+/* ----------------- Robô detetive (MCTS) ----------------- */
+
+typedef struct {
+    int sala;                      /* estado após a ação */
+    int passos;
+    uint64_t coletadas;
+    int acao;                      /* porta (0-based) ou MCTS_ACUSAR */
+    int filho, irmao;              /* índices no pool (-1 = nenhum) */
+    int proxima, totalAcoes;       /* próxima ação ainda não expandida */
+    uint32_t visitas;
+    double soma;                   /* soma das recompensas */
+} NoMCTS;
+
+typedef struct ArvoreMCTS {
+    const Caso* caso;
+    const MapaPistas* mapa;
+    const OpcoesMCTS* opcoes;
+    GeradorXoshiro gerador;
+    NoMCTS* nos;                   /* pool: alocado uma vez por partida, nós entregues em sequência */
+    int totalNos;
+    int cheia;                     /* o pool esgotou nesta jogada */
+    int* caminho;                  /* pilha da descida (horizonte + 2) */
+    long long prazo;
+    long long playouts;
+} ArvoreMCTS;
+
+/* Maior número de pistas coletadas contra um mesmo suspeito (e quem) */
+static int melhorAcusacao(const Caso* caso, const MapaPistas* mapa, uint64_t coletadas, int* suspeito) {
+    int maior = 0, quem = -1;
+    for (int s = 0; s < caso->totalSuspeitos; ++s) {
+        uint64_t doSuspeito = coletadas & mapa->mascaraSuspeito[s];
+#if defined(__GNUC__)
+        int total = __builtin_popcountll(doSuspeito);
+#else
+        int total = 0;
+        for (; doSuspeito; doSuspeito &= doSuspeito - 1) total++;
+#endif
+        if (total > maior || quem < 0) { maior = total; quem = s; }
+    }
+    if (suspeito) *suspeito = quem;
+    return maior;
+}
+
+/* Acusar agora: 1 se confirma (menos uma fração pelas portas gastas), senão 0 */
+static double recompensaMCTS(const ArvoreMCTS* arvore, uint64_t coletadas, int passos) {
+    if (melhorAcusacao(arvore->caso, arvore->mapa, coletadas, NULL) < PISTAS_PARA_CONDENAR) return 0.0;
+    return 1.0 - (double)passos / (2.0 * (arvore->opcoes->horizonte + 1));
+}
+
+static uint64_t coletarNaSala(const MapaPistas* mapa, uint64_t coletadas, int sala) {
+    int pista = mapa->pistaDaSala[sala];
+    return pista >= 0 ? coletadas | 1ULL << pista : coletadas;
+}
+
+static int novoNoMCTS(ArvoreMCTS* arvore, int sala, int passos, uint64_t coletadas, int acao) {
+    if (arvore->totalNos == arvore->opcoes->nosPorThread) {
+        arvore->cheia = 1;
+        return -1;
+    }
+
+    const Caso* caso = arvore->caso;
+    int id = arvore->totalNos++;
+    NoMCTS* no = &arvore->nos[id];
+    no->sala = sala;
+    no->passos = passos;
+    no->coletadas = coletadas;
+    no->acao = acao;
+    no->filho = no->irmao = -1;
+    no->proxima = 0;
+    /* Portas (se ainda houver passos) + acusar; o nó de acusação é terminal */
+    no->totalAcoes = acao == MCTS_ACUSAR ? 0
+                   : (passos < arvore->opcoes->horizonte ? caso->inicioPortas[sala + 1] - caso->inicioPortas[sala] : 0) + 1;
+    no->visitas = 0;
+    no->soma = 0.0;
+    return id;
+}
+
+/* Jogador aleatório a partir do estado: acusa assim que tiver evidência */
+static double simularMCTS(ArvoreMCTS* arvore, int sala, int passos, uint64_t coletadas) {
+    const Caso* caso = arvore->caso;
+
+    for (;;) {
+        if (melhorAcusacao(caso, arvore->mapa, coletadas, NULL) >= PISTAS_PARA_CONDENAR)
+            return recompensaMCTS(arvore, coletadas, passos);
+        int portas = caso->inicioPortas[sala + 1] - caso->inicioPortas[sala];
+        if (passos >= arvore->opcoes->horizonte || portas == 0) return 0.0;
+        sala = caso->destinoPortas[caso->inicioPortas[sala] + sortearAte(&arvore->gerador, portas)];
+        coletadas = coletarNaSala(arvore->mapa, coletadas, sala);
+        passos++;
+    }
+}
+
+/* Uma iteração: seleção (UCB1), expansão, simulação e retropropagação */
+static void iterarMCTS(ArvoreMCTS* arvore) {
+    const Caso* caso = arvore->caso;
+    int profundidade = 0, atual = 0;
+    double valor;
+
+    arvore->caminho[profundidade++] = 0;
+    for (;;) {
+        NoMCTS* no = &arvore->nos[atual];
+        if (no->totalAcoes == 0) {                       /* terminal: acusação */
+            valor = recompensaMCTS(arvore, no->coletadas, no->passos);
+            break;
+        }
+        if (no->proxima < no->totalAcoes) {              /* expande uma ação nova */
+            int acao = no->proxima == no->totalAcoes - 1 ? MCTS_ACUSAR : no->proxima;
+            int sala = no->sala, passos = no->passos;
+            uint64_t coletadas = no->coletadas;
+            if (acao != MCTS_ACUSAR) {
+                sala = caso->destinoPortas[caso->inicioPortas[no->sala] + acao];
+                coletadas = coletarNaSala(arvore->mapa, coletadas, sala);
+                passos++;
+            }
+            int filho = novoNoMCTS(arvore, sala, passos, coletadas, acao);
+            if (filho < 0) return;   /* pool cheio: sem o nó, a ação nunca sairia da fila; buscarMCTS para */
+            no = &arvore->nos[atual];
+            no->proxima++;
+            arvore->nos[filho].irmao = no->filho;
+            no->filho = filho;
+            arvore->caminho[profundidade++] = filho;
+            valor = acao == MCTS_ACUSAR ? recompensaMCTS(arvore, coletadas, passos)
+                                        : simularMCTS(arvore, sala, passos, coletadas);
+            break;
+        }
+
+        /* Totalmente expandido: desce pelo filho de maior UCB1 */
+        double logPai = log((double)no->visitas), melhor = -1.0;
+        int escolhido = -1;
+        for (int f = no->filho; f >= 0; f = arvore->nos[f].irmao) {
+            const NoMCTS* c = &arvore->nos[f];
+            double ucb = c->soma / c->visitas + MCTS_EXPLORACAO * sqrt(logPai / c->visitas);
+            if (ucb > melhor) { melhor = ucb; escolhido = f; }
+        }
+        atual = escolhido;
+        arvore->caminho[profundidade++] = atual;
+    }
+
+    for (int i = 0; i < profundidade; ++i) {
+        arvore->nos[arvore->caminho[i]].visitas++;
+        arvore->nos[arvore->caminho[i]].soma += valor;
+    }
+    arvore->playouts++;
+}
+
+static void buscarMCTS(void* arg, long de, long ate) {
+    ArvoreMCTS* arvores = (ArvoreMCTS*) arg;
+
+    for (long t = de; t < ate; ++t) {
+        do {
+            for (int i = 0; i < 64 && !arvores[t].cheia; ++i) iterarMCTS(&arvores[t]);
+        } while (!arvores[t].cheia && agoraMs() < arvores[t].prazo);
+    }
+}
+
+int iniciarRoboDetetive(RoboDetetive* robo, const Caso* caso, const OpcoesMCTS* opcoes) {
+    /* Mais árvores que trabalhadores só dividiriam o mesmo prazo */
+    Escalonador* escalonador = escalonadorGlobal();
+    int threads = opcoes->threads > 0 && opcoes->threads < escalonador->total ? opcoes->threads : escalonador->total;
+
+    memset(robo, 0, sizeof(*robo));
+    robo->opcoes = *opcoes;
+    if (robo->opcoes.nosPorThread < 1) robo->opcoes.nosPorThread = 1;   /* a raiz sempre cabe */
+    for (int id = 0; id < caso->totalSalas; ++id)
+        if (caso->inicioPortas[id + 1] - caso->inicioPortas[id] + 1 > robo->maxAcoes)
+            robo->maxAcoes = caso->inicioPortas[id + 1] - caso->inicioPortas[id] + 1;
+    int mapaPronto = montarMapaPistas(&robo->mapa, caso);
+    robo->arvores = (ArvoreMCTS*) calloc((size_t)threads, sizeof(ArvoreMCTS));
+    robo->visitas = (uint32_t*) calloc((size_t)robo->maxAcoes + 1, sizeof(uint32_t));
+    robo->somas = (double*) calloc((size_t)robo->maxAcoes + 1, sizeof(double));
+    if (!mapaPronto || !robo->arvores || !robo->visitas || !robo->somas) {
+        liberarRoboDetetive(robo);
+        return 0;
+    }
+    robo->threads = threads;
+    for (int t = 0; t < threads; ++t) {
+        ArvoreMCTS* a = &robo->arvores[t];
+        a->nos = (NoMCTS*) malloc(sizeof(NoMCTS) * (size_t)robo->opcoes.nosPorThread);
+        a->caminho = (int*) malloc(sizeof(int) * ((size_t)opcoes->horizonte + 2));
+        if (!a->nos || !a->caminho) {
+            liberarRoboDetetive(robo);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void liberarRoboDetetive(RoboDetetive* robo) {
+    if (robo->arvores)
+        for (int t = 0; t < robo->threads; ++t) {
+            free(robo->arvores[t].nos);
+            free(robo->arvores[t].caminho);
+        }
+    free(robo->arvores);
+    free(robo->visitas);
+    free(robo->somas);
+    liberarMapaPistas(&robo->mapa);
+    memset(robo, 0, sizeof(*robo));
+}
+
+int jogadaMCTS(RoboDetetive* robo, const Caso* caso, const Sessao* sessao, ResultadoMCTS* resultado) {
+    const MapaPistas* mapa = &robo->mapa;
+    if (!mapa->cabeEm64) return 0;
+
+    int sala = sessao->atual->id;
+    int acoes = caso->inicioPortas[sala + 1] - caso->inicioPortas[sala] + 1;
+    uint64_t coletadas = 0;
+    for (int p = 0; p < caso->totalPistas && p < sessao->totalBits; ++p)
+        if ((sessao->coletadas[p >> 3] >> (p & 7)) & 1) coletadas |= 1ULL << p;
+    memset(robo->visitas, 0, sizeof(uint32_t) * (size_t)acoes);
+    memset(robo->somas, 0, sizeof(double) * (size_t)acoes);
+
+    /* Paralelismo de raiz: uma árvore independente por tarefa, somadas no fim */
+    GeradorXoshiro gerador;
+    semearXoshiro(&gerador, (uint64_t)agoraMs() ^ ((uint64_t)sala << 32) ^ coletadas);
+    long long prazo = agoraMs() + robo->opcoes.tempoMs;
+    for (int t = 0; t < robo->threads; ++t) {
+        ArvoreMCTS* a = &robo->arvores[t];
+        a->caso = caso;
+        a->mapa = mapa;
+        a->opcoes = &robo->opcoes;
+        a->gerador = gerador;
+        saltarXoshiro(&gerador);
+        a->totalNos = 0;
+        a->cheia = 0;
+        a->playouts = 0;
+        a->prazo = prazo;
+        novoNoMCTS(a, sala, 0, coletarNaSala(mapa, coletadas, sala), MCTS_RAIZ);
+    }
+    paraCadaParalelo(escalonadorGlobal(), 0, robo->threads, 1, buscarMCTS, robo->arvores);
+
+    resultado->playouts = resultado->nos = 0;
+    resultado->arvoresCheias = 0;
+    for (int t = 0; t < robo->threads; ++t) {
+        const ArvoreMCTS* a = &robo->arvores[t];
+        for (int f = a->nos[0].filho; f >= 0; f = a->nos[f].irmao) {
+            int i = a->nos[f].acao == MCTS_ACUSAR ? acoes - 1 : a->nos[f].acao;
+            robo->visitas[i] += a->nos[f].visitas;
+            robo->somas[i] += a->nos[f].soma;
+        }
+        resultado->playouts += a->playouts;
+        resultado->nos += a->totalNos;
+        resultado->arvoresCheias += a->cheia;
+    }
+
+    /* Jogada mais visitada (critério robusto) */
+    int melhor = acoes - 1;
+    for (int i = 0; i < acoes; ++i)
+        if (robo->visitas[i] > robo->visitas[melhor]) melhor = i;
+    resultado->acao = melhor == acoes - 1 ? MCTS_ACUSAR : melhor;
+    resultado->valor = robo->visitas[melhor] ? robo->somas[melhor] / robo->visitas[melhor] : 0.0;
+    melhorAcusacao(caso, mapa, coletarNaSala(mapa, coletadas, sala), &resultado->suspeito);
+    return 1;
+}
+
+void opcoesMCTSPadrao(OpcoesMCTS* opcoes) {
+    opcoes->tempoMs = MCTS_TEMPO_PADRAO_MS;
+    opcoes->threads = 0;
+    opcoes->horizonte = MCTS_HORIZONTE_PADRAO;
+    opcoes->nosPorThread = MCTS_NOS_POR_THREAD;
+}
+
+int exibirOraculo(Caso* caso, const Sessao* sessao, RoboDetetive* robo) {
+    ResultadoMCTS r;
+
+    if (!robo->arvores) {
+        OpcoesMCTS opcoes;
+        opcoesMCTSPadrao(&opcoes);
+        if (!iniciarRoboDetetive(robo, caso, &opcoes)) {
+            printf("\nMemória insuficiente para o oráculo.\n");
+            return 0;
+        }
+    }
+    if (!jogadaMCTS(robo, caso, sessao, &r)) {
+        printf("\nO oráculo só consegue analisar casos com até 64 pistas.\n");
+        return 0;
+    }
+
+    printf("\nOráculo (%lld simulações em %d ms, valor estimado %.2f de 1):\n",
+           r.playouts, robo->opcoes.tempoMs, r.valor);
+    if (r.arvoresCheias)
+        printf("(%d árvore(s) encheram o pool de %d nós antes do prazo)\n", r.arvoresCheias, robo->opcoes.nosPorThread);
+    if (r.acao == MCTS_ACUSAR)
+        printf("Acuse %s agora.\n", caso->suspeitosPorId[r.suspeito]->nome);
+    else
+        printf("Siga pela porta (%d) %s -> %s.\n", r.acao + 1, rotuloDaPorta(caso, sessao->atual, r.acao),
+               destinoDaPorta(caso, sessao->atual, r.acao)->nome);
+    return 1;
+}
+
+int jogarComRobo(Caso* caso, const OpcoesMCTS* opcoes, int verboso, long long* simulacoes) {
+    RoboDetetive robo;
+    Sessao sessao;
+    int portas = 0;
+
+    if (!iniciarRoboDetetive(&robo, caso, opcoes)) return -1;
+    if (iniciarSessao(&sessao, caso) != SESSAO_OK) {
+        liberarRoboDetetive(&robo);
+        return -1;
+    }
+    entrarNaSala(caso, &sessao, sessao.atual);
+    if (simulacoes) *simulacoes = 0;
+    for (;;) {
+        ResultadoMCTS r;
+        robo.opcoes.horizonte = opcoes->horizonte - portas;
+        if (!jogadaMCTS(&robo, caso, &sessao, &r)) {
+            portas = -1;
+            break;
+        }
+        if (simulacoes) *simulacoes += r.playouts;
+        if (r.acao == MCTS_ACUSAR || robo.opcoes.horizonte == 0) {
+            avaliarAcusacao(caso, &sessao, caso->suspeitosPorId[r.suspeito]->nome);
+            if (verboso)
+                printf("Robô acusa %s após %d porta(s): %s.\n", sessao.acusado, portas,
+                       sessao.estadoAcusacao == ACUSACAO_CONFIRMADA ? "confirmada"
+                       : sessao.estadoAcusacao == ACUSACAO_FRAGIL ? "frágil" : "sem fundamento");
+            break;
+        }
+        if (verboso)
+            printf("%s -> (%s) %s  [%lld simulações]\n", sessao.atual->nome,
+                   rotuloDaPorta(caso, sessao.atual, r.acao), destinoDaPorta(caso, sessao.atual, r.acao)->nome,
+                   r.playouts);
+        atravessarPorta(caso, &sessao, r.acao);
+        portas++;
+    }
+    if (portas >= 0 && sessao.estadoAcusacao != ACUSACAO_CONFIRMADA) portas = -1;
+    liberarSessao(&sessao);
+    liberarRoboDetetive(&robo);
+    return portas;
+}
+
+/* ----------------- Arquivo de caso e gerador ----------------- */
+
+void montarCasoPadrao(Caso* caso) {
+    /*
+     *                 [Hall de Entrada]
+     *                   /           \
+     *            [Biblioteca]       [Cozinha]
+     *             /      \             \
+     *       [Sala de Estudo] [Jardim]  [Sótão]
+     *
+     * Cada cômodo tem uma pista estática definida abaixo. Além das portas da
+     * árvore, há portas extras que fecham ciclos (montadas mais abaixo).
+     */
+    Sala* hall       = criarSala("Hall de Entrada", "Pegadas de lama recentes");
+    Sala* biblioteca = criarSala("Biblioteca", "Página arrancada de um diário");
+    Sala* cozinha    = criarSala("Cozinha", "Copo quebrado com marca de batom");
+    Sala* estudo     = criarSala("Sala de Estudo", "Envelope selado com cera vermelha");
+    Sala* jardim     = criarSala("Jardim", "Chave antiga caída entre as flores");
+    Sala* sotao      = criarSala("Sótão", "Retrato rasgado de uma mulher desconhecida");
+
+    hall->esquerda       = biblioteca;
+    hall->direita        = cozinha;
+    biblioteca->esquerda = estudo;
+    biblioteca->direita  = jardim;
+    cozinha->direita     = sotao;
+
+    /* Tabela hash + índices */
+    inicializarCaso(caso, hall);
+
+    /*
+     * Associação pista -> suspeito (pré-definida)
+     *
+     * Observação: não há inserção dinâmica de suspeitos neste nível.
+     */
+    cadastrarPista(caso, "Pegadas de lama recentes", "Jardineiro");
+    cadastrarPista(caso, "Página arrancada de um diário", "Governanta");
+    cadastrarPista(caso, "Copo quebrado com marca de batom", "Madame Sinclair");
+    cadastrarPista(caso, "Envelope selado com cera vermelha", "Governanta");
+    cadastrarPista(caso, "Chave antiga caída entre as flores", "Jardineiro");
+    cadastrarPista(caso, "Retrato rasgado de uma mulher desconhecida", "Madame Sinclair");
+
+    /* Portas extras (o mapa deixa de ser só uma árvore) */
+    int passagem = registrarRotulo(caso, "passagem secreta");
+    int servico  = registrarRotulo(caso, "porta de serviço");
+    adicionarPorta(caso, estudo->id, sotao->id, passagem, 3);
+    adicionarPorta(caso, sotao->id, estudo->id, passagem, 3);
+    adicionarPorta(caso, jardim->id, cozinha->id, servico, 2);
+    adicionarPorta(caso, cozinha->id, jardim->id, servico, 2);
+    construirPortas(caso);
+}
+
+/* Primeiro texto do caso que o formato de arquivo não representa ('|' ou quebra de linha), ou NULL */
+static const char* textoForaDoFormatoCaso(const Caso* caso) {
+    for (int id = 0; id < caso->totalSalas; ++id) {
+        const Sala* s = caso->salasPorId[id];
+        if (s->nome[strcspn(s->nome, "|\r\n")] != '\0') return s->nome;
+        if (s->pista[strcspn(s->pista, "|\r\n")] != '\0') return s->pista;
+    }
+    for (int p = 0; p < caso->totalPistas; ++p) {
+        const SuspeitoNode* no = caso->pistasPorId[p];
+        if (no->pista[strcspn(no->pista, "|\r\n")] != '\0') return no->pista;
+        if (no->suspeito[strcspn(no->suspeito, "|\r\n")] != '\0') return no->suspeito;
+    }
+    for (int r = 0; r < caso->totalRotulos; ++r)
+        if (caso->rotulos[r][strcspn(caso->rotulos[r], "|\r\n")] != '\0') return caso->rotulos[r];
+    return NULL;
+}
+
+int gravarCaso(const Caso* caso, const char* arquivo) {
+    const char* invalido = textoForaDoFormatoCaso(caso);
+    if (invalido) {
+        fprintf(stderr, "Erro: \"%s\" tem '|' ou quebra de linha e não cabe no arquivo de caso\n", invalido);
+        return 0;
+    }
+
+    FILE* f = fopen(arquivo, "w");
+    if (!f) return 0;
+
+    fprintf(f, "%s %d\n", CASO_MAGICO, CASO_VERSAO);
+    fprintf(f, "# sala|nome|pista|sala de cima|e ou d (pré-ordem; a primeira é a entrada)\n");
+    for (int id = 0; id < caso->totalSalas; ++id) {
+        const Sala* s = caso->salasPorId[id];
+        fprintf(f, "sala|%s|%s|%s|%s\n", s->nome, s->pista, s->pai ? s->pai->nome : "",
+                !s->pai ? "" : s->pai->esquerda == s ? "e" : "d");
+    }
+    fprintf(f, "# pista|texto|suspeito\n");
+    for (int p = 0; p < caso->totalPistas; ++p)
+        fprintf(f, "pista|%s|%s\n", caso->pistasPorId[p]->pista, caso->pistasPorId[p]->suspeito);
+    fprintf(f, "# porta|origem|destino|rótulo|custo (além das portas da árvore)\n");
+    for (int id = 0; id < caso->totalSalas; ++id) {
+        const Sala* s = caso->salasPorId[id];
+        for (int p = caso->inicioPortas[id] + portasDaArvore(s); p < caso->inicioPortas[id + 1]; ++p)
+            fprintf(f, "porta|%s|%s|%s|%d\n", s->nome, caso->salasPorId[caso->destinoPortas[p]]->nome,
+                    caso->rotulos[caso->rotuloPortas[p]], caso->custoPortas[p]);
+    }
+    for (int i = 0; i < caso->totalAvulsas; ++i)   /* ainda fora do CSR */
+        fprintf(f, "porta|%s|%s|%s|%d\n", caso->salasPorId[caso->avulsasOrigem[i]]->nome,
+                caso->salasPorId[caso->avulsasDestino[i]]->nome, caso->rotulos[caso->avulsasRotulo[i]],
+                caso->avulsasCusto[i]);
+
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    return ok;
+}
+
+/* Próxima linha com conteúdo (sem comentários e sem o fim de linha); -1 se não coube no buffer */
+static int lerLinhaCaso(FILE* f, char* linha, int tamanho, int* numero) {
+    while (fgets(linha, tamanho, f)) {
+        (*numero)++;
+        if (!strchr(linha, '\n') && !feof(f)) return -1;
+        linha[strcspn(linha, "\r\n")] = '\0';
+        if (linha[0] != '\0' && linha[0] != '#') return 1;
+    }
+    return 0;
+}
+
+/* Quebra a linha nos '|' (no próprio buffer); mais campos que `maximo` devolve maximo + 1 */
+static int dividirCampos(char* linha, char** campos, int maximo) {
+    int total = 1;
+    campos[0] = linha;
+    for (char* p = linha; *p; ++p) {
+        if (*p != '|') continue;
+        if (total == maximo) return maximo + 1;
+        *p = '\0';
+        campos[total++] = p + 1;
+    }
+    return total;
+}
+
+/* Índice nome -> posição em `salas` da 1ª passada (o caso ainda não existe, nem o salasPorNome dele) */
+typedef struct {
+    int* posicoes;                 /* -1 = vazio */
+    uint32_t* hashes;
+    int capacidade;                /* potência de 2, sempre mais que o dobro das salas */
+} IndiceNomesCaso;
+
+static void inserirNomeCaso(IndiceNomesCaso* indice, Sala* const* salas, int posicao) {
+    uint32_t h = acumularAssinatura(2166136261u, salas[posicao]->nome);
+    int mascara = indice->capacidade - 1, i = (int)(h & (uint32_t)mascara);
+    while (indice->posicoes[i] >= 0) i = (i + 1) & mascara;
+    indice->posicoes[i] = posicao;
+    indice->hashes[i] = h;
+}
+
+/* Indexa salas[posicao], dobrando a tabela quando preciso; 0 sem memória */
+static int indexarNomeCaso(IndiceNomesCaso* indice, Sala* const* salas, int posicao) {
+    if (2 * (posicao + 1) >= indice->capacidade) {
+        int capacidade = indice->capacidade ? indice->capacidade * 2 : 32;
+        int* posicoes = (int*) malloc(sizeof(int) * (size_t)capacidade);
+        uint32_t* hashes = (uint32_t*) malloc(sizeof(uint32_t) * (size_t)capacidade);
+        if (!posicoes || !hashes) {
+            free(posicoes);
+            free(hashes);
+            return 0;
+        }
+        free(indice->posicoes);
+        free(indice->hashes);
+        indice->posicoes = posicoes;
+        indice->hashes = hashes;
+        indice->capacidade = capacidade;
+        for (int i = 0; i < capacidade; ++i) posicoes[i] = -1;
+        for (int p = 0; p < posicao; ++p) inserirNomeCaso(indice, salas, p);
+    }
+    inserirNomeCaso(indice, salas, posicao);
+    return 1;
+}
+
+/* Primeira sala com exatamente esse nome: as inserções seguem a ordem do arquivo, então a
+ * sondagem encontra a mais antiga antes das repetidas (como a busca linear que o índice substitui) */
+static Sala* buscarNomeCaso(const IndiceNomesCaso* indice, Sala* const* salas, const char* nome) {
+    if (indice->capacidade == 0) return NULL;
+    uint32_t h = acumularAssinatura(2166136261u, nome);
+    int mascara = indice->capacidade - 1;
+    for (int i = (int)(h & (uint32_t)mascara); indice->posicoes[i] >= 0; i = (i + 1) & mascara)
+        if (indice->hashes[i] == h && strcmp(salas[indice->posicoes[i]]->nome, nome) == 0)
+            return salas[indice->posicoes[i]];
+    return NULL;
+}
+
+int carregarCaso(Caso* caso, const char* arquivo) {
+    char linha[512];
+    char* campos[5];
+    const char* erro = NULL;
+    Sala** salas = NULL;
+    IndiceNomesCaso nomes = { NULL, NULL, 0 };
+    int totalSalas = 0, capacidade = 0, numero = 0, versao = 0, lida;
+
+    FILE* f = fopen(arquivo, "r");
+    if (!f) {
+        fprintf(stderr, "Erro: não foi possível abrir o caso '%s'\n", arquivo);
+        return 0;
+    }
+    lida = lerLinhaCaso(f, linha, sizeof(linha), &numero);
+    if (lida <= 0 || sscanf(linha, CASO_MAGICO " %d", &versao) != 1 || versao != CASO_VERSAO)
+        erro = "cabeçalho ou versão do formato inválidos";
+
+    /* 1ª passada: a planta (o caso só pode ser iniciado com a árvore pronta) */
+    while (!erro && (lida = lerLinhaCaso(f, linha, sizeof(linha), &numero)) != 0) {
+        if (lida < 0) {
+            erro = "linha longa demais";
+            break;
+        }
+        int n = dividirCampos(linha, campos, 5);
+        if (strcmp(campos[0], "sala") != 0) continue;
+        if (n != 5 || campos[1][0] == '\0') {
+            erro = "esperado sala|nome|pista|sala de cima|e ou d";
+            break;
+        }
+
+        Sala** saida = NULL;
+        if (totalSalas == 0) {
+            if (campos[3][0] != '\0') erro = "a primeira sala é a entrada e não tem sala de cima";
+        } else {
+            Sala* pai = buscarNomeCaso(&nomes, salas, campos[3]);
+            if (!pai) erro = "sala de cima desconhecida (ela deve vir antes)";
+            else if (strcmp(campos[4], "e") == 0) saida = &pai->esquerda;
+            else if (strcmp(campos[4], "d") == 0) saida = &pai->direita;
+            else erro = "lado deve ser 'e' ou 'd'";
+            if (saida && *saida) erro = "saída da sala de cima já ocupada";
+        }
+        if (erro) break;
+
+        if (totalSalas == capacidade) {
+            capacidade = capacidade ? capacidade * 2 : 16;
+            Sala** v = (Sala**) realloc(salas, sizeof(Sala*) * (size_t)capacidade);
+            if (!v) {
+                erro = "memória insuficiente para as salas do caso";
+                break;
+            }
+            salas = v;
+        }
+        salas[totalSalas] = criarSala(campos[1], campos[2]);
+        if (saida) *saida = salas[totalSalas];
+        if (!indexarNomeCaso(&nomes, salas, totalSalas)) erro = "memória insuficiente para o índice de salas";
+        totalSalas++;
+    }
+    free(nomes.posicoes);
+    free(nomes.hashes);
+    if (!erro && totalSalas == 0) erro = "o caso não tem salas";
+    if (erro) {
+        fprintf(stderr, "Erro: %s:%d: %s\n", arquivo, numero, erro);
+        if (totalSalas > 0) liberarMansao(salas[0]);
+        free(salas);
+        fclose(f);
+        return 0;
+    }
+    inicializarCaso(caso, salas[0]);
+    free(salas);
+
+    /* 2ª passada: pistas e portas, na ordem do arquivo */
+    rewind(f);
+    numero = 0;
+    lerLinhaCaso(f, linha, sizeof(linha), &numero);
+    while (!erro && (lida = lerLinhaCaso(f, linha, sizeof(linha), &numero)) > 0) {
+        int n = dividirCampos(linha, campos, 5);
+        if (strcmp(campos[0], "sala") == 0) continue;
+        if (strcmp(campos[0], "pista") == 0) {
+            if (n != 3 || campos[1][0] == '\0' || campos[2][0] == '\0') erro = "esperado pista|texto|suspeito";
+            else cadastrarPista(caso, campos[1], campos[2]);
+        } else if (strcmp(campos[0], "porta") == 0) {
+            Sala* origem = n == 5 ? buscarSala(caso, campos[1]) : NULL;
+            Sala* destino = n == 5 ? buscarSala(caso, campos[2]) : NULL;
+            int custo = n == 5 ? atoi(campos[4]) : 0;
+            if (n != 5 || campos[3][0] == '\0') erro = "esperado porta|origem|destino|rótulo|custo";
+            else if (!origem || !destino) erro = "porta para sala desconhecida";
+            else if (custo < 1 || custo > UINT16_MAX) erro = "custo da porta fora de 1..65535";
+            else adicionarPorta(caso, origem->id, destino->id, registrarRotulo(caso, campos[3]), custo);
+        } else {
+            erro = "registro desconhecido (esperado sala, pista ou porta)";
+        }
+    }
+    fclose(f);
+
+    /* A planta é endereçada por nome e toda pista de sala precisa de um suspeito */
+    for (int id = 0; id < caso->totalSalas && !erro; ++id) {
+        const Sala* s = caso->salasPorId[id];
+        if (buscarSala(caso, s->nome) != s) erro = "nome de sala repetido";
+        else if (s->pista[0] != '\0' && !buscarNaHash(caso->tabela, s->pista)) erro = "pista de sala sem suspeito";
+        if (erro) numero = 0;
+    }
+    if (erro) {
+        if (numero > 0) fprintf(stderr, "Erro: %s:%d: %s\n", arquivo, numero, erro);
+        else fprintf(stderr, "Erro: %s: %s\n", arquivo, erro);
+        liberarCaso(caso);
+        return 0;
+    }
+    construirPortas(caso);
+    return 1;
+}
+
+int resolverCasoExaustivo(const Caso* caso, const MapaPistas* mapa, int suspeito, int limiar) {
+    int n = caso->totalSalas, k = 0;
+    int* bitDaPista = (int*) malloc(sizeof(int) * ((size_t)caso->totalPistas + 1));
+
+    if (!bitDaPista) return -3;
+    for (int p = 0; p < caso->totalPistas; ++p)
+        bitDaPista[p] = mapa->suspeitoDaPista[p] == suspeito ? k++ : -1;
+    if (k < limiar || k > 16 || ((size_t)n << k) > RESOLVEDOR_MAX_ESTADOS) {
+        free(bitDaPista);
+        return k < limiar ? -1 : -2;
+    }
+
+    /* Estado = sala << k | pistas do suspeito já em mãos; BFS = menos portas */
+    size_t estados = (size_t)n << k;
+    int* distancia = (int*) malloc(sizeof(int) * estados);
+    uint32_t* fila = (uint32_t*) malloc(sizeof(uint32_t) * estados);
+    if (!distancia || !fila) {
+        free(distancia);
+        free(fila);
+        free(bitDaPista);
+        return -3;
+    }
+    for (size_t e = 0; e < estados; ++e) distancia[e] = -1;
+
+    int resposta = -1;
+    size_t inicio = 0, fim = 0;
+    int pista = mapa->pistaDaSala[0];
+    uint32_t origem = pista >= 0 && bitDaPista[pista] >= 0 ? 1u << bitDaPista[pista] : 0;
+    distancia[origem] = 0;
+    fila[fim++] = origem;
+    while (inicio < fim) {
+        uint32_t e = fila[inicio++];
+        uint32_t sala = e >> k, coletadas = e & ((1u << k) - 1);
+        if (contarBits(coletadas) >= limiar) {
+            resposta = distancia[e];
+            break;
+        }
+        for (int p = caso->inicioPortas[sala]; p < caso->inicioPortas[sala + 1]; ++p) {
+            int destino = caso->destinoPortas[p];
+            int q = mapa->pistaDaSala[destino];
+            uint32_t mais = coletadas | (q >= 0 && bitDaPista[q] >= 0 ? 1u << bitDaPista[q] : 0);
+            uint32_t proximo = ((uint32_t)destino << k) | mais;
+            if (distancia[proximo] >= 0) continue;
+            distancia[proximo] = distancia[e] + 1;
+            fila[fim++] = proximo;
+        }
+    }
+    free(distancia);
+    free(fila);
+    free(bitDaPista);
+    return resposta;
+}
+
+int avaliarCaso(const Caso* caso, AvaliacaoCaso* avaliacao) {
+    MapaPistas mapa;
+    int n = caso->totalSalas;
+
+    avaliacao->condenaveis = 0;
+    avaliacao->culpado = avaliacao->portas = avaliacao->faixa = -1;
+    avaliacao->armadilhas = 0;
+    if (!montarMapaPistas(&mapa, caso)) return -1;
+    for (int s = 0; s < caso->totalSuspeitos; ++s) {
+        int portas = resolverCasoExaustivo(caso, &mapa, s, PISTAS_PARA_CONDENAR);
+        if (portas == -3) {
+            avaliacao->condenaveis = 0;
+            avaliacao->culpado = avaliacao->portas = -1;
+            liberarMapaPistas(&mapa);
+            return -1;
+        }
+        if (portas == -1) continue;
+        avaliacao->condenaveis++;   /* -2 (grande demais) conta: não dá para garantir que é inocente */
+        avaliacao->culpado = s;
+        avaliacao->portas = portas;
+    }
+    if (avaliacao->condenaveis != 1 || avaliacao->portas < 0) {
+        avaliacao->culpado = avaliacao->portas = -1;
+        liberarMapaPistas(&mapa);
+        return 0;
+    }
+    avaliacao->faixa = avaliacao->portas <= GERADOR_FACIL_MAX_PORTAS ? FAIXA_FACIL
+                       : avaliacao->portas <= GERADOR_MEDIA_MAX_PORTAS ? FAIXA_MEDIA : FAIXA_DIFICIL;
+
+    /* Armadilhas: pistas de inocentes que o jogador encontra antes (ou no caminho) da solução */
+    int* distancia = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    int* fila = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    if (!distancia || !fila) {
+        free(distancia);
+        free(fila);
+        liberarMapaPistas(&mapa);
+        avaliacao->culpado = avaliacao->portas = avaliacao->faixa = -1;
+        return -1;
+    }
+    for (int i = 0; i < n; ++i) distancia[i] = -1;
+    int inicio = 0, fim = 0;
+    distancia[0] = 0;
+    fila[fim++] = 0;
+    while (inicio < fim) {
+        int sala = fila[inicio++];
+        int pista = mapa.pistaDaSala[sala];
+        if (distancia[sala] > avaliacao->portas) break;
+        if (pista >= 0 && mapa.suspeitoDaPista[pista] != avaliacao->culpado) avaliacao->armadilhas++;
+        for (int p = caso->inicioPortas[sala]; p < caso->inicioPortas[sala + 1]; ++p) {
+            int destino = caso->destinoPortas[p];
+            if (distancia[destino] >= 0) continue;
+            distancia[destino] = distancia[sala] + 1;
+            fila[fim++] = destino;
+        }
+    }
+    free(distancia);
+    free(fila);
+    liberarMapaPistas(&mapa);
+    return 1;
+}
+
+static const char* const NOMES_SALAS_GERADAS[] = {
+    "Biblioteca", "Cozinha", "Sala de Estudo", "Jardim", "Sótão", "Adega", "Capela", "Estufa",
+    "Salão de Baile", "Galeria", "Quarto Principal", "Despensa", "Lavanderia", "Torre",
+    "Conservatório", "Sala de Bilhar", "Observatório", "Quarto de Hóspedes", "Escritório", "Sala de Música"
+};
+static const char* const OBJETOS_PISTA[] = {
+    "Luva", "Bilhete", "Lenço", "Botão", "Fio de cabelo", "Frasco", "Cigarro", "Anel", "Recibo", "Fósforo"
+};
+static const char* const DETALHES_PISTA[] = {
+    "manchado de tinta", "com iniciais bordadas", "rasgado ao meio", "escondido sob o tapete",
+    "com cheiro de perfume", "molhado de chuva", "com marcas de dentes", "queimado na ponta"
+};
+static const char* const NOMES_SUSPEITOS[] = {
+    "Mordomo", "Governanta", "Jardineiro", "Madame Sinclair", "Coronel Mostarda", "Dra. Violeta",
+    "Cozinheira", "Motorista"
+};
+
+#define TOTAL_ITENS(v) ((int)(sizeof(v) / sizeof((v)[0])))
+
+/* Embaralha os primeiros `n` índices 0..n-1 (Fisher-Yates) */
+static void embaralharIndices(GeradorXoshiro* gerador, int* v, int n) {
+    for (int i = 0; i < n; ++i) v[i] = i;
+    for (int i = n - 1; i > 0; --i) {
+        int j = sortearAte(gerador, i + 1), t = v[i];
+        v[i] = v[j];
+        v[j] = t;
+    }
+}
+
+void gerarCasoCandidato(Caso* caso, uint64_t semente) {
+    enum { TOTAL_PISTAS_POSSIVEIS = TOTAL_ITENS(OBJETOS_PISTA) * TOTAL_ITENS(DETALHES_PISTA) };
+    GeradorXoshiro g;
+    char nome[MAX_NOME];
+    char textos[GERADOR_MAX_SUSPEITOS * GERADOR_MAX_PISTAS_SUSPEITO][MAX_PISTA];
+    int donos[GERADOR_MAX_SUSPEITOS * GERADOR_MAX_PISTAS_SUSPEITO];
+    int ordemNomes[TOTAL_ITENS(NOMES_SALAS_GERADAS)], ordemSuspeitos[TOTAL_ITENS(NOMES_SUSPEITOS)];
+    int ordemPistas[TOTAL_PISTAS_POSSIVEIS];
+
+    semearXoshiro(&g, semente);
+    int n = GERADOR_MIN_SALAS + sortearAte(&g, GERADOR_MAX_SALAS - GERADOR_MIN_SALAS + 1);
+    Sala** salas = (Sala**) malloc(sizeof(Sala*) * (size_t)n);
+    Sala** abertas = (Sala**) malloc(sizeof(Sala*) * (size_t)n);
+    int* livres = (int*) malloc(sizeof(int) * (size_t)n);
+    if (!salas || !abertas || !livres) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o caso gerado\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Planta: cada sala nova ocupa uma saída livre de uma sala anterior sorteada */
+    int totalNomes = TOTAL_ITENS(NOMES_SALAS_GERADAS), totalAbertas = 0;
+    embaralharIndices(&g, ordemNomes, totalNomes);
+    salas[0] = criarSala("Hall de Entrada", "");
+    abertas[totalAbertas++] = salas[0];
+    for (int i = 1; i < n; ++i) {
+        const char* base = NOMES_SALAS_GERADAS[ordemNomes[(i - 1) % totalNomes]];
+        if (i - 1 < totalNomes) snprintf(nome, sizeof(nome), "%s", base);
+        else snprintf(nome, sizeof(nome), "%s %d", base, (i - 1) / totalNomes + 1);
+        salas[i] = criarSala(nome, "");
+
+        int k = sortearAte(&g, totalAbertas);
+        Sala* pai = abertas[k];
+        if (!pai->esquerda && (pai->direita || sortearAte(&g, 2) == 0)) pai->esquerda = salas[i];
+        else pai->direita = salas[i];
+        if (pai->esquerda && pai->direita) abertas[k] = abertas[--totalAbertas];
+        abertas[totalAbertas++] = salas[i];
+    }
+
+    /* Suspeitos com 1 a GERADOR_MAX_PISTAS_SUSPEITO pistas; cada pista em 1 ou 2 salas */
+    int suspeitos = 3 + sortearAte(&g, GERADOR_MAX_SUSPEITOS - 2), totalPistas = 0, proximaLivre = 0;
+    embaralharIndices(&g, ordemSuspeitos, TOTAL_ITENS(NOMES_SUSPEITOS));
+    embaralharIndices(&g, ordemPistas, TOTAL_PISTAS_POSSIVEIS);
+    embaralharIndices(&g, livres, n);
+    for (int s = 0; s < suspeitos; ++s) {
+        int pistas = 1 + sortearAte(&g, GERADOR_MAX_PISTAS_SUSPEITO);
+        for (int c = 0; c < pistas && proximaLivre < n; ++c) {
+            int combinacao = ordemPistas[totalPistas];
+            snprintf(textos[totalPistas], MAX_PISTA, "%s %s",
+                     OBJETOS_PISTA[combinacao / TOTAL_ITENS(DETALHES_PISTA)],
+                     DETALHES_PISTA[combinacao % TOTAL_ITENS(DETALHES_PISTA)]);
+            donos[totalPistas] = ordemSuspeitos[s];
+            int copias = sortearAte(&g, 4) == 0 ? 2 : 1;
+            for (int k = 0; k < copias && proximaLivre < n; ++k)
+                snprintf(salas[livres[proximaLivre++]]->pista, MAX_PISTA, "%s", textos[totalPistas]);
+            totalPistas++;
+        }
+    }
+
+    inicializarCaso(caso, salas[0]);
+    for (int p = 0; p < totalPistas; ++p) cadastrarPista(caso, textos[p], NOMES_SUSPEITOS[donos[p]]);
+
+    /* Atalhos de mão dupla: o mapa deixa de ser uma árvore */
+    int corredor = registrarRotulo(caso, "corredor");
+    int passagem = registrarRotulo(caso, "passagem secreta");
+    for (int e = 0; e < n / 4; ++e) {
+        int a = salas[sortearAte(&g, n)]->id, b = salas[sortearAte(&g, n)]->id;
+        int rotulo = sortearAte(&g, 3) == 0 ? passagem : corredor;
+        int custo = 1 + sortearAte(&g, 3);
+        if (a == b) continue;
+        adicionarPorta(caso, a, b, rotulo, custo);
+        adicionarPorta(caso, b, a, rotulo, custo);
+    }
+    construirPortas(caso);
+
+    free(salas);
+    free(abertas);
+    free(livres);
+}
+
+static const char* nomeDaFaixa(int faixa) {
+    return faixa == FAIXA_FACIL ? "facil" : faixa == FAIXA_MEDIA ? "media" : "dificil";
+}
+
+/* Semente do candidato `indice`: independe de qual thread o avalia */
+static uint64_t sementeDoCandidato(uint64_t semente, long indice) {
+    return semente ^ ((uint64_t)indice * 0x9E3779B97F4A7C15ULL);
+}
+
+typedef struct {
+    long indice;
+    int armadilhas;
+    int portas;
+    int salas;
+    int suspeitos;
+} CandidatoCaso;
+
+/* Mais armadilhas primeiro; empate pelo menor índice (resultado igual com qualquer número de threads) */
+static int candidatoMelhor(const CandidatoCaso* a, const CandidatoCaso* b) {
+    if (a->armadilhas != b->armadilhas) return a->armadilhas > b->armadilhas;
+    return a->indice < b->indice;
+}
+
+/* Insere no ranking ordenado de até GERADOR_MELHORES posições */
+static void guardarCandidato(CandidatoCaso* melhores, int* total, const CandidatoCaso* c) {
+    int i = *total < GERADOR_MELHORES ? (*total)++ : GERADOR_MELHORES;
+    if (i == GERADOR_MELHORES && !candidatoMelhor(c, &melhores[GERADOR_MELHORES - 1])) return;
+    if (i == GERADOR_MELHORES) i--;
+    while (i > 0 && candidatoMelhor(c, &melhores[i - 1])) {
+        melhores[i] = melhores[i - 1];
+        i--;
+    }
+    melhores[i] = *c;
+}
+
+typedef struct {
+    long validos;
+    long semMemoria;   /* candidatos que avaliarCaso() não conseguiu avaliar: não contam como inválidos */
+    long porFaixa[3];
+    CandidatoCaso melhores[GERADOR_MELHORES];
+    int totalMelhores;
+} ResultadoGerador;
+
+typedef struct {
+    uint64_t semente;
+    int faixa;
+    ResultadoGerador* porTrabalhador;   /* cada tarefa escreve só no slot do seu trabalhador */
+} RodadaGerador;
+
+static void gerarFaixa(void* arg, long inicio, long fim) {
+    RodadaGerador* rodada = (RodadaGerador*) arg;
+    ResultadoGerador* r = &rodada->porTrabalhador[trabalhadorAtual() < 0 ? 0 : trabalhadorAtual()];
+
+    for (long i = inicio; i < fim; ++i) {
+        Caso caso;
+        AvaliacaoCaso avaliacao;
+        gerarCasoCandidato(&caso, sementeDoCandidato(rodada->semente, i));
+        int resultado = avaliarCaso(&caso, &avaliacao);
+        if (resultado < 0) r->semMemoria++;
+        if (resultado == 1) {
+            r->validos++;
+            r->porFaixa[avaliacao.faixa]++;
+            if (avaliacao.faixa == rodada->faixa) {
+                CandidatoCaso c = { i, avaliacao.armadilhas, avaliacao.portas, caso.totalSalas, caso.totalSuspeitos };
+                guardarCandidato(r->melhores, &r->totalMelhores, &c);
+            }
+        }
+        liberarCaso(&caso);
+    }
+}
+
+int gerarCasos(int faixa, long candidatos, uint64_t semente) {
+    Escalonador* escalonador = escalonadorGlobal();
+    int trabalhadores = escalonador->total;
+    RodadaGerador rodada = { semente, faixa, NULL };
+
+    rodada.porTrabalhador = (ResultadoGerador*) calloc((size_t)trabalhadores, sizeof(ResultadoGerador));
+    if (!rodada.porTrabalhador) {
+        fprintf(stderr, "Erro: falha na alocação de memória para o gerador\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long long t0 = agoraMs();
+    zerarEstatisticasEscalonador(escalonador);
+    paraCadaParalelo(escalonador, 0, candidatos, 16, gerarFaixa, &rodada);
+    long long ms = agoraMs() - t0;
+
+    CandidatoCaso melhores[GERADOR_MELHORES];
+    int totalMelhores = 0;
+    long validos = 0, semMemoria = 0, porFaixa[3] = { 0, 0, 0 };
+    for (int t = 0; t < trabalhadores; ++t) {
+        const ResultadoGerador* r = &rodada.porTrabalhador[t];
+        validos += r->validos;
+        semMemoria += r->semMemoria;
+        for (int f = 0; f < 3; ++f) porFaixa[f] += r->porFaixa[f];
+        for (int i = 0; i < r->totalMelhores; ++i) guardarCandidato(melhores, &totalMelhores, &r->melhores[i]);
+    }
+    printf("Gerador: %ld candidatos em %lld ms (%.0f/s, %d trabalhador(es)).\n", candidatos, ms,
+           ms > 0 ? (double)candidatos * 1000.0 / (double)ms : 0.0, trabalhadores);
+    exibirEstatisticasEscalonador(escalonador);
+    printf("Válidos: %ld (fácil %ld, média %ld, difícil %ld).\n", validos, porFaixa[FAIXA_FACIL],
+           porFaixa[FAIXA_MEDIA], porFaixa[FAIXA_DIFICIL]);
+    if (semMemoria) printf("(%ld candidato(s) não avaliado(s) por falta de memória)\n", semMemoria);
+
+    /* Os vencedores são remontados pela semente: nenhum caso fica guardado durante a rodada */
+    int gravados = 0;
+    for (int i = 0; i < totalMelhores; ++i) {
+        char arquivo[64];
+        Caso caso;
+        snprintf(arquivo, sizeof(arquivo), "caso-%s-%d.txt", nomeDaFaixa(faixa), i + 1);
+        gerarCasoCandidato(&caso, sementeDoCandidato(semente, melhores[i].indice));
+        if (gravarCaso(&caso, arquivo)) {
+            printf("%s: %d salas, %d suspeitos, culpado em %d porta(s), %d armadilha(s).\n", arquivo,
+                   melhores[i].salas, melhores[i].suspeitos, melhores[i].portas, melhores[i].armadilhas);
+            gravados++;
+        } else {
+            fprintf(stderr, "Aviso: não foi possível gravar '%s'.\n", arquivo);
+        }
+        liberarCaso(&caso);
+    }
+    if (totalMelhores == 0) printf("Nenhum candidato válido na faixa %s.\n", nomeDaFaixa(faixa));
+
+    free(rodada.porTrabalhador);
+    return gravados;
+}
+
+/* ----------------- Catálogo de casos (recarga a quente) ----------------- */
+
+int iniciarCatalogoCasos(CatalogoCasos* catalogo, Caso* caso, const char* arquivo) {
+    atomic_init(&catalogo->atual, NULL);
+    iniciarDominioRCU(&catalogo->rcu);
+    pthread_mutex_init(&catalogo->publicacao, NULL);
+    catalogo->arquivo = arquivo;
+    atomic_init(&catalogo->publicadas, 0);
+    atomic_init(&catalogo->liberadas, 0);
+    atomic_init(&catalogo->falhas, 0);
+    catalogo->avisos[0] = catalogo->avisos[1] = -1;
+    if (publicarCaso(catalogo, caso)) return 1;
+    pthread_mutex_destroy(&catalogo->publicacao);
+    return 0;
+}
+
+VersaoCaso* fixarCaso(CatalogoCasos* catalogo) {
+    /* A seção impede que a versão lida perca a referência do catálogo antes do incremento */
+    int marca = entrarLeituraRCU(&catalogo->rcu);
+    VersaoCaso* versao = atomic_load(&catalogo->atual);
+    atomic_fetch_add_explicit(&versao->referencias, 1, memory_order_relaxed);
+    sairLeituraRCU(&catalogo->rcu, marca);
+    return versao;
+}
+
+void soltarCaso(VersaoCaso* versao) {
+    if (atomic_fetch_sub_explicit(&versao->referencias, 1, memory_order_acq_rel) != 1) return;
+    CatalogoCasos* catalogo = versao->catalogo;
+    liberarCaso(&versao->caso);
+    free(versao);
+    atomic_fetch_add(&catalogo->liberadas, 1);
+}
+
+int publicarCaso(CatalogoCasos* catalogo, Caso* caso) {
+    VersaoCaso* nova = (VersaoCaso*) malloc(sizeof(VersaoCaso));
+    if (!nova) return 0;
+    nova->caso = *caso;
+    atomic_init(&nova->referencias, 1);
+    nova->catalogo = catalogo;
+
+    pthread_mutex_lock(&catalogo->publicacao);
+    VersaoCaso* antiga = atomic_load_explicit(&catalogo->atual, memory_order_relaxed);
+    nova->numero = antiga ? antiga->numero + 1 : 1;
+    atomic_store(&catalogo->atual, nova);
+    atomic_fetch_add(&catalogo->publicadas, 1);
+    if (antiga) {
+        sincronizarRCU(&catalogo->rcu);
+        soltarCaso(antiga);
+    }
+    pthread_mutex_unlock(&catalogo->publicacao);
+    return nova->numero;
+}
+
+int recarregarCaso(CatalogoCasos* catalogo) {
+    Caso caso;
+    AvaliacaoCaso avaliacao;
+
+    if (!catalogo->arquivo || !carregarCaso(&caso, catalogo->arquivo)) {
+        atomic_fetch_add(&catalogo->falhas, 1);
+        return 0;
+    }
+    int avaliado = avaliarCaso(&caso, &avaliacao);
+    if (avaliado < 0) {
+        fprintf(stderr, "Aviso: memória insuficiente para avaliar '%s'; a versão atual continua valendo.\n",
+                catalogo->arquivo);
+        liberarCaso(&caso);
+        atomic_fetch_add(&catalogo->falhas, 1);
+        return 0;
+    }
+    if (!avaliado)
+        fprintf(stderr, "Aviso: no caso '%s', %d suspeito(s) podem ser condenados (o esperado é 1).\n",
+                catalogo->arquivo, avaliacao.condenaveis);
+    int numero = publicarCaso(catalogo, &caso);
+    if (!numero) {
+        fprintf(stderr, "Aviso: memória insuficiente para publicar '%s'; a versão atual continua valendo.\n",
+                catalogo->arquivo);
+        liberarCaso(&caso);
+        atomic_fetch_add(&catalogo->falhas, 1);
+    }
+    return numero;
+}
+
+#ifndef _WIN32
+/* Ponta de escrita do pipe do catálogo com recarga ativa (um por processo) */
+static volatile int descritorRecarga = -1;
+
+static void tratarSinalRecarga(int sinal) {
+    char byte = 'r';
+    int erro = errno;
+    (void) sinal;
+    if (write(descritorRecarga, &byte, 1) < 0) { /* pipe cheio: já há recarga pendente */ }
+    errno = erro;
+}
+
+static void* executarCarregador(void* arg) {
+    CatalogoCasos* catalogo = (CatalogoCasos*) arg;
+    char byte;
+
+    for (;;) {
+        ssize_t lidos = read(catalogo->avisos[0], &byte, 1);
+        if (lidos < 0 && errno == EINTR) continue;
+        if (lidos != 1 || byte != 'r') break;     /* 'f' = encerrar */
+        recarregarCaso(catalogo);
+    }
+    return NULL;
+}
+
+int ativarRecargaPorSinal(CatalogoCasos* catalogo) {
+    if (!catalogo->arquivo || descritorRecarga >= 0 || pipe(catalogo->avisos) != 0) return 0;
+    fcntl(catalogo->avisos[1], F_SETFL, fcntl(catalogo->avisos[1], F_GETFL) | O_NONBLOCK);
+    if (pthread_create(&catalogo->carregador, NULL, executarCarregador, catalogo) != 0) {
+        close(catalogo->avisos[0]);
+        close(catalogo->avisos[1]);
+        catalogo->avisos[0] = catalogo->avisos[1] = -1;
+        return 0;
+    }
+    descritorRecarga = catalogo->avisos[1];
+
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinalRecarga;
+    sigemptyset(&acao.sa_mask);
+    acao.sa_flags = SA_RESTART;
+    sigaction(SIGHUP, &acao, NULL);
+    return 1;
+}
+
+void encerrarCatalogoCasos(CatalogoCasos* catalogo) {
+    if (catalogo->avisos[0] >= 0) {
+        char fim = 'f';
+        signal(SIGHUP, SIG_DFL);
+        descritorRecarga = -1;
+        while (write(catalogo->avisos[1], &fim, 1) < 0 && errno == EAGAIN) sched_yield();
+        pthread_join(catalogo->carregador, NULL);
+        close(catalogo->avisos[0]);
+        close(catalogo->avisos[1]);
+        catalogo->avisos[0] = catalogo->avisos[1] = -1;
+    }
+    soltarCaso(atomic_load(&catalogo->atual));
+    atomic_store(&catalogo->atual, NULL);
+    pthread_mutex_destroy(&catalogo->publicacao);
+}
+#else
+int ativarRecargaPorSinal(CatalogoCasos* catalogo) {
+    (void) catalogo;
+    return 0;
+}
+
+void encerrarCatalogoCasos(CatalogoCasos* catalogo) {
+    soltarCaso(atomic_load(&catalogo->atual));
+    atomic_store(&catalogo->atual, NULL);
+    pthread_mutex_destroy(&catalogo->publicacao);
+}
+#endif
+
+/* ----------------- Imagem compartilhada do caso (processos pré-criados) ----------------- */
+
+typedef struct {
+    unsigned char* base;           /* NULL = só medindo */
+    size_t usado;
+} EscritorImagem;
+
+static uint32_t reservarNaImagem(EscritorImagem* e, size_t bytes) {
+    size_t inicio = (e->usado + 7) & ~(size_t)7;
+    e->usado = inicio + bytes;
+    return (uint32_t)inicio;
+}
+
+static uint32_t gravarTextoNaImagem(EscritorImagem* e, const char* texto) {
+    size_t n = strlen(texto) + 1;
+    uint32_t inicio = (uint32_t)e->usado;
+    if (e->base) memcpy(e->base + inicio, texto, n);
+    e->usado += n;
+    return inicio;
+}
+
+size_t montarImagemCaso(const Caso* caso, void* destino, size_t capacidade) {
+    int n = caso->totalSalas, m = caso->totalPortas, p = caso->totalPistas;
+    int capacidadeIndice = 8;
+    while (capacidadeIndice < 2 * p) capacidadeIndice *= 2;
+
+    EscritorImagem e = { NULL, 0 };
+    CabecalhoImagem c;
+    memset(&c, 0, sizeof(c));
+    reservarNaImagem(&e, sizeof(CabecalhoImagem));
+    c.salas = reservarNaImagem(&e, sizeof(SalaImagem) * (size_t)n);
+    c.inicioPortas = reservarNaImagem(&e, sizeof(int32_t) * ((size_t)n + 1));
+    c.destinoPortas = reservarNaImagem(&e, sizeof(int32_t) * (size_t)m);
+    c.custoPortas = reservarNaImagem(&e, sizeof(uint16_t) * (size_t)m);
+    c.rotuloPortas = reservarNaImagem(&e, sizeof(uint16_t) * (size_t)m);
+    c.rotulos = reservarNaImagem(&e, sizeof(uint32_t) * (size_t)caso->totalRotulos);
+    c.pistas = reservarNaImagem(&e, sizeof(PistaImagem) * (size_t)p);
+    c.suspeitos = reservarNaImagem(&e, sizeof(uint32_t) * (size_t)caso->totalSuspeitos);
+    c.indice = reservarNaImagem(&e, sizeof(int32_t) * (size_t)capacidadeIndice);
+
+    /* Primeira passada só mede; a segunda escreve tabelas e textos no destino */
+    size_t textos = e.usado;
+    for (int i = 0; i < n; ++i) {
+        gravarTextoNaImagem(&e, caso->salasPorId[i]->nome);
+        gravarTextoNaImagem(&e, caso->salasPorId[i]->pista);
+    }
+    for (int i = 0; i < caso->totalRotulos; ++i) gravarTextoNaImagem(&e, caso->rotulos[i]);
+    for (int i = 0; i < p; ++i) gravarTextoNaImagem(&e, caso->pistasPorId[i]->pista);
+    for (int i = 0; i < caso->totalSuspeitos; ++i) gravarTextoNaImagem(&e, caso->suspeitosPorId[i]->nome);
+    size_t tamanho = (e.usado + 7) & ~(size_t)7;
+    if (!destino) return tamanho;
+    if (capacidade < tamanho || tamanho > UINT32_MAX) return 0;
+
+    unsigned char* base = (unsigned char*) destino;
+    memset(base, 0, tamanho);
+    e.base = base;
+    e.usado = textos;
+
+    SalaImagem* salas = (SalaImagem*)(base + c.salas);
+    for (int i = 0; i < n; ++i) {
+        const Sala* sala = caso->salasPorId[i];
+        SuspeitoNode* no = sala->pista[0] != '\0' ? buscarNaHash((SuspeitoNode**) caso->tabela, sala->pista) : NULL;
+        salas[i].nome = gravarTextoNaImagem(&e, sala->nome);
+        salas[i].pista = gravarTextoNaImagem(&e, sala->pista);
+        salas[i].esquerda = sala->esquerda ? sala->esquerda->id : -1;
+        salas[i].direita = sala->direita ? sala->direita->id : -1;
+        salas[i].pai = sala->pai ? sala->pai->id : -1;
+        salas[i].idPista = no ? no->id : -1;
+    }
+    memcpy(base + c.inicioPortas, caso->inicioPortas, sizeof(int32_t) * ((size_t)n + 1));
+    memcpy(base + c.destinoPortas, caso->destinoPortas, sizeof(int32_t) * (size_t)m);
+    memcpy(base + c.custoPortas, caso->custoPortas, sizeof(uint16_t) * (size_t)m);
+    memcpy(base + c.rotuloPortas, caso->rotuloPortas, sizeof(uint16_t) * (size_t)m);
+
+    uint32_t* rotulos = (uint32_t*)(base + c.rotulos);
+    for (int i = 0; i < caso->totalRotulos; ++i) rotulos[i] = gravarTextoNaImagem(&e, caso->rotulos[i]);
+
+    PistaImagem* pistas = (PistaImagem*)(base + c.pistas);
+    int32_t* indice = (int32_t*)(base + c.indice);
+    for (int i = 0; i < capacidadeIndice; ++i) indice[i] = -1;
+    for (int i = 0; i < p; ++i) {
+        const SuspeitoNode* no = caso->pistasPorId[i];
+        pistas[i].texto = gravarTextoNaImagem(&e, no->pista);
+        pistas[i].suspeito = no->idSuspeito;
+        pistas[i].hash = acumularAssinatura(2166136261u, no->pista);
+        int pos = (int)(pistas[i].hash & (uint32_t)(capacidadeIndice - 1));
+        while (indice[pos] >= 0) pos = (pos + 1) & (capacidadeIndice - 1);
+        indice[pos] = i;
+    }
+
+    uint32_t* suspeitos = (uint32_t*)(base + c.suspeitos);
+    for (int i = 0; i < caso->totalSuspeitos; ++i) suspeitos[i] = gravarTextoNaImagem(&e, caso->suspeitosPorId[i]->nome);
+
+    memcpy(c.magico, IMAGEM_MAGICO, sizeof(IMAGEM_MAGICO));
+    c.versao = IMAGEM_VERSAO;
+    c.tamanho = (uint32_t)tamanho;
+    c.assinatura = caso->assinatura;
+    c.totalSalas = n;
+    c.totalPortas = m;
+    c.totalRotulos = caso->totalRotulos;
+    c.totalPistas = p;
+    c.totalSuspeitos = caso->totalSuspeitos;
+    c.capacidadeIndice = capacidadeIndice;
+    memcpy(base, &c, sizeof(c));
+    return tamanho;
+}
+
+static int textoNaImagemValido(uint32_t deslocamento, uint32_t limite) {
+    return deslocamento >= sizeof(CabecalhoImagem) && deslocamento < limite;
+}
+
+const CabecalhoImagem* validarImagemCaso(const void* base, size_t tamanho) {
+    const CabecalhoImagem* c = (const CabecalhoImagem*) base;
+    if (!base || tamanho < sizeof(CabecalhoImagem) || memcmp(c->magico, IMAGEM_MAGICO, sizeof(IMAGEM_MAGICO)) != 0 ||
+        c->versao != IMAGEM_VERSAO || c->tamanho > tamanho || c->tamanho <= sizeof(CabecalhoImagem))
+        return NULL;
+
+    /* Cada tabela precisa caber na imagem */
+    const struct { uint32_t inicio; size_t bytes; } tabelas[] = {
+        { c->salas, sizeof(SalaImagem) * (size_t)c->totalSalas },
+        { c->inicioPortas, sizeof(int32_t) * ((size_t)c->totalSalas + 1) },
+        { c->destinoPortas, sizeof(int32_t) * (size_t)c->totalPortas },
+        { c->custoPortas, sizeof(uint16_t) * (size_t)c->totalPortas },
+        { c->rotuloPortas, sizeof(uint16_t) * (size_t)c->totalPortas },
+        { c->rotulos, sizeof(uint32_t) * (size_t)c->totalRotulos },
+        { c->pistas, sizeof(PistaImagem) * (size_t)c->totalPistas },
+        { c->suspeitos, sizeof(uint32_t) * (size_t)c->totalSuspeitos },
+        { c->indice, sizeof(int32_t) * (size_t)c->capacidadeIndice },
+    };
+    if (c->totalSalas < 1 || c->totalPortas < 0 || c->totalRotulos < 0 || c->totalPistas < 0 ||
+        c->totalSuspeitos < 0 || c->capacidadeIndice < 1 || (c->capacidadeIndice & (c->capacidadeIndice - 1)) != 0)
+        return NULL;
+    for (size_t i = 0; i < sizeof(tabelas) / sizeof(tabelas[0]); ++i)
+        if (tabelas[i].inicio < sizeof(CabecalhoImagem) || tabelas[i].inicio % 8 != 0 ||
+            tabelas[i].inicio > c->tamanho || tabelas[i].bytes > c->tamanho - tabelas[i].inicio)
+            return NULL;
+
+    /* Textos: basta o deslocamento cair na imagem, porque o último byte dela é '\0' */
+    const unsigned char* bytes = (const unsigned char*) base;
+    uint32_t limite = c->tamanho;
+    if (bytes[limite - 1] != '\0') return NULL;
+
+    const SalaImagem* salas = (const SalaImagem*)(bytes + c->salas);
+    for (int i = 0; i < c->totalSalas; ++i)
+        if (!textoNaImagemValido(salas[i].nome, limite) || !textoNaImagemValido(salas[i].pista, limite) ||
+            salas[i].esquerda < -1 || salas[i].esquerda >= c->totalSalas ||
+            salas[i].direita < -1 || salas[i].direita >= c->totalSalas ||
+            salas[i].pai < -1 || salas[i].pai >= c->totalSalas ||
+            salas[i].idPista < -1 || salas[i].idPista >= c->totalPistas)
+            return NULL;
+
+    const int32_t* inicio = (const int32_t*)(bytes + c->inicioPortas);
+    const int32_t* destino = (const int32_t*)(bytes + c->destinoPortas);
+    const uint16_t* rotuloPorta = (const uint16_t*)(bytes + c->rotuloPortas);
+    if (inicio[0] != 0 || inicio[c->totalSalas] != c->totalPortas) return NULL;
+    for (int i = 0; i < c->totalSalas; ++i)
+        if (inicio[i + 1] < inicio[i]) return NULL;
+    for (int p = 0; p < c->totalPortas; ++p)
+        if (destino[p] < 0 || destino[p] >= c->totalSalas || rotuloPorta[p] >= c->totalRotulos) return NULL;
+
+    const uint32_t* rotulos = (const uint32_t*)(bytes + c->rotulos);
+    for (int i = 0; i < c->totalRotulos; ++i)
+        if (!textoNaImagemValido(rotulos[i], limite)) return NULL;
+
+    const PistaImagem* pistas = (const PistaImagem*)(bytes + c->pistas);
+    for (int i = 0; i < c->totalPistas; ++i)
+        if (!textoNaImagemValido(pistas[i].texto, limite) ||
+            pistas[i].suspeito < 0 || pistas[i].suspeito >= c->totalSuspeitos)
+            return NULL;
+
+    const uint32_t* suspeitos = (const uint32_t*)(bytes + c->suspeitos);
+    for (int i = 0; i < c->totalSuspeitos; ++i)
+        if (!textoNaImagemValido(suspeitos[i], limite)) return NULL;
+
+    /* Índice: IDs válidos e ao menos uma vaga livre (senão a sondagem de pistaNaImagem não para) */
+    const int32_t* indice = (const int32_t*)(bytes + c->indice);
+    int livres = 0;
+    for (int i = 0; i < c->capacidadeIndice; ++i) {
+        if (indice[i] < -1 || indice[i] >= c->totalPistas) return NULL;
+        livres += indice[i] == -1;
+    }
+    return livres > 0 ? c : NULL;
+}
+
+const char* textoDaImagem(const CabecalhoImagem* imagem, uint32_t deslocamento) {
+    return (const char*) imagem + deslocamento;
+}
+
+int pistaNaImagem(const CabecalhoImagem* imagem, const char* pista) {
+    const PistaImagem* pistas = (const PistaImagem*)((const unsigned char*) imagem + imagem->pistas);
+    const int32_t* indice = (const int32_t*)((const unsigned char*) imagem + imagem->indice);
+    uint32_t h = acumularAssinatura(2166136261u, pista);
+    int mascara = imagem->capacidadeIndice - 1;
+
+    for (int pos = (int)(h & (uint32_t)mascara); indice[pos] >= 0; pos = (pos + 1) & mascara) {
+        const PistaImagem* candidata = &pistas[indice[pos]];
+        if (candidata->hash == h && strcmp(textoDaImagem(imagem, candidata->texto), pista) == 0) return indice[pos];
+    }
+    return -1;
+}
+
+const char* suspeitoNaImagem(const CabecalhoImagem* imagem, const char* pista) {
+    int id = pistaNaImagem(imagem, pista);
+    if (id < 0) return "Desconhecido";
+    const PistaImagem* pistas = (const PistaImagem*)((const unsigned char*) imagem + imagem->pistas);
+    const uint32_t* suspeitos = (const uint32_t*)((const unsigned char*) imagem + imagem->suspeitos);
+    return textoDaImagem(imagem, suspeitos[pistas[id].suspeito]);
+}
+
+#ifndef _WIN32
+int criarImagemCompartilhada(const Caso* caso, const char* nome, size_t* tamanho) {
+    size_t bytes = montarImagemCaso(caso, NULL, 0);
+    if (bytes > UINT32_MAX) {   /* os deslocamentos da imagem são de 32 bits */
+        fprintf(stderr, "Erro: o caso ocupa %zu bytes e a imagem compartilhada só endereça 4 GB\n", bytes);
+        return 0;
+    }
+    int fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "Erro: não foi possível criar o segmento '%s': %s\n", nome, strerror(errno));
+        return 0;
+    }
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0) base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Erro: não foi possível mapear o segmento '%s': %s\n", nome, strerror(errno));
+        shm_unlink(nome);
+        return 0;
+    }
+    size_t gravados = montarImagemCaso(caso, base, bytes);
+    munmap(base, bytes);
+    if (gravados == 0) {
+        fprintf(stderr, "Erro: a imagem do caso não coube no segmento '%s'\n", nome);
+        shm_unlink(nome);
+        return 0;
+    }
+    *tamanho = bytes;
+    return 1;
+}
+
+const CabecalhoImagem* anexarImagemCompartilhada(const char* nome, size_t* tamanho) {
+    struct stat info;
+    int fd = shm_open(nome, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* base = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    const CabecalhoImagem* imagem = validarImagemCaso(base, (size_t)info.st_size);
+    if (!imagem) munmap(base, (size_t)info.st_size);
+    *tamanho = (size_t)info.st_size;
+    return imagem;
+}
+
+void desanexarImagem(const CabecalhoImagem* imagem, size_t tamanho) {
+    munmap((void*) imagem, tamanho);
+}
+
+typedef struct {
+    int processo;
+    int pid;
+    long long anexarUs;
+    long long ms;
+    long long sessoes;
+    long long consultas;
+    long novaKB;                   /* memória anônima criada pelo filho (anexar + sessões); -1 se indisponível */
+    int erros;
+} ResultadoProcesso;
+
+/* Memória anônima do processo (smaps_rollup; a imagem em shm não conta). Sem smaps_rollup,
+ * residente - compartilhada do statm. -1 se nenhum dos dois existir */
+static long memoriaAnonimaKB(void) {
+    char linha[128];
+    long kb, paginas, residentes, compartilhadas;
+    FILE* f = fopen("/proc/self/smaps_rollup", "r");
+
+    if (f) {
+        while (fgets(linha, sizeof(linha), f))
+            if (sscanf(linha, "Anonymous: %ld kB", &kb) == 1) {
+                fclose(f);
+                return kb;
+            }
+        fclose(f);
+    }
+    f = fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    int lidos = fscanf(f, "%ld %ld %ld", &paginas, &residentes, &compartilhadas);
+    fclose(f);
+    return lidos == 3 ? (residentes - compartilhadas) * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+}
+
+/* Corpo de um processo filho: só lê a imagem (nada do Caso do pai é usado) */
+static void trabalharNaImagem(const char* nome, int processo, ResultadoProcesso* r) {
+    /* As páginas herdadas do pai (o Caso inteiro) já estão na conta; só o crescimento é do filho */
+    long anonimaInicial = memoriaAnonimaKB();
+    long long t0 = agoraNs();
+    size_t tamanho = 0;
+    const CabecalhoImagem* imagem = anexarImagemCompartilhada(nome, &tamanho);
+    r->anexarUs = (agoraNs() - t0) / 1000;
+    if (!imagem) {
+        r->erros++;
+        return;
+    }
+
+    const unsigned char* base = (const unsigned char*) imagem;
+    const SalaImagem* salas = (const SalaImagem*)(base + imagem->salas);
+    const int32_t* inicio = (const int32_t*)(base + imagem->inicioPortas);
+    const int32_t* destino = (const int32_t*)(base + imagem->destinoPortas);
+    const PistaImagem* pistas = (const PistaImagem*)(base + imagem->pistas);
+
+    /* O índice devolve o próprio ID de cada pista e de cada sala com pista */
+    for (int i = 0; i < imagem->totalPistas; ++i)
+        if (pistaNaImagem(imagem, textoDaImagem(imagem, pistas[i].texto)) != i) r->erros++;
+    for (int i = 0; i < imagem->totalSalas; ++i)
+        if (salas[i].idPista != (salas[i].idPista >= 0 ? pistaNaImagem(imagem, textoDaImagem(imagem, salas[i].pista)) : -1))
+            r->erros++;
+
+    long long t1 = agoraMs();
+    uint64_t sorteio = 0x9E3779B97F4A7C15ULL * (uint64_t)(processo + 1);
+    for (long s = 0; s < PROCESSOS_SESSOES; ++s) {
+        int sala = 0;
+        for (int passo = 0; passo < SIMULACAO_MAX_PASSOS; ++passo) {
+            int portas = inicio[sala + 1] - inicio[sala];
+            if (portas == 0) break;
+            sorteio ^= sorteio << 13;
+            sorteio ^= sorteio >> 7;
+            sorteio ^= sorteio << 17;
+            sala = destino[inicio[sala] + (int)(sorteio % (uint64_t)portas)];
+            if (salas[sala].idPista >= 0) {
+                const char* suspeito = suspeitoNaImagem(imagem, textoDaImagem(imagem, salas[sala].pista));
+                if (suspeito[0] == '\0') r->erros++;
+                r->consultas++;
+            }
+        }
+        r->sessoes++;
+    }
+    r->ms = agoraMs() - t1;
+    long anonimaFinal = memoriaAnonimaKB();
+    r->novaKB = anonimaInicial >= 0 && anonimaFinal >= 0 ? anonimaFinal - anonimaInicial : -1;
+    desanexarImagem(imagem, tamanho);
+}
+
+int executarProcessos(const Caso* caso, int processos) {
+    char nome[64];
+    size_t tamanho = 0;
+    int canal[2], largada[2];
+
+    snprintf(nome, sizeof(nome), "/detetive_quest-%ld", (long) getpid());
+    if (pipe(canal) != 0 || pipe(largada) != 0) return 0;
+    fflush(stdout);
+
+    /* Pool pré-criado: os filhos esperam a largada e só então anexam a imagem */
+    int criados = 0;
+    for (int i = 0; i < processos; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            fprintf(stderr, "Aviso: fork falhou após %d processo(s): %s\n", criados, strerror(errno));
+            break;
+        }
+        if (pid == 0) {
+            ResultadoProcesso r;
+            char sinal;
+            memset(&r, 0, sizeof(r));
+            r.processo = i;
+            r.pid = (int) getpid();
+            close(canal[0]);
+            close(largada[1]);
+            if (read(largada[0], &sinal, 1) != 1) _exit(1);   /* carregador desistiu */
+            trabalharNaImagem(nome, i, &r);
+            _exit(write(canal[1], &r, sizeof(r)) == (ssize_t) sizeof(r) && r.erros == 0 ? 0 : 1);
+        }
+        criados++;
+    }
+    close(canal[1]);
+    close(largada[0]);
+
+    long long t0 = agoraNs();
+    int publicada = criados > 0 && criarImagemCompartilhada(caso, nome, &tamanho);
+    long long t1 = agoraNs();
+    if (publicada) {
+        printf("Imagem do caso: %zu bytes em '%s' (montada em %lld us); %d processo(s), %ld sessões cada.\n",
+               tamanho, nome, (t1 - t0) / 1000, criados, PROCESSOS_SESSOES);
+        printf("Cada filho mapeia a mesma imagem somente leitura; \"Nova (KB)\" é a memória anônima que o filho criou.\n\n");
+        fflush(stdout);
+        for (int i = 0; i < criados; ++i)
+            if (write(largada[1], "v", 1) != 1) break;
+    }
+    close(largada[1]);
+
+    ResultadoProcesso* resultados = (ResultadoProcesso*) calloc((size_t)criados + 1, sizeof(ResultadoProcesso));
+    if (!resultados) {
+        fprintf(stderr, "Erro: falha na alocação de memória para os resultados dos processos\n");
+        exit(EXIT_FAILURE);
+    }
+    int recebidos = 0;
+    ResultadoProcesso r;
+    while (recebidos < criados && read(canal[0], &r, sizeof(r)) == (ssize_t) sizeof(r)) {
+        if (r.processo >= 0 && r.processo < criados) resultados[r.processo] = r;
+        recebidos++;
+    }
+    close(canal[0]);
+
+    int ok = publicada && recebidos == processos;
+    for (int i = 0; i < criados; ++i) {
+        int status;
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = 0;
+    }
+    if (publicada) shm_unlink(nome);
+
+    if (recebidos > 0) {
+        printf("  Processo        PID  Anexar (us)   Sessões/s  Consultas    Nova (KB)\n");
+        for (int i = 0; i < criados; ++i) {
+            const ResultadoProcesso* p = &resultados[i];
+            printf("  %8d %10d %12lld %11.0f %10lld %12ld%s\n", i, p->pid, p->anexarUs,
+                   p->ms > 0 ? 1000.0 * (double)p->sessoes / (double)p->ms : 0.0, p->consultas, p->novaKB,
+                   p->erros ? "  (ERROS!)" : "");
+        }
+    }
+    printf("\nTodos os processos usaram a mesma imagem sem erros: %s\n", ok ? "sim" : "NÃO");
+    free(resultados);
+    return ok;
+}
+#else
+int criarImagemCompartilhada(const Caso* caso, const char* nome, size_t* tamanho) {
+    (void) caso; (void) nome; (void) tamanho;
+    fprintf(stderr, "Erro: memória compartilhada POSIX indisponível nesta plataforma\n");
+    return 0;
+}
+
+const CabecalhoImagem* anexarImagemCompartilhada(const char* nome, size_t* tamanho) {
+    (void) nome; (void) tamanho;
+    return NULL;
+}
+
+void desanexarImagem(const CabecalhoImagem* imagem, size_t tamanho) {
+    (void) imagem; (void) tamanho;
+}
+
+int executarProcessos(const Caso* caso, int processos) {
+    (void) caso; (void) processos;
+    fprintf(stderr, "Erro: --processos exige fork() e memória compartilhada POSIX\n");
+    return 0;
+}
+#endif
+
+/* ----------------- Histogramas de latência por comando ----------------- */
+
+typedef struct {
+    HistogramaLatencia comandos[TOTAL_COMANDOS];
+} LatenciasDaThread;
+
+/*
+ * Registro do processo: cada thread viva ocupa uma vaga. A vaga é tomada e
+ * devolvida sob `vagasLatencias`, que também protege a soma (o destrutor
+ * libera o conjunto); o registro de um comando nunca passa pelo mutex.
+ */
+static _Atomic(LatenciasDaThread*) latenciasPorThread[LATENCIA_MAX_THREADS];
+static atomic_int threadsComLatencias;          /* maior vaga já usada + 1 */
+static LatenciasDaThread latenciasAposentadas;  /* threads que já terminaram */
+static pthread_mutex_t vagasLatencias = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t chaveLatencias;
+static pthread_once_t chaveLatenciasCriada = PTHREAD_ONCE_INIT;
+static atomic_llong latenciasDescartadas;
+static _Thread_local LatenciasDaThread* latenciasDaThread = NULL;
+static _Thread_local int latenciasSemVaga = 0;
+
+static const char* const nomesComandos[TOTAL_COMANDOS] = {
+    "mover", "listar", "buscar", "planejar", "gravar", "acusar"
+};
+
+static int faixaDaLatencia(long long ns) {
+    if (ns < HISTOGRAMA_SUB) return ns < 0 ? 0 : (int) ns;
+    if (ns >= (1LL << HISTOGRAMA_MAX_BITS)) ns = (1LL << HISTOGRAMA_MAX_BITS) - 1;
+#if defined(__GNUC__)
+    int bit = 63 - __builtin_clzll((unsigned long long) ns);
+#else
+    int bit = 0;
+    while ((ns >> (bit + 1)) != 0) bit++;
+#endif
+    int deslocamento = bit - (HISTOGRAMA_SUB_BITS - 1);
+    return HISTOGRAMA_SUB + (deslocamento - 1) * (HISTOGRAMA_SUB / 2)
+           + (int)(ns >> deslocamento) - HISTOGRAMA_SUB / 2;
+}
+
+/* Maior valor que cai na faixa */
+static long long limiteDaFaixa(int faixa) {
+    if (faixa < HISTOGRAMA_SUB) return faixa;
+    int k = faixa - HISTOGRAMA_SUB;
+    int deslocamento = k / (HISTOGRAMA_SUB / 2) + 1;
+    long long topo = k % (HISTOGRAMA_SUB / 2) + HISTOGRAMA_SUB / 2;
+    return ((topo + 1) << deslocamento) - 1;
+}
+
+/* Um só escritor por contador: load + store relaxados bastam */
+static void somarNoContador(atomic_llong* contador, long long valor) {
+    atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + valor,
+                          memory_order_relaxed);
+}
+
+/* Destrutor da chave: soma as contagens da thread que termina e devolve a vaga */
+static void aposentarThreadLatencias(void* valor) {
+    LatenciasDaThread* minhas = (LatenciasDaThread*) valor;
+
+    pthread_mutex_lock(&vagasLatencias);
+    for (int c = 0; c < TOTAL_COMANDOS; ++c) {
+        HistogramaLatencia* destino = &latenciasAposentadas.comandos[c];
+        const HistogramaLatencia* h = &minhas->comandos[c];
+        for (int f = 0; f < HISTOGRAMA_FAIXAS; ++f) {
+            long long n = atomic_load_explicit(&h->contagens[f], memory_order_relaxed);
+            if (n) somarNoContador(&destino->contagens[f], n);
+        }
+        long long m = atomic_load_explicit(&h->maximo, memory_order_relaxed);
+        if (m > atomic_load_explicit(&destino->maximo, memory_order_relaxed))
+            atomic_store_explicit(&destino->maximo, m, memory_order_relaxed);
+    }
+    for (int t = 0; t < LATENCIA_MAX_THREADS; ++t)
+        if (atomic_load_explicit(&latenciasPorThread[t], memory_order_relaxed) == minhas) {
+            atomic_store_explicit(&latenciasPorThread[t], NULL, memory_order_relaxed);
+            break;
+        }
+    pthread_mutex_unlock(&vagasLatencias);
+    latenciasDaThread = NULL;
+    latenciasSemVaga = 1;   /* a thread está saindo: nada mais a registrar */
+    free(minhas);
+}
+
+static void criarChaveLatencias(void) {
+    pthread_key_create(&chaveLatencias, aposentarThreadLatencias);
+}
+
+static LatenciasDaThread* registrarThreadLatencias(void) {
+    if (latenciasSemVaga) return NULL;
+    pthread_once(&chaveLatenciasCriada, criarChaveLatencias);
+
+    LatenciasDaThread* minhas = (LatenciasDaThread*) calloc(1, sizeof(LatenciasDaThread));
+    int vaga = -1;
+    pthread_mutex_lock(&vagasLatencias);
+    for (int t = 0; minhas && t < LATENCIA_MAX_THREADS && vaga < 0; ++t)
+        if (!atomic_load_explicit(&latenciasPorThread[t], memory_order_relaxed)) vaga = t;
+    if (vaga >= 0 && pthread_setspecific(chaveLatencias, minhas) == 0) {
+        atomic_store_explicit(&latenciasPorThread[vaga], minhas, memory_order_relaxed);
+        if (vaga >= atomic_load_explicit(&threadsComLatencias, memory_order_relaxed))
+            atomic_store_explicit(&threadsComLatencias, vaga + 1, memory_order_relaxed);
+    } else {
+        vaga = -1;
+    }
+    pthread_mutex_unlock(&vagasLatencias);
+    if (vaga < 0) {
+        free(minhas);
+        latenciasSemVaga = 1;
+        return NULL;
+    }
+    latenciasDaThread = minhas;
+    return minhas;
+}
+
+long long inicioComando(void) {
+    return agoraNs();
+}
+
+void registrarComando(int comando, long long inicio) {
+    long long ns = agoraNs() - inicio;
+    LatenciasDaThread* minhas = latenciasDaThread ? latenciasDaThread : registrarThreadLatencias();
+
+    if (!minhas || comando < 0 || comando >= TOTAL_COMANDOS) {
+        atomic_fetch_add_explicit(&latenciasDescartadas, 1, memory_order_relaxed);
+        return;
+    }
+    HistogramaLatencia* h = &minhas->comandos[comando];
+    somarNoContador(&h->contagens[faixaDaLatencia(ns)], 1);
+    if (ns > atomic_load_explicit(&h->maximo, memory_order_relaxed))
+        atomic_store_explicit(&h->maximo, ns, memory_order_relaxed);
+}
+
+long long somarLatencias(int comando, HistogramaLatencia* destino) {
+    long long total = 0, maximo = 0;
+
+    for (int f = 0; f < HISTOGRAMA_FAIXAS; ++f) atomic_init(&destino->contagens[f], 0);
+    pthread_mutex_lock(&vagasLatencias);   /* nenhuma thread aposenta o conjunto no meio da soma */
+    int threads = atomic_load_explicit(&threadsComLatencias, memory_order_relaxed);
+    for (int t = -1; t < threads; ++t) {
+        LatenciasDaThread* dela = t < 0 ? &latenciasAposentadas
+                                        : atomic_load_explicit(&latenciasPorThread[t], memory_order_relaxed);
+        if (!dela) continue;   /* vaga livre */
+        const HistogramaLatencia* h = &dela->comandos[comando];
+        for (int f = 0; f < HISTOGRAMA_FAIXAS; ++f) {
+            long long n = atomic_load_explicit(&h->contagens[f], memory_order_relaxed);
+            if (n) {
+                somarNoContador(&destino->contagens[f], n);
+                total += n;
+            }
+        }
+        long long m = atomic_load_explicit(&h->maximo, memory_order_relaxed);
+        if (m > maximo) maximo = m;
+    }
+    pthread_mutex_unlock(&vagasLatencias);
+    atomic_init(&destino->maximo, maximo);
+    return total;
+}
+
+long long percentilLatencia(const HistogramaLatencia* histograma, double fracao) {
+    long long total = 0, acumulado = 0;
+    long long maximo = atomic_load_explicit(&histograma->maximo, memory_order_relaxed);
+
+    for (int f = 0; f < HISTOGRAMA_FAIXAS; ++f)
+        total += atomic_load_explicit(&histograma->contagens[f], memory_order_relaxed);
+    if (total == 0) return 0;
+    long long alvo = (long long) ceil(fracao * (double) total);
+    if (alvo < 1) alvo = 1;
+    for (int f = 0; f < HISTOGRAMA_FAIXAS; ++f) {
+        acumulado += atomic_load_explicit(&histograma->contagens[f], memory_order_relaxed);
+        if (acumulado >= alvo) {
+            long long limite = limiteDaFaixa(f);
+            return limite < maximo ? limite : maximo;
+        }
+    }
+    return maximo;
+}
+
+void escreverEstatisticas(FILE* saida) {
+    HistogramaLatencia* soma = (HistogramaLatencia*) malloc(sizeof(HistogramaLatencia));
+    if (!soma) {
+        fprintf(saida, "Sem memória para somar as latências.\n");
+        return;
+    }
+    fprintf(saida, "  Comando    Amostras     p50 (us)     p99 (us)    p999 (us)     máx (us)\n");
+    for (int c = 0; c < TOTAL_COMANDOS; ++c) {
+        long long amostras = somarLatencias(c, soma);
+        fprintf(saida, "  %-9s %9lld %12.3f %12.3f %12.3f %12.3f\n", nomesComandos[c], amostras,
+                percentilLatencia(soma, 0.50) / 1000.0, percentilLatencia(soma, 0.99) / 1000.0,
+                percentilLatencia(soma, 0.999) / 1000.0,
+                atomic_load_explicit(&soma->maximo, memory_order_relaxed) / 1000.0);
+    }
+    long long descartadas = atomic_load(&latenciasDescartadas);
+    if (descartadas) fprintf(saida, "  (%lld amostra(s) descartada(s): threads vivas demais ou sem memória)\n", descartadas);
+    free(soma);
+}
+
+#ifndef _WIN32
+static void* atenderEstatisticas(void* arg) {
+    ServidorEstatisticas* servidor = (ServidorEstatisticas*) arg;
+
+    for (;;) {
+        int cliente = accept(servidor->descritor, NULL, NULL);
+        if (cliente < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;   /* fecharSocketEstatisticas() desligou o socket */
+        }
+        /* O texto é montado antes: se o cliente sumir no meio, send() não gera SIGPIPE */
+        char* texto = NULL;
+        size_t tamanho = 0;
+        FILE* memoria = open_memstream(&texto, &tamanho);
+        if (memoria) {
+            escreverEstatisticas(memoria);
+            fclose(memoria);
+            for (size_t enviados = 0; enviados < tamanho;) {
+                ssize_t n = send(cliente, texto + enviados, tamanho - enviados, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                enviados += (size_t) n;
+            }
+            free(texto);
+        }
+        close(cliente);
+    }
+    return NULL;
+}
+
+int abrirSocketEstatisticas(ServidorEstatisticas* servidor, const char* caminho) {
+    struct sockaddr_un endereco;
+    struct stat existente;
+
+    servidor->descritor = -1;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Aviso: caminho do socket longo demais: %s\n", caminho);
+        return 0;
+    }
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+    if (stat(caminho, &existente) == 0 && S_ISSOCK(existente.st_mode)) unlink(caminho);
+
+    int descritor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (descritor < 0 || bind(descritor, (struct sockaddr*) &endereco, sizeof(endereco)) != 0
+        || listen(descritor, 8) != 0) {
+        fprintf(stderr, "Aviso: não foi possível abrir o socket de estatísticas '%s': %s\n",
+                caminho, strerror(errno));
+        if (descritor >= 0) close(descritor);
+        return 0;
+    }
+    servidor->descritor = descritor;
+    strcpy(servidor->caminho, caminho);
+    if (pthread_create(&servidor->atendente, NULL, atenderEstatisticas, servidor) != 0) {
+        close(descritor);
+        unlink(caminho);
+        servidor->descritor = -1;
+        return 0;
+    }
+    return 1;
+}
+
+void fecharSocketEstatisticas(ServidorEstatisticas* servidor) {
+    if (servidor->descritor < 0) return;
+    shutdown(servidor->descritor, SHUT_RDWR);   /* acorda o accept() da thread */
+    pthread_join(servidor->atendente, NULL);
+    close(servidor->descritor);
+    unlink(servidor->caminho);
+    servidor->descritor = -1;
+}
+#else
+int abrirSocketEstatisticas(ServidorEstatisticas* servidor, const char* caminho) {
+    (void) caminho;
+    servidor->descritor = -1;
+    fprintf(stderr, "Aviso: socket de estatísticas indisponível nesta plataforma.\n");
+    return 0;
+}
+
+void fecharSocketEstatisticas(ServidorEstatisticas* servidor) {
+    (void) servidor;
+}
+#endif
+
+/* ----------------- Verificação final ----------------- */
+
+int contarPistasPorSuspeitoNaBST(SuspeitoNode* tabela[], PistaNode* raizPistas, const char* suspeito) {
+    if (!raizPistas) return 0;
+
+    int contador = 0;
+
+    /* Função interna recursiva */
+    struct Aux {
+        SuspeitoNode** tabela;
+        const char* suspeito;
+    } aux_data;
+    aux_data.tabela = tabela;
+    aux_data.suspeito = suspeito;
+
+    /* Usamos uma função recursiva local via ponteiro para função */
+    int contadorRec(PistaNode* node) {
+        if (!node) return 0;
+        int c = 0;
+        c += contadorRec(node->esquerda);
+        const char* s = encontrarSuspeito(tabela, node->pista);
+        if (strcmp(s, suspeito) == 0) c++;
+        c += contadorRec(node->direita);
+        return c;
+    }
+
+    /* chamar recursiva */
+    contador = contadorRec(raizPistas);
+    return contador;
+}
+
+int avaliarAcusacao(Caso* caso, Sessao* sessao, const char* nome) {
+    /* Casamento tolerante a erros: "governanta", "Madame Sinclar" etc. */
+    NoBK* acusado = resolverSuspeito(caso, nome, NULL);
+    strncpy(sessao->acusado, acusado ? acusado->nome : nome, MAX_NOME - 1);
+    sessao->acusado[MAX_NOME - 1] = '\0';
+
+    /* Conta quantas pistas coletadas apontam para este suspeito */
+    int total = contarPistasPorSuspeitoNaBST(caso->tabela, sessao->pistas, sessao->acusado);
+
+    sessao->estadoAcusacao = classificarAcusacao(total);
+    return total;
+}
+
+void verificarSuspeitoFinal(Caso* caso, Sessao* sessao, Diario* diario) {
+    PistaNode* raizPistas = sessao->pistas;
+    char nome[MAX_NOME];
+    SuspeitoNode** tabela = caso->tabela;
+
+    printf("\n========================================================\n");
+    printf("                      FASE FINAL - ACUSAÇÃO\n");
+    printf("========================================================\n\n");
+
+    printf("Suspeitos conhecidos: ");
+    for (int i = 0; i < caso->totalSuspeitos; ++i)
+        printf("%s%s", i ? ", " : "", caso->suspeitosPorId[i]->nome);
+    printf("\nDigite o nome do suspeito a ser acusado: ");
+    if (fgets(nome, sizeof(nome), stdin) == NULL) {
+        printf("Entrada inválida.\n");
+        return;
+    }
+    nome[strcspn(nome, "\n")] = '\0'; /* remove newline */
+
+    if (nome[0] == '\0') {
+        printf("Nenhum nome informado. Acusação abortada.\n");
+        return;
+    }
+
+    long long inicio = inicioComando();
+    registrarNoDiario(diario, DIARIO_ACUSAR, nome);
+    int total = avaliarAcusacao(caso, sessao, nome);
+    registrarComando(COMANDO_ACUSAR, inicio);
+    if (strcmp(nome, sessao->acusado) != 0)
+        printf("Considerando '%s' como '%s'.\n", nome, sessao->acusado);
+    strcpy(nome, sessao->acusado);
+
+    if (sessao->estadoAcusacao == ACUSACAO_CONFIRMADA) {
+        printf("\n✅ Acusação confirmada! '%s' é considerado culpado (evidências: %d pistas).\n", nome, total);
+    } else if (sessao->estadoAcusacao == ACUSACAO_FRAGIL) {
+        printf("\n⚠️ Acusação frágil: '%s' tem somente %d pista(s) coletada(s) relacionada(s).\n", nome, total);
+        printf("São necessárias ao menos %d pistas para confirmação.\n", PISTAS_PARA_CONDENAR);
+    } else {
+        printf("\n❌ Acusação sem fundamento: nenhuma pista coletada aponta para '%s'.\n", nome);
+    }
+
+    /* Exibir quais pistas coletadas apontam para cada suspeito (opcional, informativo) */
+    printf("\nResumo das pistas coletadas e seus suspeitos (baseado em tabela):\n");
+    exibirPistas(raizPistas);
+    printf("\nAssociações (pista -> suspeito):\n");
+    for (int i = 0; i < TAM_HASH; ++i) {
+        SuspeitoNode* cur = tabela[i];
+        while (cur) {
+            printf(" - \"%s\" -> %s\n", cur->pista, cur->suspeito);
+            cur = cur->prox;
+        }
+    }
+}
+
+/* ======================================================================== */
+/*                              BENCHMARKS                                    */
+/* ======================================================================== */
+
+void benchPrefixos(long quantidade) {
+    static const char* palavras[] = {
+        "Chave", "Envelope", "Copo", "Carta", "Retrato", "Pegadas",
+        "Luva", "Bilhete", "Faca", "Diário", "Anel", "Lenço"
+    };
+    static const char* consultas[] = {
+        "Chave", "Envelope", "Carta Luva", "Retrato Anel 1", "Faca Faca 99",
+        "Bilhete Diário 12345", "Lenço", "Zz"
+    };
+    const int nPalavras = (int)(sizeof(palavras) / sizeof(palavras[0]));
+    const int nConsultas = (int)(sizeof(consultas) / sizeof(consultas[0]));
+
+    PistaNode* bst = NULL;
+    NoRadix* radix = NULL;
+    char texto[MAX_PISTA];
+    unsigned long semente = 12345UL;
+
+    printf("Gerando %ld pistas sintéticas...\n", quantidade);
+    for (long i = 0; i < quantidade; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        snprintf(texto, sizeof(texto), "%s %s %lu",
+                 palavras[(semente >> 33) % nPalavras],
+                 palavras[(semente >> 45) % nPalavras],
+                 (semente >> 20) % 1000000UL);
+        bst = inserirPista(bst, texto);
+        radix = inserirNoRadix(radix, texto);
+    }
+    printf("Pistas distintas: %d\n\n", tamanhoPistas(bst));
+    printf("%-22s %10s %14s %14s %14s\n", "prefixo", "achadas", "varredura(ms)", "iterador(ms)", "radix(ms)");
+
+    for (int q = 0; q < nConsultas; ++q) {
+        const char* prefixo = consultas[q];
+        size_t len = strlen(prefixo);
+        long porVarredura = 0, porIterador = 0, porRadix = 0;
+
+        /* 1) Varredura completa in-order com strncmp (estilo exibirPistas) */
+        clock_t t0 = clock();
+        IteradorPistas it;
+        const char* p;
+        iniciarIteradorPistas(&it, bst, NULL);
+        while ((p = proximaPista(&it)) != NULL)
+            if (strncmp(p, prefixo, len) == 0) porVarredura++;
+
+        /* 2) Iterador da BST a partir do limite inferior */
+        clock_t t1 = clock();
+        iniciarIteradorPistas(&it, bst, prefixo);
+        while ((p = proximaPista(&it)) != NULL && strncmp(p, prefixo, len) == 0) porIterador++;
+
+        /* 3) Árvore radix: desce o prefixo e enumera a subárvore */
+        clock_t t2 = clock();
+        static const char* saida[1 << 20];
+        porRadix = listarPorPrefixo(radix, prefixo, saida, 1 << 20);
+        clock_t t3 = clock();
+
+        printf("%-22s %10ld %14.3f %14.3f %14.3f%s\n", prefixo, porRadix,
+               1000.0 * (double)(t1 - t0) / CLOCKS_PER_SEC,
+               1000.0 * (double)(t2 - t1) / CLOCKS_PER_SEC,
+               1000.0 * (double)(t3 - t2) / CLOCKS_PER_SEC,
+               (porVarredura == porIterador && porIterador == porRadix) ? "" : "  (DIVERGÊNCIA!)");
+    }
+
+    liberarPistas(bst);
+    liberarRadix(radix);
+}
+
+/* Ordena durações (ns) para os percentis do bench */
+static int compararDuracoes(const void* a, const void* b) {
+    long long x = *(const long long*) a, y = *(const long long*) b;
+    return (x > y) - (x < y);
+}
+
+int benchSuspeitos(long quantidade) {
+    static const char consoantes[] = "bcdfglmnprstv";
+    static const char vogais[] = "aeiou";
+    enum { totalConsultas = 2000, conferidas = 200 };
+    long long duracoes[totalConsultas];
+    unsigned long semente = 42UL;
+    char nome[MAX_NOME];
+    Caso caso;
+
+    memset(&caso, 0, sizeof(caso));
+    long long t0 = agoraNs();
+    for (long i = 0; i < quantidade; ++i) {
+        int len = 0;
+        for (int palavra = 0; palavra < 2; ++palavra) {
+            if (palavra) nome[len++] = ' ';
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            int silabas = 2 + (int)((semente >> 40) % 3);
+            for (int k = 0; k < silabas; ++k) {
+                semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+                nome[len++] = consoantes[(semente >> 33) % (sizeof(consoantes) - 1)];
+                nome[len++] = vogais[(semente >> 45) % (sizeof(vogais) - 1)];
+            }
+        }
+        nome[len] = '\0';
+        registrarSuspeito(&caso, nome);
+    }
+    long long t1 = agoraNs();
+
+    long long ns = 0;
+    int achados = 0, divergencias = 0;
+    for (int q = 0; q < totalConsultas; ++q) {
+        /* Um erro de digitação: troca uma letra de um nome cadastrado */
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        strcpy(nome, caso.suspeitosPorId[(semente >> 33) % (unsigned long)caso.totalSuspeitos]->nome);
+        size_t pos = (semente >> 20) % strlen(nome);
+        if (nome[pos] != ' ') nome[pos] = nome[pos] == 'z' ? 'y' : 'z';
+
+        int distancia;
+        long long inicio = agoraNs();
+        NoBK* no = resolverSuspeito(&caso, nome, &distancia);
+        duracoes[q] = agoraNs() - inicio;
+        ns += duracoes[q];
+        if (no) achados++;
+
+        if (q < conferidas) {
+            char chave[MAX_NOME];
+            int menor = MAX_NOME + 1, tolerancia;
+            normalizarNome(nome, chave, sizeof(chave));
+            tolerancia = (int)strlen(chave) / 4 < 1 ? 1 : (int)strlen(chave) / 4;
+            for (int id = 0; id < caso.totalSuspeitos; ++id) {
+                int d = distanciaEdicao(chave, caso.suspeitosPorId[id]->chave, MAX_NOME);
+                if (d < menor) menor = d;
+            }
+            if ((menor <= tolerancia ? menor : -1) != distancia) divergencias++;
+        }
+    }
+
+    printf("Suspeitos: %d distintos (%ld nomes gerados), montagem da BK-tree: %.1f ms\n",
+           caso.totalSuspeitos, quantidade, (double)(t1 - t0) / 1e6);
+    qsort(duracoes, totalConsultas, sizeof(long long), compararDuracoes);
+    long long p99 = duracoes[totalConsultas * 99 / 100];
+    printf("Consultas com um erro: %d, resolvidas: %d, média: %.3f ms, p99: %.3f ms, máx: %.3f ms\n",
+           totalConsultas, achados, (double)ns / 1e6 / totalConsultas, (double)p99 / 1e6,
+           (double)duracoes[totalConsultas - 1] / 1e6);
+    printf("Distância igual à varredura completa (%d consultas): %s\n",
+           conferidas, divergencias ? "NÃO (DIVERGÊNCIAS!)" : "sim");
+    printf("p99 abaixo de %.0f ms: %s\n", (double)META_BUSCA_SUSPEITO_NS / 1e6,
+           p99 < META_BUSCA_SUSPEITO_NS ? "sim" : "NÃO (META NÃO ATINGIDA!)");
+
+    liberarBK(caso.suspeitos);
+    free(caso.suspeitosPorId);
+    return !divergencias && p99 < META_BUSCA_SUSPEITO_NS;
+}
+
+void benchSessoes(Caso* caso, long quantidade) {
+    size_t passo = tamanhoMaximoSessao(caso);
+    unsigned char* buffer = (unsigned char*) malloc(passo * (size_t)quantidade);
+    size_t* tamanhos = (size_t*) malloc(sizeof(size_t) * (size_t)quantidade);
+    Sessao* sessoes = (Sessao*) malloc(sizeof(Sessao) * (size_t)quantidade);
+    unsigned long semente = 42UL;
+
+    if (!buffer || !tamanhos || !sessoes) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        free(buffer); free(tamanhos); free(sessoes);
+        return;
+    }
+
+    for (long i = 0; i < quantidade; ++i) {
+        if (iniciarSessao(&sessoes[i], caso) != SESSAO_OK) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int id = 0; id < caso->totalPistas; ++id) {
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            if ((semente >> 62) & 1) coletarPista(caso, &sessoes[i], caso->pistasPorId[id]->pista);
+        }
+        sessoes[i].atual = caso->salasPorId[(semente >> 33) % (unsigned long)caso->totalSalas];
+    }
+
+    clock_t t0 = clock();
+    size_t bytes = 0;
+    for (long i = 0; i < quantidade; ++i) {
+        tamanhos[i] = serializarSessao(caso, &sessoes[i], buffer + (size_t)i * passo, passo);
+        bytes += tamanhos[i];
+    }
+    clock_t t1 = clock();
+
+    int falhas = 0;
+    for (long i = 0; i < quantidade; ++i)
+        if (desserializarSessao(caso, &sessoes[i], buffer + (size_t)i * passo, tamanhos[i]) != SESSAO_OK) falhas++;
+    clock_t t2 = clock();
+
+    printf("Sessões: %ld (%.1f bytes em média)\n", quantidade, (double)bytes / (double)quantidade);
+    printf("Serializar:    %8.1f ns/sessão\n", 1e9 * (double)(t1 - t0) / CLOCKS_PER_SEC / (double)quantidade);
+    printf("Desserializar: %8.1f ns/sessão (inclui reconstruir a BST)%s\n",
+           1e9 * (double)(t2 - t1) / CLOCKS_PER_SEC / (double)quantidade, falhas ? "  (FALHAS!)" : "");
+
+    for (long i = 0; i < quantidade; ++i) liberarSessao(&sessoes[i]);
+    free(sessoes);
+    free(tamanhos);
+    free(buffer);
+}
+
+Sala* gerarMansaoAleatoria(long quantidade, unsigned long* semente) {
+    Sala** abertas = (Sala**) malloc(sizeof(Sala*) * (size_t)quantidade);
+    long totalAbertas = 0;
+    char nome[MAX_NOME];
+
+    if (!abertas) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a mansão aleatória\n");
         exit(EXIT_FAILURE);
     }
+    Sala* raiz = criarSala("Sala 0", "");
+    abertas[totalAbertas++] = raiz;
 
-    /* Copia segura dos textos (assegurando terminação) */
-    strncpy(s->nome, nome, MAX_NOME - 1);
-    s->nome[MAX_NOME - 1] = '\0';
+    for (long i = 1; i < quantidade; ++i) {
+        snprintf(nome, sizeof(nome), "Sala %ld", i);
+        Sala* nova = criarSala(nome, "");
+
+        *semente = *semente * 6364136223846793005UL + 1442695040888963407UL;
+        long k = (long)((*semente >> 33) % (unsigned long)totalAbertas);
+        Sala* pai = abertas[k];
+        if (!pai->esquerda) pai->esquerda = nova;
+        else pai->direita = nova;
+        if (pai->esquerda && pai->direita) abertas[k] = abertas[--totalAbertas];   /* sem saídas livres */
+        abertas[totalAbertas++] = nova;
+    }
+    free(abertas);
+    return raiz;
+}
+
+void benchGrafo(long quantidade) {
+    typedef struct PortaLigada {
+        int destino;
+        struct PortaLigada* prox;
+    } PortaLigada;
+
+    unsigned long semente = 7UL;
+    long extras = 8 * quantidade;
+    Caso caso;
+
+    inicializarCaso(&caso, gerarMansaoAleatoria(quantidade, &semente));
+    int rotulo = registrarRotulo(&caso, "corredor");
+    for (long i = 0; i < extras; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        int a = (int)((semente >> 33) % (unsigned long)caso.totalSalas);
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        adicionarPorta(&caso, a, (int)((semente >> 33) % (unsigned long)caso.totalSalas), rotulo, 1);
+    }
+
+    long long t0 = agoraMs();
+    construirPortas(&caso);
+    long long t1 = agoraMs();
+
+    int n = caso.totalSalas;
+    int* fila = (int*) malloc(sizeof(int) * (size_t)n);
+    unsigned char* vistas = (unsigned char*) calloc((size_t)n, 1);
+    PortaLigada** listas = (PortaLigada**) calloc((size_t)n, sizeof(PortaLigada*));
+    if (!fila || !vistas || !listas) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        free(fila); free(vistas); free(listas);
+        liberarCaso(&caso);
+        return;
+    }
+
+    /* BFS sobre o CSR: portas de uma sala são contíguas na memória */
+    long long t2 = agoraMs();
+    int cabeca = 0, cauda = 0;
+    long portasVistas = 0;
+    fila[cauda++] = 0;
+    vistas[0] = 1;
+    while (cabeca < cauda) {
+        int u = fila[cabeca++];
+        for (int p = caso.inicioPortas[u]; p < caso.inicioPortas[u + 1]; ++p) {
+            int v = caso.destinoPortas[p];
+            portasVistas++;
+            if (!vistas[v]) {
+                vistas[v] = 1;
+                fila[cauda++] = v;
+            }
+        }
+    }
+    long long t3 = agoraMs();
+    int alcancadas = cauda;
+
+    /* Mesma BFS com uma porta por nó alocado, na ordem de criação das portas */
+    for (int u = 0; u < n; ++u)
+        for (int p = caso.inicioPortas[u]; p < caso.inicioPortas[u + 1]; ++p) {
+            PortaLigada* no = (PortaLigada*) malloc(sizeof(PortaLigada));
+            if (!no) {
+                fprintf(stderr, "Erro: falha na alocação de memória para PortaLigada\n");
+                exit(EXIT_FAILURE);
+            }
+            no->destino = caso.destinoPortas[p];
+            no->prox = listas[u];
+            listas[u] = no;
+        }
+    memset(vistas, 0, (size_t)n);
+    long long t4 = agoraMs();
+    cabeca = cauda = 0;
+    fila[cauda++] = 0;
+    vistas[0] = 1;
+    while (cabeca < cauda) {
+        int u = fila[cabeca++];
+        for (PortaLigada* no = listas[u]; no; no = no->prox)
+            if (!vistas[no->destino]) {
+                vistas[no->destino] = 1;
+                fila[cauda++] = no->destino;
+            }
+    }
+    long long t5 = agoraMs();
+
+    printf("Salas: %d, portas: %d (%.1f MB de CSR)\n", n, caso.totalPortas,
+           ((double)(n + 1) * sizeof(int) + (double)caso.totalPortas * (sizeof(int) + sizeof(uint16_t))) / 1e6);
+    printf("Montagem do CSR:       %6lld ms\n", t1 - t0);
+    printf("BFS no CSR:            %6lld ms (%d salas, %ld portas)\n", t3 - t2, alcancadas, portasVistas);
+    printf("BFS em lista ligada:   %6lld ms%s\n", t5 - t4, cauda != alcancadas ? "  (DIVERGÊNCIA!)" : "");
+
+    for (int u = 0; u < n; ++u)
+        while (listas[u]) {
+            PortaLigada* prox = listas[u]->prox;
+            free(listas[u]);
+            listas[u] = prox;
+        }
+    free(listas);
+    free(vistas);
+    free(fila);
+    liberarCaso(&caso);
+}
+
+void benchRotas(long quantidade) {
+    const int consultas = 1000, consultasBase = 100;
+    unsigned long semente = 11UL;
+    PlanejadorRotas planejador;
+    Caso caso;
+
+    /* Mansão aleatória + 2 corredores extras por sala, custos 1-20 */
+    inicializarCaso(&caso, gerarMansaoAleatoria(quantidade, &semente));
+    int rotulo = registrarRotulo(&caso, "corredor");
+    for (long i = 0; i < 2 * quantidade; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        int a = (int)((semente >> 33) % (unsigned long)caso.totalSalas);
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        int b = (int)((semente >> 33) % (unsigned long)caso.totalSalas);
+        adicionarPorta(&caso, a, b, rotulo, 1 + (int)((semente >> 20) % 20));
+    }
+    construirPortas(&caso);
+    iniciarPlanejador(&planejador, &caso);
+
+    int n = caso.totalSalas;
+    int* pares = (int*) malloc(sizeof(int) * 2 * (size_t)consultas);
+    long* esperado = (long*) malloc(sizeof(long) * (size_t)consultas);
+    int* fila = (int*) malloc(sizeof(int) * (size_t)n);
+    uint32_t* dist = (uint32_t*) malloc(sizeof(uint32_t) * (size_t)n);
+    if (!pares || !esperado || !fila || !dist) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        free(pares); free(esperado); free(fila); free(dist);
+        liberarPlanejador(&planejador);
+        liberarCaso(&caso);
+        return;
+    }
+    for (int i = 0; i < 2 * consultas; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        pares[i] = (int)((semente >> 33) % (unsigned long)n);
+    }
+
+    /* Base: BFS de um lado só até alcançar o destino */
+    long long t0 = agoraMs();
+    for (int q = 0; q < consultasBase; ++q) {
+        int origem = pares[2 * q], destino = pares[2 * q + 1], cabeca = 0, cauda = 0;
+        memset(dist, 0xFF, sizeof(uint32_t) * (size_t)n);
+        dist[origem] = 0;
+        fila[cauda++] = origem;
+        while (cabeca < cauda && dist[destino] == UINT32_MAX) {
+            int u = fila[cabeca++];
+            for (int p = caso.inicioPortas[u]; p < caso.inicioPortas[u + 1]; ++p)
+                if (dist[caso.destinoPortas[p]] == UINT32_MAX) {
+                    dist[caso.destinoPortas[p]] = dist[u] + 1;
+                    fila[cauda++] = caso.destinoPortas[p];
+                }
+        }
+        esperado[q] = dist[destino] == UINT32_MAX ? -1 : (long)dist[destino];
+    }
+    long long t1 = agoraMs();
+    int divergencias = 0;
+    for (int q = 0; q < consultas; ++q) {
+        int r = rotaMenosPortas(&planejador, pares[2 * q], pares[2 * q + 1], NULL, 0);
+        if (q < consultasBase && r != esperado[q]) divergencias++;
+    }
+    long long t2 = agoraMs();
+
+    /* Base: Dijkstra de um lado só (mesma heap radix), parando no destino */
+    HeapRadix heap;
+    iniciarHeapRadix(&heap);
+    long long t3 = agoraMs();
+    for (int q = 0; q < consultasBase; ++q) {
+        int origem = pares[2 * q], destino = pares[2 * q + 1];
+        memset(dist, 0xFF, sizeof(uint32_t) * (size_t)n);
+        esvaziarHeapRadix(&heap);
+        dist[origem] = 0;
+        inserirHeapRadix(&heap, 0, origem);
+        while (heap.total > 0) {
+            uint32_t d;
+            int u = retirarHeapRadix(&heap, &d);
+            if (d != dist[u]) continue;
+            if (u == destino) break;
+            for (int p = caso.inicioPortas[u]; p < caso.inicioPortas[u + 1]; ++p) {
+                uint32_t nd = d + caso.custoPortas[p];
+                if (nd < dist[caso.destinoPortas[p]]) {
+                    dist[caso.destinoPortas[p]] = nd;
+                    inserirHeapRadix(&heap, nd, caso.destinoPortas[p]);
+                }
+            }
+        }
+        esperado[q] = dist[destino] == UINT32_MAX ? -1 : (long)dist[destino];
+    }
+    long long t4 = agoraMs();
+    liberarHeapRadix(&heap);
+    for (int q = 0; q < consultas; ++q) {
+        long r = rotaMaisRapida(&planejador, pares[2 * q], pares[2 * q + 1], NULL, 0, NULL);
+        if (q < consultasBase && r != esperado[q]) divergencias++;
+    }
+    long long t5 = agoraMs();
+
+    int totalTabelas = 0;
+    long long t6 = agoraMs();
+    TabelaAla* tabelas = construirTabelasAlas(&caso, 64, &totalTabelas);
+    long long t7 = agoraMs();
+    long salasCobertas = 0;
+    for (int i = 0; i < totalTabelas; ++i) salasCobertas += tabelas[i].tamanho;
+
+    printf("Salas: %d, portas: %d\n", n, caso.totalPortas);
+    printf("BFS de um lado:          %8.3f ms/consulta\n", (double)(t1 - t0) / consultasBase);
+    printf("BFS bidirecional:        %8.3f ms/consulta\n", (double)(t2 - t1) / consultas);
+    printf("Dijkstra de um lado:     %8.3f ms/consulta\n", (double)(t4 - t3) / consultasBase);
+    printf("Dijkstra bidirecional:   %8.3f ms/consulta%s\n", (double)(t5 - t4) / consultas,
+           divergencias ? "  (DIVERGÊNCIAS!)" : "");
+    printf("Tabelas de alas (<= 64): %d alas, %ld salas, %lld ms\n", totalTabelas, salasCobertas, t7 - t6);
+
+    liberarTabelasAlas(tabelas, totalTabelas);
+    free(dist);
+    free(fila);
+    free(esperado);
+    free(pares);
+    liberarPlanejador(&planejador);
+    liberarCaso(&caso);
+}
+
+/* Referência da conferência: BFS sobre (sala, pistas novas já reunidas), sem tabelas */
+static long planoForcaBruta(const Caso* caso, const Sessao* sessao, int suspeito, int limiar) {
+    int n = caso->totalSalas, k = limiar - pistasColetadasContra(caso, sessao, suspeito), bits = 0;
+    long resultado = -1;
+
+    if (k <= 0) return 0;
+    int* bitDaSala = (int*) malloc(sizeof(int) * ((size_t)n + 1));
+    int* bitDaPista = (int*) malloc(sizeof(int) * ((size_t)caso->totalPistas + 1));
+    if (!bitDaSala || !bitDaPista) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < caso->totalPistas; ++i) bitDaPista[i] = -1;
+    for (int id = 0; id < n; ++id) {
+        const Sala* sala = caso->salasPorId[id];
+        SuspeitoNode* no = sala->pista[0] != '\0' ? buscarNaHash((SuspeitoNode**) caso->tabela, sala->pista) : NULL;
+        bitDaSala[id] = -1;
+        if (!no || no->idSuspeito != suspeito || pistaColetadaPorId(sessao, no->id)) continue;
+        if (bitDaPista[no->id] < 0) bitDaPista[no->id] = bits++;
+        bitDaSala[id] = bitDaPista[no->id];
+    }
+
+    if (bits >= k) {
+        size_t estados = (size_t)n << bits, cabeca = 0, cauda = 0;
+        int* distancia = (int*) malloc(sizeof(int) * estados);
+        size_t* fila = (size_t*) malloc(sizeof(size_t) * estados);
+        if (!distancia || !fila) {
+            fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t e = 0; e < estados; ++e) distancia[e] = -1;
+        size_t inicio = (size_t)sessao->atual->id << bits;
+        distancia[inicio] = 0;
+        fila[cauda++] = inicio;
+        while (cabeca < cauda) {
+            size_t e = fila[cabeca++];
+            int u = (int)(e >> bits);
+            unsigned int mascara = (unsigned int)(e & (((size_t)1 << bits) - 1));
+            if (contarBits(mascara) >= k) { resultado = distancia[e]; break; }
+            for (int p = caso->inicioPortas[u]; p < caso->inicioPortas[u + 1]; ++p) {
+                int v = caso->destinoPortas[p];
+                unsigned int nova = bitDaSala[v] >= 0 ? mascara | (1u << bitDaSala[v]) : mascara;
+                size_t f = ((size_t)v << bits) | nova;
+                if (distancia[f] >= 0) continue;
+                distancia[f] = distancia[e] + 1;
+                fila[cauda++] = f;
+            }
+        }
+        free(distancia);
+        free(fila);
+    }
+    free(bitDaSala);
+    free(bitDaPista);
+    return resultado;
+}
+
+/* Casos pequenos (20 a 40 salas, pistas repetidas em duas salas), limiar de condenação e um acima:
+   plano exato == força bruta, guloso >= ótimo */
+static void conferirPlanosEvidencia(long casos) {
+    unsigned long semente = 59UL;
+    char pista[MAX_PISTA], suspeito[MAX_NOME];
+    long consultas = 0, exatasDiferentes = 0, gulososAbaixo = 0;
+
+    for (long c = 0; c < casos; ++c) {
+        Caso caso;
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        int n = 20 + (int)((semente >> 33) % 21);
+        inicializarCaso(&caso, gerarMansaoAleatoria(n, &semente));
+        for (int i = 0; i < 12; ++i) {
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            Sala* sala = caso.salasPorId[(semente >> 33) % (unsigned long)n];
+            if (sala->pista[0] != '\0') continue;
+            snprintf(pista, sizeof(pista), "Pista %d", i % 10);
+            snprintf(suspeito, sizeof(suspeito), "Suspeito %d", i % 10 % 3);
+            strcpy(sala->pista, pista);
+            cadastrarPista(&caso, pista, suspeito);
+        }
+        int rotulo = registrarRotulo(&caso, "corredor");
+        for (int i = 0; i < n / 2; ++i) {
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            adicionarPorta(&caso, (int)((semente >> 33) % (unsigned long)n),
+                           (int)((semente >> 13) % (unsigned long)n), rotulo, 1);
+        }
+        construirPortas(&caso);
+
+        PlanejadorRotas rotas;
+        PlanejadorEvidencias evidencias;
+        Sessao sessao;
+        iniciarPlanejador(&rotas, &caso);
+        iniciarPlanejadorEvidencias(&evidencias, &caso, &rotas);
+        if (iniciarSessao(&sessao, &caso) != SESSAO_OK) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+            exit(EXIT_FAILURE);
+        }
+        entrarNaSala(&caso, &sessao, sessao.atual);
+
+        /* Consulta na entrada e depois de cada um de 3 passos aleatórios */
+        for (int passo = 0; passo < 4; ++passo) {
+            for (int s = 0; s < caso.totalSuspeitos; ++s)
+            for (int limiar = PISTAS_PARA_CONDENAR; limiar <= PISTAS_PARA_CONDENAR + 1; ++limiar) {
+                int faltam = 0;
+                long exato = planejarEvidencias(&evidencias, &sessao, s, limiar, NULL, 0, &faltam);
+                long otimo = planoForcaBruta(&caso, &sessao, s, limiar);
+                long guloso = faltam > 0 ? planoGuloso(&evidencias, &sessao, s, faltam, NULL, 0) : 0;
+                consultas++;
+                if (exato != otimo) exatasDiferentes++;
+                if ((guloso < 0) != (otimo < 0) || (otimo >= 0 && guloso < otimo)) gulososAbaixo++;
+            }
+            int portas = portasDaSala(&caso, sessao.atual);
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            if (portas > 0) atravessarPorta(&caso, &sessao, (int)((semente >> 33) % (unsigned long)portas));
+        }
+        liberarSessao(&sessao);
+        liberarPlanejadorEvidencias(&evidencias);
+        liberarPlanejador(&rotas);
+        liberarCaso(&caso);
+    }
+
+    printf("Força bruta: %ld caso(s), %ld consulta(s); exato diferente: %ld, guloso abaixo do ótimo: %ld\n",
+           casos, consultas, exatasDiferentes, gulososAbaixo);
+}
+
+void benchDicas(long quantidade) {
+    const int suspeitos = 6, salasPorSuspeito = 10, passos = 2000;
+    unsigned long semente = 23UL;
+    char pista[MAX_PISTA], suspeito[MAX_NOME];
+    PlanejadorRotas rotas;
+    PlanejadorEvidencias evidencias;
+    Sessao sessao;
+    Caso caso;
+
+    inicializarCaso(&caso, gerarMansaoAleatoria(quantidade, &semente));
+    for (int i = 0; i < suspeitos * salasPorSuspeito; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        Sala* sala = caso.salasPorId[(semente >> 33) % (unsigned long)caso.totalSalas];
+        snprintf(pista, sizeof(pista), "Pista sintética %d", i);
+        snprintf(suspeito, sizeof(suspeito), "Suspeito %d", i % suspeitos);
+        strcpy(sala->pista, pista);
+        cadastrarPista(&caso, pista, suspeito);
+    }
+    int rotulo = registrarRotulo(&caso, "corredor");
+    for (long i = 0; i < quantidade; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        adicionarPorta(&caso, (int)((semente >> 33) % (unsigned long)caso.totalSalas),
+                       (int)((semente >> 13) % (unsigned long)caso.totalSalas), rotulo, 1);
+    }
+    construirPortas(&caso);
+    iniciarPlanejador(&rotas, &caso);
+    iniciarPlanejadorEvidencias(&evidencias, &caso, &rotas);
+    if (iniciarSessao(&sessao, &caso) != SESSAO_OK) {
+        fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+        exit(EXIT_FAILURE);
+    }
+    entrarNaSala(&caso, &sessao, sessao.atual);
+
+    long long t0 = agoraNs();
+    for (int s = 0; s < caso.totalSuspeitos; ++s)
+        planejarEvidencias(&evidencias, &sessao, s, PISTAS_PARA_CONDENAR, NULL, 0, NULL);
+    long long t1 = agoraNs();
+
+    long dicas = 0, soma = 0;
+    long long gasto = 0;
+    for (int k = 0; k < passos; ++k) {
+        long long antes = agoraNs();
+        for (int s = 0; s < caso.totalSuspeitos; ++s) {
+            soma += planejarEvidencias(&evidencias, &sessao, s, PISTAS_PARA_CONDENAR, NULL, 0, NULL);
+            dicas++;
+        }
+        gasto += agoraNs() - antes;
+        int portas = portasDaSala(&caso, sessao.atual);
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        if (portas > 0) atravessarPorta(&caso, &sessao, (int)((semente >> 33) % (unsigned long)portas));
+    }
+
+    printf("Salas: %d, portas: %d, suspeitos: %d\n", caso.totalSalas, caso.totalPortas, caso.totalSuspeitos);
+    printf("Montagem das tabelas (1a dica): %.3f ms\n", (double)(t1 - t0) / 1e6);
+    printf("Dicas:                          %.3f us/dica (%ld dicas, soma %ld)\n",
+           dicas ? (double)gasto / 1000.0 / (double)dicas : 0.0, dicas, soma);
+
+    liberarSessao(&sessao);
+    liberarPlanejadorEvidencias(&evidencias);
+    liberarPlanejador(&rotas);
+    liberarCaso(&caso);
+
+    conferirPlanosEvidencia(CASOS_CONFERENCIA_DICAS);
+}
+
+void benchSimd(long quantidade) {
+    unsigned long semente = 41UL;
+    char pista[MAX_PISTA], suspeito[MAX_NOME];
+    Caso caso;
+
+    inicializarCaso(&caso, gerarMansaoAleatoria(1000, &semente));
+    for (int i = 0; i < 40; ++i) {
+        Sala* sala = caso.salasPorId[i * 25];
+        snprintf(pista, sizeof(pista), "Pista sintética %d", i);
+        snprintf(suspeito, sizeof(suspeito), "Suspeito %d", i % 5);
+        strcpy(sala->pista, pista);
+        cadastrarPista(&caso, pista, suspeito);
+    }
+    construirPortas(&caso);
+
+    long long* contagens[2];
+    double taxa[2];
+    for (int v = 0; v < 2; ++v) {
+        contagens[v] = (long long*) malloc(sizeof(long long) * ((size_t)caso.totalSuspeitos * 4 + 1));
+        if (!contagens[v]) {
+            fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+            exit(EXIT_FAILURE);
+        }
+        simdHabilitado = v;
+        long long t0 = agoraMs();
+        simularPartidas(&caso, POLITICA_ALEATORIA, quantidade, SIMULACAO_SEMENTE, 1, contagens[v]);
+        long long ms = agoraMs() - t0;
+        taxa[v] = ms > 0 ? (double)quantidade / (double)ms / 1000.0 : 0.0;
+    }
+    simdHabilitado = 1;
+
+    double diferenca = 0.0;
+    for (int i = 0; i < caso.totalSuspeitos * 4; ++i) {
+        double d = 100.0 * (double)(contagens[0][i] - contagens[1][i]) / (double)quantidade;
+        if (d < 0) d = -d;
+        if (d > diferenca) diferenca = d;
+    }
+
+    printf("Salas: %d, pistas: %d, suspeitos: %d, partidas: %ld (1 thread)\n",
+           caso.totalSalas, caso.totalPistas, caso.totalSuspeitos, quantidade);
+    printf("Escalar:        %8.2f M partidas/s\n", taxa[0]);
+#if defined(SIMULACAO_AVX2)
+    printf("AVX2 (16 pistas): %6.2f M partidas/s%s\n", taxa[1],
+           __builtin_cpu_supports("avx2") ? "" : "  (CPU sem AVX2: escalar)");
+#else
+    printf("AVX2 indisponível nesta compilação: as duas medições são escalares.\n");
+#endif
+    printf("Maior diferença entre as taxas: %.3f ponto(s) percentual(is)\n", diferenca);
+
+    free(contagens[0]);
+    free(contagens[1]);
+    liberarCaso(&caso);
+}
+
+void benchMCTS(long quantidade) {
+    unsigned long semente = 77UL;
+    char pista[MAX_PISTA], suspeito[MAX_NOME];
+    long confirmados = 0, otimos = 0, soluveis = 0, portasRobo = 0, portasOtimas = 0;
+    long long simulacoes = 0, ms = 0;
+    OpcoesMCTS opcoes;
+
+    opcoesMCTSPadrao(&opcoes);
+    opcoes.tempoMs = 10;
+    for (long c = 0; c < quantidade; ++c) {
+        Caso caso;
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        int n = 20 + (int)((semente >> 33) % 21);
+        inicializarCaso(&caso, gerarMansaoAleatoria(n, &semente));
+        for (int i = 0; i < 12; ++i) {
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            Sala* sala = caso.salasPorId[1 + (semente >> 33) % (unsigned long)(n - 1)];
+            if (sala->pista[0] != '\0') continue;
+            snprintf(pista, sizeof(pista), "Pista %d", i);
+            snprintf(suspeito, sizeof(suspeito), "Suspeito %d", i % 3);
+            strcpy(sala->pista, pista);
+            cadastrarPista(&caso, pista, suspeito);
+        }
+        int rotulo = registrarRotulo(&caso, "corredor");
+        for (int i = 0; i < n / 2; ++i) {
+            semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+            int a = (int)((semente >> 33) % (unsigned long)n), b = (int)((semente >> 13) % (unsigned long)n);
+            adicionarPorta(&caso, a, b, rotulo, 1);
+            adicionarPorta(&caso, b, a, rotulo, 1);
+        }
+        construirPortas(&caso);
+
+        /* Ótimo: menor plano exato entre todos os suspeitos, saindo do Hall */
+        PlanejadorRotas rotas;
+        PlanejadorEvidencias evidencias;
+        Sessao sessao;
+        long otimo = -1;
+        iniciarPlanejador(&rotas, &caso);
+        iniciarPlanejadorEvidencias(&evidencias, &caso, &rotas);
+        if (iniciarSessao(&sessao, &caso) != SESSAO_OK) {
+            fprintf(stderr, "Erro: falha na alocação de memória para a sessão\n");
+            exit(EXIT_FAILURE);
+        }
+        entrarNaSala(&caso, &sessao, sessao.atual);
+        for (int s = 0; s < caso.totalSuspeitos; ++s) {
+            long p = planejarEvidencias(&evidencias, &sessao, s, PISTAS_PARA_CONDENAR, NULL, 0, NULL);
+            if (p >= 0 && (otimo < 0 || p < otimo)) otimo = p;
+        }
+        liberarSessao(&sessao);
+        liberarPlanejadorEvidencias(&evidencias);
+        liberarPlanejador(&rotas);
 
-    if (pista && pista[0] != '\0') {
-        strncpy(s->pista, pista, MAX_PISTA - 1);
-        s->pista[MAX_PISTA - 1] = '\0';
-    } else {
-        s->pista[0] = '\0';
+        long long jogadas = 0, t0 = agoraMs();
+        int portas = jogarComRobo(&caso, &opcoes, 0, &jogadas);
+        ms += agoraMs() - t0;
+        simulacoes += jogadas;
+        if (otimo >= 0 && otimo <= opcoes.horizonte) {
+            soluveis++;
+            if (portas >= 0) {
+                confirmados++;
+                portasRobo += portas;
+                portasOtimas += otimo;
+                if (portas == otimo) otimos++;
+            }
+        }
+        liberarCaso(&caso);
     }
 
-    s->esquerda = s->direita = NULL;
-    return s;
+    printf("Casos: %ld (%ld com acusação confirmável), %d ms por jogada\n", quantidade, soluveis, opcoes.tempoMs);
+    printf("Simulações: %.2f M/s (%d trabalhador(es))\n",
+           ms > 0 ? (double)simulacoes / (double)ms / 1000.0 : 0.0, escalonadorGlobal()->total);
+    printf("Robô confirmou:      %ld de %ld\n", confirmados, soluveis);
+    printf("Jogadas ótimas:      %ld de %ld\n", otimos, soluveis);
+    printf("Portas (robô/ótimo): %.2f / %.2f em média nos casos confirmados\n",
+           confirmados ? (double)portasRobo / (double)confirmados : 0.0,
+           confirmados ? (double)portasOtimas / (double)confirmados : 0.0);
 }
 
-void explorarMansao(Sala* atual, PistaNode** raizPistas, SuspeitoNode* tabela[]) {
-    char opcao;
+typedef struct {
+    uint64_t soma;
+    char folga[56];                /* um acumulador por linha de cache */
+} SomaTrabalhador;
 
-    while (atual != NULL) {
-        limparTela();
-        printf("--------------------------------------------------------\n");
-        printf("Local: %s\n", atual->nome);
-        printf("--------------------------------------------------------\n");
+typedef struct {
+    SomaTrabalhador* somas;
+    long* fatias;
+} AcumuloBench;
 
-        /* Coleta automática: insere pista se existir e não for vazia */
-        if (atual->pista[0] != '\0') {
-            printf("Pista encontrada: \"%s\"\n", atual->pista);
-            *raizPistas = inserirPista(*raizPistas, atual->pista);
-        } else {
-            printf("Nenhuma pista encontrada aqui.\n");
-        }
+static uint64_t trabalhoBench(const char* texto) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 16; ++i) h = acumularAssinatura(h, texto);
+    return h;
+}
 
-        /* Opções de navegação apresentadas ao jogador */
-        printf("\nEscolha o caminho:\n");
-        if (atual->esquerda) printf(" (e) Ir para %s\n", atual->esquerda->nome);
-        if (atual->direita)  printf(" (d) Ir para %s\n", atual->direita->nome);
-        printf(" (s) Encerrar investigação\n");
-        printf("\n> ");
-        scanf(" %c", &opcao);
-        limparBufferEntrada();
+static int visitarSalaBench(Sala* sala, void* arg) {
+    ((AcumuloBench*) arg)->somas[trabalhadorAtual()].soma += trabalhoBench(sala->nome);
+    return 1;
+}
 
-        if (opcao == 'e' || opcao == 'E') {
-            if (atual->esquerda) atual = atual->esquerda;
-            else {
-                printf("Caminho inexistente à esquerda! Pressione ENTER para continuar...");
-                limparBufferEntrada();
-            }
-        } else if (opcao == 'd' || opcao == 'D') {
-            if (atual->direita) atual = atual->direita;
-            else {
-                printf("Caminho inexistente à direita! Pressione ENTER para continuar...");
-                limparBufferEntrada();
-            }
-        } else if (opcao == 's' || opcao == 'S') {
-            printf("\nEncerrando exploração...\n");
-            break;
-        } else {
-            printf("Opção inválida! Pressione ENTER para tentar novamente...");
-            limparBufferEntrada();
-        }
+static int visitarPistaBench(PistaNode* no, void* arg) {
+    ((AcumuloBench*) arg)->somas[trabalhadorAtual()].soma += trabalhoBench(no->pista);
+    return 1;
+}
+
+static void fatiaBench(void* arg, long de, long ate) {
+    AcumuloBench* a = (AcumuloBench*) arg;
+    for (long i = de; i < ate; ++i) a->fatias[i] = i * 3 + 1;
+}
+
+static uint64_t somarAcumulos(AcumuloBench* a, int total) {
+    uint64_t soma = 0;
+    for (int t = 0; t < total; ++t) {
+        soma += a->somas[t].soma;
+        a->somas[t].soma = 0;
     }
+    return soma;
 }
 
-PistaNode* inserirPista(PistaNode* raiz, const char* pista) {
-    if (pista == NULL || pista[0] == '\0') return raiz; /* nada a inserir */
+void benchTarefas(long quantidade) {
+    const long fatias = 1000000L;
+    unsigned long semente = 42UL;
+    char texto[MAX_PISTA];
+    Caso caso;
+    PistaNode* pistas = NULL;
 
-    if (raiz == NULL) {
-        PistaNode* novo = (PistaNode*) malloc(sizeof(PistaNode));
-        if (!novo) {
-            fprintf(stderr, "Erro: falha na alocação de memória para PistaNode\n");
-            exit(EXIT_FAILURE);
-        }
-        strncpy(novo->pista, pista, MAX_PISTA - 1);
-        novo->pista[MAX_PISTA - 1] = '\0';
-        novo->esquerda = novo->direita = NULL;
-        return novo;
+    inicializarCaso(&caso, gerarMansaoAleatoria(quantidade, &semente));
+    for (long i = 0; i < quantidade / 4; ++i) {
+        snprintf(texto, sizeof(texto), "Pista %ld", i);
+        pistas = inserirPista(pistas, texto);
     }
 
-    int cmp = strcmp(pista, raiz->pista);
-    if (cmp < 0) {
-        raiz->esquerda = inserirPista(raiz->esquerda, pista);
-    } else if (cmp > 0) {
-        raiz->direita = inserirPista(raiz->direita, pista);
-    } else {
-        /* duplicata: não insere novamente */
+    int nucleos = numeroDeNucleos();
+    int configuracoes[3] = { 1, nucleos, nucleos < 4 ? 4 : 2 * nucleos };
+    uint64_t esperadoSalas = 0, esperadoPistas = 0;
+    long divergencias = 0;
+    AcumuloBench acumulo;
+    acumulo.somas = (SomaTrabalhador*) calloc((size_t)configuracoes[2], sizeof(SomaTrabalhador));
+    acumulo.fatias = (long*) malloc(sizeof(long) * (size_t)fatias);
+    if (!acumulo.somas || !acumulo.fatias) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        exit(EXIT_FAILURE);
     }
 
-    return raiz;
+    printf("Salas: %d, pistas na BST: %d, núcleos: %d\n", caso.totalSalas, tamanhoPistas(pistas), nucleos);
+    for (int c = 0; c < 3; ++c) {
+        if (c == 1 && nucleos == 1) continue;   /* igual à configuração 0 */
+        Escalonador escalonador;
+        int w = configuracoes[c];
+        iniciarEscalonador(&escalonador, w);
+
+        long long t0 = agoraMs();
+        visitarSalasParalelo(&escalonador, caso.mansao, visitarSalaBench, &acumulo, 0);
+        long long t1 = agoraMs();
+        uint64_t salas = somarAcumulos(&acumulo, w);
+        visitarPistasParalelo(&escalonador, pistas, visitarPistaBench, &acumulo, 0);
+        long long t2 = agoraMs();
+        uint64_t somaPistas = somarAcumulos(&acumulo, w);
+        paraCadaParalelo(&escalonador, 0, fatias, 1, fatiaBench, &acumulo);
+        long long t3 = agoraMs();
+
+        if (c == 0) {
+            esperadoSalas = salas;
+            esperadoPistas = somaPistas;
+        }
+        if (salas != esperadoSalas || somaPistas != esperadoPistas) divergencias++;
+        for (long i = 0; i < fatias; ++i)
+            if (acumulo.fatias[i] != i * 3 + 1) divergencias++;
+        memset(acumulo.fatias, 0, sizeof(long) * (size_t)fatias);
+
+        printf("\n%d trabalhador(es):\n", w);
+        printf("  Salas (fork/join):   %6lld ms\n", t1 - t0);
+        printf("  Pistas (fork/join):  %6lld ms\n", t2 - t1);
+        printf("  Laço com grão 1:     %6lld ms (%.0f ns/tarefa)\n", t3 - t2,
+               1e6 * (double)(t3 - t2) / (double)fatias);
+        exibirEstatisticasEscalonador(&escalonador);
+        encerrarEscalonador(&escalonador);
+    }
+    printf("\nResultados iguais aos de 1 trabalhador: %s\n", divergencias ? "NÃO (DIVERGÊNCIAS!)" : "sim");
+
+    free(acumulo.somas);
+    free(acumulo.fatias);
+    liberarPistas(pistas);
+    liberarCaso(&caso);
 }
 
-void exibirPistas(PistaNode* raiz) {
-    if (!raiz) return;
-    exibirPistas(raiz->esquerda);
-    printf("- %s\n", raiz->pista);
-    exibirPistas(raiz->direita);
+typedef struct {
+    ConjuntoPistas* conjunto;
+    PistaNode* arvore;             /* comparação: BST AVL atrás de uma trava */
+    pthread_mutex_t trava;
+    char (*textos)[32];
+    const int* ordem;              /* cada pista aparece duas vezes, embaralhada */
+    AcumuloBench acumulo;          /* somas por trabalhador */
+} CargaConjunto;
+
+static void inserirFatiaConjunto(void* arg, long de, long ate) {
+    CargaConjunto* c = (CargaConjunto*) arg;
+    uint64_t inseridas = 0;
+    for (long i = de; i < ate; ++i) inseridas += (uint64_t)inserirNoConjuntoPistas(c->conjunto, c->textos[c->ordem[i]]);
+    c->acumulo.somas[trabalhadorAtual()].soma += inseridas;
 }
 
-void liberarPistas(PistaNode* raiz) {
-    if (!raiz) return;
-    liberarPistas(raiz->esquerda);
-    liberarPistas(raiz->direita);
-    free(raiz);
+static void buscarFatiaConjunto(void* arg, long de, long ate) {
+    CargaConjunto* c = (CargaConjunto*) arg;
+    uint64_t achadas = 0;
+    for (long i = de; i < ate; ++i) achadas += (uint64_t)conjuntoContemPista(c->conjunto, c->textos[c->ordem[i]]);
+    c->acumulo.somas[trabalhadorAtual()].soma += achadas;
 }
 
-/* ----------------- Tabela hash ----------------- */
+static void inserirFatiaArvore(void* arg, long de, long ate) {
+    CargaConjunto* c = (CargaConjunto*) arg;
+    for (long i = de; i < ate; ++i) {
+        pthread_mutex_lock(&c->trava);
+        c->arvore = inserirPista(c->arvore, c->textos[c->ordem[i]]);
+        pthread_mutex_unlock(&c->trava);
+    }
+}
 
-void inicializarHash(SuspeitoNode* tabela[]) {
-    for (int i = 0; i < TAM_HASH; ++i) tabela[i] = NULL;
+void benchConjunto(long quantidade) {
+    static const int configuracoes[] = { 1, 2, 4, 8, 16, 32, 64 };
+    long distintas = quantidade / 2 > 0 ? quantidade / 2 : 1;
+    unsigned long semente = 42UL;
+    CargaConjunto carga;
+
+    quantidade = distintas * 2;
+    carga.textos = (char (*)[32]) malloc(sizeof(*carga.textos) * (size_t)distintas);
+    int* ordem = (int*) malloc(sizeof(int) * (size_t)quantidade);
+    carga.acumulo.somas = (SomaTrabalhador*) calloc(64, sizeof(SomaTrabalhador));
+    carga.acumulo.fatias = NULL;
+    if (!carga.textos || !ordem || !carga.acumulo.somas) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+    for (long i = 0; i < distintas; ++i) snprintf(carga.textos[i], sizeof(carga.textos[i]), "Pista %ld", i);
+    for (long i = 0; i < quantidade; ++i) ordem[i] = (int)(i % distintas);
+    for (long i = quantidade - 1; i > 0; --i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        long j = (long)((semente >> 17) % (unsigned long)(i + 1));
+        int t = ordem[i];
+        ordem[i] = ordem[j];
+        ordem[j] = t;
+    }
+    carga.ordem = ordem;
+    pthread_mutex_init(&carga.trava, NULL);
+
+    printf("Inserções: %ld (%ld pistas distintas, cada uma duas vezes), núcleos: %d\n",
+           quantidade, distintas, numeroDeNucleos());
+    printf("  Threads   Skiplist (M/s)  Aceleração   AVL + trava (M/s)   Buscas (M/s)\n");
+    double base = 0.0;
+    long divergencias = 0;
+    for (size_t c = 0; c < sizeof(configuracoes) / sizeof(configuracoes[0]); ++c) {
+        int w = configuracoes[c];
+        long grao = quantidade / ((long)w * 8) > 0 ? quantidade / ((long)w * 8) : 1;
+        Escalonador escalonador;
+        ConjuntoPistas conjunto;
+        iniciarEscalonador(&escalonador, w);
+        iniciarConjuntoPistas(&conjunto);
+        carga.conjunto = &conjunto;
+        carga.arvore = NULL;
+
+        long long t0 = agoraMs();
+        paraCadaParalelo(&escalonador, 0, quantidade, grao, inserirFatiaConjunto, &carga);
+        long long t1 = agoraMs();
+        uint64_t inseridas = somarAcumulos(&carga.acumulo, w);
+        paraCadaParalelo(&escalonador, 0, quantidade, grao, buscarFatiaConjunto, &carga);
+        long long t2 = agoraMs();
+        uint64_t achadas = somarAcumulos(&carga.acumulo, w);
+        paraCadaParalelo(&escalonador, 0, quantidade, grao, inserirFatiaArvore, &carga);
+        long long t3 = agoraMs();
+
+        /* Cada pista inserida exatamente uma vez; a foto sai ordenada e igual à BST */
+        long total;
+        const char** foto = fotografarConjuntoPistas(&conjunto, &total);
+        if ((long)inseridas != distintas || (long)achadas != quantidade || total != distintas ||
+            tamanhoPistas(carga.arvore) != distintas)
+            divergencias++;
+        for (long i = 1; i < total; ++i)
+            if (strcmp(foto[i - 1], foto[i]) >= 0) divergencias++;
+        free(foto);
+
+        double taxa = t1 > t0 ? (double)quantidade / (double)(t1 - t0) / 1000.0 : 0.0;
+        if (c == 0) base = taxa;
+        printf("  %7d %16.2f %10.2fx %19.2f %14.2f\n", w, taxa, base > 0.0 ? taxa / base : 0.0,
+               t3 > t2 ? (double)quantidade / (double)(t3 - t2) / 1000.0 : 0.0,
+               t2 > t1 ? (double)quantidade / (double)(t2 - t1) / 1000.0 : 0.0);
+
+        liberarPistas(carga.arvore);
+        liberarConjuntoPistas(&conjunto);
+        encerrarEscalonador(&escalonador);
+    }
+    printf("\nConjunto consistente (inserções únicas, foto ordenada): %s\n", divergencias ? "NÃO (DIVERGÊNCIAS!)" : "sim");
+
+    pthread_mutex_destroy(&carga.trava);
+    free(carga.textos);
+    free(ordem);
+    free(carga.acumulo.somas);
 }
 
-int hash(const char* pista) {
-    unsigned int soma = 0;
-    for (const unsigned char* p = (const unsigned char*)pista; *p != '\0'; ++p)
-        soma += *p;
-    return (int)(soma % (unsigned int)TAM_HASH);
+typedef struct {
+    TabelaSuspeitosRCU* tabela;
+    pthread_rwlock_t trava;        /* comparação: as mesmas operações atrás de uma trava de leitura/escrita */
+    int comTrava;
+    char (*pistas)[32];
+    long totalPistas;
+    long consultas;
+    long fatias;                   /* fatias de leitura (tarefas 1..fatias; a 0 é a escrita) */
+    long atualizacoes;             /* feitas pela tarefa 0 */
+    long long msEscrita;
+    AcumuloBench acumulo;          /* respostas inválidas por trabalhador */
+} CargaRCU;
+
+static void atualizarRCUBench(CargaRCU* c, long j, int* suspeitoFinal) {
+    char texto[MAX_PISTA], nome[MAX_NOME];
+
+    if (c->comTrava) pthread_rwlock_wrlock(&c->trava);
+    if (j % 8 == 7) {
+        /* Pistas extras entram e saem (forçam crescimento e remoções) */
+        snprintf(texto, sizeof(texto), "Pista extra %ld", j % 64);
+        if (!removerPistaRCU(c->tabela, texto)) publicarSuspeitoRCU(c->tabela, texto, "Suspeito 0");
+    } else {
+        long p = (j * 7919) % c->totalPistas;
+        int s = (int)((p + j) % 16);
+        snprintf(nome, sizeof(nome), "Suspeito %d", s);
+        publicarSuspeitoRCU(c->tabela, c->pistas[p], nome);
+        if (suspeitoFinal) suspeitoFinal[p] = s;
+    }
+    if (c->comTrava) pthread_rwlock_unlock(&c->trava);
 }
 
-void inserirNaHash(SuspeitoNode* tabela[], const char* pista, const char* suspeito) {
-    if (!pista || !suspeito) return;
+static void tarefaRCUBench(void* arg, long de, long ate) {
+    CargaRCU* c = (CargaRCU*) arg;
+    char nome[MAX_NOME];
 
-    int idx = hash(pista);
-    SuspeitoNode* novo = (SuspeitoNode*) malloc(sizeof(SuspeitoNode));
-    if (!novo) {
-        fprintf(stderr, "Erro: falha na alocação de memória para SuspeitoNode\n");
+    for (long t = de; t < ate; ++t) {
+        if (t == 0) {
+            long long t0 = agoraMs();
+            for (long j = 0; j < c->atualizacoes; ++j) atualizarRCUBench(c, j, NULL);
+            c->msEscrita = agoraMs() - t0;
+            continue;
+        }
+        long inicio = c->consultas * (t - 1) / c->fatias, fim = c->consultas * t / c->fatias;
+        uint64_t erros = 0;
+        for (long k = inicio; k < fim; ++k) {
+            const char* pista = c->pistas[(uint64_t)k * 2654435761u % (uint64_t)c->totalPistas];
+            if (c->comTrava) pthread_rwlock_rdlock(&c->trava);
+            encontrarSuspeitoRCU(c->tabela, pista, nome);
+            if (c->comTrava) pthread_rwlock_unlock(&c->trava);
+            /* Pistas base nunca somem: a resposta é sempre um suspeito de alguma versão */
+            if (strncmp(nome, "Suspeito ", 9) != 0) erros++;
+        }
+        c->acumulo.somas[trabalhadorAtual()].soma += erros;
+    }
+}
+
+void benchRCU(long quantidade) {
+    static const char* cenarios[] = { "RCU, sem escrita", "RCU + escritor", "rwlock + escritor" };
+    const long totalPistas = 4096, atualizacoes = 2000;
+    char nome[MAX_NOME];
+    CargaRCU carga;
+
+    carga.pistas = (char (*)[32]) malloc(sizeof(*carga.pistas) * (size_t)totalPistas);
+    int* suspeitoFinal = (int*) malloc(sizeof(int) * (size_t)totalPistas);
+    int nucleos = numeroDeNucleos();
+    int configuracoes[3] = { 1, nucleos, nucleos < 4 ? 4 : 2 * nucleos };
+    carga.acumulo.somas = (SomaTrabalhador*) calloc((size_t)configuracoes[2], sizeof(SomaTrabalhador));
+    carga.acumulo.fatias = NULL;
+    if (!carga.pistas || !suspeitoFinal || !carga.acumulo.somas) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
         exit(EXIT_FAILURE);
     }
-    strncpy(novo->pista, pista, MAX_PISTA - 1);
-    novo->pista[MAX_PISTA - 1] = '\0';
-    strncpy(novo->suspeito, suspeito, MAX_NOME - 1);
-    novo->suspeito[MAX_NOME - 1] = '\0';
+    for (long p = 0; p < totalPistas; ++p) snprintf(carga.pistas[p], sizeof(carga.pistas[p]), "Pista %ld", p);
+    carga.totalPistas = totalPistas;
+    carga.consultas = quantidade;
+    pthread_rwlock_init(&carga.trava, NULL);
 
-    novo->prox = tabela[idx];
-    tabela[idx] = novo;
+    printf("Consultas: %ld sobre %ld pistas; escritor: %ld atualizações; núcleos: %d\n",
+           quantidade, totalPistas, atualizacoes, nucleos);
+    long divergencias = 0;
+    for (int c = 0; c < 3; ++c) {
+        if (c == 1 && nucleos == 1) continue;   /* igual à configuração 0 */
+        int w = configuracoes[c];
+        Escalonador escalonador;
+        iniciarEscalonador(&escalonador, w);
+        printf("\n%d trabalhador(es):\n", w);
+
+        for (int cenario = 0; cenario < 3; ++cenario) {
+            TabelaSuspeitosRCU tabela;
+            iniciarTabelaSuspeitosRCU(&tabela, NULL);
+            for (long p = 0; p < totalPistas; ++p) {
+                suspeitoFinal[p] = (int)(p % 16);
+                snprintf(nome, sizeof(nome), "Suspeito %d", suspeitoFinal[p]);
+                publicarSuspeitoRCU(&tabela, carga.pistas[p], nome);
+            }
+            carga.tabela = &tabela;
+            carga.comTrava = cenario == 2;
+            carga.atualizacoes = cenario == 0 ? 0 : atualizacoes;
+            carga.msEscrita = 0;
+            carga.fatias = (long)w * 8;
+            long periodos = atomic_load(&tabela.rcu.periodos), redimensionamentos = tabela.redimensionamentos;
+
+            long long t0 = agoraMs();
+            paraCadaParalelo(&escalonador, cenario == 0 ? 1 : 0, carga.fatias + 1, 1, tarefaRCUBench, &carga);
+            long long ms = agoraMs() - t0;
+            uint64_t erros = somarAcumulos(&carga.acumulo, w);
+
+            /* Depois da escrita, cada pista base tem o suspeito da última atualização */
+            carga.comTrava = 0;
+            for (long j = 0; j < carga.atualizacoes; ++j)
+                if (j % 8 != 7) suspeitoFinal[(j * 7919) % totalPistas] = (int)(((j * 7919) % totalPistas + j) % 16);
+            for (long p = 0; p < totalPistas; ++p) {
+                char esperado[MAX_NOME];
+                snprintf(esperado, sizeof(esperado), "Suspeito %d", suspeitoFinal[p]);
+                if (strcmp(encontrarSuspeitoRCU(&tabela, carga.pistas[p], nome), esperado) != 0) erros++;
+            }
+            divergencias += (long)erros;
+
+            printf("  %-18s %8.2f M consultas/s", cenarios[cenario],
+                   ms > 0 ? (double)quantidade / (double)ms / 1000.0 : 0.0);
+            if (carga.atualizacoes)
+                printf("  escrita: %.1f us/atualização, %ld período(s) de graça, %ld redimensionamento(s)",
+                       1000.0 * (double)carga.msEscrita / (double)carga.atualizacoes,
+                       atomic_load(&tabela.rcu.periodos) - periodos, tabela.redimensionamentos - redimensionamentos);
+            printf("%s\n", erros ? "  (DIVERGÊNCIAS!)" : "");
+            liberarTabelaSuspeitosRCU(&tabela);
+        }
+        encerrarEscalonador(&escalonador);
+    }
+    printf("\nRespostas sempre válidas e estado final correto: %s\n", divergencias ? "NÃO (DIVERGÊNCIAS!)" : "sim");
+
+    pthread_rwlock_destroy(&carga.trava);
+    free(carga.pistas);
+    free(suspeitoFinal);
+    free(carga.acumulo.somas);
 }
 
-const char* encontrarSuspeito(SuspeitoNode* tabela[], const char* pista) {
-    if (!pista) return "Desconhecido";
-    int idx = hash(pista);
-    SuspeitoNode* cur = tabela[idx];
-    while (cur) {
-        if (strcmp(cur->pista, pista) == 0) return cur->suspeito;
-        cur = cur->prox;
+typedef struct {
+    long long passos, ns, fixacaoNs, sessoes;
+    long long faixas[64];          /* passos por faixa de 2^k ns (para o p99) */
+    long erros;
+    char folga[64];
+} EstatisticaRecarga;
+
+typedef struct {
+    CatalogoCasos* catalogo;
+    long sessoes, fatias;
+    int recargas;                  /* publicações feitas pela tarefa 0 */
+    int relendo;                   /* 1 = as recargas releem o arquivo (SIGHUP), 0 = casos em memória */
+    EstatisticaRecarga* estatisticas;
+} CargaRecarga;
+
+static void sessaoRecargaBench(CargaRecarga* c, long sessao, EstatisticaRecarga* e) {
+    long long t0 = agoraNs();
+    VersaoCaso* versao = fixarCaso(c->catalogo);
+    e->fixacaoNs += agoraNs() - t0;
+
+    const Caso* caso = &versao->caso;
+    uint32_t assinatura = caso->assinatura;
+    uint64_t sorteio = 0x9E3779B97F4A7C15ULL * (uint64_t)(sessao + 1);
+    int sala = caso->mansao->id, suspeitas = 0;
+
+    /* Passo como o de explorarMansao: escolhe a porta, entra e consulta o suspeito da pista */
+    for (int passo = 0; passo < SIMULACAO_MAX_PASSOS; ++passo) {
+        long long inicio = agoraNs();
+        int portas = caso->inicioPortas[sala + 1] - caso->inicioPortas[sala];
+        if (portas == 0) break;
+        sorteio ^= sorteio << 13;
+        sorteio ^= sorteio >> 7;
+        sorteio ^= sorteio << 17;
+        sala = caso->destinoPortas[caso->inicioPortas[sala] + (int)(sorteio % (uint64_t)portas)];
+        const Sala* atual = caso->salasPorId[sala];
+        if (atual->pista[0] != '\0' && buscarNaHash((SuspeitoNode**) caso->tabela, atual->pista)) suspeitas++;
+        long long ns = agoraNs() - inicio;
+        e->passos++;
+        e->ns += ns;
+        e->faixas[ns > 0 ? 63 - __builtin_clzll((unsigned long long)ns) : 0]++;
     }
-    return "Desconhecido";
+    /* A versão fixada não pode ter mudado nem sumido durante a sessão */
+    if (caso->assinatura != assinatura || suspeitas > SIMULACAO_MAX_PASSOS) e->erros++;
+    e->sessoes++;
+    t0 = agoraNs();
+    soltarCaso(versao);            /* a última sessão de uma versão antiga paga a liberação */
+    e->fixacaoNs += agoraNs() - t0;
 }
 
-void liberarHash(SuspeitoNode* tabela[]) {
-    for (int i = 0; i < TAM_HASH; ++i) {
-        SuspeitoNode* cur = tabela[i];
-        while (cur) {
-            SuspeitoNode* tmp = cur;
-            cur = cur->prox;
-            free(tmp);
+static void tarefaRecargaBench(void* arg, long de, long ate) {
+    CargaRecarga* c = (CargaRecarga*) arg;
+    EstatisticaRecarga* e = &c->estatisticas[trabalhadorAtual()];
+
+    for (long t = de; t < ate; ++t) {
+        if (t == 0) {
+            for (int r = 0; r < c->recargas; ++r) {
+#ifndef _WIN32
+                if (c->relendo) {
+                    /* Como um operador: SIGHUP e espera a thread do catálogo terminar a releitura */
+                    int antes = atomic_load(&c->catalogo->publicadas) + atomic_load(&c->catalogo->falhas);
+                    kill(getpid(), SIGHUP);
+                    while (atomic_load(&c->catalogo->publicadas) + atomic_load(&c->catalogo->falhas) == antes)
+                        sched_yield();
+                    continue;
+                }
+#endif
+                Caso caso;
+                if (r % 2) montarCasoPadrao(&caso);
+                else gerarCasoCandidato(&caso, GERADOR_SEMENTE + (uint64_t)r);
+                if (!publicarCaso(c->catalogo, &caso)) liberarCaso(&caso);
+                sched_yield();
+            }
+            continue;
         }
-        tabela[i] = NULL;
+        for (long s = c->sessoes * (t - 1) / c->fatias; s < c->sessoes * t / c->fatias; ++s)
+            sessaoRecargaBench(c, s, e);
     }
 }
 
-/* ----------------- Verificação final ----------------- */
+void benchRecarga(const char* arquivo, long quantidade) {
+    static const char* cenarios[] = { "sem recarga", "com recarga", "relendo" };
+    int nucleos = numeroDeNucleos(), w = nucleos < 4 ? 4 : nucleos, totalCenarios = 2, releituras = 50;
+    Escalonador escalonador;
+    CargaRecarga carga;
+    char temporario[] = "/tmp/detetive_quest_recargaXXXXXX";
 
-int contarPistasPorSuspeitoNaBST(SuspeitoNode* tabela[], PistaNode* raizPistas, const char* suspeito) {
-    if (!raizPistas) return 0;
+#ifndef _WIN32
+    /* Sem --caso, a releitura usa o primeiro caso gerado válido, gravado num arquivo temporário */
+    if (!arquivo) {
+        Caso gerado;
+        AvaliacaoCaso avaliacao;
+        int descritor = mkstemp(temporario);
+        for (uint64_t semente = GERADOR_SEMENTE;; ++semente) {
+            gerarCasoCandidato(&gerado, semente);
+            if (avaliarCaso(&gerado, &avaliacao) == 1 || semente == GERADOR_SEMENTE + 1000) break;
+            liberarCaso(&gerado);
+        }
+        if (descritor >= 0) {
+            close(descritor);
+            if (gravarCaso(&gerado, temporario)) arquivo = temporario;
+            else unlink(temporario);
+        }
+        liberarCaso(&gerado);
+    }
+    if (arquivo) totalCenarios = 3;
+    else printf("(Cenário de releitura indisponível: não foi possível gravar o caso temporário.)\n");
+#endif
 
-    int contador = 0;
+    carga.estatisticas = (EstatisticaRecarga*) malloc(sizeof(EstatisticaRecarga) * (size_t)w);
+    if (!carga.estatisticas) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+    carga.sessoes = quantidade;
+    carga.fatias = (long)w * 8;
+    iniciarEscalonador(&escalonador, w);
 
-    /* Função interna recursiva */
-    struct Aux {
-        SuspeitoNode** tabela;
-        const char* suspeito;
-    } aux_data;
-    aux_data.tabela = tabela;
-    aux_data.suspeito = suspeito;
+    printf("Sessões: %ld (até %d portas cada), %d trabalhador(es), núcleos: %d\n",
+           quantidade, SIMULACAO_MAX_PASSOS, w, nucleos);
+    printf("  Cenário        Sessões/s  Passo médio  Passo p99   Fixar+soltar  Versões (publ./liberadas)\n");
+    long erros = 0;
+    for (int cenario = 0; cenario < totalCenarios; ++cenario) {
+        CatalogoCasos catalogo;
+        Caso inicial;
+        if (cenario < 2) montarCasoPadrao(&inicial);
+        else if (!carregarCaso(&inicial, arquivo)) {
+            erros++;
+            break;
+        }
+        if (!iniciarCatalogoCasos(&catalogo, &inicial, cenario < 2 ? NULL : arquivo)) {
+            fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+            liberarCaso(&inicial);
+            erros++;
+            break;
+        }
+        if (cenario == 2 && !ativarRecargaPorSinal(&catalogo)) {
+            printf("  %-12s (recarga por SIGHUP indisponível)\n", cenarios[cenario]);
+            encerrarCatalogoCasos(&catalogo);
+            break;
+        }
+        memset(carga.estatisticas, 0, sizeof(EstatisticaRecarga) * (size_t)w);
+        carga.catalogo = &catalogo;
+        carga.recargas = cenario == 0 ? 0 : cenario == 1 ? 200 : releituras;
+        carga.relendo = cenario == 2;
 
-    /* Usamos uma função recursiva local via ponteiro para função */
-    int contadorRec(PistaNode* node) {
-        if (!node) return 0;
-        int c = 0;
-        c += contadorRec(node->esquerda);
-        const char* s = encontrarSuspeito(tabela, node->pista);
-        if (strcmp(s, suspeito) == 0) c++;
-        c += contadorRec(node->direita);
-        return c;
+        long long t0 = agoraMs();
+        paraCadaParalelo(&escalonador, cenario == 0 ? 1 : 0, carga.fatias + 1, 1, tarefaRecargaBench, &carga);
+        long long ms = agoraMs() - t0;
+
+        EstatisticaRecarga soma;
+        memset(&soma, 0, sizeof(soma));
+        for (int i = 0; i < w; ++i) {
+            EstatisticaRecarga* e = &carga.estatisticas[i];
+            soma.passos += e->passos;
+            soma.ns += e->ns;
+            soma.fixacaoNs += e->fixacaoNs;
+            soma.sessoes += e->sessoes;
+            soma.erros += e->erros;
+            for (int k = 0; k < 64; ++k) soma.faixas[k] += e->faixas[k];
+        }
+        long long acumulado = 0, p99 = 0;
+        for (int k = 0; k < 64; ++k) {
+            acumulado += soma.faixas[k];
+            if (acumulado * 100 >= soma.passos * 99) {
+                p99 = 2LL << k;   /* limite superior da faixa */
+                break;
+            }
+        }
+        int publicadas = atomic_load(&catalogo.publicadas), falhas = atomic_load(&catalogo.falhas);
+        encerrarCatalogoCasos(&catalogo);
+        int liberadas = atomic_load(&catalogo.liberadas);
+        if (soma.sessoes != quantidade || soma.erros || liberadas != publicadas) erros++;
+        if (cenario == 2 && (falhas || publicadas != carga.recargas + 1)) erros++;
+
+        printf("  %-12s %11.0f %9.0f ns %7lld ns %11.0f ns %12d / %d\n", cenarios[cenario],
+               ms > 0 ? 1000.0 * (double)soma.sessoes / (double)ms : 0.0,
+               soma.passos ? (double)soma.ns / (double)soma.passos : 0.0, p99,
+               soma.sessoes ? (double)soma.fixacaoNs / (double)soma.sessoes : 0.0, publicadas, liberadas);
     }
+    if (totalCenarios == 3) printf("  (relendo: %d x SIGHUP -> recarregarCaso('%s'))\n", releituras, arquivo);
+    printf("\nSessões íntegras e todas as versões liberadas: %s\n", erros ? "NÃO (DIVERGÊNCIAS!)" : "sim");
 
-    /* chamar recursiva */
-    contador = contadorRec(raizPistas);
-    return contador;
+#ifndef _WIN32
+    if (arquivo == temporario) unlink(temporario);
+#endif
+    encerrarEscalonador(&escalonador);
+    free(carga.estatisticas);
 }
 
-void verificarSuspeitoFinal(SuspeitoNode* tabela[], PistaNode* raizPistas) {
-    char nome[MAX_NOME];
+typedef struct {
+    Caso* caso;
+    PlanejadorRotas* rotas;            /* um por trabalhador, montado na primeira tarefa dele */
+    PlanejadorEvidencias* evidencias;
+    atomic_long comandos, erros;
+} CargaLatencia;
 
-    printf("\n========================================================\n");
-    printf("                      FASE FINAL - ACUSAÇÃO\n");
-    printf("========================================================\n\n");
+/* Mansão grande: suspeitos 0-5 com poucas salas (dica exata), 6 e 7 com muitas (estimativa) */
+static void montarCasoLatencia(Caso* caso) {
+    unsigned long semente = 0x1A7E2025UL;
+    char pista[MAX_PISTA], suspeito[MAX_NOME];
 
-    printf("Suspeitos conhecidos: Jardineiro, Governanta, Madame Sinclair\n");
-    printf("Digite o nome do suspeito a ser acusado: ");
-    if (fgets(nome, sizeof(nome), stdin) == NULL) {
-        printf("Entrada inválida.\n");
+    inicializarCaso(caso, gerarMansaoAleatoria(LATENCIA_SALAS, &semente));
+    for (int i = 0; i < LATENCIA_PISTAS; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        Sala* sala = caso->salasPorId[(semente >> 33) % (unsigned long)caso->totalSalas];
+        snprintf(pista, sizeof(pista), "Pista sintética %d", i);
+        snprintf(suspeito, sizeof(suspeito), "Suspeito %d", i < 48 ? i % 6 : 6 + i % 2);
+        strcpy(sala->pista, pista);
+        cadastrarPista(caso, pista, suspeito);
+    }
+    int rotulo = registrarRotulo(caso, "corredor");
+    for (int i = 0; i < caso->totalSalas; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        adicionarPorta(caso, (int)((semente >> 33) % (unsigned long)caso->totalSalas),
+                       (int)((semente >> 13) % (unsigned long)caso->totalSalas), rotulo,
+                       1 + (int)((semente >> 7) % 9));
+    }
+    construirPortas(caso);
+}
+
+/* Uma sessão curta como a de um jogador: anda, lista, busca, pede rota e dica, grava e acusa */
+static void sessaoLatenciaBench(CargaLatencia* c, long numero, PlanejadorRotas* rotas,
+                                PlanejadorEvidencias* evidencias, unsigned char* estado, size_t capacidade) {
+    Caso* caso = c->caso;
+    Sessao sessao;
+    uint64_t sorteio = 0x9E3779B97F4A7C15ULL * (uint64_t)(numero + 1);
+    long erros = 0;
+
+    if (iniciarSessao(&sessao, caso) != SESSAO_OK) {
+        atomic_fetch_add(&c->erros, 1);
         return;
     }
-    nome[strcspn(nome, "\n")] = '\0'; /* remove newline */
+    entrarNaSala(caso, &sessao, caso->mansao);
+    for (int i = 0; i < LATENCIA_COMANDOS_POR_SESSAO; ++i) {
+        sorteio ^= sorteio << 13;
+        sorteio ^= sorteio >> 7;
+        sorteio ^= sorteio << 17;
+        int tipo = (int)(sorteio % 100);
+        long long inicio = inicioComando();
 
-    if (nome[0] == '\0') {
-        printf("Nenhum nome informado. Acusação abortada.\n");
+        if (tipo < 60) {
+            int portas = portasDaSala(caso, sessao.atual);
+            int r = portas ? atravessarPorta(caso, &sessao, (int)((sorteio >> 8) % (uint64_t)portas))
+                           : voltarSessao(caso, &sessao);
+            if (r < 0) erros++;
+            registrarComando(COMANDO_MOVER, inicio);
+        } else if (tipo < 75) {
+            int n = 0;
+            retomarIteradorPistas(&sessao.listagem, sessao.pistas);
+            while (n < PISTAS_POR_PAGINA && proximaPista(&sessao.listagem)) n++;
+            if (n < PISTAS_POR_PAGINA) iniciarIteradorPistas(&sessao.listagem, NULL, NULL);
+            registrarComando(COMANDO_LISTAR, inicio);
+        } else if (tipo < 90) {
+            const char* achadas[PISTAS_POR_PAGINA];
+            char prefixo[4] = "";
+            if (caso->totalPistas > 0) {
+                const char* pista = caso->pistasPorId[(sorteio >> 8) % (uint64_t)caso->totalPistas]->pista;
+                snprintf(prefixo, sizeof(prefixo), "%.3s", pista);
+            }
+            if (listarPorPrefixo(caso->prefixos, prefixo, achadas, PISTAS_POR_PAGINA) == 0 && prefixo[0]) erros++;
+            registrarComando(COMANDO_BUSCAR, inicio);
+        } else if (tipo < 95) {
+            /* 'r': o que exibirRota() calcula, sem a impressão */
+            const Sala* destino = buscarSala(caso, caso->salasPorId[(sorteio >> 8) % (uint64_t)caso->totalSalas]->nome);
+            if (!destino || rotaMaisRapida(rotas, sessao.atual->id, destino->id, rotas->caminho,
+                                           caso->totalSalas + 1, NULL) == SESSAO_ERRO_MEMORIA) erros++;
+            registrarComando(COMANDO_PLANEJAR, inicio);
+        } else {
+            /* 'c': o que exibirDica() calcula para um suspeito */
+            int ordem[PISTAS_PARA_CONDENAR];
+            if (caso->totalSuspeitos > 0
+                && planejarEvidencias(evidencias, &sessao, (int)((sorteio >> 8) % (uint64_t)caso->totalSuspeitos),
+                                      PISTAS_PARA_CONDENAR, ordem, PISTAS_PARA_CONDENAR, NULL) == SESSAO_ERRO_MEMORIA)
+                erros++;
+            registrarComando(COMANDO_PLANEJAR, inicio);
+        }
+    }
+
+    long long inicio = inicioComando();
+    if (serializarSessao(caso, &sessao, estado, capacidade) == 0) erros++;
+    registrarComando(COMANDO_GRAVAR, inicio);
+
+    if (caso->totalSuspeitos > 0) {
+        inicio = inicioComando();
+        avaliarAcusacao(caso, &sessao, caso->suspeitosPorId[(sorteio >> 8) % (uint64_t)caso->totalSuspeitos]->nome);
+        registrarComando(COMANDO_ACUSAR, inicio);
+    }
+
+    liberarSessao(&sessao);
+    atomic_fetch_add(&c->comandos, LATENCIA_COMANDOS_POR_SESSAO + 2);
+    if (erros) atomic_fetch_add(&c->erros, erros);
+}
+
+static void tarefaLatenciaBench(void* arg, long de, long ate) {
+    CargaLatencia* c = (CargaLatencia*) arg;
+    int w = trabalhadorAtual() < 0 ? 0 : trabalhadorAtual();
+    size_t capacidade = tamanhoMaximoSessao(c->caso);
+    unsigned char* estado = (unsigned char*) malloc(capacidade);
+
+    if (!estado) {
+        atomic_fetch_add(&c->erros, ate - de);
         return;
     }
+    if (!c->rotas[w].caso) {
+        iniciarPlanejador(&c->rotas[w], c->caso);
+        iniciarPlanejadorEvidencias(&c->evidencias[w], c->caso, &c->rotas[w]);
+    }
+    for (long s = de; s < ate; ++s) sessaoLatenciaBench(c, s, &c->rotas[w], &c->evidencias[w], estado, capacidade);
+    free(estado);
+}
 
-    /* Conta quantas pistas coletadas apontam para este suspeito */
-    int total = contarPistasPorSuspeitoNaBST(tabela, raizPistas, nome);
+void benchLatencia(Caso* caso, long quantidade) {
+    Escalonador* escalonador = escalonadorGlobal();
+    CargaLatencia carga;
+    Caso sintetico;
 
-    if (total >= 2) {
-        printf("\n✅ Acusação confirmada! '%s' é considerado culpado (evidências: %d pistas).\n", nome, total);
-    } else if (total > 0) {
-        printf("\n⚠️ Acusação frágil: '%s' tem somente %d pista(s) coletada(s) relacionada(s).\n", nome, total);
-        printf("São necessárias ao menos 2 pistas para confirmação.\n");
-    } else {
-        printf("\n❌ Acusação sem fundamento: nenhuma pista coletada aponta para '%s'.\n", nome);
+    if (!caso) {
+        montarCasoLatencia(&sintetico);
+        caso = &sintetico;
     }
+    carga.caso = caso;
+    carga.rotas = (PlanejadorRotas*) calloc((size_t)escalonador->total, sizeof(PlanejadorRotas));
+    carga.evidencias = (PlanejadorEvidencias*) calloc((size_t)escalonador->total, sizeof(PlanejadorEvidencias));
+    if (!carga.rotas || !carga.evidencias) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        free(carga.rotas);
+        free(carga.evidencias);
+        if (caso == &sintetico) liberarCaso(&sintetico);
+        return;
+    }
+    atomic_init(&carga.comandos, 0);
+    atomic_init(&carga.erros, 0);
 
-    /* Exibir quais pistas coletadas apontam para cada suspeito (opcional, informativo) */
-    printf("\nResumo das pistas coletadas e seus suspeitos (baseado em tabela):\n");
-    exibirPistas(raizPistas);
-    printf("\nAssociações (pista -> suspeito):\n");
-    for (int i = 0; i < TAM_HASH; ++i) {
-        SuspeitoNode* cur = tabela[i];
-        while (cur) {
-            printf(" - \"%s\" -> %s\n", cur->pista, cur->suspeito);
-            cur = cur->prox;
+    printf("Sessões: %ld (%d comandos + gravar + acusar cada), %d trabalhador(es), salas: %d\n",
+           quantidade, LATENCIA_COMANDOS_POR_SESSAO, escalonador->total, caso->totalSalas);
+    long long t0 = agoraMs();
+    paraCadaParalelo(escalonador, 0, quantidade, 64, tarefaLatenciaBench, &carga);
+    long long ms = agoraMs() - t0;
+
+    long comandos = atomic_load(&carga.comandos);
+    printf("Comandos: %ld em %lld ms (%.0f comandos/s)\n\n", comandos, ms,
+           ms > 0 ? 1000.0 * (double)comandos / (double)ms : 0.0);
+    escreverEstatisticas(stdout);
+    printf("\nTodas as sessões concluídas sem erro: %s\n", atomic_load(&carga.erros) ? "NÃO (ERROS!)" : "sim");
+
+    for (int w = 0; w < escalonador->total; ++w)
+        if (carga.rotas[w].caso) {
+            liberarPlanejadorEvidencias(&carga.evidencias[w]);
+            liberarPlanejador(&carga.rotas[w]);
         }
+    free(carga.rotas);
+    free(carga.evidencias);
+    if (caso == &sintetico) liberarCaso(&sintetico);
+}
+
+void benchLCA(long quantidade) {
+    const long totalConsultas = 4000000L;
+    unsigned long semente = 42UL;
+    IndiceLCA indice;
+    Caso caso;
+
+    inicializarCaso(&caso, gerarMansaoAleatoria(quantidade, &semente));
+
+    long long t0 = agoraMs();
+    construirIndiceLCA(&indice, &caso);
+    long long t1 = agoraMs();
+
+    ConsultaLCA* consultas = (ConsultaLCA*) malloc(sizeof(ConsultaLCA) * (size_t)totalConsultas);
+    int* esperado = (int*) malloc(sizeof(int) * (size_t)totalConsultas);
+    char* passos = (char*) malloc((size_t)caso.totalSalas + 1);
+    if (!consultas || !esperado || !passos) {
+        fprintf(stderr, "Erro: memória insuficiente para o benchmark\n");
+        free(consultas); free(esperado); free(passos);
+        liberarIndiceLCA(&indice);
+        liberarCaso(&caso);
+        return;
+    }
+    for (long i = 0; i < totalConsultas; ++i) {
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        consultas[i].a = (int)((semente >> 33) % (unsigned long)caso.totalSalas);
+        semente = semente * 6364136223846793005UL + 1442695040888963407UL;
+        consultas[i].b = (int)((semente >> 33) % (unsigned long)caso.totalSalas);
+    }
+
+    long long t2 = agoraMs();
+    responderConsultasLCA(&indice, consultas, totalConsultas, 1);
+    long long t3 = agoraMs();
+    for (long i = 0; i < totalConsultas; ++i) esperado[i] = consultas[i].ancestral;
+
+    /* O lote paralelo roda no escalonador global: é o número dele que vale, não o de núcleos */
+    int trabalhadores = escalonadorGlobal()->total;
+    long long t4 = 0, t5 = 0;
+    if (trabalhadores > 1) {
+        t4 = agoraMs();
+        responderConsultasLCA(&indice, consultas, totalConsultas, trabalhadores);
+        t5 = agoraMs();
+    }
+
+    long divergencias = 0;
+    for (long i = 0; i < totalConsultas; ++i)
+        if (consultas[i].ancestral != esperado[i]) divergencias++;
+    for (long i = 0; i < totalConsultas && i < 1000; ++i) {
+        int n = rotaEntreSalas(caso.salasPorId[consultas[i].a], caso.salasPorId[consultas[i].b],
+                               passos, caso.totalSalas);
+        if (n != consultas[i].distancia) divergencias++;
     }
+
+    printf("Salas: %d (%d níveis na sparse table)\n", caso.totalSalas, indice.totalNiveis);
+    printf("Construção:          %6lld ms\n", t1 - t0);
+    printf("Consultas:           %ld\n", totalConsultas);
+    printf("Sequencial:          %6lld ms (%.1f ns/consulta, 1 trabalhador)\n", t3 - t2,
+           1e6 * (double)(t3 - t2) / (double)totalConsultas);
+    if (trabalhadores > 1)
+        printf("Paralelo:            %6lld ms (%.1f ns/consulta, %d trabalhadores, %.2fx)\n", t5 - t4,
+               1e6 * (double)(t5 - t4) / (double)totalConsultas, trabalhadores,
+               t5 > t4 ? (double)(t3 - t2) / (double)(t5 - t4) : 0.0);
+    else
+        printf("Paralelo:            omitido (1 trabalhador)\n");
+    if (divergencias) printf("DIVERGÊNCIAS: %ld\n", divergencias);
+
+    free(passos);
+    free(esperado);
+    free(consultas);
+    liberarIndiceLCA(&indice);
+    liberarCaso(&caso);
 }
 
 /* ======================================================================== */
@@ -581,6 +11793,16 @@ void limparBufferEntrada(void) {
     while ((c = getchar()) != '\n' && c != EOF) { /* descarta */ }
 }
 
+long long agoraMs(void) {
+#ifdef _WIN32
+    return (long long)clock() * 1000 / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
 void limparTela(void) {
 #ifdef _WIN32
     system("cls");